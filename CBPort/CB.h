@@ -59,26 +59,32 @@
 
 
 // Hide some of the code to make Logging cleaner
+// The logger handle is cached, and the arguments are only evaluated if the level is enabled
+inline const odc::LogHandle& CBPortLog()
+{
+	static const odc::LogHandle handle("CBPort");
+	return handle;
+}
 #define LOGTRACE(...) \
-	if (auto log = odc::spdlog_get("CBPort")) \
+	if (auto log = CBPortLog().ForLevel(spdlog::level::trace)) \
 		log->trace(__VA_ARGS__);
 #define LOGDEBUG(...) \
-	if (auto log = odc::spdlog_get("CBPort")) \
+	if (auto log = CBPortLog().ForLevel(spdlog::level::debug)) \
 		log->debug(__VA_ARGS__);
 #define LOGERROR(...) \
-	if (auto log = odc::spdlog_get("CBPort")) \
+	if (auto log = CBPortLog().ForLevel(spdlog::level::err)) \
 		log->error(__VA_ARGS__);
 #define LOGWARN(...) \
-	if (auto log = odc::spdlog_get("CBPort"))  \
+	if (auto log = CBPortLog().ForLevel(spdlog::level::warn)) \
 		log->warn(__VA_ARGS__);
 #define LOGINFO(...) \
-	if (auto log = odc::spdlog_get("CBPort")) \
+	if (auto log = CBPortLog().ForLevel(spdlog::level::info)) \
 		log->info(__VA_ARGS__);
 
 void CommandLineLoggingSetup(spdlog::level::level_enum log_level);
 void CommandLineLoggingCleanup();
 
-typedef asio::basic_waitable_timer<std::chrono::steady_clock> Timer_t;
+typedef odc::steady_timer Timer_t;
 typedef std::shared_ptr<Timer_t> pTimer_t;
 
 typedef uint64_t CBTime; // msec since epoch, utc, most time functions are uint64_t
@@ -78,13 +78,14 @@ CBConnection::CBConnection
 {
 	pSockMan.reset(new TCPSocketManager<std::string>
 			(pIOS, IsServer, EndPoint, Port,
-			std::bind(&CBConnection::ReadCompletionHandler, this, std::placeholders::_1),
+			[this](const char* data, size_t len){ return ReadCompletionHandler(data,len); },
 			std::bind(&CBConnection::SocketStateHandler, this, std::placeholders::_1),
 			std::numeric_limits<size_t>::max(),
 			true,
 			retry_time_ms));
 
 	InternalChannelID = MakeChannelID(aEndPoint, aPort, aisServer);
+	pSockMan->SetOwner("CBConnection "+InternalChannelID);
 
 
 	LOGDEBUG("Opened an CBConnection object {} As a {} - {}",InternalChannelID, (IsServer ? "Server" : "Client"), (IsBakerDevice ? " Baker Device" : " Conitel Device"));
@@ -351,7 +352,8 @@ void CBConnection::InjectSimulatedTCPMessage(const ConnectionTokenType &Connecti
 	// Just pass to the Connection ReadCompletionHandler, as if it had come in from the TCP port
 	if (auto pConnection = ConnectionTok.pConnection)
 	{
-		pConnection->ReadCompletionHandler(readbuf);
+		const std::string data(asio::buffers_begin(readbuf.data()),asio::buffers_end(readbuf.data()));
+		readbuf.consume(pConnection->ReadCompletionHandler(data.data(),data.size()));
 	}
 	else
 	{
@@ -363,7 +365,7 @@ void CBConnection::InjectSimulatedTCPMessage(const ConnectionTokenType &Connecti
 // We do some basic CB block identification and processing, enough to give us complete blocks and StationAddresses
 // The TCPSocketManager class ensures that this callback is not called again with more data until it is complete.
 // Does not make sense for it to do anything else on a TCP stream which must (should) be sequentially processed.
-void CBConnection::ReadCompletionHandler(buf_t&readbuf)
+size_t CBConnection::ReadCompletionHandler(const char* data, size_t len)
 {
 	// We need to treat the TCP data as a stream, just like a serial stream. The first block (4 bytes) is probably the start block, but we cannot assume this.
 	// Also we could get more than one message in a TCP block so need to handle this correctly.
@@ -374,15 +376,14 @@ void CBConnection::ReadCompletionHandler(buf_t&readbuf)
 	if (!enabled)
 	{
 		LOGDEBUG("CBConnection called ReadCompletionHandler when not enabled - ignoring");
-		return;
+		return 0; // leave it for when we are
 	}
 
-	while (readbuf.size() > 0)
+	for (size_t i = 0; i < len; i++)
 	{
 		// Add another byte to our 4 byte block.
 
-		ReadCompletionHandlerCBblock.AddByteToBlock(static_cast<uint8_t>(readbuf.sgetc()));
-		readbuf.consume(1);
+		ReadCompletionHandlerCBblock.AddByteToBlock(static_cast<uint8_t>(data[i]));
 
 		if (ReadCompletionHandlerCBblock.IsValidBlock()) // Check checksum and B bit.
 		{
@@ -434,6 +435,8 @@ void CBConnection::ReadCompletionHandler(buf_t&readbuf)
 			// The block was not valid, we will push another byte in (and one out) and try again (think shifting 4 byte window)
 		}
 	}
+	// Everything goes into the block collector, so we've used it all
+	return len;
 }
 void CBConnection::RouteCBMessage(CBMessage_t &CompleteCBMessage)
 {
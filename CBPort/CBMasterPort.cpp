@@ -103,7 +103,7 @@ void CBMasterPort::Build()
 		PollScheduler.reset(new ASIOScheduler(*pIOS));
 
 	MasterCommandProtectedData.CurrentCommandTimeoutTimer = pIOS->make_steady_timer();
-	MasterCommandStrand = pIOS->make_strand();
+	MasterCommandStrand = pIOS->make_serial_executor(Name);
 
 	// Need a couple of things passed to the point table. SOEQueue not actually used.
 	MyPointConf->PointTable.Build(Name, IsOutStation, *pIOS, 5, SOEBufferOverflowFlag);
@@ -153,13 +153,15 @@ void CBMasterPort::SendCBMessage(const CBMessage_t& CompleteCBMessage)
 // If the callback gets an error it will be ignored which will result in a timeout and the next command being sent.
 // This is necessary if somehow we get an old command sent to us, or a left over broadcast message.
 // Only issue is if we do a broadcast message and can get information back from multiple sources... These commands are probably not used, and we will ignore them anyway.
-void CBMasterPort::QueueCBCommand(const CBMessage_t& CompleteCBMessage, SharedStatusCallback_t pStatusCallback)
+void CBMasterPort::QueueCBCommand(const CBMessage_t& CompleteCBMessage, SharedStatusCallback_t pStatusCallback, const HandlerPriority priority)
 {
 	MasterCommandStrand->dispatch([=]() // Tries to execute, if not able to will post.
 		{
-			if (MasterCommandProtectedData.MasterCommandQueue.size() < MasterCommandProtectedData.MaxCommandQueueSize)
+			// Controls have their own queue, so they don't wait behind (or get turned away by) a backlog of scans
+			auto& Queue = (priority == HandlerPriority::High) ? MasterCommandProtectedData.PriorityCommandQueue : MasterCommandProtectedData.MasterCommandQueue;
+			if (Queue.size() < MasterCommandProtectedData.MaxCommandQueueSize)
 			{
-			      MasterCommandProtectedData.MasterCommandQueue.push(MasterCommandQueueItem(CompleteCBMessage, pStatusCallback)); // async
+			      Queue.push(MasterCommandQueueItem(CompleteCBMessage, pStatusCallback)); // async
 			}
 			else
 			{
@@ -169,14 +171,14 @@ void CBMasterPort::QueueCBCommand(const CBMessage_t& CompleteCBMessage, SharedSt
 
 			// Will only send if we can - blockindex.e. not currently processing a command
 			UnprotectedSendNextMasterCommand(false);
-		});
+		},priority);
 }
 // Handle the many single block command messages better
-void CBMasterPort::QueueCBCommand(const CBBlockData& SingleBlockCBMessage, SharedStatusCallback_t pStatusCallback)
+void CBMasterPort::QueueCBCommand(const CBBlockData& SingleBlockCBMessage, SharedStatusCallback_t pStatusCallback, const HandlerPriority priority)
 {
 	CBMessage_t CommandCBMessage;
 	CommandCBMessage.push_back(SingleBlockCBMessage);
-	QueueCBCommand(CommandCBMessage, pStatusCallback);
+	QueueCBCommand(CommandCBMessage, pStatusCallback, priority);
 }
 
 
@@ -257,15 +259,17 @@ void CBMasterPort::UnprotectedSendNextMasterCommand(bool timeoutoccured)
 			}
 		}
 
-		if (!MasterCommandProtectedData.MasterCommandQueue.empty() && (MasterCommandProtectedData.ProcessingCBCommand != true))
+		// Controls go before anything else that is waiting.
+		auto& NextCommandQueue = MasterCommandProtectedData.PriorityCommandQueue.empty() ? MasterCommandProtectedData.MasterCommandQueue : MasterCommandProtectedData.PriorityCommandQueue;
+		if (!NextCommandQueue.empty() && (MasterCommandProtectedData.ProcessingCBCommand != true))
 		{
 			// Send the next command if there is one and we are not retrying.
 
 			MasterCommandProtectedData.ProcessingCBCommand = true;
 			MasterCommandProtectedData.RetriesLeft = MyPointConf->CBCommandRetries;
 
-			MasterCommandProtectedData.CurrentCommand = MasterCommandProtectedData.MasterCommandQueue.front();
-			MasterCommandProtectedData.MasterCommandQueue.pop();
+			MasterCommandProtectedData.CurrentCommand = NextCommandQueue.front();
+			NextCommandQueue.pop();
 
 			MasterCommandProtectedData.CurrentFunctionCode = MasterCommandProtectedData.CurrentCommand.first[0].GetFunctionCode();
 			LOGDEBUG("{} Sending next command : Fn {}, St {}, Gr {}, 1B {}", Name, GetFunctionCodeName(MasterCommandProtectedData.CurrentFunctionCode),
@@ -332,6 +336,10 @@ void CBMasterPort::ClearCBCommandQueue()
 			{
 			      MasterCommandProtectedData.MasterCommandQueue.pop();
 			}
+			while (!MasterCommandProtectedData.PriorityCommandQueue.empty())
+			{
+			      MasterCommandProtectedData.PriorityCommandQueue.pop();
+			}
 			MasterCommandProtectedData.CurrentFunctionCode = 0;
 			MasterCommandProtectedData.ProcessingCBCommand = false;
 		});
@@ -1124,14 +1132,14 @@ void CBMasterPort::WriteObject(const int16_t& command, const uint32_t& index, co
 		FunctionCode = FUNC_SETPOINT_B;
 
 	CBBlockData commandblock = CBBlockData(MyConf->mAddrConf.OutstationAddr, Group, FunctionCode, BData, true);
-	QueueCBCommand(commandblock, nullptr);
+	QueueCBCommand(commandblock, nullptr, HandlerPriority::High);
 
 	// Then queue the execute command - if the previous one does not work, then this one will not either.
 	// Bit of a question about how to  feedback failure.
 	// Only do the callback on the second - EXECUTE - command.
 
 	CBBlockData executeblock = CBBlockData(MyConf->mAddrConf.OutstationAddr, Group, FUNC_EXECUTE_COMMAND, 0, true);
-	QueueCBCommand(executeblock, pStatusCallback);
+	QueueCBCommand(executeblock, pStatusCallback, HandlerPriority::High);
 }
 
 
@@ -1165,14 +1173,14 @@ void CBMasterPort::SendDigitalControlOnCommand(const uint8_t& StationAddress, co
 	uint16_t BData = numeric_cast<uint16_t>(1 << bitshift);
 
 	CBBlockData commandblock = CBBlockData(StationAddress, Group, FUNC_CLOSE, BData, true); // Trip is OPEN or OFF
-	QueueCBCommand(commandblock, nullptr);
+	QueueCBCommand(commandblock, nullptr, HandlerPriority::High);
 
 	// Then queue the execute command - if the previous one does not work, then this one will not either.
 	// Bit of a question about how to  feedback failure.
 	// Only do the callback on the second - EXECUTE - command.
 
 	CBBlockData executeblock = CBBlockData(StationAddress, Group, FUNC_EXECUTE_COMMAND, 0, true);
-	QueueCBCommand(executeblock, pStatusCallback);
+	QueueCBCommand(executeblock, pStatusCallback, HandlerPriority::High);
 }
 void CBMasterPort::SendDigitalControlOffCommand(const uint8_t& StationAddress, const uint8_t& Group, const uint16_t& Channel, const SharedStatusCallback_t& pStatusCallback)
 {
@@ -1184,14 +1192,14 @@ void CBMasterPort::SendDigitalControlOffCommand(const uint8_t& StationAddress, c
 
 	uint16_t BData = numeric_cast<uint16_t>(1 << bitshift);
 	CBBlockData commandblock = CBBlockData(StationAddress, Group, FUNC_TRIP, BData, true); // Trip is OPEN or OFF
-	QueueCBCommand(commandblock, nullptr);
+	QueueCBCommand(commandblock, nullptr, HandlerPriority::High);
 
 	// Then queue the execute command - if the previous one does not work, then this one will not either.
 	// Bit of a question about how to  feedback failure.
 	// Only do the callback on the second - EXECUTE - command.
 
 	CBBlockData executeblock = CBBlockData(StationAddress, Group, FUNC_EXECUTE_COMMAND, 0, true);
-	QueueCBCommand(executeblock, pStatusCallback);
+	QueueCBCommand(executeblock, pStatusCallback, HandlerPriority::High);
 }
 
 
@@ -47,6 +47,7 @@ class MasterCommandData
 public:
 	unsigned int MaxCommandQueueSize = 20; //TODO: The maximum number of CB commands that can be in the master queue? Somewhat arbitrary??
 	std::queue<MasterCommandQueueItem> MasterCommandQueue;
+	std::queue<MasterCommandQueueItem> PriorityCommandQueue; // Controls - sent before anything waiting in MasterCommandQueue
 	MasterCommandQueueItem CurrentCommand; // Keep a copy of what has been sent to make retries easier.
 	uint8_t CurrentFunctionCode = 0;       // When we send a command, make sure the response we get is one we are waiting for.
 	bool ProcessingCBCommand = false;
@@ -84,8 +85,9 @@ public:
 	// If the callback gets an error it will be ignored which will result in a timeout and the next command (or retry) being sent.
 	// This is necessary if somehow we get an old command sent to us, or a left over broadcast message.
 	// Only issue is if we do a broadcast message and can get information back from multiple sources... These commands are probably not used, and we will ignore them anyway.
-	void QueueCBCommand(const CBMessage_t &CompleteCBMessage, SharedStatusCallback_t pStatusCallback);
-	void QueueCBCommand(const CBBlockData & SingleBlockCBMessage, SharedStatusCallback_t pStatusCallback); // Handle the many single block command messages better
+	// High priority commands (controls) have their own queue, which is always sent from first.
+	void QueueCBCommand(const CBMessage_t &CompleteCBMessage, SharedStatusCallback_t pStatusCallback, const HandlerPriority priority = HandlerPriority::Normal);
+	void QueueCBCommand(const CBBlockData & SingleBlockCBMessage, SharedStatusCallback_t pStatusCallback, const HandlerPriority priority = HandlerPriority::Normal); // Handle the many single block command messages better
 	void PostCallbackCall(const odc::SharedStatusCallback_t &pStatusCallback, CommandStatus c);
 
 	void ResetDigitalCommandSequenceNumber();
@@ -109,7 +111,7 @@ public:
 	bool GetOutStationSOEBufferOverflowFlag() { return OutStationSOEBufferOverflow.getandset(false); };
 private:
 
-	std::unique_ptr<asio::io_service::strand> MasterCommandStrand;
+	std::unique_ptr<odc::serial_executor> MasterCommandStrand;
 	MasterCommandData MasterCommandProtectedData; // Must be protected by the MasterCommandStrand.
 
 	std::mutex DigitalCommandSequenceNumberMutex;
@@ -37,7 +37,9 @@ void CBPointTableAccess::Build(const std::string _Name, const bool isoutstation,
 	IsOutstation = isoutstation;
 	// Setup TimeTagged event queue.
 	// The size (default 500) does not consume memory, just sets an upper limit to the number of items in the queue.
-	pBinaryTimeTaggedEventQueue = std::make_shared<StrandProtectedQueue<CBBinaryPoint>>(IOS, SOEQueueSize, SOEBufferOverflowFlag);
+	pBinaryTimeTaggedEventQueue = std::make_shared<odc::BoundedMPMCQueue<CBBinaryPoint>>(SOEQueueSize);
+	pSOEBufferOverflowFlag = SOEBufferOverflowFlag;
+	pSOEBufferOverflowFlag->set(false);
 }
 
 #ifdef _MSC_VER
@@ -337,21 +339,35 @@ void CBPointTableAccess::AddToDigitalEvents(const CBBinaryPoint &inpt, const uin
 		// Set the queue point value, just so we can set the time. The value does not matter.
 		queuefullpt.SetBinary(1, CBNowUTC());
 
-		pBinaryTimeTaggedEventQueue->async_push(pt, queuefullpt, odc::spdlog_get("CBPort"));
+		// Keep the last place for the overflow point, so the master can tell events were lost
+		if (!pBinaryTimeTaggedEventQueue->Push(pt, 1))
+		{
+			if (pBinaryTimeTaggedEventQueue->Push(queuefullpt))
+			{
+				pSOEBufferOverflowFlag->set(true);
+				LOGDEBUG("{} Outstation SOE Queue Overflow - Overflow point (127) added to the queue", Name);
+			}
+			else
+			{
+				// No space - dump
+				LOGDEBUG("{} Outstation SOE Queue Overflow - Point dumped", Name);
+			}
+			return;
+		}
 		LOGDEBUG("{} Outstation Added Binary Event to SOE Queue - ODCIndex {}, Value {}",Name, pt.GetIndex(),pt.GetBinary());
 	}
 }
 bool CBPointTableAccess::PeekNextTaggedEventPoint(CBBinaryPoint &pt)
 {
-	return pBinaryTimeTaggedEventQueue->sync_front(pt);
+	return pBinaryTimeTaggedEventQueue->Front(pt);
 }
 bool CBPointTableAccess::PopNextTaggedEventPoint( )
 {
-	return pBinaryTimeTaggedEventQueue->sync_pop();
+	return pBinaryTimeTaggedEventQueue->Pop();
 }
 bool CBPointTableAccess::TimeTaggedDataAvailable()
 {
-	return !pBinaryTimeTaggedEventQueue->sync_empty();
+	return !pBinaryTimeTaggedEventQueue->Empty();
 }
 // Dumps the points out in a list, only used for UnitTests
 std::vector<CBBinaryPoint> CBPointTableAccess::DumpTimeTaggedPointList( )
@@ -360,10 +376,9 @@ std::vector<CBBinaryPoint> CBPointTableAccess::DumpTimeTaggedPointList( )
 	std::vector<CBBinaryPoint> PointList;
 	PointList.reserve(50);
 
-	while (pBinaryTimeTaggedEventQueue->sync_front(CurrentPoint))
+	while (pBinaryTimeTaggedEventQueue->Pop(CurrentPoint))
 	{
 		PointList.emplace_back(CurrentPoint);
-		pBinaryTimeTaggedEventQueue->sync_pop();
 	}
 
 	return PointList;
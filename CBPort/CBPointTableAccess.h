@@ -34,7 +34,7 @@
 
 #include "CB.h"
 #include "CBUtility.h"
-#include "StrandProtectedQueue.h"
+#include <opendatacon/BoundedMPMCQueue.h>
 
 using namespace odc;
 
@@ -129,7 +129,8 @@ protected:
 
 	bool IsOutstation = true;
 	std::string Name;
-	std::shared_ptr<StrandProtectedQueue<CBBinaryPoint>> pBinaryTimeTaggedEventQueue; // Separate queue for time tagged binary events.
+	std::shared_ptr<odc::BoundedMPMCQueue<CBBinaryPoint>> pBinaryTimeTaggedEventQueue; // Separate queue for time tagged binary events.
+	std::shared_ptr<protected_bool> pSOEBufferOverflowFlag;
 	// Define the special SOE buffer overflow point, so that it can be added to the SOE queue if the buffer overflows. The only thing that gets changed is the time.
 	CBBinaryPoint queuefullpt = CBBinaryPoint(0, 0, 1, PayloadLocationType(), BinaryPointType::DIG, true, 127);
 };
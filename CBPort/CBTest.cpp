@@ -269,7 +269,7 @@ void TestTearDown(void)
 	LOGINFO("Test Finished");
 	#ifndef NONVSTESTING
 
-	spdlog::drop_all(); // Un-register loggers, and if no other shared_ptr references exist, they will be destroyed.
+	odc::spdlog_drop_all(); // Un-register loggers, and if no other shared_ptr references exist, they will be destroyed.
 	#endif
 }
 // Used for command line test setup
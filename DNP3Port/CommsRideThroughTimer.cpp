@@ -24,7 +24,7 @@ CommsRideThroughTimer::CommsRideThroughTimer(odc::asio_service &ios,
 	std::function<void()>&& aCommsGoodCB,
 	std::function<void()>&& aCommsBadCB):
 	Timeoutms(aTimeoutms),
-	pTimerAccessStrand(ios.make_strand()),
+	pTimerAccessStrand(ios.make_serial_executor()),
 	RideThroughInProgress(false),
 	pCommsRideThroughTimer(ios.make_steady_timer()),
 	CommsGoodCB(aCommsGoodCB),
@@ -38,9 +38,9 @@ public:
 
 private:
 	uint32_t Timeoutms;
-	std::unique_ptr<asio::io_service::strand> pTimerAccessStrand;
+	std::unique_ptr<odc::serial_executor> pTimerAccessStrand;
 	bool RideThroughInProgress;
-	std::unique_ptr<asio::steady_timer> pCommsRideThroughTimer;
+	std::unique_ptr<odc::steady_timer> pCommsRideThroughTimer;
 	const std::function<void()> CommsGoodCB;
 	const std::function<void()> CommsBadCB;
 };
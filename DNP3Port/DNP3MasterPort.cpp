@@ -47,6 +47,7 @@ DNP3MasterPort::~DNP3MasterPort()
 	}
 	if(pChannel)
 		pChannel.reset();
+	RemoveStackMaster();
 }
 
 void DNP3MasterPort::Enable()
@@ -115,7 +116,7 @@ void DNP3MasterPort::SetCommsGood()
 		if(auto log = odc::spdlog_get("DNP3Port"))
 			log->debug("{}: Updating comms point (good).", Name);
 
-		auto commsUpEvent = std::make_shared<EventInfo>(EventType::Binary, pConf->pPointConf->mCommsPoint.second, Name);
+		auto commsUpEvent = MakeEvent(EventType::Binary, pConf->pPointConf->mCommsPoint.second, Name);
 		auto failed_val = pConf->pPointConf->mCommsPoint.first.value;
 		commsUpEvent->SetPayload<EventType::Binary>(std::move(!failed_val));
 		PublishEvent(commsUpEvent);
@@ -133,13 +134,13 @@ void DNP3MasterPort::SetCommsFailed()
 
 		for (auto index : pConf->pPointConf->BinaryIndicies)
 		{
-			auto event = std::make_shared<EventInfo>(EventType::BinaryQuality,index,Name);
+			auto event = MakeEvent(EventType::BinaryQuality,index,Name);
 			event->SetPayload<EventType::BinaryQuality>(QualityFlags::COMM_LOST);
 			PublishEvent(event);
 		}
 		for (auto index : pConf->pPointConf->AnalogIndicies)
 		{
-			auto event = std::make_shared<EventInfo>(EventType::AnalogQuality,index,Name);
+			auto event = MakeEvent(EventType::AnalogQuality,index,Name);
 			event->SetPayload<EventType::AnalogQuality>(QualityFlags::COMM_LOST);
 			PublishEvent(event);
 		}
@@ -151,7 +152,7 @@ void DNP3MasterPort::SetCommsFailed()
 		if(auto log = odc::spdlog_get("DNP3Port"))
 			log->debug("{}: Updating comms point (failed).", Name);
 
-		auto commsDownEvent = std::make_shared<EventInfo>(EventType::Binary, pConf->pPointConf->mCommsPoint.second, Name);
+		auto commsDownEvent = MakeEvent(EventType::Binary, pConf->pPointConf->mCommsPoint.second, Name);
 		auto failed_val = pConf->pPointConf->mCommsPoint.first.value;
 		commsDownEvent->SetPayload<EventType::Binary>(std::move(failed_val));
 		PublishEvent(commsDownEvent);
@@ -231,6 +232,27 @@ void DNP3MasterPort::OnKeepAliveSuccess()
 	}
 }
 
+bool DNP3MasterPort::UpstreamHasSnapshot(const std::string& PortName)
+{
+	auto& handlers = IOHandler::GetIOHandlers();
+	auto handler_it = handlers.find(PortName);
+	if(handler_it == handlers.end())
+		return false;
+	auto pSnapshot = handler_it->second->GetSnapshot();
+	if(!pSnapshot)
+		return false;
+
+	//it has to have every point we'd get from a scan, not just someone else's
+	DNP3PortConf* pConf = static_cast<DNP3PortConf*>(this->pConf.get());
+	for(auto index : pConf->pPointConf->BinaryIndicies)
+		if(!pSnapshot->Has(EventType::Binary,index))
+			return false;
+	for(auto index : pConf->pPointConf->AnalogIndicies)
+		if(!pSnapshot->Has(EventType::Analog,index))
+			return false;
+	return true;
+}
+
 TCPClientServer DNP3MasterPort::ClientOrServer()
 {
 	DNP3PortConf* pConf = static_cast<DNP3PortConf*>(this->pConf.get());
@@ -242,6 +264,7 @@ TCPClientServer DNP3MasterPort::ClientOrServer()
 void DNP3MasterPort::Build()
 {
 	DNP3PortConf* pConf = static_cast<DNP3PortConf*>(this->pConf.get());
+	RegisterPoints();
 
 	pChannel = GetChannel();
 
@@ -321,6 +344,9 @@ template<typename T>
 inline void DNP3MasterPort::LoadT(const opendnp3::ICollection<opendnp3::Indexed<T> >& meas)
 {
 	auto pConf = static_cast<DNP3PortConf*>(this->pConf.get());
+	//publish the whole collection as one batch
+	EventBatch_t batch;
+	batch.reserve(meas.Count());
 	meas.ForeachItem([&](const opendnp3::Indexed<T>&pair)
 		{
 			auto event = ToODC(pair.value, pair.index, Name);
@@ -329,8 +355,10 @@ inline void DNP3MasterPort::LoadT(const opendnp3::ICollection<opendnp3::Indexed<
 			{
 			      event->SetTimestamp();
 			}
-			PublishEvent(event);
+			batch.push_back(std::move(event));
 		});
+	if(!batch.empty())
+		PublishEvent(batch);
 }
 
 void DNP3MasterPort::Process(const opendnp3::HeaderInfo& info, const opendnp3::ICollection<opendnp3::DNPTime>& values)
@@ -355,12 +383,21 @@ void DNP3MasterPort::Event(std::shared_ptr<const EventInfo> event, const std::st
 		auto state = event->GetPayload<EventType::ConnectState>();
 
 		// If an upstream port has been enabled after the stack has already been enabled, do an integrity scan
+		//	unless it's caught up from its snapshot - while our link is up, that has everything we've had
 		if (stack_enabled && state == ConnectState::PORT_UP)
 		{
-			if(auto log = odc::spdlog_get("DNP3Port"))
-				log->info("{}: Upstream port enabled, performing integrity scan.", Name);
+			if(!link_dead && UpstreamHasSnapshot(event->GetSourcePort()))
+			{
+				if(auto log = odc::spdlog_get("DNP3Port"))
+					log->info("{}: Upstream port enabled, seeded from its snapshot - skipping integrity scan.", Name);
+			}
+			else
+			{
+				if(auto log = odc::spdlog_get("DNP3Port"))
+					log->info("{}: Upstream port enabled, performing integrity scan.", Name);
 
-			IntegrityScan->Demand();
+				IntegrityScan->Demand();
+			}
 		}
 
 		DNP3PortConf* pConf = static_cast<DNP3PortConf*>(this->pConf.get());
@@ -45,7 +45,9 @@ public:
 		assign_class_sent(false),
 		IntegrityScan(nullptr),
 		pCommsRideThroughTimer(nullptr)
-	{}
+	{
+		AddStackMaster();
+	}
 	~DNP3MasterPort() override;
 
 	void Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override;
@@ -113,6 +115,8 @@ private:
 	inline void DoOverrideControlCode(T& arCommand){}
 	void PortUp();
 	void PortDown();
+	//Whether the named port keeps a snapshot, and has every one of our points in it to catch up from
+	bool UpstreamHasSnapshot(const std::string& PortName);
 	inline void EnableStack()
 	{
 		PortDown(); //initialise as comms down - in case they never come up
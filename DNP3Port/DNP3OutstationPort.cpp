@@ -43,7 +43,10 @@
 DNP3OutstationPort::DNP3OutstationPort(const std::string& aName, const std::string& aConfFilename, const Json::Value& aConfOverrides):
 	DNP3Port(aName, aConfFilename, aConfOverrides),
 	pOutstation(nullptr)
-{}
+{
+	//to seed new connections and answer GetCurrentState
+	KeepSnapshot();
+}
 
 DNP3OutstationPort::~DNP3OutstationPort()
 {
@@ -70,6 +73,8 @@ void DNP3OutstationPort::Enable()
 	}
 	pOutstation->Enable();
 	enabled = true;
+	//Events that came while we were disabled were rejected - catch up with the last known values
+	SeedFromSnapshot();
 
 	PublishEvent(ConnectState::PORT_UP);
 }
@@ -140,6 +145,7 @@ TCPClientServer DNP3OutstationPort::ClientOrServer()
 void DNP3OutstationPort::Build()
 {
 	DNP3PortConf* pConf = static_cast<DNP3PortConf*>(this->pConf.get());
+	RegisterPoints();
 
 	pChannel = GetChannel();
 
@@ -235,18 +241,15 @@ const Json::Value DNP3OutstationPort::GetCurrentState() const
 	if (pOutstation == nullptr)
 		return IUIResponder::GenerateResult("Bad port");
 
-	//FIXME: The new opendnp3 API doesn't expose internal state
-
-//	auto configView = pOutstation->GetConfigView();
-//
-//	for (auto point : configView.analogs)
-//	{
-//		analogValues[std::to_string(point.vIndex)] = point.value.value;
-//	}
-//	for (auto point : configView.binaries)
-//	{
-//		binaryValues[std::to_string(point.vIndex)] = point.value.value;
-//	}
+	//The opendnp3 API doesn't expose internal state, but the snapshot has what we've been sent
+	for (auto& point : GetSnapshot()->GetEvents(EventType::Analog))
+	{
+		analogValues[std::to_string(point->GetIndex())] = point->GetPayload<EventType::Analog>();
+	}
+	for (auto& point : GetSnapshot()->GetEvents(EventType::Binary))
+	{
+		binaryValues[std::to_string(point->GetIndex())] = point->GetPayload<EventType::Binary>();
+	}
 
 	event["AnalogCurrent"] = analogValues;
 	event["BinaryCurrent"] = binaryValues;
@@ -325,25 +328,49 @@ inline opendnp3::CommandStatus DNP3OutstationPort::PerformT(T& arCommand, uint16
 		return opendnp3::CommandStatus::SUCCESS;
 	}
 
-	//TODO: enquire about the possibility of the opendnp3 API having a callback for the result
-	// Or if the outstation supported Group13Var1/2 (BinaryCommandEvent), we could use that (maybe the latest opendnp3 already does...?)
-	// either one would avoid the below polling loop
-	std::atomic_bool cb_executed(false);
-	CommandStatus cb_status;
-	auto StatusCallback = std::make_shared<std::function<void (CommandStatus status)>>([&](CommandStatus status)
+	//opendnp3 wants the result before we return, so the stack thread has to wait for it
+	//	but not if it's the last one free - a DNP3 master passing the command on would need it
+	//	to get the result, so we'd just wait out the timeout
+	//	We can't honestly claim success without the result, so the command is refused (and not passed on)
+	if(!StartStackWait())
+	{
+		if(!stack_wait_warned.test_and_set())
 		{
-			cb_status = status;
-			cb_executed = true;
-		});
-	PublishEvent(event, StatusCallback);
-	while(!cb_executed)
+			if(auto log = odc::spdlog_get("DNP3Port"))
+				log->error("{}: Not enough DNP3 stack threads (ProtocolWorkers) to wait for downstream command responses - refusing commands with TOO_MANY_OPS.", Name);
+		}
+		if(auto log = odc::spdlog_get("DNP3Port"))
+			log->debug("{}: Refused command at index {} - no DNP3 stack thread free to wait for the response.", Name, aIndex);
+		return opendnp3::CommandStatus::TOO_MANY_OPS;
+	}
+	//	sleep (rather than spin or run other handlers) until it comes back, or give up
+	StatusWaiter waiter;
+	PublishEvent(event, waiter.Callback());
+	auto status = waiter.Wait(std::chrono::milliseconds(pConf->pPointConf->CommandResponseTimeoutms));
+	EndStackWait();
+	if(status == CommandStatus::TIMEOUT)
+	{
+		if(auto log = odc::spdlog_get("DNP3Port"))
+			log->warn("{}: Timed out waiting for downstream response to command at index {}.", Name, aIndex);
+	}
+	return FromODC(status);
+}
+
+EventInterest DNP3OutstationPort::GetEventInterest()
+{
+	auto pConf = static_cast<DNP3PortConf*>(this->pConf.get());
+	auto interest = EventInterest::Nothing();
+	for(auto index : pConf->pPointConf->BinaryIndicies)
 	{
-		//This loop pegs a core and blocks the outstation strand,
-		//	but there's no other way to wait for the result.
-		//	We can maybe do some work while we wait.
-		pIOS->poll_one();
+		interest.Add(EventType::Binary,index,index);
+		interest.Add(EventType::BinaryQuality,index,index);
 	}
-	return FromODC(cb_status);
+	for(auto index : pConf->pPointConf->AnalogIndicies)
+	{
+		interest.Add(EventType::Analog,index,index);
+		interest.Add(EventType::AnalogQuality,index,index);
+	}
+	return interest;
 }
 
 void DNP3OutstationPort::Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback)
@@ -403,4 +430,10 @@ inline void DNP3OutstationPort::EventT(T meas, uint16_t index)
 	pOutstation->Apply(builder.Build());
 }
 
-
+void DNP3OutstationPort::SeedFromSnapshot()
+{
+	for(auto& point : GetSnapshot()->GetEvents(EventType::Binary))
+		EventT(FromODC<opendnp3::Binary>(point), point->GetIndex());
+	for(auto& point : GetSnapshot()->GetEvents(EventType::Analog))
+		EventT(FromODC<opendnp3::Analog>(point), point->GetIndex());
+}
@@ -27,6 +27,7 @@
 #ifndef DNP3SERVERPORT_H_
 #define DNP3SERVERPORT_H_
 
+#include <atomic>
 #include <unordered_map>
 #include <opendnp3/outstation/ICommandHandler.h>
 
@@ -75,11 +76,15 @@ protected:
 	opendnp3::CommandStatus Operate(const opendnp3::AnalogOutputDouble64& arCommand, uint16_t aIndex,opendnp3::OperateType op_type) override {return PerformT(arCommand,aIndex);}
 
 	//Implement IOHandler
+	EventInterest GetEventInterest() override;
 	void Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override;
 
 private:
 	std::shared_ptr<asiodnp3::IOutstation> pOutstation;
 	void LinkStatusListener(opendnp3::LinkStatus status);
+	void SeedFromSnapshot();
+	//so we only warn once about responding to commands without waiting (see PerformT)
+	std::atomic_flag stack_wait_warned = ATOMIC_FLAG_INIT;
 
 	template<typename T> void EventT(T meas, uint16_t index);
 	template<typename T, typename Q> void EventQ(Q qual, uint16_t index, opendnp3::FlagsType FT);
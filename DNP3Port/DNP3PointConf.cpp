@@ -76,6 +76,7 @@ DNP3PointConf::DNP3PointConf(const std::string& FileName, const Json::Value& Con
 	SolConfirmTimeoutms(5000),
 	UnsolConfirmTimeoutms(5000),
 	WaitForCommandResponses(false),
+	CommandResponseTimeoutms(5000),
 	// Default Static Variations
 	StaticBinaryResponse(opendnp3::StaticBinaryVariation::Group1Var1),
 	StaticAnalogResponse(opendnp3::StaticAnalogVariation::Group30Var5),
@@ -266,6 +267,8 @@ void DNP3PointConf::ProcessElements(const Json::Value& JSONRoot)
 		UnsolConfirmTimeoutms = JSONRoot["UnsolConfirmTimeoutms"].asUInt();
 	if (JSONRoot.isMember("WaitForCommandResponses"))
 		WaitForCommandResponses = JSONRoot["WaitForCommandResponses"].asBool();
+	if (JSONRoot.isMember("CommandResponseTimeoutms"))
+		CommandResponseTimeoutms = JSONRoot["CommandResponseTimeoutms"].asUInt();
 
 	// Default Static Variations
 	if (JSONRoot.isMember("StaticBinaryResponse"))
@@ -96,6 +96,7 @@ public:
 	uint32_t SolConfirmTimeoutms;   /// Timeout for solicited confirms
 	uint32_t UnsolConfirmTimeoutms; /// Timeout for unsolicited confirms
 	bool WaitForCommandResponses;   // when responding to a command, wait for downstream command responses, otherwise returns success
+	uint32_t CommandResponseTimeoutms; /// How long to wait for downstream command responses before responding with TIMEOUT
 
 	// Default Static Variations
 	opendnp3::StaticBinaryVariation StaticBinaryResponse;
@@ -24,13 +24,29 @@
  *      Author: Neil Stephens <dearknarl@gmail.com>
  */
 
+#include <algorithm>
+#include <atomic>
 #include <openpal/logging/LogLevels.h>
 #include <opendnp3/gen/Parity.h>
 #include <opendatacon/util.h>
+#include <opendatacon/PointRegistry.h>
+#include <opendatacon/ThreadBudget.h>
 #include "DNP3Port.h"
 #include "DNP3PortConf.h"
 #include "ChannelStateSubscriber.h"
 
+struct StackThreads
+{
+	std::atomic<size_t> workers{1};
+	std::atomic<size_t> waiting{0};
+	std::atomic<size_t> masters{0};
+};
+static StackThreads& GetStackThreads()
+{
+	static StackThreads stack_threads;
+	return stack_threads;
+}
+
 DNP3Port::DNP3Port(const std::string& aName, const std::string& aConfFilename, const Json::Value& aConfOverrides):
 	DataPort(aName, aConfFilename, aConfOverrides),
 	pChannel(nullptr),
@@ -48,8 +64,19 @@ DNP3Port::DNP3Port(const std::string& aName, const std::string& aConfFilename, c
 		//make a custom deleter for the DNP3Manager that will also clear the init flag
 		auto deinit_del = [](asiodnp3::DNP3Manager* mgr_ptr)
 					{init_flag.clear(); delete mgr_ptr;};
+		//opendnp3 runs its own pool - size it from the protocol share of the thread budget
+		const auto budget = odc::GetThreadBudget();
+		GetStackThreads().workers = std::max(budget.ProtocolWorkers,size_t(1));
+		auto on_thread_start = [budget]()
+					     {
+						     if(!odc::SetCurrentThreadAffinity(budget.ProtocolCPUs))
+						     {
+							     if(auto log = odc::spdlog_get("DNP3Port"))
+								     log->warn("Failed to set CPU affinity for DNP3 stack thread");
+						     }
+					     };
 		this->IOMgr = std::shared_ptr<asiodnp3::DNP3Manager>(
-			new asiodnp3::DNP3Manager(std::thread::hardware_concurrency(),std::make_shared<DNP3Log2spdlog>()),
+			new asiodnp3::DNP3Manager(budget.ProtocolWorkers,std::make_shared<DNP3Log2spdlog>(),on_thread_start),
 			deinit_del);
 		weak_mgr = this->IOMgr;
 	}
@@ -70,6 +97,31 @@ DNP3Port::DNP3Port(const std::string& aName, const std::string& aConfFilename, c
 DNP3Port::~DNP3Port()
 {}
 
+void DNP3Port::AddStackMaster()
+{
+	GetStackThreads().masters++;
+}
+void DNP3Port::RemoveStackMaster()
+{
+	GetStackThreads().masters--;
+}
+
+bool DNP3Port::StartStackWait()
+{
+	auto& threads = GetStackThreads();
+	auto waiting = threads.waiting.load();
+	do
+	{
+		if(threads.masters > 0 && waiting+1 >= threads.workers)
+			return false;
+	} while(!threads.waiting.compare_exchange_weak(waiting,waiting+1));
+	return true;
+}
+void DNP3Port::EndStackWait()
+{
+	GetStackThreads().waiting--;
+}
+
 // Called by OpenDNP3 Thread Pool
 void DNP3Port::StateListener(opendnp3::ChannelState state)
 {
@@ -238,6 +290,17 @@ private:
 	const std::string ChanID;
 };
 
+void DNP3Port::RegisterPoints()
+{
+	DNP3PortConf* pConf = static_cast<DNP3PortConf*>(this->pConf.get());
+	for(auto index : pConf->pPointConf->BinaryIndicies)
+		RegisterPoint(Name, EventType::Binary, index);
+	for(auto index : pConf->pPointConf->AnalogIndicies)
+		RegisterPoint(Name, EventType::Analog, index);
+	for(auto index : pConf->pPointConf->ControlIndicies)
+		RegisterPoint(Name, EventType::ControlRelayOutputBlock, index);
+}
+
 std::shared_ptr<asiodnp3::IChannel> DNP3Port::GetChannel()
 {
 	static std::unordered_map<std::string, std::weak_ptr<asiodnp3::IChannel>> Channels;
@@ -65,6 +65,19 @@ protected:
 	bool link_dead;
 	bool channel_dead;
 
+	//Give our points IDs in the odc::PointRegistry - call from Build()
+	void RegisterPoints();
+
+	//All DNP3 ports share the opendnp3 stack threads (ProtocolWorkers)
+	//	An outstation waiting for a command result ties one up, and if the result comes from
+	//	a DNP3 master, that needs a stack thread too - so while there are masters,
+	//	the last free stack thread is never left waiting
+	static void AddStackMaster();
+	static void RemoveStackMaster();
+	//false if the calling stack thread mustn't wait - otherwise call EndStackWait() when it's done
+	static bool StartStackWait();
+	static void EndStackWait();
+
 	virtual void OnLinkDown()=0;
 	virtual TCPClientServer ClientOrServer()=0;
 
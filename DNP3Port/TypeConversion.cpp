@@ -180,7 +180,7 @@ opendnp3::CommandStatus FromODC(const CommandStatus stat)
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::Binary& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::Binary, ind, source);
+	auto event = MakeEvent(EventType::Binary, ind, source);
 
 	auto val = dnp3.value;
 
@@ -207,7 +207,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::Binary& dnp3, const size_t ind,
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::DoubleBitBinary& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::DoubleBitBinary, ind, source);
+	auto event = MakeEvent(EventType::DoubleBitBinary, ind, source);
 
 	EventTypePayload<EventType::DoubleBitBinary>::type val;
 
@@ -246,7 +246,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::DoubleBitBinary& dnp3, const si
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::Analog& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::Analog, ind, source);
+	auto event = MakeEvent(EventType::Analog, ind, source);
 
 	auto val = dnp3.value;
 
@@ -275,7 +275,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::Analog& dnp3, const size_t ind,
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::Counter& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::Counter, ind, source);
+	auto event = MakeEvent(EventType::Counter, ind, source);
 
 	auto val = dnp3.value;
 
@@ -304,7 +304,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::Counter& dnp3, const size_t ind
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::FrozenCounter& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::FrozenCounter, ind, source);
+	auto event = MakeEvent(EventType::FrozenCounter, ind, source);
 
 	auto val = dnp3.value;
 
@@ -333,7 +333,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::FrozenCounter& dnp3, const size
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::BinaryOutputStatus& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::BinaryOutputStatus, ind, source);
+	auto event = MakeEvent(EventType::BinaryOutputStatus, ind, source);
 
 	auto val = dnp3.value;
 
@@ -358,7 +358,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::BinaryOutputStatus& dnp3, const
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::AnalogOutputStatus& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::AnalogOutputStatus, ind, source);
+	auto event = MakeEvent(EventType::AnalogOutputStatus, ind, source);
 
 	auto val = dnp3.value;
 
@@ -387,7 +387,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::AnalogOutputStatus& dnp3, const
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::BinaryQuality& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::BinaryQuality, ind, source);
+	auto event = MakeEvent(EventType::BinaryQuality, ind, source);
 
 	QualityFlags qual = QualityFlags::NONE;
 	if(static_cast<uint8_t>(dnp3) & static_cast<uint8_t>(opendnp3::BinaryQuality::ONLINE))
@@ -412,7 +412,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::BinaryQuality& dnp3, const size
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::DoubleBitBinaryQuality& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::DoubleBitBinaryQuality, ind, source);
+	auto event = MakeEvent(EventType::DoubleBitBinaryQuality, ind, source);
 
 	QualityFlags qual = QualityFlags::NONE;
 	if(static_cast<uint8_t>(dnp3) & static_cast<uint8_t>(opendnp3::DoubleBitBinaryQuality::ONLINE))
@@ -437,7 +437,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::DoubleBitBinaryQuality& dnp3, c
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::AnalogQuality& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::AnalogQuality, ind, source);
+	auto event = MakeEvent(EventType::AnalogQuality, ind, source);
 
 	QualityFlags qual = QualityFlags::NONE;
 	if(static_cast<uint8_t>(dnp3) & static_cast<uint8_t>(opendnp3::AnalogQuality::ONLINE))
@@ -464,7 +464,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::AnalogQuality& dnp3, const size
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::CounterQuality& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::CounterQuality, ind, source);
+	auto event = MakeEvent(EventType::CounterQuality, ind, source);
 
 	QualityFlags qual = QualityFlags::NONE;
 	if(static_cast<uint8_t>(dnp3) & static_cast<uint8_t>(opendnp3::CounterQuality::ONLINE))
@@ -491,7 +491,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::CounterQuality& dnp3, const siz
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::BinaryOutputStatusQuality& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::BinaryOutputStatusQuality, ind, source);
+	auto event = MakeEvent(EventType::BinaryOutputStatusQuality, ind, source);
 
 	QualityFlags qual = QualityFlags::NONE;
 	if(static_cast<uint8_t>(dnp3) & static_cast<uint8_t>(opendnp3::BinaryOutputStatusQuality::ONLINE))
@@ -514,7 +514,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::BinaryOutputStatusQuality& dnp3
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::ControlRelayOutputBlock& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::ControlRelayOutputBlock, ind, source);
+	auto event = MakeEvent(EventType::ControlRelayOutputBlock, ind, source);
 
 	EventTypePayload<EventType::ControlRelayOutputBlock>::type val;
 
@@ -581,7 +581,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::ControlRelayOutputBlock& dnp3,
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::AnalogOutputInt16& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::AnalogOutputInt16, ind, source);
+	auto event = MakeEvent(EventType::AnalogOutputInt16, ind, source);
 
 	EventTypePayload<EventType::AnalogOutputInt16>::type val;
 
@@ -597,7 +597,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::AnalogOutputInt16& dnp3, const
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::AnalogOutputInt32& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::AnalogOutputInt32, ind, source);
+	auto event = MakeEvent(EventType::AnalogOutputInt32, ind, source);
 
 	EventTypePayload<EventType::AnalogOutputInt32>::type val;
 
@@ -613,7 +613,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::AnalogOutputInt32& dnp3, const
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::AnalogOutputFloat32& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::AnalogOutputFloat32, ind, source);
+	auto event = MakeEvent(EventType::AnalogOutputFloat32, ind, source);
 
 	EventTypePayload<EventType::AnalogOutputFloat32>::type val;
 
@@ -629,7 +629,7 @@ std::shared_ptr<EventInfo> ToODC(const opendnp3::AnalogOutputFloat32& dnp3, cons
 
 std::shared_ptr<EventInfo> ToODC(const opendnp3::AnalogOutputDouble64& dnp3, const size_t ind, const std::string& source)
 {
-	auto event = std::make_shared<EventInfo>(EventType::AnalogOutputDouble64, ind, source);
+	auto event = MakeEvent(EventType::AnalogOutputDouble64, ind, source);
 
 	EventTypePayload<EventType::AnalogOutputDouble64>::type val;
 
@@ -28,6 +28,7 @@
 #include <chrono>
 #include <opendatacon/util.h>
 #include <opendatacon/IOTypes.h>
+#include <opendatacon/PointRegistry.h>
 #include "JSONPort.h"
 
 using namespace odc;
@@ -71,6 +72,27 @@ void JSONPort::Disable()
 	pSockMan->Close();
 }
 
+//DataPort function for UI
+const Json::Value JSONPort::GetStatus() const
+{
+	auto ret_val = Json::Value();
+
+	const size_t sessions = pSockMan ? pSockMan->SessionCount() : 0;
+	if(!enabled)
+		ret_val["Result"] = "Port disabled";
+	else if(sessions == 0)
+		ret_val["Result"] = "Port enabled - not connected";
+	else
+		ret_val["Result"] = "Port enabled - connected";
+	if(isServer)
+	{
+		ret_val["Sessions"] = Json::UInt64(sessions);
+		ret_val["MaxSessions"] = Json::UInt64(static_cast<JSONPortConf*>(pConf.get())->max_sessions);
+	}
+
+	return ret_val;
+}
+
 void JSONPort::SocketStateHandler(bool state)
 {
 	std::string msg;
@@ -106,6 +128,20 @@ void JSONPort::ProcessElements(const Json::Value& JSONRoot)
 	//TODO: document this
 	if(JSONRoot.isMember("EventBufferSize"))
 		static_cast<JSONPortConf*>(pConf.get())->evt_buffer_size = JSONRoot["EventBufferSize"].asUInt();
+	if(JSONRoot.isMember("WriteHighWater"))
+		static_cast<JSONPortConf*>(pConf.get())->write_high_water = JSONRoot["WriteHighWater"].asUInt64();
+	if(JSONRoot.isMember("MaxSessions"))
+		static_cast<JSONPortConf*>(pConf.get())->max_sessions = JSONRoot["MaxSessions"].asUInt();
+	if(JSONRoot.isMember("Transport"))
+	{
+		auto transport = JSONRoot["Transport"].asString();
+		if(transport == "io_uring")
+			static_cast<JSONPortConf*>(pConf.get())->use_io_uring = true;
+		else if(transport == "asio")
+			static_cast<JSONPortConf*>(pConf.get())->use_io_uring = false;
+		else if(auto log = odc::spdlog_get("JSONPort"))
+			log->error("{}: Invalid Transport '{}', should be 'asio' or 'io_uring'", Name, transport);
+	}
 	//TODO: document this
 	if(JSONRoot.isMember("StyleOutput"))
 		static_cast<JSONPortConf*>(pConf.get())->style_output = JSONRoot["StyleOutput"].asBool();
@@ -115,67 +151,102 @@ void JSONPort::Build()
 {
 	auto pConf = static_cast<JSONPortConf*>(this->pConf.get());
 
+	for(auto& point : pConf->pPointConf->Analogs)
+		RegisterPoint(Name,EventType::Analog,point.first);
+	for(auto& point : pConf->pPointConf->Binaries)
+		RegisterPoint(Name,EventType::Binary,point.first);
+	for(auto& point : pConf->pPointConf->Controls)
+		RegisterPoint(Name,EventType::ControlRelayOutputBlock,point.first);
+
 	pSockMan = std::make_unique<TCPSocketManager<std::string>>
 		           (pIOS, isServer, pConf->mAddrConf.IP, std::to_string(pConf->mAddrConf.Port),
-		           std::bind(&JSONPort::ReadCompletionHandler,this,std::placeholders::_1),
+		           [this](const char* data, size_t len){ return ReadCompletionHandler(0,data,len); },
 		           std::bind(&JSONPort::SocketStateHandler,this,std::placeholders::_1),
 		           1000,
 		           true,
 		           pConf->retry_time_ms);
+	pSockMan->SetOwner(Name);
+	if(pConf->max_sessions > 1)
+	{
+		if(isServer)
+		{
+			pSockMan->SetMultiClient(pConf->max_sessions,
+				[this](size_t session, const char* data, size_t len){ return ReadCompletionHandler(session,data,len); },
+				[this](size_t session, bool state)
+				{
+					if(auto log = odc::spdlog_get("JSONPort"))
+						log->info("{}: Session {} {}. {} connected.", Name, session, state ? "established" : "closed", pSockMan->SessionCount());
+				});
+		}
+		else if(auto log = odc::spdlog_get("JSONPort"))
+			log->warn("{}: MaxSessions is only for servers - ignoring", Name);
+	}
+	if(pConf->use_io_uring)
+	{
+		if(auto pRing = io_uring_service::Shared(pIOS))
+			pSockMan->SetIOUring(pRing);
+		else if(auto log = odc::spdlog_get("JSONPort"))
+			log->warn("{}: io_uring isn't supported here - using asio", Name);
+	}
+	pSockMan->SetWriteHighWater(pConf->write_high_water,[this](bool on)
+		{
+			write_backpressure = on;
+			if(auto log = odc::spdlog_get("JSONPort"))
+			{
+				if(on)
+					log->warn("{}: writes are backing up - dropping telemetry until they catch up", Name);
+				else
+					log->info("{}: writes have caught up", Name);
+			}
+		});
 }
 
-void JSONPort::ReadCompletionHandler(buf_t& readbuf)
+size_t JSONPort::ReadCompletionHandler(size_t session, const char* data, size_t len)
 {
-	//transfer content between matched braces to get processed as json
-	char ch;
-	std::string braced;
+	//hand over content between matched braces to get processed as json
+	//	straight out of the read buffer - no copying
+	size_t used = 0, braced_start = 0;
 	size_t count_open_braces = 0, count_close_braces = 0;
-	while(readbuf.size() > 0)
+	for(size_t i = 0; i < len; i++)
 	{
-		ch = readbuf.sgetc();
-		readbuf.consume(1);
-		if(ch=='{')
+		if(data[i]=='{')
 		{
 			count_open_braces++;
-			if(count_open_braces == 1 && braced.length() > 0)
-				braced.clear(); //discard anything before the first brace
+			if(count_open_braces == 1)
+				used = braced_start = i; //discard anything before the first brace
 		}
-		else if(ch=='}')
+		else if(data[i]=='}')
 		{
 			count_close_braces++;
 			if(count_close_braces > count_open_braces)
 			{
-				braced.clear(); //discard because it must be outside matched braces
+				used = i+1; //discard because it must be outside matched braces
 				count_close_braces = count_open_braces = 0;
 				if(auto log = odc::spdlog_get("JSONPort"))
 					log->warn("Malformed JSON recieved: unmatched closing brace.");
 			}
 		}
-		braced.push_back(ch);
 		//check if we've found a match to the first brace
 		if(count_open_braces > 0 && count_close_braces == count_open_braces)
 		{
-			ProcessBraced(braced);
-			braced.clear();
+			ProcessBraced(data+braced_start,data+i+1,session);
+			used = i+1;
 			count_close_braces = count_open_braces = 0;
 		}
 	}
-	//put back the leftovers
-	for(auto ch : braced)
-		readbuf.sputc(ch);
+	//leave the leftovers if we're part way through an object, otherwise there's nothing worth keeping
+	return count_open_braces > 0 ? used : len;
 }
 
 //At this point we have a whole (hopefully JSON) object - ie. {.*}
 //Here we parse it and extract any paths that match our point config
-void JSONPort::ProcessBraced(const std::string& braced)
+//	any control results go back to the session it came from
+void JSONPort::ProcessBraced(const char* start, const char* stop, size_t session)
 {
 	//TODO: make this a reusable reader (class member)
 	Json::CharReaderBuilder rbuilder;
 	std::unique_ptr<Json::CharReader> const JSONReader(rbuilder.newCharReader());
 
-	char const* start = braced.c_str();
-	char const* stop = start + braced.size();
-
 	Json::Value JSONRoot; // will contain the root value after parsing.
 	std::string err_str;
 
@@ -214,7 +285,7 @@ void JSONPort::ProcessBraced(const std::string& braced)
 		}
 
 		//vector to store any events we find contained in this Json object
-		std::vector<std::shared_ptr<EventInfo>> events;
+		EventBatch_t events;
 
 		for(auto& point_pair : pConf->pPointConf->Analogs)
 		{
@@ -224,7 +295,7 @@ void JSONPort::ProcessBraced(const std::string& braced)
 			//if the path existed, load up the point
 			if(!val.isNull())
 			{
-				auto event = std::make_shared<EventInfo>(EventType::Analog,point_pair.first,Name,QualityFlags::ONLINE,timestamp);
+				auto event = MakeEvent(EventType::Analog,point_pair.first,Name,QualityFlags::ONLINE,timestamp);
 				if(val.isNumeric())
 					event->SetPayload<EventType::Analog>(val.asDouble());
 				else if(val.isString())
@@ -250,7 +321,7 @@ void JSONPort::ProcessBraced(const std::string& braced)
 					event->SetPayload<EventType::Analog>(0);
 					event->SetQuality(QualityFlags::OVERRANGE);
 				}
-				events.push_back(event);
+				events.push_back(std::move(event));
 			}
 		}
 
@@ -262,7 +333,7 @@ void JSONPort::ProcessBraced(const std::string& braced)
 			//if the path existed, load up the point
 			if(!val.isNull())
 			{
-				auto event = std::make_shared<EventInfo>(EventType::Binary,point_pair.first,Name,QualityFlags::ONLINE,timestamp);
+				auto event = MakeEvent(EventType::Binary,point_pair.first,Name,QualityFlags::ONLINE,timestamp);
 				bool true_val = false;
 				if(point_pair.second.isMember("TrueVal"))
 				{
@@ -285,15 +356,13 @@ void JSONPort::ProcessBraced(const std::string& braced)
 					event->SetQuality(QualityFlags::COMM_LOST);
 
 				event->SetPayload<EventType::Binary>(std::move(true_val));
-				events.push_back(event);
+				events.push_back(std::move(event));
 			}
 		}
 
-		//Publish any analog and binary events from above
-		for(auto& event : events)
-		{
-			PublishEvent(event);
-		}
+		//Publish any analog and binary events from above, in one go
+		if(!events.empty())
+			PublishEvent(events);
 		//We'll publish any controls separately below, because they each have a callback
 
 		for(auto& point_pair : pConf->pPointConf->Controls)
@@ -304,7 +373,7 @@ void JSONPort::ProcessBraced(const std::string& braced)
 			//if the path existed, get the value and send the control
 			if(!val.isNull())
 			{
-				auto event = std::make_shared<EventInfo>(EventType::ControlRelayOutputBlock,point_pair.first,Name,QualityFlags::NONE,timestamp);
+				auto event = MakeEvent(EventType::ControlRelayOutputBlock,point_pair.first,Name,QualityFlags::NONE,timestamp);
 
 				ControlRelayOutputBlock command;
 				command.functionCode = ControlCode::PULSE_ON; //default pulse if nothing else specified
@@ -423,7 +492,7 @@ void JSONPort::ProcessBraced(const std::string& braced)
 
 							std::ostringstream oss;
 							pWriter->write(result, &oss); oss<<std::endl;
-							pSockMan->Write(oss.str());
+							pSockMan->WriteTo(session,oss.str(),HandlerPriority::High);
 						});
 				event->SetPayload<EventType::ControlRelayOutputBlock>(std::move(command));
 				PublishEvent(event,pStatusCallback);
@@ -440,7 +509,7 @@ void JSONPort::ProcessBraced(const std::string& braced)
 			// Now decode the val JSON string to get the index and value and process that
 			if (!val.isNull())
 			{
-				auto event = std::make_shared<EventInfo>(EventType::AnalogOutputInt16, point_pair.first, Name, QualityFlags::ONLINE, timestamp);
+				auto event = MakeEvent(EventType::AnalogOutputInt16, point_pair.first, Name, QualityFlags::ONLINE, timestamp);
 				AO16 analogpayload;
 				analogpayload.second = CommandStatus::SUCCESS;
 
@@ -489,7 +558,7 @@ void JSONPort::ProcessBraced(const std::string& braced)
 
 							std::ostringstream oss;
 							pWriter->write(result, &oss); oss << std::endl;
-							pSockMan->Write(oss.str());
+							pSockMan->WriteTo(session,oss.str(),HandlerPriority::High);
 						});
 
 				PublishEvent(event, pStatusCallback);
@@ -499,10 +568,24 @@ void JSONPort::ProcessBraced(const std::string& braced)
 	else
 	{
 		if(auto log = odc::spdlog_get("JSONPort"))
-			log->warn("Error parsing JSON string: '{}' : '{}'", braced, err_str);
+			log->warn("Error parsing JSON string: '{}' : '{}'", std::string(start,stop), err_str);
 	}
 }
 
+//We only output points that have config (see Event() below)
+EventInterest JSONPort::GetEventInterest()
+{
+	auto pConf = static_cast<JSONPortConf*>(this->pConf.get());
+	auto interest = EventInterest::Nothing();
+	for(auto& point : pConf->pPointConf->Analogs)
+		interest.Add(EventType::Analog,point.first,point.first);
+	for(auto& point : pConf->pPointConf->Binaries)
+		interest.Add(EventType::Binary,point.first,point.first);
+	for(auto& point : pConf->pPointConf->Controls)
+		interest.Add(EventType::ControlRelayOutputBlock,point.first,point.first);
+	return interest;
+}
+
 void JSONPort::Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback)
 {
 	if(!enabled)
@@ -555,6 +638,13 @@ void JSONPort::Event(std::shared_ptr<const EventInfo> event, const std::string&
 		return;
 	}
 
+	//the other end isn't keeping up - controls still go through
+	if(write_backpressure && !IsPriorityEvent(event->GetEventType()))
+	{
+		(*pStatusCallback)(CommandStatus::BLOCKED);
+		return;
+	}
+
 	//TODO: make this writer reusable (class member)
 	//WARNING: Json::StreamWriter isn't threadsafe - maybe just share the StreamWriterBuilder for now...
 	Json::StreamWriterBuilder wbuilder;
@@ -564,7 +654,8 @@ void JSONPort::Event(std::shared_ptr<const EventInfo> event, const std::string&
 
 	std::ostringstream oss;
 	pWriter->write(output, &oss); oss<<std::endl;
-	pSockMan->Write(oss.str());
+	//controls don't wait behind telemetry that's queued to write
+	pSockMan->Write(oss.str(),IsPriorityEvent(event->GetEventType()) ? HandlerPriority::High : HandlerPriority::Normal);
 
 	(*pStatusCallback)(CommandStatus::SUCCESS);
 }
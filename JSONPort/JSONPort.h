@@ -46,15 +46,20 @@ public:
 
 	void Build() override;
 
+	EventInterest GetEventInterest() override;
 	void Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override;
 
+	const Json::Value GetStatus() const override;
+
 private:
 	bool isServer;
 	std::unique_ptr<TCPSocketManager<std::string>> pSockMan;
+	//set while the socket's write queue is over the high water mark
+	std::atomic_bool write_backpressure{false};
 	void SocketStateHandler(bool state);
-	void ReadCompletionHandler(buf_t& readbuf);
-	typedef asio::basic_waitable_timer<std::chrono::steady_clock> Timer_t;
-	void ProcessBraced(const std::string& braced);
+	size_t ReadCompletionHandler(size_t session, const char* data, size_t len);
+	typedef odc::steady_timer Timer_t;
+	void ProcessBraced(const char* start, const char* stop, size_t session);
 };
 
 #endif /* JSONDATAPORT_H_ */
@@ -27,6 +27,7 @@
 #ifndef JSONPORTCONF_H_
 #define JSONPORTCONF_H_
 
+#include <limits>
 #include <memory>
 #include <opendatacon/DataPortConf.h>
 #include "JSONPointConf.h"
@@ -43,6 +44,9 @@ public:
 	JSONPortConf(const std::string& FileName, const Json::Value& ConfOverrides):
 		retry_time_ms(3000),
 		evt_buffer_size(1000),
+		write_high_water(std::numeric_limits<size_t>::max()),
+		max_sessions(1),
+		use_io_uring(false),
 		style_output(false)
 	{
 		pPointConf = std::make_unique<JSONPointConf>(FileName, ConfOverrides);
@@ -52,6 +56,12 @@ public:
 	JSONAddrConf mAddrConf;
 	unsigned int retry_time_ms;
 	unsigned int evt_buffer_size;
+	//bytes queued to write before telemetry is dropped
+	size_t write_high_water;
+	//how many clients a server serves at once
+	size_t max_sessions;
+	//"Transport": "io_uring" instead of the default asio reactor (falls back if unsupported)
+	bool use_io_uring;
 	bool style_output;
 };
 
@@ -71,13 +71,14 @@ MD3Connection::MD3Connection
 	isServer(aisServer),
 	pSockMan(std::make_shared<TCPSocketManager<std::string>>
 			(pIOS, isServer, EndPoint, Port,
-			std::bind(&MD3Connection::ReadCompletionHandler, this, std::placeholders::_1),
+			[this](const char* data, size_t len){ return ReadCompletionHandler(data,len); },
 			std::bind(&MD3Connection::SocketStateHandler, this, std::placeholders::_1),
 			std::numeric_limits<size_t>::max(),
 			true,
 			retry_time_ms))
 {
 	ChannelID = MakeChannelID(aEndPoint, aPort, aisServer);
+	pSockMan->SetOwner("MD3Connection "+ChannelID);
 
 	LOGDEBUG("Opened an MD3Connection object " + ChannelID + " As a " + (isServer ? "Server" : "Client"));
 }
@@ -309,7 +310,8 @@ void MD3Connection::InjectSimulatedTCPMessage(const ConnectionTokenType &Connect
 	// Just pass to the Connection ReadCompletionHandler, as if it had come in from the TCP port
 	if (auto pConnection = ConnectionTok.pConnection)
 	{
-		pConnection->ReadCompletionHandler(readbuf);
+		const std::string data(asio::buffers_begin(readbuf.data()),asio::buffers_end(readbuf.data()));
+		readbuf.consume(pConnection->ReadCompletionHandler(data.data(),data.size()));
 	}
 	else
 	{
@@ -319,19 +321,18 @@ void MD3Connection::InjectSimulatedTCPMessage(const ConnectionTokenType &Connect
 
 // We need one read completion handler hooked to each address/port combination. This method is re-entrant,
 // We do some basic MD3 block identification and processing, enough to give us complete blocks and StationAddresses
-void MD3Connection::ReadCompletionHandler(buf_t&readbuf)
+size_t MD3Connection::ReadCompletionHandler(const char* data, size_t len)
 {
 	// We are currently assuming a whole complete packet will turn up in one unit. If not it will be difficult to do the packet decoding and multi-drop routing.
 	// MD3 only has addressing information in the first block of the packet.
 	// We should have a multiple of 6 bytes. 5 data bytes and one padding byte for every MD3 block, then possibly multiple blocks
 	// We need to know enough about the packets to work out the first and last, and the station address, so we can pass them to the correct station.
 
-	while (readbuf.size() > 0)
+	for (size_t i = 0; i < len; i++)
 	{
 		// Add another byte to our 4 byte block.
 
-		ReadCompletionHandlerMD3block.AddByteToBlock(static_cast<uint8_t>(readbuf.sgetc()));
-		readbuf.consume(1);
+		ReadCompletionHandlerMD3block.AddByteToBlock(static_cast<uint8_t>(data[i]));
 
 		if (ReadCompletionHandlerMD3block.IsValidBlock()) // Check checksum padding byte and number of chars we have stuffed into the block
 		{
@@ -372,6 +373,8 @@ void MD3Connection::ReadCompletionHandler(buf_t&readbuf)
 			// The block was not valid, we will push another byte in (and one out) and try again (think shifting 4 byte window)
 		}
 	}
+	// Everything goes into the block collector, so we've used it all
+	return len;
 }
 void MD3Connection::RouteMD3Message(MD3Message_t &CompleteMD3Message)
 {
@@ -107,10 +107,11 @@ void MD3MasterPort::Build()
 		PollScheduler.reset(new ASIOScheduler(*pIOS));
 
 	MasterCommandProtectedData.CurrentCommandTimeoutTimer = pIOS->make_steady_timer();
-	MasterCommandStrand = pIOS->make_strand();
+	MasterCommandStrand = pIOS->make_serial_executor(Name);
 
 	// Need a couple of things passed to the point table.
 	MyPointConf->PointTable.Build(IsOutStation, MyPointConf->NewDigitalCommands, *pIOS);
+	RegisterPoints();
 
 	// Creates internally if necessary, returns a token for the connection
 	pConnection = MD3Connection::AddConnection(pIOS, IsServer(), MyConf->mAddrConf.IP, MyConf->mAddrConf.Port, MyConf->mAddrConf.TCPConnectRetryPeriodms); //Static method
@@ -157,13 +158,15 @@ void MD3MasterPort::SendMD3Message(const MD3Message_t &CompleteMD3Message)
 // If the callback gets an error it will be ignored which will result in a timeout and the next command being sent.
 // This is necessary if somehow we get an old command sent to us, or a left over broadcast message.
 // Only issue is if we do a broadcast message and can get information back from multiple sources... These commands are probably not used, and we will ignore them anyway.
-void MD3MasterPort::QueueMD3Command(const MD3Message_t &CompleteMD3Message, SharedStatusCallback_t pStatusCallback)
+void MD3MasterPort::QueueMD3Command(const MD3Message_t &CompleteMD3Message, SharedStatusCallback_t pStatusCallback, const HandlerPriority priority)
 {
 	MasterCommandStrand->dispatch([=]() // Tries to execute, if not able to will post. Note the calling thread must be one of the io_service threads.... this changes our tests!
 		{
-			if (MasterCommandProtectedData.MasterCommandQueue.size() < MasterCommandProtectedData.MaxCommandQueueSize)
+			// Controls have their own queue, so they don't wait behind (or get turned away by) a backlog of scans
+			auto& Queue = (priority == HandlerPriority::High) ? MasterCommandProtectedData.PriorityCommandQueue : MasterCommandProtectedData.MasterCommandQueue;
+			if (Queue.size() < MasterCommandProtectedData.MaxCommandQueueSize)
 			{
-			      MasterCommandProtectedData.MasterCommandQueue.push(MasterCommandQueueItem(CompleteMD3Message, pStatusCallback)); // async
+			      Queue.push(MasterCommandQueueItem(CompleteMD3Message, pStatusCallback)); // async
 			}
 			else
 			{
@@ -173,21 +176,21 @@ void MD3MasterPort::QueueMD3Command(const MD3Message_t &CompleteMD3Message, Shar
 
 			// Will only send if we can - i.e. not currently processing a command
 			UnprotectedSendNextMasterCommand(false);
-		});
+		},priority);
 }
 // Handle the many single block command messages better
-void MD3MasterPort::QueueMD3Command(const MD3BlockData &SingleBlockMD3Message, SharedStatusCallback_t pStatusCallback)
+void MD3MasterPort::QueueMD3Command(const MD3BlockData &SingleBlockMD3Message, SharedStatusCallback_t pStatusCallback, const HandlerPriority priority)
 {
 	MD3Message_t CommandMD3Message;
 	CommandMD3Message.push_back(SingleBlockMD3Message);
-	QueueMD3Command(CommandMD3Message, pStatusCallback);
+	QueueMD3Command(CommandMD3Message, pStatusCallback, priority);
 }
 // Handle the many single block command messages better
-void MD3MasterPort::QueueMD3Command(const MD3BlockFormatted &SingleBlockMD3Message, SharedStatusCallback_t pStatusCallback)
+void MD3MasterPort::QueueMD3Command(const MD3BlockFormatted &SingleBlockMD3Message, SharedStatusCallback_t pStatusCallback, const HandlerPriority priority)
 {
 	MD3Message_t CommandMD3Message;
 	CommandMD3Message.push_back(SingleBlockMD3Message);
-	QueueMD3Command(CommandMD3Message, pStatusCallback);
+	QueueMD3Command(CommandMD3Message, pStatusCallback, priority);
 }
 
 // Just schedule the callback, don't want to do it in a strand protected section.
@@ -244,15 +247,17 @@ void MD3MasterPort::UnprotectedSendNextMasterCommand(bool timeoutoccured)
 			}
 		}
 
-		if (!MasterCommandProtectedData.MasterCommandQueue.empty() && (MasterCommandProtectedData.ProcessingMD3Command != true))
+		// Controls go before anything else that is waiting.
+		auto& NextCommandQueue = MasterCommandProtectedData.PriorityCommandQueue.empty() ? MasterCommandProtectedData.MasterCommandQueue : MasterCommandProtectedData.PriorityCommandQueue;
+		if (!NextCommandQueue.empty() && (MasterCommandProtectedData.ProcessingMD3Command != true))
 		{
 			// Send the next command if there is one and we are not retrying.
 
 			MasterCommandProtectedData.ProcessingMD3Command = true;
 			MasterCommandProtectedData.RetriesLeft = MyPointConf->MD3CommandRetries;
 
-			MasterCommandProtectedData.CurrentCommand = MasterCommandProtectedData.MasterCommandQueue.front();
-			MasterCommandProtectedData.MasterCommandQueue.pop();
+			MasterCommandProtectedData.CurrentCommand = NextCommandQueue.front();
+			NextCommandQueue.pop();
 
 			MasterCommandProtectedData.CurrentFunctionCode = MD3BlockFormatted(MasterCommandProtectedData.CurrentCommand.first[0]).GetFunctionCode();
 			LOGDEBUG("Sending next command :" + std::to_string(MasterCommandProtectedData.CurrentFunctionCode))
@@ -313,6 +318,10 @@ void MD3MasterPort::ClearMD3CommandQueue()
 			{
 			      MasterCommandProtectedData.MasterCommandQueue.pop();
 			}
+			while (!MasterCommandProtectedData.PriorityCommandQueue.empty())
+			{
+			      MasterCommandProtectedData.PriorityCommandQueue.pop();
+			}
 			MasterCommandProtectedData.CurrentFunctionCode = 0;
 			MasterCommandProtectedData.ProcessingMD3Command = false;
 		});
@@ -571,6 +580,8 @@ bool MD3MasterPort::ProcessAnalogUnconditionalReturn(MD3BlockFormatted & Header,
 	bool FirstModuleIsCounterModule = MyPointConf->PointTable.GetCounterValueUsingMD3Index(ModuleAddress, 0, wordres,hasbeenset);
 	MD3Time now = MD3NowUTC();
 
+	EventBatch_t batch;
+	batch.reserve(Channels);
 	for (uint8_t i = 0; i < Channels; i++)
 	{
 		// Code to adjust the ModuleAddress and index if the first module is a counter module (8 channels)
@@ -591,7 +602,7 @@ bool MD3MasterPort::ProcessAnalogUnconditionalReturn(MD3BlockFormatted & Header,
 
 				auto event = std::make_shared<EventInfo>(EventType::Analog, ODCIndex, Name, qual, static_cast<msSinceEpoch_t>(now)); // We don't get time info from MD3, so add it as soon as possible);
 				event->SetPayload<EventType::Analog>(std::move(AnalogValues[i]));
-				PublishEvent(event);
+				batch.push_back(std::move(event));
 			}
 		}
 		else if (MyPointConf->PointTable.SetCounterValueUsingMD3Index(maddress, idx, AnalogValues[i]))
@@ -605,15 +616,17 @@ bool MD3MasterPort::ProcessAnalogUnconditionalReturn(MD3BlockFormatted & Header,
 				LOGDEBUG("MA - Published Event - Counter - Index {} Value {}",ODCIndex, to_hexstring(AnalogValues[i]));
 				auto event = std::make_shared<EventInfo>(EventType::Counter, ODCIndex, Name, qual, static_cast<msSinceEpoch_t>(now)); // We don't get time info from MD3, so add it as soon as possible);
 				event->SetPayload<EventType::Counter>(std::move(AnalogValues[i]));
-				PublishEvent(event);
+				batch.push_back(std::move(event));
 			}
 		}
 		else
 		{
 			LOGERROR("MA - Fn5 Failed to set an Analog or Counter Value - {} On Station Address - {} Module : {} Channel : {}",Header.GetFunctionCode(),Header.GetStationAddress(),maddress, idx);
+			PublishEvent(batch);
 			return false;
 		}
 	}
+	PublishEvent(batch);
 	return true;
 }
 
@@ -664,6 +677,8 @@ bool MD3MasterPort::ProcessAnalogDeltaScanReturn(MD3BlockFormatted & Header, con
 	bool FirstModuleIsCounterModule = MyPointConf->PointTable.GetCounterValueUsingMD3Index(ModuleAddress, 0, wordres,hasbeenset);
 	MD3Time now = MD3NowUTC();
 
+	EventBatch_t batch;
+	batch.reserve(Channels);
 	for (uint8_t i = 0; i < Channels; i++)
 	{
 		// Code to adjust the ModuleAddress and index if the first module is a counter module (8 channels)
@@ -686,7 +701,7 @@ bool MD3MasterPort::ProcessAnalogDeltaScanReturn(MD3BlockFormatted & Header, con
 				LOGDEBUG("MA - Published Event - Analog Index {} Value {}", ODCIndex, to_hexstring(wordres));
 				auto event = std::make_shared<EventInfo>(EventType::Analog, ODCIndex, Name, qual, static_cast<msSinceEpoch_t>(now)); // We don't get time info from MD3, so add it as soon as possible
 				event->SetPayload<EventType::Analog>(std::move(wordres));
-				PublishEvent(event);
+				batch.push_back(std::move(event));
 			}
 		}
 		else if (MyPointConf->PointTable.GetCounterValueUsingMD3Index(maddress, idx,wordres,hasbeenset))
@@ -703,15 +718,17 @@ bool MD3MasterPort::ProcessAnalogDeltaScanReturn(MD3BlockFormatted & Header, con
 				LOGDEBUG("MA - Published Event - Counter Index {} Value {}", ODCIndex, to_hexstring(wordres));
 				auto event = std::make_shared<EventInfo>(EventType::Counter, ODCIndex, Name, qual, static_cast<msSinceEpoch_t>(now)); // We don't get time info from MD3, so add it as soon as possible);
 				event->SetPayload<EventType::Counter>(std::move(wordres));
-				PublishEvent(event);
+				batch.push_back(std::move(event));
 			}
 		}
 		else
 		{
 			LOGERROR("Fn6 Failed to set an Analog or Counter Value - {} On Station Address - {} Module : {} Channel : {}",Header.GetFunctionCode(), Header.GetStationAddress(), maddress,std::to_string(idx));
+			PublishEvent(batch);
 			return false;
 		}
 	}
+	PublishEvent(batch);
 	return true;
 }
 
@@ -741,6 +758,8 @@ bool MD3MasterPort::ProcessAnalogNoChangeReturn(MD3BlockFormatted & Header, cons
 
 		MD3Time now = MD3NowUTC();
 
+		EventBatch_t batch;
+		batch.reserve(Channels);
 		for (uint8_t i = 0; i < Channels; i++)
 		{
 			// Code to adjust the ModuleAddress and index if the first module is a counter module (8 channels)
@@ -762,7 +781,7 @@ bool MD3MasterPort::ProcessAnalogNoChangeReturn(MD3BlockFormatted & Header, cons
 					LOGDEBUG("MA - Published Event - Analog Index {} Value {}",ODCIndex, to_hexstring(wordres));
 					auto event = std::make_shared<EventInfo>(EventType::Analog, ODCIndex, Name, qual, static_cast<msSinceEpoch_t>(now)); // We don't get time info from MD3, so add it as soon as possible
 					event->SetPayload<EventType::Analog>(std::move(wordres));
-					PublishEvent(event);
+					batch.push_back(std::move(event));
 				}
 			}
 			else if (MyPointConf->PointTable.GetCounterValueUsingMD3Index(maddress, idx, wordres, hasbeenset))
@@ -778,15 +797,17 @@ bool MD3MasterPort::ProcessAnalogNoChangeReturn(MD3BlockFormatted & Header, cons
 					LOGDEBUG("MA - Published Event - Counter Index {} Value {}",ODCIndex, to_hexstring(wordres));
 					auto event = std::make_shared<EventInfo>(EventType::Counter, ODCIndex, Name, qual, static_cast<msSinceEpoch_t>(now)); // We don't get time info from MD3, so add it as soon as possible);
 					event->SetPayload<EventType::Counter>(std::move(wordres));
-					PublishEvent(event);
+					batch.push_back(std::move(event));
 				}
 			}
 			else
 			{
 				LOGERROR("Fn5 Failed to set an Analog or Counter Time - {} On Station Address - {} Module : {} Channel : {}",Header.GetFunctionCode(), Header.GetStationAddress(), maddress,idx);
+				PublishEvent(batch);
 				return false;
 			}
 		}
+		PublishEvent(batch);
 	}
 	return true;
 }
@@ -1378,49 +1399,49 @@ void MD3MasterPort::SetAllPointsQualityToCommsLost()
 {
 	LOGDEBUG("MD3 Master setting quality to comms lost");
 
-	auto eventbinary = std::make_shared<EventInfo>(EventType::BinaryQuality, 0, Name, QualityFlags::COMM_LOST);
-	eventbinary->SetPayload<EventType::BinaryQuality>(QualityFlags::COMM_LOST);
+	// All the quality changes go out as one batch
+	EventBatch_t batch;
 
 	// Loop through all Binary points.
 	MyPointConf->PointTable.ForEachBinaryPoint([&](MD3BinaryPoint &Point)
 		{
 			uint32_t index = Point.GetIndex();
-			eventbinary->SetIndex(index);
-			PublishEvent(eventbinary);
+			auto eventbinary = MakeEvent(EventType::BinaryQuality, index, Name, QualityFlags::COMM_LOST);
+			eventbinary->SetPayload<EventType::BinaryQuality>(QualityFlags::COMM_LOST);
+			batch.push_back(std::move(eventbinary));
 			Point.SetChangedFlag();
 		});
 
 	// Analogs
-
-	auto eventanalog = std::make_shared<EventInfo>(EventType::AnalogQuality, 0, Name, QualityFlags::COMM_LOST);
-	eventanalog->SetPayload<EventType::AnalogQuality>(QualityFlags::COMM_LOST);
 	MyPointConf->PointTable.ForEachAnalogPoint([&](MD3AnalogCounterPoint &Point)
 		{
 			uint32_t index = Point.GetIndex();
 			if (!MyPointConf->PointTable.ResetAnalogValueUsingODCIndex(index)) // Sets to 0x8000, time = 0, HasBeenSet to false
 				LOGERROR("Tried to set the value for an invalid analog point index {}",index);
 
-			eventanalog->SetIndex(index);
-			PublishEvent(eventanalog);
+			auto eventanalog = MakeEvent(EventType::AnalogQuality, index, Name, QualityFlags::COMM_LOST);
+			eventanalog->SetPayload<EventType::AnalogQuality>(QualityFlags::COMM_LOST);
+			batch.push_back(std::move(eventanalog));
 		});
 	// Counters
-	auto eventcounter = std::make_shared<EventInfo>(EventType::CounterQuality, 0, Name, QualityFlags::COMM_LOST);
-	eventcounter->SetPayload<EventType::CounterQuality>(QualityFlags::COMM_LOST);
-
 	MyPointConf->PointTable.ForEachCounterPoint([&](MD3AnalogCounterPoint &Point)
 		{
 			uint32_t index = Point.GetIndex();
 			if (!MyPointConf->PointTable.ResetCounterValueUsingODCIndex(index)) // Sets to 0x8000, time = 0, HasBeenSet to false
 				LOGERROR("Tried to set the value for an invalid analog point index {}",index);
 
-			eventcounter->SetIndex(index);
-			PublishEvent(eventcounter);
+			auto eventcounter = MakeEvent(EventType::CounterQuality, index, Name, QualityFlags::COMM_LOST);
+			eventcounter->SetPayload<EventType::CounterQuality>(QualityFlags::COMM_LOST);
+			batch.push_back(std::move(eventcounter));
 		});
+	PublishEvent(batch);
 }
 
 // When a new device connects to us through ODC (or an existing one reconnects), send them everything we currently have.
 void MD3MasterPort::SendAllPointEvents()
 {
+	EventBatch_t batch;
+
 	// Quality of ONLINE means the data is GOOD.
 	MyPointConf->PointTable.ForEachBinaryPoint([&](MD3BinaryPoint &Point)
 		{
@@ -1430,7 +1451,7 @@ void MD3MasterPort::SendAllPointEvents()
 
 			auto event = std::make_shared<EventInfo>(EventType::Binary, index, Name, qual, static_cast<msSinceEpoch_t>(Point.GetChangedTime()));
 			event->SetPayload<EventType::Binary>(meas == 1);
-			PublishEvent(event);
+			batch.push_back(std::move(event));
 		});
 
 	// Analogs
@@ -1444,7 +1465,7 @@ void MD3MasterPort::SendAllPointEvents()
 
 			auto event = std::make_shared<EventInfo>(EventType::Analog, index, Name, qual, static_cast<msSinceEpoch_t>(Point.GetChangedTime()));
 			event->SetPayload<EventType::Analog>(std::move(meas));
-			PublishEvent(event);
+			batch.push_back(std::move(event));
 		});
 
 	// Counters
@@ -1457,8 +1478,9 @@ void MD3MasterPort::SendAllPointEvents()
 
 			auto event = std::make_shared<EventInfo>(EventType::Counter, index, Name, qual, static_cast<msSinceEpoch_t>(Point.GetChangedTime()));
 			event->SetPayload<EventType::Counter>(std::move(meas));
-			PublishEvent(event);
+			batch.push_back(std::move(event));
 		});
+	PublishEvent(batch);
 }
 
 // Binary quality only depends on our link status and if we have received data
@@ -1740,7 +1762,7 @@ void MD3MasterPort::SendDOMOutputCommand(const uint8_t &StationAddress, const ui
 	MD3Message_t Cmd;
 	Cmd.push_back(commandblock);
 	Cmd.push_back(datablock);
-	QueueMD3Command(Cmd, pStatusCallback);
+	QueueMD3Command(Cmd, pStatusCallback, HandlerPriority::High);
 }
 void MD3MasterPort::SendPOMOutputCommand(const uint8_t &StationAddress, const uint8_t &ModuleAddress, const uint8_t &outputselection, const SharedStatusCallback_t &pStatusCallback)
 {
@@ -1750,7 +1772,7 @@ void MD3MasterPort::SendPOMOutputCommand(const uint8_t &StationAddress, const ui
 	MD3Message_t Cmd;
 	Cmd.push_back(commandblock);
 	Cmd.push_back(datablock);
-	QueueMD3Command(Cmd, pStatusCallback);
+	QueueMD3Command(Cmd, pStatusCallback, HandlerPriority::High);
 }
 void MD3MasterPort::SendDIMOutputCommand(const uint8_t& StationAddress, const uint8_t& ModuleAddress, const uint8_t& outputselection, const DIMControlSelectionType controlselect, const uint16_t outputdata, const SharedStatusCallback_t& pStatusCallback)
 {
@@ -1773,7 +1795,7 @@ void MD3MasterPort::SendDIMOutputCommand(const uint8_t& StationAddress, const ui
 		Cmd.push_back(datablock);
 	}
 
-	QueueMD3Command(Cmd, pStatusCallback);
+	QueueMD3Command(Cmd, pStatusCallback, HandlerPriority::High);
 }
 void MD3MasterPort::SendAOMOutputCommand(const uint8_t &StationAddress, const uint8_t &ModuleAddress, const uint8_t &Channel, const uint16_t &value, const SharedStatusCallback_t &pStatusCallback)
 {
@@ -1783,5 +1805,5 @@ void MD3MasterPort::SendAOMOutputCommand(const uint8_t &StationAddress, const ui
 	MD3Message_t Cmd;
 	Cmd.push_back(commandblock);
 	Cmd.push_back(datablock);
-	QueueMD3Command(Cmd, pStatusCallback);
+	QueueMD3Command(Cmd, pStatusCallback, HandlerPriority::High);
 }
\ No newline at end of file
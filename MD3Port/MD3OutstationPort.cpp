@@ -106,6 +106,7 @@ void MD3OutstationPort::Build()
 
 	// Need a couple of things passed to the point table.
 	MyPointConf->PointTable.Build(IsOutStation, MyPointConf->NewDigitalCommands, *pIOS);
+	RegisterPoints();
 
 	pConnection = MD3Connection::AddConnection(pIOS, IsServer(), MyConf->mAddrConf.IP, MyConf->mAddrConf.Port, MyConf->mAddrConf.TCPConnectRetryPeriodms); //Static method
 
@@ -184,6 +185,27 @@ CommandStatus MD3OutstationPort::Perform(std::shared_ptr<EventInfo> event, bool
 #pragma region DataEvents
 #endif
 
+// Only the points in our point table are any use to us - the rest would just be rejected by Event() below
+EventInterest MD3OutstationPort::GetEventInterest()
+{
+	auto interest = EventInterest::Nothing();
+	MyPointConf->PointTable.ForEachAnalogPoint([&interest](MD3AnalogCounterPoint &pt)
+		{
+			interest.Add(EventType::Analog, pt.GetIndex(), pt.GetIndex());
+			interest.Add(EventType::AnalogQuality, pt.GetIndex(), pt.GetIndex());
+		});
+	MyPointConf->PointTable.ForEachCounterPoint([&interest](MD3AnalogCounterPoint &pt)
+		{
+			interest.Add(EventType::Counter, pt.GetIndex(), pt.GetIndex());
+			interest.Add(EventType::CounterQuality, pt.GetIndex(), pt.GetIndex());
+		});
+	MyPointConf->PointTable.ForEachBinaryPoint([&interest](MD3BinaryPoint &pt)
+		{
+			interest.Add(EventType::Binary, pt.GetIndex(), pt.GetIndex());
+		});
+	return interest;
+}
+
 // We received a change in data from an Event (from the opendatacon Connector) now store it so that it can be produced when the Scada master polls us
 // for a group or individually on our TCP connection.
 void MD3OutstationPort::Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback)
@@ -99,6 +99,7 @@ public:
 	void Disable() override;
 	void Build() override;
 
+	EventInterest GetEventInterest() override;
 	void Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override;
 	CommandStatus Perform(std::shared_ptr<EventInfo> event, bool waitforresult);
 
@@ -35,7 +35,7 @@ void MD3PointTableAccess::Build(const bool isoutstation, const bool newdigitalco
 {
 	IsOutstation = isoutstation;
 	NewDigitalCommands = newdigitalcommands;
-	pBinaryTimeTaggedEventQueue.reset(new StrandProtectedQueue<MD3BinaryPoint>(IOS, 256));
+	pBinaryTimeTaggedEventQueue.reset(new odc::BoundedMPMCQueue<MD3BinaryPoint>(256));
 }
 
 #ifdef _MSC_VER
@@ -437,7 +437,7 @@ void MD3PointTableAccess::AddToDigitalEvents(MD3BinaryPoint &inpt)
 			pt.SetModuleBinarySnapShot(wordres);
 		}
 		// Will fail if full, which is the defined MD3 behaviour. Push takes a copy
-		pBinaryTimeTaggedEventQueue->async_push(pt);
+		pBinaryTimeTaggedEventQueue->Push(pt);
 	}
 }
 uint16_t MD3PointTableAccess::CollectModuleBitsIntoWordandResetChangeFlags(const uint8_t ModuleAddress, bool &ModuleFailed)
@@ -534,25 +534,24 @@ std::vector<MD3BinaryPoint> MD3PointTableAccess::DumpTimeTaggedPointList()
 	MD3BinaryPoint CurrentPoint;
 	std::vector<MD3BinaryPoint> PointList(50);
 
-	while (pBinaryTimeTaggedEventQueue->sync_front(CurrentPoint))
+	while (pBinaryTimeTaggedEventQueue->Pop(CurrentPoint))
 	{
 		PointList.emplace_back(CurrentPoint);
-		pBinaryTimeTaggedEventQueue->sync_pop();
 	}
 
 	return PointList;
 }
 bool MD3PointTableAccess::PeekNextTaggedEventPoint(MD3BinaryPoint &pt)
 {
-	return pBinaryTimeTaggedEventQueue->sync_front(pt);
+	return pBinaryTimeTaggedEventQueue->Front(pt);
 }
 bool MD3PointTableAccess::PopNextTaggedEventPoint()
 {
-	return pBinaryTimeTaggedEventQueue->sync_pop();
+	return pBinaryTimeTaggedEventQueue->Pop();
 }
 bool MD3PointTableAccess::TimeTaggedDataAvailable()
 {
-	return !pBinaryTimeTaggedEventQueue->sync_empty();
+	return !pBinaryTimeTaggedEventQueue->Empty();
 }
 
 void MD3PointTableAccess::ForEachBinaryPoint(std::function<void(MD3BinaryPoint &pt)> fn)
@@ -36,7 +36,7 @@
 #include "MD3PointConf.h"
 //#include "MD3PortConf.h"
 #include "MD3Utility.h"
-#include "StrandProtectedQueue.h"
+#include <opendatacon/BoundedMPMCQueue.h>
 
 using namespace odc;
 
@@ -127,7 +127,7 @@ protected:
 	bool NewDigitalCommands = true;
 
 	// Only used in outstation
-	std::shared_ptr<StrandProtectedQueue<MD3BinaryPoint>> pBinaryTimeTaggedEventQueue; // Separate queue for time tagged binary events.
+	std::shared_ptr<odc::BoundedMPMCQueue<MD3BinaryPoint>> pBinaryTimeTaggedEventQueue; // Separate queue for time tagged binary events.
 };
 
 #endif
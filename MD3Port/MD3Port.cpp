@@ -28,6 +28,7 @@
 #include <iostream>
 #include "MD3Port.h"
 #include "MD3PortConf.h"
+#include <opendatacon/PointRegistry.h>
 
 MD3Port::MD3Port(const std::string &aName, const std::string & aConfFilename, const Json::Value & aConfOverrides):
 	DataPort(aName, aConfFilename, aConfOverrides)
@@ -92,6 +93,22 @@ void MD3Port::ProcessElements(const Json::Value& JSONRoot)
 
 }
 
+void MD3Port::RegisterPoints()
+{
+	MyPointConf->PointTable.ForEachAnalogPoint([this](MD3AnalogCounterPoint &pt)
+		{
+			RegisterPoint(Name, EventType::Analog, pt.GetIndex());
+		});
+	MyPointConf->PointTable.ForEachCounterPoint([this](MD3AnalogCounterPoint &pt)
+		{
+			RegisterPoint(Name, EventType::Counter, pt.GetIndex());
+		});
+	MyPointConf->PointTable.ForEachBinaryPoint([this](MD3BinaryPoint &pt)
+		{
+			RegisterPoint(Name, EventType::Binary, pt.GetIndex());
+		});
+}
+
 int MD3Port::Limit(int val, int max)
 {
 	return val > max ? max : val;
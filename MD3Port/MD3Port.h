@@ -37,7 +37,6 @@
 #include "MD3PortConf.h"
 #include "MD3Utility.h"
 #include "MD3Connection.h"
-#include "StrandProtectedQueue.h"
 
 using namespace odc;
 
@@ -70,6 +69,9 @@ protected:
 	MD3PortConf *MyConf;
 	std::shared_ptr<MD3PointConf> MyPointConf;
 
+	//Give our points IDs in the odc::PointRegistry - call from Build()
+	void RegisterPoints();
+
 	int Limit(int val, int max);
 	uint8_t Limit(uint8_t val, uint8_t max);
 
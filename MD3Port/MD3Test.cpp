@@ -48,6 +48,7 @@
 #include "MD3MasterPort.h"
 #include "MD3Utility.h"
 #include "StrandProtectedQueue.h"
+#include <opendatacon/BoundedMPMCQueue.h>
 #include "ProducerConsumerQueue.h"
 
 #ifdef NONVSTESTING
@@ -263,7 +264,7 @@ void TestSetup(bool writeconffiles = true)
 
 void TestTearDown()
 {
-	spdlog::drop_all(); // Close off everything
+	odc::spdlog_drop_all(); // Close off everything
 }
 // Used for command line test setup
 void CommandLineLoggingSetup(spdlog::level::level_enum log_level)
@@ -453,6 +454,57 @@ TEST_CASE("Utility - Strand Queue")
 	t1.join(); // Wait for thread to end
 	t2.join();
 }
+TEST_CASE("Utility - Queue Throughput", "[.][benchmark]")
+{
+	// Compare the old strand protected queue with the lock-free ring the point table now uses
+	odc::asio_service IOS(2);
+	auto work = IOS.make_work();
+	std::thread t1([&]() {IOS.run(); });
+	std::thread t2([&]() {IOS.run(); });
+
+	const int num_items = 100000;
+	const int batch = 200;
+
+	StrandProtectedQueue<int> strandqueue(IOS, batch);
+	auto start = std::chrono::high_resolution_clock::now();
+	int sum = 0;
+	for (int i = 0; i < num_items; i += batch)
+	{
+		for (int j = 0; j < batch; j++)
+			strandqueue.sync_push(i + j);
+		int res;
+		while (strandqueue.sync_front(res))
+		{
+			sum += res & 1;
+			strandqueue.sync_pop();
+		}
+	}
+	auto strand_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+	REQUIRE(sum == num_items / 2);
+
+	odc::BoundedMPMCQueue<int> ringqueue(batch);
+	start = std::chrono::high_resolution_clock::now();
+	sum = 0;
+	for (int i = 0; i < num_items; i += batch)
+	{
+		for (int j = 0; j < batch; j++)
+			ringqueue.Push(i + j);
+		int res;
+		while (ringqueue.Front(res))
+		{
+			sum += res & 1;
+			ringqueue.Pop();
+		}
+	}
+	auto ring_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+	REQUIRE(sum == num_items / 2);
+
+	std::cout << "Queue push+front+pop: StrandProtectedQueue " << strand_ns / num_items << "ns per item, BoundedMPMCQueue " << ring_ns / num_items << "ns per item" << std::endl;
+
+	work.reset();
+	t1.join();
+	t2.join();
+}
 #ifdef _MSC_VER
 #pragma region Block Tests
 #endif
@@ -45,7 +45,7 @@ public:
 	StrandProtectedQueue(odc::asio_service& _io_context, unsigned int _size)
 		: size(_size),
 		queue_io_context(_io_context),
-		internal_queue_strand(_io_context.make_strand())
+		internal_queue_strand(_io_context.make_serial_executor())
 	{}
 
 	// Return front of queue value
@@ -196,7 +196,7 @@ private:
 	std::queue<T> fifo;
 	unsigned int size;
 	odc::asio_service& queue_io_context;
-	std::unique_ptr<asio::io_service::strand> internal_queue_strand;
+	std::unique_ptr<odc::serial_executor> internal_queue_strand;
 };
 
 #endif
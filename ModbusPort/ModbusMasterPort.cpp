@@ -151,7 +151,7 @@ void ModbusMasterPort::Disconnect()
 
 	//TODO: implement a comms point
 
-	auto event = std::make_shared<EventInfo>(EventType::BinaryQuality,0,Name,QualityFlags::COMM_LOST);
+	auto event = MakeEvent(EventType::BinaryQuality,0,Name,QualityFlags::COMM_LOST);
 	event->SetPayload<EventType::BinaryQuality>(QualityFlags::COMM_LOST);
 
 	// Modbus function code 0x01 (read coil status)
@@ -254,7 +254,7 @@ void ModbusMasterPort::Build()
 
 		//TODO: collect these on a collection of modbus tcp connections
 		MBSync = std::make_unique<ModbusExecutor>(
-			modbus_new_tcp_pi(pConf->mAddrConf.IP.c_str(), std::to_string(pConf->mAddrConf.Port).c_str()), *pIOS);
+			modbus_new_tcp_pi(pConf->mAddrConf.IP.c_str(), std::to_string(pConf->mAddrConf.Port).c_str()), *pIOS, Name);
 
 		if (MBSync->isNull())
 		{
@@ -268,7 +268,7 @@ void ModbusMasterPort::Build()
 	{
 		log_id = "mast_" + pConf->mAddrConf.SerialDevice;
 		MBSync = std::make_unique<ModbusExecutor>(
-			modbus_new_rtu(pConf->mAddrConf.SerialDevice.c_str(),pConf->mAddrConf.BaudRate,(char)pConf->mAddrConf.Parity,pConf->mAddrConf.DataBits,pConf->mAddrConf.StopBits), *pIOS);
+			modbus_new_rtu(pConf->mAddrConf.SerialDevice.c_str(),pConf->mAddrConf.BaudRate,(char)pConf->mAddrConf.Parity,pConf->mAddrConf.DataBits,pConf->mAddrConf.StopBits), *pIOS, Name);
 
 		if (MBSync->isNull())
 		{
@@ -324,13 +324,16 @@ void ModbusMasterPort::DoPoll(uint32_t pollgroup, modbus_t* mb)
 		else
 		{
 			uint16_t index = range.start;
+			EventBatch_t batch;
+			batch.reserve(rc);
 			for(uint16_t i = 0; i < rc; i++ )
 			{
-				auto event = std::make_shared<EventInfo>(EventType::BinaryOutputStatus,index,Name,QualityFlags::ONLINE);
+				auto event = MakeEvent(EventType::BinaryOutputStatus,index,Name,QualityFlags::ONLINE);
 				event->SetPayload<EventType::BinaryOutputStatus>(((uint8_t*)modbus_read_buffer)[i] != false);
-				PublishEvent(event);
+				batch.push_back(std::move(event));
 				++index;
 			}
+			PublishEvent(batch);
 		}
 	}
 
@@ -355,13 +358,16 @@ void ModbusMasterPort::DoPoll(uint32_t pollgroup, modbus_t* mb)
 		else
 		{
 			uint16_t index = range.start;
+			EventBatch_t batch;
+			batch.reserve(rc);
 			for(uint16_t i = 0; i < rc; i++ )
 			{
-				auto event = std::make_shared<EventInfo>(EventType::Binary,index,Name,QualityFlags::ONLINE);
+				auto event = MakeEvent(EventType::Binary,index,Name,QualityFlags::ONLINE);
 				event->SetPayload<EventType::Binary>(((uint8_t*)modbus_read_buffer)[i] != false);
-				PublishEvent(event);
+				batch.push_back(std::move(event));
 				++index;
 			}
+			PublishEvent(batch);
 		}
 	}
 
@@ -386,14 +392,17 @@ void ModbusMasterPort::DoPoll(uint32_t pollgroup, modbus_t* mb)
 		else
 		{
 			uint16_t index = range.start;
+			EventBatch_t batch;
+			batch.reserve(rc);
 			for(uint16_t i = 0; i < rc; i++ )
 			{
-				auto event = std::make_shared<EventInfo>(EventType::AnalogOutputInt16,index,Name,QualityFlags::ONLINE);
+				auto event = MakeEvent(EventType::AnalogOutputInt16,index,Name,QualityFlags::ONLINE);
 				auto payload = AO16(((uint16_t*)modbus_read_buffer)[i],CommandStatus::SUCCESS);
 				event->SetPayload<EventType::AnalogOutputInt16>(std::move(payload));
-				PublishEvent(event);
+				batch.push_back(std::move(event));
 				++index;
 			}
+			PublishEvent(batch);
 		}
 	}
 
@@ -418,13 +427,16 @@ void ModbusMasterPort::DoPoll(uint32_t pollgroup, modbus_t* mb)
 		else
 		{
 			uint16_t index = range.start;
+			EventBatch_t batch;
+			batch.reserve(rc);
 			for(uint16_t i = 0; i < rc; i++ )
 			{
-				auto event = std::make_shared<EventInfo>(EventType::Analog,index,Name,QualityFlags::ONLINE);
+				auto event = MakeEvent(EventType::Analog,index,Name,QualityFlags::ONLINE);
 				event->SetPayload<EventType::Analog>(std::move(((uint16_t*)modbus_read_buffer)[i]));
-				PublishEvent(event);
+				batch.push_back(std::move(event));
 				++index;
 			}
+			PublishEvent(batch);
 		}
 	}
 }
@@ -104,7 +104,7 @@ private:
 
 	void* modbus_read_buffer;
 	size_t modbus_read_buffer_size;
-	typedef asio::basic_waitable_timer<std::chrono::steady_clock> Timer_t;
+	typedef odc::steady_timer Timer_t;
 	std::unique_ptr<Timer_t> pTCPRetryTimer;
 	std::unique_ptr<ASIOScheduler> PollScheduler;
 };
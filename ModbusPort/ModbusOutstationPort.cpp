@@ -127,7 +127,7 @@ void ModbusOutstationPort::Build()
 
 		//TODO: collect these on a collection of modbus tcp connections
 		MBSync = std::make_unique<ModbusExecutor>(
-			modbus_new_tcp_pi(pConf->mAddrConf.IP.c_str(), std::to_string(pConf->mAddrConf.Port).c_str()),*pIOS);
+			modbus_new_tcp_pi(pConf->mAddrConf.IP.c_str(), std::to_string(pConf->mAddrConf.Port).c_str()),*pIOS,Name);
 		if (MBSync->isNull())
 		{
 			if(auto log = odc::spdlog_get("ModbusPort"))
@@ -140,7 +140,7 @@ void ModbusOutstationPort::Build()
 	{
 		log_id = "outst_" + pConf->mAddrConf.SerialDevice;
 		MBSync = std::make_unique<ModbusExecutor>(
-			modbus_new_rtu(pConf->mAddrConf.SerialDevice.c_str(),pConf->mAddrConf.BaudRate,(char)pConf->mAddrConf.Parity,pConf->mAddrConf.DataBits,pConf->mAddrConf.StopBits), *pIOS);
+			modbus_new_rtu(pConf->mAddrConf.SerialDevice.c_str(),pConf->mAddrConf.BaudRate,(char)pConf->mAddrConf.Parity,pConf->mAddrConf.DataBits,pConf->mAddrConf.StopBits), *pIOS, Name);
 		if (MBSync->isNull())
 		{
 			if(auto log = odc::spdlog_get("ModbusPort"))
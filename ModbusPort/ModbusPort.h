@@ -37,9 +37,9 @@ using namespace odc;
 class ModbusExecutor
 {
 public:
-	ModbusExecutor(modbus_t* mb_,odc::asio_service& ios):
+	ModbusExecutor(modbus_t* mb_,odc::asio_service& ios,const std::string& owner = ""):
 		mb(mb_),
-		sync(ios.make_strand())
+		sync(ios.make_serial_executor(owner))
 	{}
 	~ModbusExecutor()
 	{
@@ -56,7 +56,7 @@ public:
 	}
 private:
 	modbus_t* mb;
-	std::unique_ptr<asio::io_service::strand> sync;
+	std::unique_ptr<odc::serial_executor> sync;
 };
 
 class ModbusPort: public DataPort
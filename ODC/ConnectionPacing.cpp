@@ -0,0 +1,89 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * ConnectionPacing.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#include <opendatacon/ConnectionPacing.h>
+#include <mutex>
+
+namespace odc
+{
+
+//Never destroyed - connections can be paced during static destruction
+struct ConnectRateLimiter
+{
+	std::mutex mtx;
+	asio_clock::duration interval{0};
+	//how far ahead of schedule a burst can run
+	asio_clock::duration tolerance{0};
+	//when the next connection would be due, if they were all spaced out evenly
+	asio_clock::time_point next_due;
+};
+static ConnectRateLimiter& GetConnectRateLimiter()
+{
+	static auto pLimiter = new ConnectRateLimiter();
+	return *pLimiter;
+}
+
+void SetConnectRateLimit(const double per_second, const size_t burst)
+{
+	auto& limiter = GetConnectRateLimiter();
+	std::lock_guard<std::mutex> lck(limiter.mtx);
+	if(per_second > 0)
+		limiter.interval = std::chrono::duration_cast<asio_clock::duration>(std::chrono::duration<double>(1.0/per_second));
+	else
+		limiter.interval = asio_clock::duration::zero();
+	limiter.tolerance = limiter.interval*(std::max(burst,size_t(1))-1);
+	limiter.next_due = asio_clock::time_point();
+}
+
+void PaceConnect(const std::shared_ptr<asio_service>& pIOS, const std::function<void()>& fn)
+{
+	auto& limiter = GetConnectRateLimiter();
+	auto now = asio_clock::now();
+	asio_clock::time_point start;
+	{
+		std::lock_guard<std::mutex> lck(limiter.mtx);
+		if(limiter.interval == asio_clock::duration::zero())
+			start = now;
+		else
+		{
+			start = std::max(now,limiter.next_due-limiter.tolerance);
+			limiter.next_due = std::max(limiter.next_due,now)+limiter.interval;
+		}
+	}
+	if(start <= now)
+	{
+		pIOS->post(fn);
+		return;
+	}
+	std::shared_ptr<steady_timer> pTimer = pIOS->make_steady_timer();
+	pTimer->expires_at(start);
+	pTimer->async_wait([pTimer,fn](asio::error_code)
+		{
+			fn();
+		});
+}
+
+} //namespace odc
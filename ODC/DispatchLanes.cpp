@@ -0,0 +1,74 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * DispatchLanes.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#include <opendatacon/DispatchLanes.h>
+#include <stdexcept>
+
+namespace odc
+{
+
+DispatchLanes::DispatchLanes(asio_service& ios, const size_t num_lanes, const std::string& owner)
+{
+	if(num_lanes == 0)
+		throw std::invalid_argument("DispatchLanes needs at least one lane");
+	Lanes.reserve(num_lanes);
+	for(size_t i = 0; i < num_lanes; i++)
+		Lanes.emplace_back(new serial_executor(ios,owner));
+}
+
+size_t DispatchLanes::LaneFor(const SourcePortID_t source, const EventType type, const size_t index) const
+{
+	//mix the key so neighbouring indexes spread over the lanes (splitmix64 finaliser)
+	uint64_t key = (uint64_t(source)<<40) ^ (uint64_t(type)<<32) ^ uint64_t(index);
+	key ^= key >> 30;
+	key *= 0xbf58476d1ce4e5b9ULL;
+	key ^= key >> 27;
+	key *= 0x94d049bb133111ebULL;
+	key ^= key >> 31;
+	return key % Lanes.size();
+}
+
+std::vector<DispatchLanes::SubBatch> DispatchLanes::Split(const EventBatch_t& batch) const
+{
+	//index into the result for each lane and priority, or -1 if it's not there yet
+	std::vector<int> slots(Lanes.size()*2,-1);
+	std::vector<SubBatch> split;
+	for(const auto& event : batch)
+	{
+		auto lane = LaneFor(*event);
+		auto priority = IsPriorityEvent(event->GetEventType()) ? HandlerPriority::High : HandlerPriority::Normal;
+		auto& slot = slots[lane*2+(priority == HandlerPriority::High ? 1 : 0)];
+		if(slot == -1)
+		{
+			slot = int(split.size());
+			split.push_back({lane,priority,{}});
+		}
+		split[slot].Events.push_back(event);
+	}
+	return split;
+}
+
+} //namespace odc
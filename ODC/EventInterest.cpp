@@ -0,0 +1,112 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * EventInterest.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#include <opendatacon/EventInterest.h>
+#include <algorithm>
+
+namespace odc
+{
+
+EventInterest::EventInterest():
+	Types(~uint64_t(0)),
+	AllIndexes(~uint64_t(0))
+{}
+
+EventInterest EventInterest::Nothing()
+{
+	EventInterest interest;
+	interest.Types = interest.AllIndexes = TypeBit(EventType::ConnectState);
+	return interest;
+}
+
+void EventInterest::Add(const EventType type)
+{
+	Types |= TypeBit(type);
+	AllIndexes |= TypeBit(type);
+	Ranges.erase(std::remove_if(Ranges.begin(),Ranges.end(),[type](const Range& r){ return r.Type == type; }),Ranges.end());
+}
+
+void EventInterest::Add(const EventType type, const size_t first, const size_t last)
+{
+	if(first > last || (AllIndexes & TypeBit(type)))
+		return;
+	Types |= TypeBit(type);
+
+	//Point configs are usually added in index order, so this is normally an append
+	auto before = [](const Range& a, const Range& b)
+			  {
+				  return a.Type < b.Type || (a.Type == b.Type && a.First < b.First);
+			  };
+	Range range{type,first,last};
+	auto it = Ranges.insert(std::upper_bound(Ranges.begin(),Ranges.end(),range,before),range);
+
+	//merge with the one before if they touch
+	if(it != Ranges.begin())
+	{
+		auto prev = it-1;
+		if(prev->Type == type && (prev->Last == SIZE_MAX || prev->Last+1 >= it->First))
+		{
+			prev->Last = std::max(prev->Last,it->Last);
+			it = Ranges.erase(it)-1;
+		}
+	}
+	//then swallow any that follow
+	auto next = it+1;
+	while(next != Ranges.end() && next->Type == type && (it->Last == SIZE_MAX || it->Last+1 >= next->First))
+	{
+		it->Last = std::max(it->Last,next->Last);
+		next = Ranges.erase(next);
+		it = next-1;
+	}
+}
+
+void EventInterest::Add(const EventInterest& other)
+{
+	for(auto& range : other.Ranges)
+		Add(range.Type,range.First,range.Last);
+	for(uint8_t t = 0; t < static_cast<uint8_t>(EventType::AfterRange); t++)
+		if(other.AllIndexes & TypeBit(static_cast<EventType>(t)))
+			Add(static_cast<EventType>(t));
+	//in case other was built with bits for types beyond AfterRange
+	Types |= other.Types;
+	AllIndexes |= other.AllIndexes;
+}
+
+bool EventInterest::MatchesIndex(const EventType type, const size_t index) const
+{
+	//find the last range that starts at or before the index
+	Range probe{type,index,index};
+	auto it = std::upper_bound(Ranges.begin(),Ranges.end(),probe,[](const Range& a, const Range& b)
+		{
+			return a.Type < b.Type || (a.Type == b.Type && a.First < b.First);
+		});
+	if(it == Ranges.begin())
+		return false;
+	--it;
+	return it->Type == type && index <= it->Last;
+}
+
+} //namespace odc
@@ -0,0 +1,375 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * HandlerMonitor.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#include <opendatacon/HandlerMonitor.h>
+#include <opendatacon/util.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <regex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace odc
+{
+
+static int64_t NowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//What each thread is running right now, for the watchdog to look at
+struct ThreadSlot
+{
+	std::atomic<int64_t> StartNs{0}; //0 means idle
+	std::atomic<HandlerOwner*> pOwner{nullptr};
+	//bumped every time the slot changes hands, so a stall is only reported once
+	std::atomic<uint64_t> Serial{0};
+	//only touched by the watchdog
+	uint64_t ReportedSerial = 0;
+};
+
+//Never destroyed - handlers can run during static destruction, and the watchdog thread
+//	just dies with the process if nobody turned it off
+class HandlerMonitor
+{
+public:
+	HandlerOwner* Owner(const std::string& name)
+	{
+		const auto& key = name.empty() ? Unattributed : name;
+		std::lock_guard<std::mutex> lck(OwnersMtx);
+		auto it = OwnersByName.find(key);
+		if(it != OwnersByName.end())
+			return it->second;
+		auto pOwner = new HandlerOwner(key);
+		OwnersByName[key] = pOwner;
+		Owners.push_back(pOwner);
+		return pOwner;
+	}
+	std::vector<HandlerOwner*> AllOwners()
+	{
+		std::lock_guard<std::mutex> lck(OwnersMtx);
+		return Owners;
+	}
+
+	ThreadSlot* TakeSlot()
+	{
+		std::lock_guard<std::mutex> lck(SlotsMtx);
+		if(!FreeSlots.empty())
+		{
+			auto pSlot = FreeSlots.back();
+			FreeSlots.pop_back();
+			return pSlot;
+		}
+		auto pSlot = new ThreadSlot();
+		Slots.push_back(pSlot);
+		return pSlot;
+	}
+	void ReturnSlot(ThreadSlot* pSlot)
+	{
+		pSlot->StartNs = 0;
+		std::lock_guard<std::mutex> lck(SlotsMtx);
+		FreeSlots.push_back(pSlot);
+	}
+
+	void Enable(const std::chrono::milliseconds& stall_threshold, const std::chrono::milliseconds& scan_period)
+	{
+		StallThresholdNs = std::chrono::duration_cast<std::chrono::nanoseconds>(stall_threshold).count();
+		std::lock_guard<std::mutex> lck(WatchdogMtx);
+		ScanPeriod = scan_period;
+		if(!Watchdog.joinable())
+		{
+			StopWatchdog = false;
+			Watchdog = std::thread([this](){ WatchdogLoop(); });
+		}
+		Enabled = true;
+	}
+	void Disable()
+	{
+		Enabled = false;
+		std::thread watchdog;
+		{
+			std::lock_guard<std::mutex> lck(WatchdogMtx);
+			StopWatchdog = true;
+			std::swap(watchdog,Watchdog);
+		}
+		WatchdogCV.notify_all();
+		if(watchdog.joinable())
+			watchdog.join();
+	}
+
+	std::atomic<bool> Enabled{false};
+	std::atomic<int64_t> StallThresholdNs{0};
+	//fair share is off unless it's configured
+	std::atomic<int64_t> FairShareQuantumNs{0};
+
+private:
+	void WatchdogLoop()
+	{
+		std::unique_lock<std::mutex> lck(WatchdogMtx);
+		while(!StopWatchdog)
+		{
+			WatchdogCV.wait_for(lck,ScanPeriod);
+			if(StopWatchdog)
+				break;
+			lck.unlock();
+			Scan();
+			lck.lock();
+		}
+	}
+	void Scan()
+	{
+		const auto now = NowNs();
+		const auto threshold = StallThresholdNs.load();
+		std::lock_guard<std::mutex> lck(SlotsMtx);
+		for(auto pSlot : Slots)
+		{
+			auto start = pSlot->StartNs.load();
+			auto serial = pSlot->Serial.load();
+			if(start == 0 || now - start <= threshold || serial == pSlot->ReportedSerial)
+				continue;
+			pSlot->ReportedSerial = serial;
+			auto pOwner = pSlot->pOwner.load();
+			if(!pOwner)
+				continue;
+			pOwner->Stalls++;
+			if(auto log = odc::spdlog_get("opendatacon"))
+				log->warn("Handler for '{}' has been running for {}ms - stalled?", pOwner->Name, (now-start)/1000000);
+		}
+	}
+
+	const std::string Unattributed = "unattributed";
+	std::mutex OwnersMtx;
+	std::unordered_map<std::string,HandlerOwner*> OwnersByName;
+	std::vector<HandlerOwner*> Owners;
+
+	std::mutex SlotsMtx;
+	std::vector<ThreadSlot*> Slots;
+	std::vector<ThreadSlot*> FreeSlots;
+
+	std::mutex WatchdogMtx;
+	std::condition_variable WatchdogCV;
+	std::chrono::milliseconds ScanPeriod{100};
+	bool StopWatchdog = false;
+	std::thread Watchdog;
+};
+
+static HandlerMonitor& GetHandlerMonitor()
+{
+	static auto pMonitor = new HandlerMonitor();
+	return *pMonitor;
+}
+
+//Each thread gets a slot the first time it runs a monitored handler, and gives it back when it exits
+struct LocalSlot
+{
+	LocalSlot():
+		pSlot(GetHandlerMonitor().TakeSlot())
+	{}
+	~LocalSlot()
+	{
+		GetHandlerMonitor().ReturnSlot(pSlot);
+	}
+	ThreadSlot* const pSlot;
+};
+static ThreadSlot& GetLocalSlot()
+{
+	thread_local LocalSlot local;
+	return *local.pSlot;
+}
+
+HandlerOwner* GetHandlerOwner(const std::string& name)
+{
+	return GetHandlerMonitor().Owner(name);
+}
+
+HandlerOwner* CurrentHandlerOwner()
+{
+	static auto pUnattributed = GetHandlerOwner("");
+	if(!HandlerMonitorEnabled())
+		return pUnattributed;
+	auto pOwner = GetLocalSlot().pOwner.load(std::memory_order_relaxed);
+	return pOwner ? pOwner : pUnattributed;
+}
+
+void RunMonitored(HandlerOwner* pOwner, void (*fn)(void*), void* ctx)
+{
+	if(!HandlerMonitorEnabled() || pOwner == GetLocalSlot().pOwner.load(std::memory_order_relaxed))
+	{
+		fn(ctx);
+		return;
+	}
+	HandlerScope scope(pOwner);
+	fn(ctx);
+}
+
+void EnableHandlerMonitor(const std::chrono::milliseconds& stall_threshold, const std::chrono::milliseconds& scan_period)
+{
+	GetHandlerMonitor().Enable(stall_threshold,scan_period);
+}
+
+void DisableHandlerMonitor()
+{
+	GetHandlerMonitor().Disable();
+}
+
+bool HandlerMonitorEnabled()
+{
+	return GetHandlerMonitor().Enabled.load(std::memory_order_relaxed);
+}
+
+bool QueueDepthTracked()
+{
+	auto& monitor = GetHandlerMonitor();
+	return monitor.Enabled.load(std::memory_order_relaxed) || monitor.FairShareQuantumNs.load(std::memory_order_relaxed) > 0;
+}
+
+void SetFairShareQuantum(const std::chrono::microseconds& quantum)
+{
+	GetHandlerMonitor().FairShareQuantumNs = std::chrono::duration_cast<std::chrono::nanoseconds>(quantum).count();
+}
+
+std::chrono::nanoseconds GetFairShareQuantum()
+{
+	return std::chrono::nanoseconds(GetHandlerMonitor().FairShareQuantumNs.load(std::memory_order_relaxed));
+}
+
+void SetHandlerWeight(const std::string& name, const uint32_t weight)
+{
+	GetHandlerOwner(name)->Weight = std::max(weight,1u);
+}
+
+Json::Value GetHandlerStats(const HandlerOwner& owner)
+{
+	Json::Value owner_stats;
+	uint64_t count = owner.Count;
+	owner_stats["Count"] = Json::UInt64(count);
+	owner_stats["TotalMs"] = double(owner.TotalNs)/1e6;
+	owner_stats["MeanUs"] = count ? double(owner.TotalNs)/count/1e3 : 0.0;
+	owner_stats["MaxUs"] = double(owner.MaxNs)/1e3;
+	owner_stats["Slow"] = Json::UInt64(owner.Slow);
+	owner_stats["Stalls"] = Json::UInt64(owner.Stalls);
+	owner_stats["Weight"] = Json::UInt(owner.Weight);
+	owner_stats["QueueDepth"] = Json::Int64(owner.QueueDepth);
+	owner_stats["MaxQueueDepth"] = Json::Int64(owner.MaxQueueDepth);
+	owner_stats["Throttled"] = Json::UInt64(owner.Throttled);
+	auto& histogram = owner_stats["Histogram"];
+	histogram = Json::Value(Json::objectValue);
+	for(size_t i = 0; i < HandlerOwner::NumBuckets; i++)
+	{
+		uint64_t n = owner.Histogram[i];
+		if(n == 0)
+			continue;
+		auto label = (i == HandlerOwner::NumBuckets-1)
+		             ? ">="+std::to_string(uint64_t(1)<<(i-1))+"us"
+			     : "<"+std::to_string(uint64_t(1)<<i)+"us";
+		histogram[label] = Json::UInt64(n);
+	}
+	return owner_stats;
+}
+
+Json::Value GetHandlerStats(const std::string& owner_regex)
+{
+	Json::Value stats(Json::objectValue);
+	std::regex reg;
+	if(!owner_regex.empty())
+		reg = std::regex(owner_regex);
+
+	for(auto pOwner : GetHandlerMonitor().AllOwners())
+	{
+		if(!owner_regex.empty() && !std::regex_match(pOwner->Name,reg))
+			continue;
+		if(pOwner->Count == 0 && pOwner->Stalls == 0 && pOwner->MaxQueueDepth == 0)
+			continue;
+		stats[pOwner->Name] = GetHandlerStats(*pOwner);
+	}
+	return stats;
+}
+
+void ResetHandlerStats()
+{
+	for(auto pOwner : GetHandlerMonitor().AllOwners())
+	{
+		pOwner->Count = 0;
+		pOwner->TotalNs = 0;
+		pOwner->MaxNs = 0;
+		pOwner->Slow = 0;
+		pOwner->Stalls = 0;
+		pOwner->MaxQueueDepth = pOwner->QueueDepth.load();
+		pOwner->Throttled = 0;
+		for(auto& bucket : pOwner->Histogram)
+			bucket = 0;
+	}
+}
+
+HandlerScope::HandlerScope(HandlerOwner* apOwner):
+	pOwner(apOwner),
+	Active(HandlerMonitorEnabled())
+{
+	if(!Active)
+		return;
+	Start = std::chrono::steady_clock::now();
+	auto& slot = GetLocalSlot();
+	OuterStartNs = slot.StartNs.load(std::memory_order_relaxed);
+	pOuterOwner = slot.pOwner.load(std::memory_order_relaxed);
+	slot.pOwner = pOwner;
+	slot.Serial++;
+	slot.StartNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Start.time_since_epoch()).count();
+}
+
+HandlerScope::~HandlerScope()
+{
+	if(!Active)
+		return;
+	const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-Start).count();
+
+	auto& slot = GetLocalSlot();
+	slot.StartNs = OuterStartNs;
+	slot.pOwner = pOuterOwner;
+	slot.Serial++;
+
+	if(!pOwner)
+		return;
+	pOwner->Count.fetch_add(1,std::memory_order_relaxed);
+	pOwner->TotalNs.fetch_add(ns,std::memory_order_relaxed);
+	auto max = pOwner->MaxNs.load(std::memory_order_relaxed);
+	while(ns > max && !pOwner->MaxNs.compare_exchange_weak(max,ns,std::memory_order_relaxed))
+	{}
+	size_t bucket = 0;
+	for(auto us = ns/1000; us > 0 && bucket < HandlerOwner::NumBuckets-1; us >>= 1)
+		bucket++;
+	pOwner->Histogram[bucket].fetch_add(1,std::memory_order_relaxed);
+
+	if(int64_t(ns) > GetHandlerMonitor().StallThresholdNs.load(std::memory_order_relaxed))
+	{
+		pOwner->Slow.fetch_add(1,std::memory_order_relaxed);
+		if(auto log = odc::spdlog_get("opendatacon"))
+			log->warn("Handler for '{}' took {}ms", pOwner->Name, ns/1000000);
+	}
+}
+
+} //namespace odc
@@ -25,6 +25,9 @@
  */
 
 #include <opendatacon/IOHandler.h>
+#include <opendatacon/HandlerMonitor.h>
+#include <algorithm>
+#include <condition_variable>
 
 namespace odc
 {
@@ -41,14 +44,110 @@ IOHandler::IOHandler(const std::string& aName):
 	EnableDelayms(0),
 	Name(aName),
 	pIOS(nullptr),
-	enabled(false)
+	enabled(false),
+	pHandlerOwner(GetHandlerOwner(aName))
 {
 	IOHandlers[Name]=this;
 }
 
-void IOHandler::Subscribe(IOHandler* pIOHandler, std::string aName)
+void IOHandler::Subscribe(IOHandler* pIOHandler, std::string aName, EventInterest Interest)
 {
-	this->Subscribers[aName] = pIOHandler;
+	this->Subscribers[aName] = Subscriber{pIOHandler,std::move(Interest)};
+}
+
+void IOHandler::PublishEvent(const EventBatch_t& batch, SharedStatusCallback_t pStatusCallback)
+{
+	if(!pStatusCallback)
+		pStatusCallback = NoOpStatusCallback();
+	if(batch.empty())
+	{
+		(*pStatusCallback)(CommandStatus::SUCCESS);
+		return;
+	}
+	//Controls and command status go first, so subscribers don't get to them after a pile of telemetry
+	//	(the order within each lane stays the same)
+	auto is_priority = [](const std::shared_ptr<const EventInfo>& event){ return IsPriorityEvent(event->GetEventType()); };
+	auto first_normal = std::find_if_not(batch.begin(),batch.end(),is_priority);
+	if(first_normal != batch.end() && std::any_of(first_normal+1,batch.end(),is_priority))
+	{
+		EventBatch_t reordered(batch);
+		std::stable_partition(reordered.begin(),reordered.end(),is_priority);
+		PublishEvent(reordered,pStatusCallback);
+		return;
+	}
+
+	if(pSnapshot)
+		pSnapshot->Update(batch);
+	for(const auto& event : batch)
+	{
+		if(event->GetEventType() == EventType::ConnectState)
+		{
+			for(const auto& IOHandler_pair: Subscribers)
+				IOHandler_pair.second.pIOHandler->Event(event->GetPayload<EventType::ConnectState>(), Name);
+		}
+	}
+
+	if(pDispatchLanes)
+	{
+		auto split = pDispatchLanes->Split(batch);
+		auto lanes_callback = SyncMultiCallback(split.size(),pStatusCallback);
+		for(auto& sub_batch : split)
+		{
+			pDispatchLanes->Post(sub_batch.Lane,[this,events = std::move(sub_batch.Events),lanes_callback]()
+				{
+					DeliverBatch(events,lanes_callback);
+				},sub_batch.Priority);
+		}
+		return;
+	}
+	DeliverBatch(batch,pStatusCallback);
+}
+
+void IOHandler::DeliverBatch(const EventBatch_t& batch, const SharedStatusCallback_t& pStatusCallback)
+{
+
+	//Work out what each subscriber wants first, so we know how many results to wait for
+	//	subscribers that want everything get the batch as it is
+	struct Delivery
+	{
+		const std::string* pSubscriberName;
+		IOHandler* pIOHandler;
+		EventBatch_t Filtered;
+		bool Everything;
+	};
+	std::vector<Delivery> deliveries;
+	deliveries.reserve(Subscribers.size());
+	for(const auto& IOHandler_pair: Subscribers)
+	{
+		const auto& interest = IOHandler_pair.second.Interest;
+		if(interest.IsEverything())
+		{
+			deliveries.push_back({&IOHandler_pair.first,IOHandler_pair.second.pIOHandler,{},true});
+			continue;
+		}
+		EventBatch_t filtered;
+		for(const auto& event : batch)
+			if(interest.Matches(*event))
+				filtered.push_back(event);
+		if(filtered.size() == batch.size())
+			deliveries.push_back({&IOHandler_pair.first,IOHandler_pair.second.pIOHandler,{},true});
+		else if(!filtered.empty())
+			deliveries.push_back({&IOHandler_pair.first,IOHandler_pair.second.pIOHandler,std::move(filtered),false});
+	}
+	if(deliveries.empty() && !Subscribers.empty())
+	{
+		(*pStatusCallback)(CommandStatus::NOT_SUPPORTED);
+		return;
+	}
+
+	auto multi_callback = SyncMultiCallback(deliveries.size(),pStatusCallback);
+	for(const auto& delivery : deliveries)
+	{
+		const auto& to_send = delivery.Everything ? batch : delivery.Filtered;
+		if(auto log = EventLog().ForLevel(spdlog::level::trace))
+			log->trace("Batch of {} events Event {} => {}", to_send.size(), Name, *delivery.pSubscriberName);
+		delivery.pIOHandler->Event(to_send, Name, multi_callback);
+	}
 }
 
 void IOHandler::SetIOS(std::shared_ptr<odc::asio_service> ios_ptr)
@@ -56,6 +155,23 @@ void IOHandler::SetIOS(std::shared_ptr<odc::asio_service> ios_ptr)
 	pIOS = ios_ptr;
 }
 
+void IOHandler::SetDispatchLanes(std::shared_ptr<odc::asio_service> ios_ptr, const size_t num_lanes)
+{
+	pDispatchLanes.reset();
+	pDispatchIOS.reset();
+	if(num_lanes == 0)
+		return;
+	pDispatchIOS = std::move(ios_ptr);
+	pDispatchLanes = std::make_unique<DispatchLanes>(*pDispatchIOS,num_lanes,Name);
+}
+
+void IOHandler::SetShard(std::shared_ptr<ShardedExecutor> pExecutor, const size_t shard)
+{
+	pIOS = pExecutor->GetShard(shard);
+	pShardExecutor = std::move(pExecutor);
+	Shard = shard;
+}
+
 bool DemandMap::InDemand()
 {
 	std::lock_guard<std::mutex> lck (mtx);
@@ -90,54 +206,113 @@ void IOHandler::Event(ConnectState state, const std::string& SenderName)
 	MuxConnectionEvents(state, SenderName);
 }
 
-SharedStatusCallback_t IOHandler::SyncMultiCallback (const size_t cb_number, SharedStatusCallback_t pStatusCallback)
+void IOHandler::Event(const EventBatch_t& batch, const std::string& SenderName, SharedStatusCallback_t pStatusCallback)
+{
+	if(batch.empty())
+	{
+		(*pStatusCallback)(CommandStatus::SUCCESS);
+		return;
+	}
+	auto multi_callback = SyncMultiCallback(batch.size(),pStatusCallback);
+	for(const auto& event : batch)
+		Event(event, SenderName, multi_callback);
+}
+
+const SharedStatusCallback_t& NoOpStatusCallback()
+{
+	//never destroyed - callbacks can be called after static destruction
+	static auto pNoOp = new SharedStatusCallback_t(std::make_shared<std::function<void (CommandStatus status)>>([] (CommandStatus status){}));
+	return *pNoOp;
+}
+
+struct StatusWaiter::State
+{
+	std::mutex mtx;
+	std::condition_variable cv;
+	bool done = false;
+	CommandStatus status = CommandStatus::UNDEFINED;
+};
+
+StatusWaiter::StatusWaiter():
+	pState(std::make_shared<State>())
 {
-	if(pIOS == nullptr)
+	//the callback holds its own reference, so it can outlive us
+	auto pS = pState;
+	pCallback = std::make_shared<std::function<void (CommandStatus status)>>([pS](CommandStatus status)
+		{
+			{
+				std::lock_guard<std::mutex> lck(pS->mtx);
+				if(pS->done)
+					return;
+				pS->status = status;
+				pS->done = true;
+			}
+			pS->cv.notify_all();
+		});
+}
+
+CommandStatus StatusWaiter::Wait(const std::chrono::milliseconds& timeout)
+{
+	std::unique_lock<std::mutex> lck(pState->mtx);
+	if(!pState->cv.wait_for(lck,timeout,[this](){ return pState->done; }))
+		return CommandStatus::TIMEOUT;
+	return pState->status;
+}
+
+//Combines the results of a number of callbacks into one result
+//	The combined callback lives in the same allocation, so it just needs a plain pointer back to us
+class MultiCallback
+{
+public:
+	MultiCallback(const size_t cb_number, SharedStatusCallback_t pStatusCallback):
+		Callback([this](CommandStatus status){ Result(status); }),
+		pStatusCallback(std::move(pStatusCallback)),
+		Remaining(cb_number),
+		Combined(NoStatus),
+		Fired(false)
+	{}
+
+	std::function<void (CommandStatus status)> Callback;
+
+private:
+	void Result(CommandStatus status)
+	{
+		if(Fired.load(std::memory_order_acquire))
+			return;
+
+		//any disagreement (or an UNDEFINED result) makes the combined result UNDEFINED, straight away
+		if(status == CommandStatus::UNDEFINED)
+			return Fire(CommandStatus::UNDEFINED);
+		auto expected = NoStatus;
+		if(!Combined.compare_exchange_strong(expected,static_cast<uint16_t>(status),std::memory_order_acq_rel)
+		   && expected != static_cast<uint16_t>(status))
+			return Fire(CommandStatus::UNDEFINED);
+
+		//everyone agreed
+		if(Remaining.fetch_sub(1,std::memory_order_acq_rel) == 1)
+			Fire(status);
+	}
+	void Fire(CommandStatus status)
 	{
-		throw std::runtime_error("Uninitialised io_service on enabled IOHandler");
+		if(!Fired.exchange(true,std::memory_order_acq_rel))
+			(*pStatusCallback)(status);
 	}
 
+	static constexpr uint16_t NoStatus = 0xFFFF;
+	const SharedStatusCallback_t pStatusCallback;
+	std::atomic<size_t> Remaining;
+	std::atomic<uint16_t> Combined;
+	std::atomic_bool Fired;
+};
+
+SharedStatusCallback_t IOHandler::SyncMultiCallback (const size_t cb_number, SharedStatusCallback_t pStatusCallback)
+{
 	if(cb_number < 2)
 		return pStatusCallback;
 
-	//We must keep the io_service active for the life of the strand/handler we're about to create
-	std::shared_ptr<asio::io_service::work> work = pIOS->make_work();
-	auto pCombinedStatus = std::make_shared<CommandStatus>(CommandStatus::SUCCESS);
-	auto pExecCount = std::make_shared<size_t>(0);
-	std::shared_ptr<asio::io_service::strand> pCB_sync = pIOS->make_strand();
-	return std::make_shared<std::function<void (CommandStatus status)>>
-		       (pCB_sync->wrap(
-				 [work,
-				  pCB_sync,
-				  pCombinedStatus,
-				  pExecCount,
-				  cb_number,
-				  pStatusCallback](CommandStatus status)
-				 {
-					 if(*pCombinedStatus == CommandStatus::UNDEFINED)
-						 return;
-
-					 if(++(*pExecCount) == 1)
-					 {
-					       *pCombinedStatus = status;
-					       if(*pCombinedStatus == CommandStatus::UNDEFINED)
-					       {
-					             (*pStatusCallback)(*pCombinedStatus);
-					             return;
-						 }
-					 }
-					 else if(status != *pCombinedStatus)
-					 {
-					       *pCombinedStatus = CommandStatus::UNDEFINED;
-					       (*pStatusCallback)(*pCombinedStatus);
-					       return;
-					 }
-
-					 if(*pExecCount >= cb_number)
-					 {
-					       (*pStatusCallback)(*pCombinedStatus);
-					 }
-				 }));
+	auto pMulti = std::make_shared<MultiCallback>(cb_number,std::move(pStatusCallback));
+	//share ownership of the whole object, but point at the callback
+	return SharedStatusCallback_t(pMulti,&pMulti->Callback);
 }
 
 }
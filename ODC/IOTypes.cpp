@@ -0,0 +1,233 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * IOTypes.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#include <opendatacon/IOTypes.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace odc
+{
+
+//Names are never removed, so the references we hand out stay valid for the life of the process
+//The ID -> name table is sized once and never reallocated, so GetSourcePortName doesn't need the lock
+class SourcePortTable
+{
+public:
+	static constexpr size_t MaxSourcePorts = 1<<16;
+
+	SourcePortTable():
+		Names(MaxSourcePorts,nullptr)
+	{
+		//ID 0 is always the empty name
+		Insert("");
+	}
+
+	SourcePortID_t Intern(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		auto it = IDs.find(name);
+		if(it != IDs.end())
+			return it->second;
+		return Insert(name);
+	}
+
+	const std::string& Name(const SourcePortID_t id) const
+	{
+		if(id >= MaxSourcePorts || Names[id] == nullptr)
+			throw std::runtime_error("Invalid odc::SourcePortID_t "+std::to_string(id));
+		return *Names[id];
+	}
+
+private:
+	SourcePortID_t Insert(const std::string& name)
+	{
+		if(Store.size() >= MaxSourcePorts)
+			throw std::runtime_error("Too many distinct odc::EventInfo source names");
+		auto id = static_cast<SourcePortID_t>(Store.size());
+		Store.push_back(name);
+		Names[id] = &Store.back();
+		IDs[name] = id;
+		return id;
+	}
+
+	std::deque<std::string> Store;
+	std::vector<const std::string*> Names;
+	std::unordered_map<std::string,SourcePortID_t> IDs;
+	std::mutex mtx;
+};
+
+static SourcePortTable& GetSourcePortTable()
+{
+	static SourcePortTable table;
+	return table;
+}
+
+SourcePortID_t InternSourcePort(const std::string& name)
+{
+	if(name.empty())
+		return 0;
+
+	//Each thread remembers what it has already looked up, so the shared table (and lock)
+	//	is only hit the first time a thread sees a name
+	thread_local std::unordered_map<std::string,SourcePortID_t> cache;
+	auto it = cache.find(name);
+	if(it != cache.end())
+		return it->second;
+
+	auto id = GetSourcePortTable().Intern(name);
+	cache[name] = id;
+	return id;
+}
+
+const std::string& GetSourcePortName(const SourcePortID_t id)
+{
+	return GetSourcePortTable().Name(id);
+}
+
+//Free blocks are linked through their own storage
+struct FreeBlock
+{
+	FreeBlock* next;
+};
+typedef std::pair<FreeBlock*,size_t> FreeList;
+
+static std::atomic<uint64_t> PoolHeapAllocations(0);
+
+//Where threads leave and collect whole batches of free blocks
+class EventPoolDepot
+{
+public:
+	static constexpr size_t BatchSize = 64;
+
+	EventPoolDepot()
+	{
+		Batches.reserve(1024);
+	}
+	bool Take(FreeList& list)
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		if(Batches.empty())
+			return false;
+		list = Batches.back();
+		Batches.pop_back();
+		return true;
+	}
+	void Give(const FreeList& list)
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		Batches.push_back(list);
+	}
+private:
+	std::vector<FreeList> Batches;
+	std::mutex mtx;
+};
+
+static EventPoolDepot& GetEventPoolDepot()
+{
+	//never destroyed - events can outlive static destruction
+	static auto depot = new EventPoolDepot();
+	return *depot;
+}
+
+//Plain data, so it's still usable after the thread_local destructors have run
+static thread_local FreeList LocalFree = {nullptr,0};
+static thread_local bool LocalFreeRetired = false;
+
+static void GiveBatch()
+{
+	FreeList batch(LocalFree.first,1);
+	auto last = LocalFree.first;
+	while(batch.second < EventPoolDepot::BatchSize && last->next)
+	{
+		last = last->next;
+		batch.second++;
+	}
+	LocalFree.first = last->next;
+	LocalFree.second -= batch.second;
+	last->next = nullptr;
+	GetEventPoolDepot().Give(batch);
+}
+
+//hands whatever a thread has left over to the depot when the thread exits
+struct LocalFreeRetirer
+{
+	~LocalFreeRetirer()
+	{
+		while(LocalFree.first)
+			GiveBatch();
+		LocalFreeRetired = true;
+	}
+};
+static void EnsureRetirer()
+{
+	thread_local LocalFreeRetirer retirer;
+	(void)retirer;
+}
+
+void* EventPoolAllocate(const size_t size)
+{
+	if(size <= EventPoolBlockSize && !LocalFreeRetired && !LocalFree.first)
+	{
+		//a batch from the depot has to go back when this thread exits, same as ones we freed
+		EnsureRetirer();
+		GetEventPoolDepot().Take(LocalFree);
+	}
+	if(size <= EventPoolBlockSize && !LocalFreeRetired && LocalFree.first)
+	{
+		auto block = LocalFree.first;
+		LocalFree.first = block->next;
+		LocalFree.second--;
+		return block;
+	}
+	PoolHeapAllocations.fetch_add(1,std::memory_order_relaxed);
+	return ::operator new(size <= EventPoolBlockSize ? EventPoolBlockSize : size);
+}
+
+void EventPoolFree(void* p, const size_t size)
+{
+	if(size > EventPoolBlockSize || LocalFreeRetired)
+	{
+		::operator delete(p);
+		return;
+	}
+	EnsureRetirer();
+	auto block = static_cast<FreeBlock*>(p);
+	block->next = LocalFree.first;
+	LocalFree.first = block;
+	//keep up to two batches locally, so we don't bounce a batch back and forth with the depot
+	if(++LocalFree.second >= 2*EventPoolDepot::BatchSize)
+		GiveBatch();
+}
+
+uint64_t EventPoolHeapAllocations()
+{
+	return PoolHeapAllocations.load(std::memory_order_relaxed);
+}
+
+} //namespace odc
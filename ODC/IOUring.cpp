@@ -0,0 +1,753 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * IOUring.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#include <opendatacon/IOUring.h>
+#include <mutex>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+
+//multishot recv (and provided buffer rings) came in with the 6.0 kernel headers
+#ifdef IORING_RECV_MULTISHOT
+#define ODC_IO_URING
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+
+namespace odc
+{
+
+#ifdef ODC_IO_URING
+
+namespace
+{
+
+//There's no liburing dependency - these are all there is to the syscall interface
+inline int sys_io_uring_setup(unsigned entries, io_uring_params* p)
+{
+	return int(syscall(__NR_io_uring_setup,entries,p));
+}
+inline int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+	return int(syscall(__NR_io_uring_enter,fd,to_submit,min_complete,flags,nullptr,0));
+}
+inline int sys_io_uring_register(int fd, unsigned opcode, void* arg, unsigned nr_args)
+{
+	return int(syscall(__NR_io_uring_register,fd,opcode,arg,nr_args));
+}
+
+//The ring indexes are shared with the kernel
+template<typename T>
+inline T load_acquire(const T* p)
+{
+	return __atomic_load_n(p,__ATOMIC_ACQUIRE);
+}
+template<typename T>
+inline void store_release(T* p, const T v)
+{
+	__atomic_store_n(p,v,__ATOMIC_RELEASE);
+}
+
+//The reaper thread never owns a reference to the ring, so the ring is never destroyed (and the reaper joined) on it
+//	anything posted from there only gets hold of the ring if it's still around
+class io_uring_impl: public io_uring_service
+{
+public:
+	io_uring_impl(std::shared_ptr<asio_service> pIOS):
+		pIOS(pIOS)
+	{}
+	~io_uring_impl() override
+	{
+		if(reaper.joinable())
+		{
+			//nobody's left to hand completions to - cancel whatever's still going, and wait for the kernel to finish with it
+			{
+				std::lock_guard<std::mutex> lck(buf_mtx);
+				closing = true;
+				for(auto pOp : starved)
+					FinishOp(pOp);
+				starved.clear();
+			}
+			std::unique_lock<std::mutex> lck(files_mtx);
+			while(live_ops > 0)
+			{
+				lck.unlock();
+				io_uring_sqe sqe;
+				std::memset(&sqe,0,sizeof(sqe));
+				sqe.opcode = IORING_OP_ASYNC_CANCEL;
+				sqe.cancel_flags = IORING_ASYNC_CANCEL_ANY;
+				Push(sqe);
+				Flush();
+				lck.lock();
+				//anything that was re-armed in the meantime gets cancelled next time round
+				ops_cv.wait_for(lck,std::chrono::milliseconds(100),[this](){ return live_ops == 0; });
+			}
+			lck.unlock();
+
+			//then wake the reaper up to see it's time to go
+			exiting = true;
+			io_uring_sqe sqe;
+			std::memset(&sqe,0,sizeof(sqe));
+			sqe.opcode = IORING_OP_NOP;
+			Push(sqe);
+			Flush();
+			reaper.join();
+		}
+		if(pBufRing)
+			munmap(pBufRing,buf_ring_size);
+		if(pPool)
+			munmap(pPool,pool_size);
+		if(sqes)
+			munmap(sqes,sqes_size);
+		if(cq_ptr && cq_ptr != sq_ptr)
+			munmap(cq_ptr,cq_size);
+		if(sq_ptr)
+			munmap(sq_ptr,sq_size);
+		if(ring_fd >= 0)
+			close(ring_fd);
+	}
+
+	//false if the kernel can't do it
+	bool Setup(const std::shared_ptr<io_uring_impl>& self, const unsigned int entries, const unsigned int buffers, const unsigned int buf_size, unsigned int files)
+	{
+		weak_self = self;
+
+		io_uring_params params;
+		std::memset(&params,0,sizeof(params));
+		//plenty of room for completions, because every socket can have a multishot read going
+		params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+		params.cq_entries = entries*4;
+		ring_fd = sys_io_uring_setup(entries,&params);
+		if(ring_fd < 0)
+			return false;
+
+		//multishot recv came in with 6.0, and there's no op or feature flag that says so
+		utsname uts;
+		unsigned major = 0, minor = 0;
+		if(uname(&uts) != 0 || sscanf(uts.release,"%u.%u",&major,&minor) != 2 || major < 6)
+			return false;
+
+		//probe for the ops we need
+		std::vector<char> probe_mem(sizeof(io_uring_probe)+256*sizeof(io_uring_probe_op),0);
+		auto probe = reinterpret_cast<io_uring_probe*>(probe_mem.data());
+		if(sys_io_uring_register(ring_fd,IORING_REGISTER_PROBE,probe,256) < 0)
+			return false;
+		for(auto op : {IORING_OP_NOP,IORING_OP_RECV,IORING_OP_SENDMSG,IORING_OP_ASYNC_CANCEL})
+			if(op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+				return false;
+
+		//an empty table for the sockets - the kernel won't take more than the open file limit
+		rlimit fd_limit;
+		if(getrlimit(RLIMIT_NOFILE,&fd_limit) == 0 && fd_limit.rlim_cur < files)
+			files = unsigned(fd_limit.rlim_cur);
+		if(files == 0)
+			return false;
+		std::vector<int> table(files,-1);
+		if(sys_io_uring_register(ring_fd,IORING_REGISTER_FILES,table.data(),files) < 0)
+			return false;
+		slots.resize(files);
+		//lowest first
+		for(unsigned slot = files; slot-- > 0;)
+			free_slots.push_back(int(slot));
+
+		sq_entries = params.sq_entries;
+		sq_size = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+		cq_size = params.cq_off.cqes + params.cq_entries*sizeof(io_uring_cqe);
+		if(params.features & IORING_FEAT_SINGLE_MMAP)
+			sq_size = cq_size = std::max(sq_size,cq_size);
+		sq_ptr = Map(sq_size,IORING_OFF_SQ_RING);
+		if(!sq_ptr)
+			return false;
+		cq_ptr = (params.features & IORING_FEAT_SINGLE_MMAP) ? sq_ptr : Map(cq_size,IORING_OFF_CQ_RING);
+		if(!cq_ptr)
+			return false;
+		sqes_size = params.sq_entries*sizeof(io_uring_sqe);
+		sqes = static_cast<io_uring_sqe*>(Map(sqes_size,IORING_OFF_SQES));
+		if(!sqes)
+			return false;
+		auto sq = static_cast<char*>(sq_ptr);
+		sq_head = reinterpret_cast<unsigned*>(sq+params.sq_off.head);
+		sq_tail = reinterpret_cast<unsigned*>(sq+params.sq_off.tail);
+		sq_mask = *reinterpret_cast<unsigned*>(sq+params.sq_off.ring_mask);
+		sq_array = reinterpret_cast<unsigned*>(sq+params.sq_off.array);
+		auto cq = static_cast<char*>(cq_ptr);
+		cq_head = reinterpret_cast<unsigned*>(cq+params.cq_off.head);
+		cq_tail = reinterpret_cast<unsigned*>(cq+params.cq_off.tail);
+		cq_mask = *reinterpret_cast<unsigned*>(cq+params.cq_off.ring_mask);
+		cqes = reinterpret_cast<io_uring_cqe*>(cq+params.cq_off.cqes);
+
+		//the read buffer pool - the kernel picks a buffer from the ring for each read
+		//	the ring size has to be a power of two
+		num_buffers = 1;
+		while(num_buffers*2 <= buffers && num_buffers*2 <= 32768)
+			num_buffers *= 2;
+		buffer_size = buf_size;
+		pool_size = size_t(num_buffers)*buffer_size;
+		pPool = static_cast<char*>(Map(pool_size,-1));
+		buf_ring_size = num_buffers*sizeof(io_uring_buf);
+		pBufRing = static_cast<io_uring_buf*>(Map(buf_ring_size,-1));
+		if(!pPool || !pBufRing)
+			return false;
+		io_uring_buf_reg reg;
+		std::memset(&reg,0,sizeof(reg));
+		reg.ring_addr = reinterpret_cast<uint64_t>(pBufRing);
+		reg.ring_entries = num_buffers;
+		reg.bgid = buffer_group;
+		if(sys_io_uring_register(ring_fd,IORING_REGISTER_PBUF_RING,&reg,1) < 0)
+			return false;
+		for(unsigned bid = 0; bid < num_buffers; bid++)
+			ProvideBuffer(bid);
+
+		reaper = std::thread([this](){ Reap(); });
+		return true;
+	}
+
+	file_t Register(const int fd) override
+	{
+		std::lock_guard<std::mutex> lck(files_mtx);
+		file_t file;
+		if(free_slots.empty() || UpdateFile(free_slots.back(),fd) != 1)
+			return file;
+		file.slot = free_slots.back();
+		free_slots.pop_back();
+		slots[file.slot].registered = true;
+		file.generation = slots[file.slot].generation;
+		return file;
+	}
+	void Unregister(const file_t& file) override
+	{
+		std::lock_guard<std::mutex> lck(files_mtx);
+		if(!Current(file))
+			return;
+		auto& slot = slots[file.slot];
+		slot.registered = false;
+		slot.generation++;
+		//the kernel hangs on to the socket until the ops already going on it are done
+		//	but the slot can't go to another socket until we've seen them finish
+		UpdateFile(file.slot,-1);
+		if(slot.ops == 0)
+			free_slots.push_back(file.slot);
+	}
+
+	void recv(const file_t& file, serial_executor& executor, const recv_handler_t& handler) override
+	{
+		if(!StartOp(file))
+		{
+			executor.post([handler](){ handler(asio::error::bad_descriptor,nullptr,0); });
+			return;
+		}
+		auto pOp = new Op(Op::Type::Recv,file.slot,executor);
+		pOp->pRecvHandler = std::make_shared<recv_handler_t>(handler);
+		Arm(pOp);
+		ScheduleFlush();
+	}
+	void send(const file_t& file, const std::vector<asio::const_buffer>& bufs, serial_executor& executor, const send_handler_t& handler) override
+	{
+		if(!StartOp(file))
+		{
+			executor.post([handler](){ handler(asio::error::bad_descriptor,0); });
+			return;
+		}
+		auto pOp = new Op(Op::Type::Send,file.slot,executor);
+		pOp->SendHandler = handler;
+		pOp->iov.reserve(bufs.size());
+		for(auto& buf : bufs)
+		{
+			auto len = asio::buffer_size(buf);
+			if(len == 0)
+				continue;
+			pOp->iov.push_back({const_cast<void*>(static_cast<const void*>(asio::buffer_cast<const char*>(buf))),len});
+			pOp->total += len;
+		}
+		if(pOp->total == 0)
+		{
+			auto SendHandler = std::move(pOp->SendHandler);
+			executor.post([SendHandler](){ SendHandler(asio::error_code(),0); });
+			FinishOp(pOp);
+			return;
+		}
+		SubmitSend(pOp);
+		ScheduleFlush();
+	}
+
+	size_t SubmitCalls() const override
+	{
+		return submit_calls;
+	}
+	size_t Submitted() const override
+	{
+		return submitted;
+	}
+
+private:
+	struct Op
+	{
+		enum class Type { Recv, Send };
+		Op(const Type type, const int slot, serial_executor& executor):
+			type(type),
+			slot(slot),
+			executor(executor)
+		{
+			std::memset(&msg,0,sizeof(msg));
+		}
+		const Type type;
+		//in the file table
+		const int slot;
+		//copies share the same queue
+		serial_executor executor;
+		//shared with the handlers that are posted, because the op can finish before they run
+		std::shared_ptr<recv_handler_t> pRecvHandler;
+		send_handler_t SendHandler;
+		std::vector<iovec> iov;
+		size_t iov_begin = 0;
+		msghdr msg;
+		size_t sent = 0;
+		size_t total = 0;
+	};
+
+	void* Map(const size_t size, const off_t offset)
+	{
+		void* p = offset < 0
+		          ? mmap(nullptr,size,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_POPULATE,-1,0)
+			  : mmap(nullptr,size,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,ring_fd,offset);
+		return p == MAP_FAILED ? nullptr : p;
+	}
+
+	//Point a slot in the file table at fd (or nothing, with -1) - call with files_mtx locked
+	int UpdateFile(const int slot, int fd)
+	{
+		io_uring_files_update update;
+		std::memset(&update,0,sizeof(update));
+		update.offset = unsigned(slot);
+		update.fds = reinterpret_cast<uint64_t>(&fd);
+		return sys_io_uring_register(ring_fd,IORING_REGISTER_FILES_UPDATE,&update,1);
+	}
+	//Whether file is still registered - call with files_mtx locked
+	bool Current(const file_t& file) const
+	{
+		return file && size_t(file.slot) < slots.size()
+		       && slots[file.slot].registered && slots[file.slot].generation == file.generation;
+	}
+	//Count an op on file - false if it's not registered any more
+	bool StartOp(const file_t& file)
+	{
+		std::lock_guard<std::mutex> lck(files_mtx);
+		if(!Current(file))
+			return false;
+		slots[file.slot].ops++;
+		live_ops++;
+		return true;
+	}
+	//The op's done with the kernel - its slot can go to another socket once it's unregistered and nothing else is using it
+	void FinishOp(Op* pOp)
+	{
+		{
+			std::lock_guard<std::mutex> lck(files_mtx);
+			auto& slot = slots[pOp->slot];
+			if(--slot.ops == 0 && !slot.registered)
+				free_slots.push_back(pOp->slot);
+			live_ops--;
+		}
+		ops_cv.notify_all();
+		delete pOp;
+	}
+
+	//Queue a submission - it doesn't go to the kernel until the next Flush()
+	void Push(const io_uring_sqe& sqe)
+	{
+		std::lock_guard<std::mutex> lck(sq_mtx);
+		//only the kernel moves the head, and only when we submit - so if it's full, submit now
+		while(*sq_tail - load_acquire(sq_head) >= sq_entries)
+			Enter();
+		const unsigned tail = *sq_tail;
+		const unsigned idx = tail & sq_mask;
+		sqes[idx] = sqe;
+		sq_array[idx] = idx;
+		store_release(sq_tail,tail+1);
+	}
+	//One flush for however many submissions queue up before it runs
+	void ScheduleFlush()
+	{
+		if(flush_pending.exchange(true))
+			return;
+		auto weak = weak_self;
+		pIOS->post([weak]()
+			{
+				if(auto self = weak.lock())
+					self->Flush();
+			});
+	}
+	void Flush()
+	{
+		flush_pending = false;
+		//what the reaper handed over
+		std::vector<Op*> ops;
+		{
+			std::lock_guard<std::mutex> lck(deferred_mtx);
+			ops.swap(deferred);
+		}
+		for(auto pOp : ops)
+		{
+			if(closing)
+				FinishOp(pOp);
+			else if(pOp->type == Op::Type::Recv)
+				Arm(pOp);
+			else
+				SubmitSend(pOp);
+		}
+		std::lock_guard<std::mutex> lck(sq_mtx);
+		if(*sq_tail != load_acquire(sq_head))
+			Enter();
+	}
+	//submit everything queued - call with sq_mtx locked
+	void Enter()
+	{
+		const unsigned n = *sq_tail - load_acquire(sq_head);
+		int ret;
+		while((ret = sys_io_uring_enter(ring_fd,n,0,0)) < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY))
+			std::this_thread::yield(); //the completion queue's backed up - the reaper will sort it out (it never submits itself)
+		submit_calls++;
+		if(ret > 0)
+			submitted += ret;
+	}
+
+	//The reaper can't submit anything itself - if the queue was full, it'd be waiting on itself to make room
+	//	so re-arms and re-sends go with the next flush instead
+	void Defer(Op* pOp)
+	{
+		{
+			std::lock_guard<std::mutex> lck(deferred_mtx);
+			if(!closing)
+			{
+				deferred.push_back(pOp);
+				pOp = nullptr;
+			}
+		}
+		if(pOp)
+			FinishOp(pOp);
+		else
+			ScheduleFlush();
+	}
+
+	void Arm(Op* pOp)
+	{
+		io_uring_sqe sqe;
+		std::memset(&sqe,0,sizeof(sqe));
+		sqe.opcode = IORING_OP_RECV;
+		sqe.fd = pOp->slot;
+		sqe.ioprio = IORING_RECV_MULTISHOT;
+		sqe.flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+		sqe.buf_group = buffer_group;
+		sqe.user_data = reinterpret_cast<uint64_t>(pOp);
+		Push(sqe);
+	}
+	void SubmitSend(Op* pOp)
+	{
+		pOp->msg.msg_iov = pOp->iov.data()+pOp->iov_begin;
+		pOp->msg.msg_iovlen = pOp->iov.size()-pOp->iov_begin;
+		io_uring_sqe sqe;
+		std::memset(&sqe,0,sizeof(sqe));
+		sqe.opcode = IORING_OP_SENDMSG;
+		sqe.fd = pOp->slot;
+		sqe.flags = IOSQE_FIXED_FILE;
+		sqe.addr = reinterpret_cast<uint64_t>(&pOp->msg);
+		sqe.len = 1;
+		sqe.msg_flags = MSG_NOSIGNAL;
+		sqe.user_data = reinterpret_cast<uint64_t>(pOp);
+		Push(sqe);
+	}
+
+	//put a buffer (back) in the ring for the kernel to use - call with buf_mtx locked (or before the reaper starts)
+	void ProvideBuffer(const unsigned bid)
+	{
+		//the ring's tail overlays the reserved field of the first entry
+		//	(io_uring_buf_ring's flexible array doesn't come out at offset zero in C++, so don't use it)
+		auto tail_ptr = &pBufRing[0].resv;
+		const uint16_t tail = *tail_ptr;
+		auto& buf = pBufRing[tail & (num_buffers-1)];
+		buf.addr = reinterpret_cast<uint64_t>(pPool+size_t(bid)*buffer_size);
+		buf.len = buffer_size;
+		buf.bid = uint16_t(bid);
+		store_release(tail_ptr,uint16_t(tail+1));
+	}
+	void ReturnBuffer(const unsigned bid)
+	{
+		std::vector<Op*> rearm;
+		{
+			std::lock_guard<std::mutex> lck(buf_mtx);
+			ProvideBuffer(bid);
+			buffers_out--;
+			rearm.swap(starved);
+		}
+		for(auto pOp : rearm)
+			Arm(pOp);
+		if(!rearm.empty())
+			ScheduleFlush();
+	}
+
+	void Reap()
+	{
+		while(true)
+		{
+			unsigned head = *cq_head;
+			const unsigned tail = load_acquire(cq_tail);
+			if(head == tail)
+			{
+				if(exiting)
+					return;
+				sys_io_uring_enter(ring_fd,0,1,IORING_ENTER_GETEVENTS);
+				continue;
+			}
+			for(; head != tail; head++)
+			{
+				const io_uring_cqe cqe = cqes[head & cq_mask];
+				if(auto pOp = reinterpret_cast<Op*>(cqe.user_data))
+				{
+					if(pOp->type == Op::Type::Recv)
+						RecvComplete(pOp,cqe);
+					else
+						SendComplete(pOp,cqe);
+				}
+			}
+			store_release(cq_head,head);
+		}
+	}
+	void RecvComplete(Op* pOp, const io_uring_cqe& cqe)
+	{
+		if(cqe.res > 0 && (cqe.flags & IORING_CQE_F_BUFFER) && !closing)
+		{
+			const unsigned bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+			{
+				std::lock_guard<std::mutex> lck(buf_mtx);
+				buffers_out++;
+			}
+			const char* data = pPool+size_t(bid)*buffer_size;
+			const size_t len = size_t(cqe.res);
+			auto weak = weak_self;
+			auto pHandler = pOp->pRecvHandler;
+			pOp->executor.post([weak,pHandler,data,len,bid]()
+				{
+					//the data's in the ring's buffers
+					auto self = weak.lock();
+					if(!self)
+						return;
+					(*pHandler)(asio::error_code(),data,len);
+					self->ReturnBuffer(bid);
+				});
+		}
+		if(cqe.flags & IORING_CQE_F_MORE)
+			return; //still armed
+
+		if(closing)
+		{
+			FinishOp(pOp);
+			return;
+		}
+		if(cqe.res == -ENOBUFS)
+		{
+			//we're waiting on the consumers to give some buffers back
+			std::unique_lock<std::mutex> lck(buf_mtx);
+			if(closing)
+			{
+				lck.unlock();
+				FinishOp(pOp);
+				return;
+			}
+			if(buffers_out >= num_buffers)
+			{
+				starved.push_back(pOp);
+				return;
+			}
+			lck.unlock();
+			Defer(pOp);
+			return;
+		}
+		if(cqe.res > 0)
+		{
+			//the kernel can stop a multishot for its own reasons - just start it again
+			Defer(pOp);
+			return;
+		}
+		asio::error_code err = asio::error::eof;
+		if(cqe.res < 0)
+			err = asio::error_code(-cqe.res,asio::error::get_system_category());
+		auto pHandler = pOp->pRecvHandler;
+		pOp->executor.post([pHandler,err](){ (*pHandler)(err,nullptr,0); });
+		FinishOp(pOp);
+	}
+	void SendComplete(Op* pOp, const io_uring_cqe& cqe)
+	{
+		if(closing)
+		{
+			FinishOp(pOp);
+			return;
+		}
+		asio::error_code err;
+		if(cqe.res < 0)
+			err = asio::error_code(-cqe.res,asio::error::get_system_category());
+		else if(cqe.res == 0)
+			err = asio::error::broken_pipe;
+		else
+		{
+			pOp->sent += size_t(cqe.res);
+			if(pOp->sent < pOp->total)
+			{
+				//a short write - send the rest
+				size_t n = size_t(cqe.res);
+				while(n >= pOp->iov[pOp->iov_begin].iov_len)
+					n -= pOp->iov[pOp->iov_begin++].iov_len;
+				auto& iov = pOp->iov[pOp->iov_begin];
+				iov.iov_base = static_cast<char*>(iov.iov_base)+n;
+				iov.iov_len -= n;
+				Defer(pOp);
+				return;
+			}
+		}
+		auto SendHandler = std::move(pOp->SendHandler);
+		const auto sent = pOp->sent;
+		pOp->executor.post([SendHandler,err,sent](){ SendHandler(err,sent); });
+		FinishOp(pOp);
+	}
+
+	std::shared_ptr<asio_service> pIOS;
+	std::weak_ptr<io_uring_impl> weak_self;
+
+	int ring_fd = -1;
+	void* sq_ptr = nullptr;
+	size_t sq_size = 0;
+	void* cq_ptr = nullptr;
+	size_t cq_size = 0;
+	io_uring_sqe* sqes = nullptr;
+	size_t sqes_size = 0;
+
+	//submission queue - we own the tail, the kernel owns the head
+	std::mutex sq_mtx;
+	unsigned sq_entries = 0;
+	unsigned* sq_head = nullptr;
+	unsigned* sq_tail = nullptr;
+	unsigned sq_mask = 0;
+	unsigned* sq_array = nullptr;
+	std::atomic_bool flush_pending{false};
+	std::atomic<size_t> submit_calls{0};
+	std::atomic<size_t> submitted{0};
+	//ops the reaper wants (re)submitted - see Defer()
+	std::mutex deferred_mtx;
+	std::vector<Op*> deferred;
+
+	//completion queue - only the reaper touches it
+	unsigned* cq_head = nullptr;
+	unsigned* cq_tail = nullptr;
+	unsigned cq_mask = 0;
+	io_uring_cqe* cqes = nullptr;
+	std::thread reaper;
+	std::atomic_bool exiting{false};
+	//being destroyed - finish ops without calling their handlers, and don't start any more
+	std::atomic_bool closing{false};
+
+	//the registered sockets - an op's slot isn't reused until the op's finished
+	struct Slot
+	{
+		bool registered = false;
+		//stale file_ts don't match
+		uint32_t generation = 0;
+		size_t ops = 0;
+	};
+	std::mutex files_mtx;
+	std::vector<Slot> slots;
+	std::vector<int> free_slots;
+	//ops that aren't finished, on any slot
+	size_t live_ops = 0;
+	std::condition_variable ops_cv;
+
+	//the registered read buffers
+	static constexpr uint16_t buffer_group = 0;
+	std::mutex buf_mtx;
+	char* pPool = nullptr;
+	size_t pool_size = 0;
+	io_uring_buf* pBufRing = nullptr;
+	size_t buf_ring_size = 0;
+	unsigned num_buffers = 0;
+	unsigned buffer_size = 0;
+	//how many are with the consumers, and who's waiting for them to come back
+	unsigned buffers_out = 0;
+	std::vector<Op*> starved;
+};
+
+} //namespace
+
+std::shared_ptr<io_uring_service> io_uring_service::Create(std::shared_ptr<asio_service> pIOS,
+	const unsigned int entries, const unsigned int num_buffers, const unsigned int buffer_size, const unsigned int max_files)
+{
+	auto pRing = std::make_shared<io_uring_impl>(pIOS);
+	if(!pRing->Setup(pRing,entries,num_buffers,buffer_size,max_files))
+		return nullptr;
+	return pRing;
+}
+
+#else
+
+std::shared_ptr<io_uring_service> io_uring_service::Create(std::shared_ptr<asio_service>, const unsigned int, const unsigned int, const unsigned int, const unsigned int)
+{
+	return nullptr;
+}
+
+#endif
+
+std::shared_ptr<io_uring_service> io_uring_service::Shared(std::shared_ptr<asio_service> pIOS)
+{
+	static auto pMtx = new std::mutex();
+	static auto pShared = new std::weak_ptr<io_uring_service>();
+	static bool unsupported = false;
+
+	std::lock_guard<std::mutex> lck(*pMtx);
+	if(unsupported)
+		return nullptr;
+	auto pRing = pShared->lock();
+	if(!pRing)
+	{
+		pRing = Create(pIOS);
+		unsupported = !pRing;
+		*pShared = pRing;
+	}
+	return pRing;
+}
+
+} //namespace odc
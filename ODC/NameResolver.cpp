@@ -0,0 +1,234 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * NameResolver.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#include <opendatacon/NameResolver.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace odc
+{
+
+static tcp_endpoints_t SystemLookup(const std::string& host, const std::string& port, asio::error_code& err)
+{
+	//the blocking resolve doesn't need the io_service running - it's just to construct the resolver
+	asio::io_service ios;
+	asio::ip::tcp::resolver resolver(ios);
+	tcp_endpoints_t endpoints;
+	asio::ip::tcp::resolver::iterator it = resolver.resolve(host,port,err), end;
+	for(; !err && it != end; ++it)
+		endpoints.push_back(it->endpoint());
+	return endpoints;
+}
+
+//An IP address and port number don't need looking up
+static bool NumericEndpoint(const std::string& host, const std::string& port, tcp_endpoints_t& endpoints)
+{
+	if(port.empty() || port.size() > 5 || !std::all_of(port.begin(),port.end(),[](char c){ return std::isdigit(static_cast<unsigned char>(c)); }))
+		return false;
+	auto port_num = std::stoul(port);
+	if(port_num > 65535)
+		return false;
+	asio::error_code err;
+	auto address = asio::ip::make_address(host,err);
+	if(err)
+		return false;
+	endpoints.emplace_back(address,static_cast<unsigned short>(port_num));
+	return true;
+}
+
+//Never destroyed - the lookup threads just die with the process
+class Resolver
+{
+public:
+	void Resolve(const std::shared_ptr<asio_service>& pIOS, const std::string& host, const std::string& port, const ResolveHandler_t& handler)
+	{
+		tcp_endpoints_t endpoints;
+		if(NumericEndpoint(host,port,endpoints))
+		{
+			pIOS->post([handler,endpoints](){ handler(asio::error_code(),endpoints); });
+			return;
+		}
+
+		const auto key = std::make_pair(host,port);
+		std::unique_lock<std::mutex> lck(mtx);
+		auto cached = cache.find(key);
+		if(cached != cache.end() && std::chrono::steady_clock::now() - cached->second.fetched < cache_time)
+		{
+			endpoints = cached->second.endpoints;
+			lck.unlock();
+			pIOS->post([handler,endpoints](){ handler(asio::error_code(),endpoints); });
+			return;
+		}
+		auto& waiters = in_progress[key];
+		waiters.push_back({pIOS,handler});
+		//someone's already waiting on it
+		if(waiters.size() > 1)
+			return;
+		queue.push_back(key);
+		if(idle_threads == 0 && threads.size() < max_threads)
+			threads.emplace_back([this](){ LookupThread(); });
+		else
+			cv.notify_one();
+	}
+	void SetCacheTime(const std::chrono::steady_clock::duration& acache_time)
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		cache_time = acache_time;
+	}
+	void ClearCache()
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		cache.clear();
+		generation++;
+	}
+	void SetLookup(const NameLookup_t& alookup)
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		lookup = alookup ? alookup : SystemLookup;
+		cache.clear();
+		generation++;
+	}
+	uint64_t LookupCount()
+	{
+		return lookup_count;
+	}
+
+private:
+	typedef std::pair<std::string,std::string> key_t;
+	struct Waiter
+	{
+		std::shared_ptr<asio_service> pIOS;
+		ResolveHandler_t handler;
+	};
+	struct CacheEntry
+	{
+		tcp_endpoints_t endpoints;
+		std::chrono::steady_clock::time_point fetched;
+	};
+	//enough that one slow server doesn't hold up lookups from the others
+	static constexpr size_t max_threads = 4;
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::map<key_t,CacheEntry> cache;
+	std::map<key_t,std::vector<Waiter>> in_progress;
+	std::deque<key_t> queue;
+	std::vector<std::thread> threads;
+	size_t idle_threads = 0;
+	NameLookup_t lookup = SystemLookup;
+	std::chrono::steady_clock::duration cache_time = std::chrono::seconds(60);
+	//so a lookup that was already going when the cache was cleared doesn't put its answer back in
+	uint64_t generation = 0;
+	std::atomic<uint64_t> lookup_count{0};
+
+	void LookupThread()
+	{
+		std::unique_lock<std::mutex> lck(mtx);
+		while(true)
+		{
+			idle_threads++;
+			cv.wait(lck,[this](){ return !queue.empty(); });
+			idle_threads--;
+			const auto key = queue.front();
+			queue.pop_front();
+			const auto lookup_now = lookup;
+			const auto generation_now = generation;
+			lck.unlock();
+
+			lookup_count++;
+			asio::error_code err;
+			tcp_endpoints_t endpoints;
+			try
+			{
+				endpoints = lookup_now(key.first,key.second,err);
+			}
+			catch(const std::exception&)
+			{
+				err = asio::error::host_not_found;
+			}
+			if(!err && endpoints.empty())
+				err = asio::error::host_not_found;
+
+			lck.lock();
+			auto cached = cache.find(key);
+			if(!err && generation_now == generation)
+				cache[key] = {endpoints,std::chrono::steady_clock::now()};
+			//an old answer is more use than none
+			else if(err && cached != cache.end())
+			{
+				endpoints = cached->second.endpoints;
+				err.clear();
+			}
+			auto waiters = std::move(in_progress[key]);
+			in_progress.erase(key);
+			lck.unlock();
+
+			for(auto& waiter : waiters)
+			{
+				auto handler = std::move(waiter.handler);
+				waiter.pIOS->post([handler,err,endpoints](){ handler(err,endpoints); });
+			}
+			waiters.clear();
+			lck.lock();
+		}
+	}
+};
+
+static Resolver& GetResolver()
+{
+	static auto pResolver = new Resolver();
+	return *pResolver;
+}
+
+void AsyncResolve(const std::shared_ptr<asio_service>& pIOS, const std::string& host, const std::string& port, const ResolveHandler_t& handler)
+{
+	GetResolver().Resolve(pIOS,host,port,handler);
+}
+void SetResolveCacheTime(const std::chrono::steady_clock::duration& cache_time)
+{
+	GetResolver().SetCacheTime(cache_time);
+}
+void ClearResolveCache()
+{
+	GetResolver().ClearCache();
+}
+void SetNameLookup(const NameLookup_t& lookup)
+{
+	GetResolver().SetLookup(lookup);
+}
+uint64_t NameLookupCount()
+{
+	return GetResolver().LookupCount();
+}
+
+} //namespace odc
@@ -0,0 +1,223 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * PointRegistry.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#include <opendatacon/PointRegistry.h>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+namespace odc
+{
+
+//Lookups never lock: everything they read is reached through atomic pointers, and nothing is ever moved or freed
+//	(the table lives for the whole process) so readers can't have anything pulled out from under them
+class PointTable
+{
+public:
+	static constexpr size_t InfoChunkSize = 4096;
+	static constexpr size_t MaxInfoChunks = 4096;
+	static constexpr size_t PortChunkSize = 256;
+	static constexpr size_t MaxPortChunks = 256;
+	static constexpr size_t NumEventTypes = static_cast<size_t>(EventType::AfterRange);
+
+	PointTable():
+		Count(0)
+	{
+		for(auto& chunk : InfoChunks)
+			chunk.store(nullptr,std::memory_order_relaxed);
+		for(auto& chunk : PortChunks)
+			chunk.store(nullptr,std::memory_order_relaxed);
+	}
+
+	PointID_t Register(const SourcePortID_t port, const EventType type, const size_t index)
+	{
+		if(index > MaxRegisteredIndex || static_cast<size_t>(type) >= NumEventTypes)
+			return NoPointID;
+
+		std::lock_guard<std::mutex> lck(mtx);
+		auto existing = Find(port,type,index);
+		if(existing != NoPointID)
+			return existing;
+
+		auto id = Count.load(std::memory_order_relaxed);
+		if(id/InfoChunkSize >= MaxInfoChunks)
+			throw std::runtime_error("Too many odc::PointRegistry points");
+		auto& info_chunk = InfoChunks[id/InfoChunkSize];
+		if(!info_chunk.load(std::memory_order_relaxed))
+			info_chunk.store(new PointInfo[InfoChunkSize],std::memory_order_release);
+		info_chunk.load(std::memory_order_relaxed)[id%InfoChunkSize] = PointInfo{port,type,index};
+
+		GetID(port,type,index).store(id,std::memory_order_release);
+		Count.store(id+1,std::memory_order_release);
+		return id;
+	}
+
+	PointID_t Find(const SourcePortID_t port, const EventType type, const size_t index) const
+	{
+		if(static_cast<size_t>(type) >= NumEventTypes || port >= PortChunkSize*MaxPortChunks || index > MaxRegisteredIndex)
+			return NoPointID;
+		auto pPortChunk = PortChunks[port/PortChunkSize].load(std::memory_order_acquire);
+		if(!pPortChunk)
+			return NoPointID;
+		auto pPort = pPortChunk->Ports[port%PortChunkSize].load(std::memory_order_acquire);
+		if(!pPort)
+			return NoPointID;
+		auto pTop = pPort->ByType[static_cast<size_t>(type)].load(std::memory_order_acquire);
+		if(!pTop)
+			return NoPointID;
+		auto pMid = pTop->Children[RadixDigit(index,2)].load(std::memory_order_acquire);
+		if(!pMid)
+			return NoPointID;
+		auto pLeaf = pMid->Children[RadixDigit(index,1)].load(std::memory_order_acquire);
+		if(!pLeaf)
+			return NoPointID;
+		return pLeaf->IDs[RadixDigit(index,0)].load(std::memory_order_acquire);
+	}
+
+	const PointInfo& Info(const PointID_t id) const
+	{
+		if(id >= Count.load(std::memory_order_acquire))
+			throw std::runtime_error("Invalid odc::PointID_t "+std::to_string(id));
+		return InfoChunks[id/InfoChunkSize].load(std::memory_order_acquire)[id%InfoChunkSize];
+	}
+
+	size_t Size() const
+	{
+		return Count.load(std::memory_order_acquire);
+	}
+
+private:
+	//Each port's indexes of a type map to IDs through a three level radix tree
+	//	only the nodes covering registered indexes are made, so a few scattered (or huge)
+	//	indexes don't cost a flat table sized to the biggest one, and there's never a table to outgrow
+	static constexpr size_t RadixBits = 8;
+	static constexpr size_t RadixSize = size_t(1)<<RadixBits;
+	static_assert((MaxRegisteredIndex>>(3*RadixBits)) == 0, "Radix tree too shallow for MaxRegisteredIndex");
+	static size_t RadixDigit(const size_t index, const size_t level)
+	{
+		return (index>>(level*RadixBits))&(RadixSize-1);
+	}
+	struct Leaf
+	{
+		Leaf()
+		{
+			for(auto& id : IDs)
+				id.store(NoPointID,std::memory_order_relaxed);
+		}
+		std::atomic<PointID_t> IDs[RadixSize];
+	};
+	template<typename Child>
+	struct Node
+	{
+		Node()
+		{
+			for(auto& child : Children)
+				child.store(nullptr,std::memory_order_relaxed);
+		}
+		std::atomic<Child*> Children[RadixSize];
+	};
+	typedef Node<Node<Leaf>> RadixTree;
+	struct PortPoints
+	{
+		PortPoints()
+		{
+			for(auto& tree : ByType)
+				tree.store(nullptr,std::memory_order_relaxed);
+		}
+		std::atomic<RadixTree*> ByType[NumEventTypes];
+	};
+	struct PortChunk
+	{
+		PortChunk()
+		{
+			for(auto& port : Ports)
+				port.store(nullptr,std::memory_order_relaxed);
+		}
+		std::atomic<PortPoints*> Ports[PortChunkSize];
+	};
+
+	//Called with the lock held - only the writer makes things, so there's no race to publish them
+	template<typename T>
+	static T& GetOrMake(std::atomic<T*>& ptr)
+	{
+		auto p = ptr.load(std::memory_order_relaxed);
+		if(!p)
+		{
+			p = new T();
+			ptr.store(p,std::memory_order_release);
+		}
+		return *p;
+	}
+	std::atomic<PointID_t>& GetID(const SourcePortID_t port, const EventType type, const size_t index)
+	{
+		if(port >= PortChunkSize*MaxPortChunks)
+			throw std::runtime_error("Invalid odc::SourcePortID_t "+std::to_string(port));
+		auto& port_points = GetOrMake(PortChunks[port/PortChunkSize]).Ports[port%PortChunkSize];
+		auto& tree = GetOrMake(GetOrMake(port_points).ByType[static_cast<size_t>(type)]);
+		auto& mid = GetOrMake(tree.Children[RadixDigit(index,2)]);
+		auto& leaf = GetOrMake(mid.Children[RadixDigit(index,1)]);
+		return leaf.IDs[RadixDigit(index,0)];
+	}
+
+	std::atomic<PointInfo*> InfoChunks[MaxInfoChunks];
+	std::atomic<PortChunk*> PortChunks[MaxPortChunks];
+	std::atomic<size_t> Count;
+	std::mutex mtx;
+};
+
+static PointTable& GetPointTable()
+{
+	//never destroyed - events can outlive static destruction
+	static auto table = new PointTable();
+	return *table;
+}
+//Set by the first registration, so making events doesn't create the table (or allocate) if nobody registers points
+static std::atomic<PointTable*> pRegisteredTable(nullptr);
+
+PointID_t RegisterPoint(const std::string& port, const EventType type, const size_t index)
+{
+	auto& table = GetPointTable();
+	pRegisteredTable.store(&table,std::memory_order_release);
+	return table.Register(InternSourcePort(port),type,index);
+}
+
+PointID_t FindPoint(const SourcePortID_t port, const EventType type, const size_t index)
+{
+	auto pTable = pRegisteredTable.load(std::memory_order_acquire);
+	return pTable ? pTable->Find(port,type,index) : NoPointID;
+}
+
+const PointInfo& GetPointInfo(const PointID_t id)
+{
+	return GetPointTable().Info(id);
+}
+
+size_t PointCount()
+{
+	return GetPointTable().Size();
+}
+
+} //namespace odc
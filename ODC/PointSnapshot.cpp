@@ -0,0 +1,351 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * PointSnapshot.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#include <opendatacon/PointSnapshot.h>
+#include <cstring>
+
+namespace odc
+{
+
+static const EventType TableTypes[] =
+{
+	EventType::Binary,
+	EventType::DoubleBitBinary,
+	EventType::Analog,
+	EventType::Counter,
+	EventType::FrozenCounter,
+	EventType::BinaryOutputStatus,
+	EventType::AnalogOutputStatus
+};
+
+//Which table an event type goes in, or -1 if we don't keep it
+static int TableOf(const EventType type, bool& quality_only)
+{
+	quality_only = false;
+	switch(type)
+	{
+		case EventType::BinaryQuality:             quality_only = true; //fallthrough
+		case EventType::Binary:                    return 0;
+		case EventType::DoubleBitBinaryQuality:    quality_only = true; //fallthrough
+		case EventType::DoubleBitBinary:           return 1;
+		case EventType::AnalogQuality:             quality_only = true; //fallthrough
+		case EventType::Analog:                    return 2;
+		case EventType::CounterQuality:            quality_only = true; //fallthrough
+		case EventType::Counter:                   return 3;
+		case EventType::FrozenCounterQuality:      quality_only = true; //fallthrough
+		case EventType::FrozenCounter:             return 4;
+		case EventType::BinaryOutputStatusQuality: quality_only = true; //fallthrough
+		case EventType::BinaryOutputStatus:        return 5;
+		case EventType::AnalogOutputStatusQuality: quality_only = true; //fallthrough
+		case EventType::AnalogOutputStatus:        return 6;
+		default:                                   return -1;
+	}
+}
+
+static uint64_t DoubleBits(const double d)
+{
+	uint64_t bits;
+	std::memcpy(&bits,&d,sizeof(bits));
+	return bits;
+}
+static double BitsDouble(const uint64_t bits)
+{
+	double d;
+	std::memcpy(&d,&bits,sizeof(d));
+	return d;
+}
+
+//Pack the payload into 64 bits
+static uint64_t EncodeValue(const EventInfo& event)
+{
+	switch(event.GetEventType())
+	{
+		case EventType::Binary:
+			return event.GetPayload<EventType::Binary>();
+		case EventType::DoubleBitBinary:
+		{
+			auto& dbb = event.GetPayload<EventType::DoubleBitBinary>();
+			return (uint64_t(dbb.first)<<1) | uint64_t(dbb.second);
+		}
+		case EventType::Analog:
+			return DoubleBits(event.GetPayload<EventType::Analog>());
+		case EventType::Counter:
+			return event.GetPayload<EventType::Counter>();
+		case EventType::FrozenCounter:
+			return event.GetPayload<EventType::FrozenCounter>();
+		case EventType::BinaryOutputStatus:
+			return event.GetPayload<EventType::BinaryOutputStatus>();
+		case EventType::AnalogOutputStatus:
+			return DoubleBits(event.GetPayload<EventType::AnalogOutputStatus>());
+		default:
+			return 0;
+	}
+}
+
+static void DecodeValue(EventInfo& event, const uint64_t value)
+{
+	switch(event.GetEventType())
+	{
+		case EventType::Binary:
+			event.SetPayload<EventType::Binary>(value != 0);
+			break;
+		case EventType::DoubleBitBinary:
+			event.SetPayload<EventType::DoubleBitBinary>(DBB((value>>1) & 1, value & 1));
+			break;
+		case EventType::Analog:
+			event.SetPayload<EventType::Analog>(BitsDouble(value));
+			break;
+		case EventType::Counter:
+			event.SetPayload<EventType::Counter>(static_cast<uint32_t>(value));
+			break;
+		case EventType::FrozenCounter:
+			event.SetPayload<EventType::FrozenCounter>(static_cast<uint32_t>(value));
+			break;
+		case EventType::BinaryOutputStatus:
+			event.SetPayload<EventType::BinaryOutputStatus>(value != 0);
+			break;
+		case EventType::AnalogOutputStatus:
+			event.SetPayload<EventType::AnalogOutputStatus>(BitsDouble(value));
+			break;
+		default:
+			break;
+	}
+}
+
+PointSnapshot::PointSnapshot()
+{
+	for(auto& table : Tables)
+		table.store(nullptr,std::memory_order_relaxed);
+}
+
+PointSnapshot::~PointSnapshot()
+{
+	for(auto& table : Tables)
+	{
+		auto pTable = table.load(std::memory_order_acquire);
+		if(!pTable)
+			continue;
+		for(auto& chunk : pTable->Chunks)
+			delete chunk.load(std::memory_order_acquire);
+		delete pTable;
+	}
+}
+
+bool PointSnapshot::Stores(const EventType type)
+{
+	bool quality_only;
+	return TableOf(type,quality_only) >= 0;
+}
+
+PointSnapshot::Slot* PointSnapshot::GetSlot(const size_t table, const size_t index, const bool create)
+{
+	if(index > MaxIndex)
+		return nullptr;
+
+	auto pTable = Tables[table].load(std::memory_order_acquire);
+	if(!pTable)
+	{
+		if(!create)
+			return nullptr;
+		//value initialised, so all the chunk pointers start null
+		auto pNew = new Table();
+		if(Tables[table].compare_exchange_strong(pTable,pNew,std::memory_order_acq_rel,std::memory_order_acquire))
+			pTable = pNew;
+		else
+			delete pNew;
+	}
+
+	auto& chunk = pTable->Chunks[index/ChunkSize];
+	auto pChunk = chunk.load(std::memory_order_acquire);
+	if(!pChunk)
+	{
+		if(!create)
+			return nullptr;
+		auto pNew = new Chunk();
+		if(chunk.compare_exchange_strong(pChunk,pNew,std::memory_order_acq_rel,std::memory_order_acquire))
+			pChunk = pNew;
+		else
+			delete pNew;
+	}
+	return &pChunk->Slots[index%ChunkSize];
+}
+
+const PointSnapshot::Slot* PointSnapshot::GetSlot(const size_t table, const size_t index) const
+{
+	return const_cast<PointSnapshot*>(this)->GetSlot(table,index,false);
+}
+
+void PointSnapshot::Update(const EventInfo& event)
+{
+	bool quality_only;
+	auto table = TableOf(event.GetEventType(),quality_only);
+	if(table < 0 || !event.IsPayloadSet())
+		return;
+
+	//a quality event for a point we don't know yet doesn't tell us anything worth keeping
+	auto pSlot = GetSlot(table,event.GetIndex(),!quality_only);
+	if(!pSlot)
+		return;
+	auto& slot = *pSlot;
+
+	//There can be more than one publisher, so writers take turns by making the sequence odd
+	auto seq = slot.Seq.load(std::memory_order_relaxed);
+	do
+	{
+		while(seq & 1)
+			seq = slot.Seq.load(std::memory_order_relaxed);
+	} while(!slot.Seq.compare_exchange_weak(seq,seq+1,std::memory_order_acquire,std::memory_order_relaxed));
+	std::atomic_thread_fence(std::memory_order_release);
+
+	if(quality_only)
+	{
+		if(seq == 0)
+		{
+			slot.Seq.store(0,std::memory_order_release);
+			return;
+		}
+		QualityFlags quality;
+		switch(event.GetEventType())
+		{
+			case EventType::BinaryQuality:             quality = event.GetPayload<EventType::BinaryQuality>(); break;
+			case EventType::DoubleBitBinaryQuality:    quality = event.GetPayload<EventType::DoubleBitBinaryQuality>(); break;
+			case EventType::AnalogQuality:             quality = event.GetPayload<EventType::AnalogQuality>(); break;
+			case EventType::CounterQuality:            quality = event.GetPayload<EventType::CounterQuality>(); break;
+			case EventType::FrozenCounterQuality:      quality = event.GetPayload<EventType::FrozenCounterQuality>(); break;
+			case EventType::BinaryOutputStatusQuality: quality = event.GetPayload<EventType::BinaryOutputStatusQuality>(); break;
+			default:                                   quality = event.GetPayload<EventType::AnalogOutputStatusQuality>(); break;
+		}
+		slot.Quality.store(static_cast<uint32_t>(quality),std::memory_order_relaxed);
+	}
+	else
+	{
+		slot.Value.store(EncodeValue(event),std::memory_order_relaxed);
+		slot.Quality.store(static_cast<uint32_t>(event.GetQuality()),std::memory_order_relaxed);
+		slot.SourcePort.store(event.GetSourcePortID(),std::memory_order_relaxed);
+	}
+	slot.Timestamp.store(event.GetTimestamp(),std::memory_order_relaxed);
+
+	//zero means never written, so skip it if we wrap
+	auto next = seq+2;
+	slot.Seq.store(next ? next : 2,std::memory_order_release);
+}
+
+std::shared_ptr<EventInfo> PointSnapshot::Read(const size_t table, const Slot& slot, const size_t index) const
+{
+	uint32_t seq, quality, source;
+	uint64_t value, timestamp;
+	for(;;)
+	{
+		seq = slot.Seq.load(std::memory_order_acquire);
+		if(seq == 0)
+			return nullptr;
+		if(seq & 1)
+			continue;
+		quality = slot.Quality.load(std::memory_order_relaxed);
+		value = slot.Value.load(std::memory_order_relaxed);
+		timestamp = slot.Timestamp.load(std::memory_order_relaxed);
+		source = slot.SourcePort.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(slot.Seq.load(std::memory_order_relaxed) == seq)
+			break;
+	}
+
+	auto event = MakeEvent(TableTypes[table],index,GetSourcePortName(source),static_cast<QualityFlags>(quality),timestamp);
+	DecodeValue(*event,value);
+	return event;
+}
+
+std::shared_ptr<EventInfo> PointSnapshot::Get(const EventType type, const size_t index) const
+{
+	bool quality_only;
+	auto table = TableOf(type,quality_only);
+	if(table < 0 || quality_only)
+		return nullptr;
+	auto pSlot = GetSlot(table,index);
+	if(!pSlot)
+		return nullptr;
+	return Read(table,*pSlot,index);
+}
+
+bool PointSnapshot::Has(const EventType type, const size_t index) const
+{
+	bool quality_only;
+	auto table = TableOf(type,quality_only);
+	if(table < 0 || quality_only)
+		return false;
+	auto pSlot = GetSlot(table,index);
+	if(!pSlot)
+		return false;
+	//a quality event for an unknown point makes the sequence odd for a moment before putting it back to zero
+	auto seq = pSlot->Seq.load(std::memory_order_acquire);
+	while(seq & 1)
+		seq = pSlot->Seq.load(std::memory_order_acquire);
+	return seq != 0;
+}
+
+EventBatch_t PointSnapshot::GetEvents(const EventType type) const
+{
+	EventBatch_t events;
+	bool quality_only;
+	auto table = TableOf(type,quality_only);
+	if(table < 0 || quality_only)
+		return events;
+	auto pTable = Tables[table].load(std::memory_order_acquire);
+	if(!pTable)
+		return events;
+	for(size_t c = 0; c < MaxChunks; c++)
+	{
+		auto pChunk = pTable->Chunks[c].load(std::memory_order_acquire);
+		if(!pChunk)
+			continue;
+		for(size_t i = 0; i < ChunkSize; i++)
+			if(auto event = Read(table,pChunk->Slots[i],c*ChunkSize+i))
+				events.push_back(std::move(event));
+	}
+	return events;
+}
+
+bool PointSnapshot::Empty() const
+{
+	//tables are only made for a point with a value
+	for(auto& table : Tables)
+		if(table.load(std::memory_order_acquire))
+			return false;
+	return true;
+}
+
+EventBatch_t PointSnapshot::GetEvents() const
+{
+	EventBatch_t events;
+	for(auto type : TableTypes)
+	{
+		auto type_events = GetEvents(type);
+		events.insert(events.end(),type_events.begin(),type_events.end());
+	}
+	return events;
+}
+
+} //namespace odc
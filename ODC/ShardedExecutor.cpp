@@ -0,0 +1,179 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * ShardedExecutor.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#include <opendatacon/ShardedExecutor.h>
+#include <opendatacon/HandlerMonitor.h>
+#include <opendatacon/ThreadBudget.h>
+#include <opendatacon/util.h>
+
+namespace odc
+{
+
+const ShardedExecutor*& ShardedExecutor::CurrentExecutor()
+{
+	thread_local const ShardedExecutor* current = nullptr;
+	return current;
+}
+size_t& ShardedExecutor::CurrentShard()
+{
+	thread_local size_t current = 0;
+	return current;
+}
+
+ShardedExecutor::ShardedExecutor(const size_t num_shards, const std::vector<std::vector<unsigned int>>& cpu_sets)
+{
+	if(num_shards == 0)
+		throw std::invalid_argument("ShardedExecutor needs at least one shard");
+	for(size_t i = 0; i < num_shards; i++)
+	{
+		Shards.emplace_back(new Shard());
+		auto& shard = *Shards.back();
+		//only ever run by one thread
+		shard.pIOS = std::make_shared<asio_service>(1);
+		shard.pWork = shard.pIOS->make_work();
+		if(i < cpu_sets.size())
+			shard.CPUs = cpu_sets[i];
+	}
+}
+
+ShardedExecutor::~ShardedExecutor()
+{
+	//the shard threads use the Shards (and this), so they have to finish before they're freed
+	Stop();
+	Join();
+	for(auto& pShard : Shards)
+	{
+		for(auto node : {pShard->Mailbox.exchange(nullptr), pShard->PriorityMailbox.exchange(nullptr)})
+			while(node)
+			{
+				auto next = node->next;
+				delete node;
+				node = next;
+			}
+	}
+}
+
+size_t ShardedExecutor::ShardFor(const std::string& name) const
+{
+	//FNV-1a, so it's the same from run to run (and platform to platform)
+	uint64_t hash = 14695981039346656037ULL;
+	for(auto c : name)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ULL;
+	}
+	return hash % Shards.size();
+}
+
+void ShardedExecutor::Post(const size_t shard, std::function<void()>&& fn, HandlerOwner* pOwner, const HandlerPriority priority)
+{
+	auto& s = *Shards.at(shard);
+	auto& mailbox = (priority == HandlerPriority::High) ? s.PriorityMailbox : s.Mailbox;
+	auto node = new MailboxNode{std::move(fn),pOwner,mailbox.load(std::memory_order_relaxed)};
+	while(!mailbox.compare_exchange_weak(node->next,node,std::memory_order_release,std::memory_order_relaxed))
+		;
+	//only the push that finds the mailbox empty needs to wake the shard
+	if(node->next == nullptr)
+		s.pIOS->post_unmonitored([this,&s](){ Drain(s); });
+}
+
+ShardedExecutor::MailboxNode* ShardedExecutor::TakeInOrder(std::atomic<MailboxNode*>& mailbox)
+{
+	//take everything at once, and put it back in the order it was posted
+	auto node = mailbox.exchange(nullptr,std::memory_order_acquire);
+	MailboxNode* in_order = nullptr;
+	while(node)
+	{
+		auto next = node->next;
+		node->next = in_order;
+		in_order = node;
+		node = next;
+	}
+	return in_order;
+}
+
+void ShardedExecutor::Drain(Shard& shard)
+{
+	auto priority = TakeInOrder(shard.PriorityMailbox);
+	auto in_order = TakeInOrder(shard.Mailbox);
+	const bool monitored = HandlerMonitorEnabled();
+	static auto pUnattributed = GetHandlerOwner("");
+	while(true)
+	{
+		//anything high priority that turns up in the meantime goes before the rest of the normal lane
+		if(!priority && shard.PriorityMailbox.load(std::memory_order_relaxed))
+			priority = TakeInOrder(shard.PriorityMailbox);
+		auto& lane = priority ? priority : in_order;
+		if(!lane)
+			break;
+		std::unique_ptr<MailboxNode> current(lane);
+		lane = lane->next;
+		if(monitored)
+		{
+			HandlerScope scope(current->pOwner ? current->pOwner : pUnattributed);
+			current->fn();
+		}
+		else
+			current->fn();
+	}
+}
+
+void ShardedExecutor::Start()
+{
+	for(size_t i = 0; i < Shards.size(); i++)
+	{
+		auto& shard = *Shards[i];
+		if(shard.Thread.joinable())
+			continue;
+		shard.Thread = std::thread([this,i,&shard]()
+			{
+				CurrentExecutor() = this;
+				CurrentShard() = i;
+				if(!SetCurrentThreadAffinity(shard.CPUs))
+				{
+					if(auto log = odc::spdlog_get("opendatacon"))
+						log->warn("Failed to set CPU affinity for executor shard {}", i);
+				}
+				shard.pIOS->run();
+				CurrentExecutor() = nullptr;
+			});
+	}
+}
+
+void ShardedExecutor::Stop()
+{
+	for(auto& pShard : Shards)
+		pShard->pWork.reset();
+}
+
+void ShardedExecutor::Join()
+{
+	for(auto& pShard : Shards)
+		if(pShard->Thread.joinable())
+			pShard->Thread.join();
+}
+
+} //namespace odc
@@ -0,0 +1,131 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * ThreadBudget.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#include <opendatacon/ThreadBudget.h>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace odc
+{
+
+static std::vector<unsigned int> ParseCPUs(const Json::Value& JSONCPUs)
+{
+	std::vector<unsigned int> cpus;
+	if(JSONCPUs.isArray())
+		for(Json::ArrayIndex n = 0; n < JSONCPUs.size(); ++n)
+			cpus.push_back(JSONCPUs[n].asUInt());
+	else if(JSONCPUs.isUInt())
+		cpus.push_back(JSONCPUs.asUInt());
+	return cpus;
+}
+
+ThreadBudget DefaultThreadBudget()
+{
+	const size_t num_cpus = std::max(1u,std::thread::hardware_concurrency());
+	return ThreadBudget{num_cpus,num_cpus,3,{},{},{}};
+}
+
+ThreadBudget ParseThreadBudget(const Json::Value& JSONThreads)
+{
+	auto budget = DefaultThreadBudget();
+	if(!JSONThreads.isObject())
+		return budget;
+
+	//every pool needs at least one thread
+	if(JSONThreads.isMember("Workers"))
+		budget.Workers = std::max(1u,JSONThreads["Workers"].asUInt());
+	if(JSONThreads.isMember("ProtocolWorkers"))
+		budget.ProtocolWorkers = std::max(1u,JSONThreads["ProtocolWorkers"].asUInt());
+	if(JSONThreads.isMember("LogWorkers"))
+		budget.LogWorkers = std::max(1u,JSONThreads["LogWorkers"].asUInt());
+
+	const auto& affinity = JSONThreads["CPUAffinity"];
+	if(affinity.isObject())
+	{
+		budget.WorkerCPUs = ParseCPUs(affinity["Workers"]);
+		budget.ProtocolCPUs = ParseCPUs(affinity["Protocol"]);
+		budget.LogCPUs = ParseCPUs(affinity["Log"]);
+	}
+	else
+	{
+		budget.WorkerCPUs = budget.ProtocolCPUs = budget.LogCPUs = ParseCPUs(affinity);
+	}
+	return budget;
+}
+
+static std::mutex& BudgetMutex()
+{
+	static std::mutex mtx;
+	return mtx;
+}
+static ThreadBudget& TheBudget()
+{
+	static ThreadBudget budget = DefaultThreadBudget();
+	return budget;
+}
+
+void SetThreadBudget(const ThreadBudget& budget)
+{
+	std::lock_guard<std::mutex> lck(BudgetMutex());
+	TheBudget() = budget;
+}
+
+ThreadBudget GetThreadBudget()
+{
+	std::lock_guard<std::mutex> lck(BudgetMutex());
+	return TheBudget();
+}
+
+bool SetCurrentThreadAffinity(const std::vector<unsigned int>& cpus)
+{
+	if(cpus.empty())
+		return true;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32)
+	DWORD_PTR mask = 0;
+	for(auto cpu : cpus)
+		if(cpu < sizeof(mask)*8)
+			mask |= DWORD_PTR(1) << cpu;
+	return mask && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for(auto cpu : cpus)
+		if(cpu < CPU_SETSIZE)
+			CPU_SET(cpu,&set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+} //namespace odc
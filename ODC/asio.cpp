@@ -25,6 +25,10 @@
  */
 
 #include <opendatacon/asio.h>
+#include <opendatacon/HandlerMonitor.h>
+#include <map>
+#include <mutex>
+#include <set>
 
 //compile asio only in libODC
 //ASIO_SEPARATE_COMPILATION lets other modules link to it
@@ -41,17 +45,21 @@ std::unique_ptr<asio::io_service::strand> asio_service::make_strand()
 {
 	return std::make_unique<asio::io_service::strand>(*unwrap_this);
 }
-std::unique_ptr<asio::steady_timer> asio_service::make_steady_timer()
+std::unique_ptr<serial_executor> asio_service::make_serial_executor(const std::string& owner)
 {
-	return std::make_unique<asio::steady_timer>(*unwrap_this);
+	return std::make_unique<serial_executor>(*this,owner);
 }
-std::unique_ptr<asio::steady_timer> asio_service::make_steady_timer(std::chrono::steady_clock::duration t)
+std::unique_ptr<steady_timer> asio_service::make_steady_timer()
 {
-	return std::make_unique<asio::steady_timer>(*unwrap_this, t);
+	return std::make_unique<steady_timer>(*unwrap_this);
 }
-std::unique_ptr<asio::steady_timer> asio_service::make_steady_timer(std::chrono::steady_clock::time_point t)
+std::unique_ptr<steady_timer> asio_service::make_steady_timer(std::chrono::steady_clock::duration t)
 {
-	return std::make_unique<asio::steady_timer>(*unwrap_this, t);
+	return std::make_unique<steady_timer>(*unwrap_this, t);
+}
+std::unique_ptr<steady_timer> asio_service::make_steady_timer(std::chrono::steady_clock::time_point t)
+{
+	return std::make_unique<steady_timer>(*unwrap_this, t);
 }
 std::unique_ptr<asio::ip::tcp::resolver> asio_service::make_tcp_resolver()
 {
@@ -65,6 +73,10 @@ std::unique_ptr<asio::ip::tcp::acceptor> asio_service::make_tcp_acceptor(asio::i
 {
 	return std::make_unique<asio::ip::tcp::acceptor>(*unwrap_this,*EndPoint);
 }
+std::unique_ptr<asio::ip::tcp::acceptor> asio_service::make_tcp_acceptor(const asio::ip::tcp::endpoint& EndPoint)
+{
+	return std::make_unique<asio::ip::tcp::acceptor>(*unwrap_this,EndPoint);
+}
 std::unique_ptr<asio::ip::tcp::acceptor> asio_service::make_tcp_acceptor()
 {
 	return std::make_unique<asio::ip::tcp::acceptor>(*unwrap_this);
@@ -78,4 +90,361 @@ std::unique_ptr<asio::ip::udp::socket> asio_service::make_udp_socket()
 	return std::make_unique<asio::ip::udp::socket>(*unwrap_this);
 }
 
+VirtualTime& GetVirtualTime()
+{
+	static auto pTime = new VirtualTime();
+	return *pTime;
+}
+
+struct VirtualClock
+{
+	//timers waiting in virtual time, in the order they're due
+	std::mutex mtx;
+	std::set<std::pair<asio_clock::time_point,uint64_t>> waits;
+	uint64_t next_id = 0;
+	//every asio_service, so they can be woken up to check their timers when the clock moves
+	//	an already expired timer goes to the front of the timer queue, which makes asio work out how long to wait again
+	struct ServiceWake
+	{
+		std::unique_ptr<asio::basic_waitable_timer<asio_clock,asio_wait_traits>> pTimer;
+		bool pending = false;
+		asio_clock::rep woken_at = 0;
+	};
+	std::map<asio_service*,ServiceWake> services;
+
+	//call with mtx held
+	void Wake(asio_service* pService, ServiceWake& wake)
+	{
+		//only one at a time, so a service nobody is running doesn't pile them up - it checks whether it needs another
+		if(wake.pending)
+			return;
+		if(!wake.pTimer)
+			wake.pTimer = std::make_unique<asio::basic_waitable_timer<asio_clock,asio_wait_traits>>(*pService->unwrap_this);
+		wake.pending = true;
+		wake.woken_at = GetVirtualTime().now.load();
+		wake.pTimer->expires_at(asio_clock::time_point());
+		wake.pTimer->async_wait([this,pService](const asio::error_code& err)
+			{
+				if(err)
+					return;
+				std::lock_guard<std::mutex> lck(mtx);
+				auto it = services.find(pService);
+				if(it == services.end())
+					return;
+				it->second.pending = false;
+				//the clock moved again since the timers were checked
+				if(GetVirtualTime().now.load() != it->second.woken_at)
+					Wake(pService,it->second);
+			});
+	}
+	void WakeAll()
+	{
+		for(auto& service : services)
+			Wake(service.first,service.second);
+	}
+};
+static VirtualClock& GetVirtualClock()
+{
+	//never destroyed - timers can be cancelled during static destruction
+	static auto pClock = new VirtualClock();
+	return *pClock;
+}
+
+asio_service::asio_service():
+	asio::io_service()
+{
+	auto& clock = GetVirtualClock();
+	std::lock_guard<std::mutex> lck(clock.mtx);
+	clock.services[this];
+}
+asio_service::asio_service(int concurrency_hint):
+	asio::io_service(concurrency_hint)
+{
+	auto& clock = GetVirtualClock();
+	std::lock_guard<std::mutex> lck(clock.mtx);
+	clock.services[this];
+}
+asio_service::~asio_service()
+{
+	auto& clock = GetVirtualClock();
+	std::lock_guard<std::mutex> lck(clock.mtx);
+	clock.services.erase(this);
+}
+
+void EnableVirtualTime()
+{
+	auto& time = GetVirtualTime();
+	time.now = std::chrono::steady_clock::now().time_since_epoch().count();
+	time.enabled = true;
+}
+void DisableVirtualTime()
+{
+	GetVirtualTime().enabled = false;
+	auto& clock = GetVirtualClock();
+	std::lock_guard<std::mutex> lck(clock.mtx);
+	clock.waits.clear();
+	//anyone waiting on the virtual clock needs to go back to real time
+	clock.WakeAll();
+}
+bool VirtualTimeEnabled()
+{
+	return GetVirtualTime().enabled.load(std::memory_order_relaxed);
+}
+//only ever forward - the clock is steady
+static void AdvanceVirtualTimeTo(const asio_clock::time_point& t)
+{
+	auto& now = GetVirtualTime().now;
+	auto current = now.load();
+	bool moved = false;
+	while(current < t.time_since_epoch().count() && !(moved = now.compare_exchange_weak(current,t.time_since_epoch().count())))
+	{}
+	if(!moved)
+		return;
+	//timers that aren't due are waited on as long as asio allows, so wake everyone up if some are due now
+	auto& clock = GetVirtualClock();
+	std::lock_guard<std::mutex> lck(clock.mtx);
+	if(!clock.waits.empty() && clock.waits.begin()->first <= t)
+		clock.WakeAll();
+}
+void AdvanceVirtualTime(const asio_clock::duration& d)
+{
+	AdvanceVirtualTimeTo(asio_clock::now()+d);
+}
+
+//asio caps the wait anyway, and checks the timers again when it's up
+static constexpr auto VirtualWaitCap = std::chrono::minutes(5);
+
+asio_clock::duration asio_wait_traits::to_wait_duration(const asio_clock::duration& d)
+{
+	if(VirtualTimeEnabled())
+		return d > asio_clock::duration::zero() ? asio_clock::duration(VirtualWaitCap) : asio_clock::duration::zero();
+	return d;
+}
+asio_clock::duration asio_wait_traits::to_wait_duration(const asio_clock::time_point& t)
+{
+	if(VirtualTimeEnabled())
+		return t > asio_clock::now() ? asio_clock::duration(VirtualWaitCap) : asio_clock::duration::zero();
+	return asio::wait_traits<std::chrono::steady_clock>::to_wait_duration(t);
+}
+
+VirtualWait VirtualWaitStart(const asio_clock::time_point& expiry)
+{
+	auto& clock = GetVirtualClock();
+	std::lock_guard<std::mutex> lck(clock.mtx);
+	VirtualWait wait{expiry,clock.next_id++};
+	clock.waits.emplace(wait.expiry,wait.id);
+	return wait;
+}
+void VirtualWaitEnd(const VirtualWait& wait)
+{
+	auto& clock = GetVirtualClock();
+	std::lock_guard<std::mutex> lck(clock.mtx);
+	clock.waits.erase({wait.expiry,wait.id});
+}
+
+size_t asio_service::run_virtual(const asio_clock::time_point& until)
+{
+	auto& clock = GetVirtualClock();
+	size_t count = 0;
+	while(!stopped())
+	{
+		auto ran = poll();
+		count += ran;
+		if(ran)
+			continue;
+
+		//nothing ready - move the clock on to the next timer
+		asio_clock::time_point next;
+		{
+			std::lock_guard<std::mutex> lck(clock.mtx);
+			if(clock.waits.empty())
+				break;
+			next = clock.waits.begin()->first;
+		}
+		if(next > until)
+		{
+			AdvanceVirtualTimeTo(until);
+			break;
+		}
+		AdvanceVirtualTimeTo(next);
+	}
+	return count;
+}
+
+//The serial_executors whose handlers are running on this thread (innermost first)
+//	more than one when a handler dispatches straight into another executor
+struct SerialFrame
+{
+	const void* queue;
+	SerialFrame* next;
+};
+static SerialFrame*& SerialCallStack()
+{
+	thread_local SerialFrame* top = nullptr;
+	return top;
+}
+
+serial_executor::serial_executor(asio_service& ios, const std::string& owner):
+	pQueue(std::make_shared<Queue>(ios,GetHandlerOwner(owner)))
+{}
+
+void serial_executor::set_owner(const std::string& owner)
+{
+	pQueue->pOwner = GetHandlerOwner(owner);
+}
+
+serial_executor::Queue::~Queue()
+{
+	for(auto node : {ready, head.exchange(nullptr), priority_ready, priority_head.exchange(nullptr)})
+		while(node)
+		{
+			auto next = node->next;
+			if(node->counted)
+				node->pOwner->Dequeued();
+			delete node;
+			node = next;
+		}
+}
+
+void serial_executor::post(std::function<void()> fn, const HandlerPriority priority)
+{
+	post(std::move(fn),pQueue->pOwner.load(std::memory_order_relaxed),priority);
+}
+
+void serial_executor::post(std::function<void()> fn, HandlerOwner* pOwner, const HandlerPriority priority)
+{
+	auto& head = (priority == HandlerPriority::High) ? pQueue->priority_head : pQueue->head;
+	//count it before it's visible, so the runner can't take it and leave the count behind
+	auto was_pending = pQueue->pending.fetch_add(1,std::memory_order_acq_rel);
+	const bool counted = QueueDepthTracked();
+	if(counted)
+		pOwner->Queued();
+	auto node = new Node{std::move(fn),pOwner,head.load(std::memory_order_relaxed),counted};
+	while(!head.compare_exchange_weak(node->next,node,std::memory_order_release,std::memory_order_relaxed))
+	{}
+	if(was_pending == 0)
+	{
+		auto pQ = pQueue;
+		pQueue->ios.post_unmonitored([pQ](){ Run(pQ); });
+	}
+}
+
+void serial_executor::dispatch(std::function<void()> fn, const HandlerPriority priority)
+{
+	if(running_in_this_thread())
+		fn();
+	else
+		post(std::move(fn),priority);
+}
+
+void serial_executor::dispatch(std::function<void()> fn, HandlerOwner* pOwner, const HandlerPriority priority)
+{
+	if(running_in_this_thread())
+		RunMonitored(pOwner,[](void* ctx){ (*static_cast<std::function<void()>*>(ctx))(); },&fn);
+	else
+		post(std::move(fn),pOwner,priority);
+}
+
+bool serial_executor::running_in_this_thread() const
+{
+	for(auto frame = SerialCallStack(); frame; frame = frame->next)
+		if(frame->queue == pQueue.get())
+			return true;
+	return false;
+}
+
+serial_executor::Node* serial_executor::TakeInOrder(std::atomic<Node*>& head)
+{
+	//reverse what's been posted into posting order
+	auto node = head.exchange(nullptr,std::memory_order_acquire);
+	Node* in_order = nullptr;
+	while(node)
+	{
+		auto next = node->next;
+		node->next = in_order;
+		in_order = node;
+		node = next;
+	}
+	return in_order;
+}
+
+void serial_executor::Run(const std::shared_ptr<Queue>& pQueue)
+{
+	//only one Run is ever scheduled at a time, so this is the only consumer
+	auto& q = *pQueue;
+	if(!q.ready)
+		q.ready = TakeInOrder(q.head);
+
+	//account for what we ran, even if a handler throws (what's left stays ready for next time)
+	struct Finish
+	{
+		const std::shared_ptr<Queue>& pQueue;
+		SerialFrame frame;
+		size_t ran;
+		~Finish()
+		{
+			SerialCallStack() = frame.next;
+			//anything posted while we were running gets its own turn, so we don't hog the thread
+			if(pQueue->pending.fetch_sub(ran,std::memory_order_acq_rel) != ran)
+			{
+				auto pQ = pQueue;
+				pQueue->ios.post_unmonitored([pQ](){ Run(pQ); });
+			}
+		}
+	} finish{pQueue,{pQueue.get(),SerialCallStack()},0};
+	SerialCallStack() = &finish.frame;
+
+	//Deficit round robin: each turn adds our share of run time, and we stop when it's used up
+	//	the rest waits at the back of the asio_service queue, behind everyone else's turn
+	//	(off by default - then there's no timing at all)
+	const auto quantum = GetFairShareQuantum().count();
+	const int64_t allowance = quantum > 0 ? quantum*q.pOwner.load(std::memory_order_relaxed)->Weight : 0;
+	std::chrono::steady_clock::time_point last;
+	if(quantum > 0)
+	{
+		q.deficit += allowance;
+		last = std::chrono::steady_clock::now();
+	}
+
+	const bool monitored = HandlerMonitorEnabled();
+	while(true)
+	{
+		//high priority handlers go first, even if they were posted by the handler we just ran
+		if(!q.priority_ready && q.priority_head.load(std::memory_order_relaxed))
+			q.priority_ready = TakeInOrder(q.priority_head);
+		auto& lane = q.priority_ready ? q.priority_ready : q.ready;
+		if(!lane)
+		{
+			//whatever is left of the turn isn't saved up
+			q.deficit = 0;
+			break;
+		}
+		if(quantum > 0 && q.deficit <= 0)
+		{
+			q.pOwner.load(std::memory_order_relaxed)->Throttled++;
+			break;
+		}
+		std::unique_ptr<Node> current(lane);
+		lane = current->next;
+		finish.ran++;
+		if(current->counted)
+			current->pOwner->Dequeued();
+		if(monitored)
+		{
+			HandlerScope scope(current->pOwner);
+			current->fn();
+		}
+		else
+			current->fn();
+		if(quantum > 0)
+		{
+			auto now = std::chrono::steady_clock::now();
+			q.deficit -= std::chrono::duration_cast<std::chrono::nanoseconds>(now-last).count();
+			//one long handler only costs the next turn - it doesn't leave a debt that takes many empty turns to pay off
+			q.deficit = std::max(q.deficit,1-allowance);
+			last = now;
+		}
+	}
+}
+
 } //namespace odc
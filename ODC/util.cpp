@@ -25,8 +25,10 @@
  */
 
 #include <opendatacon/util.h>
+#include <atomic>
 #include <regex>
 #include <iostream>
+#include <vector>
 
 namespace odc
 {
@@ -36,6 +38,11 @@ void spdlog_init_thread_pool(size_t q_size, size_t thread_count)
 	spdlog::init_thread_pool(q_size, thread_count);
 }
 
+void spdlog_init_thread_pool(size_t q_size, size_t thread_count, std::function<void()> on_thread_start)
+{
+	spdlog::init_thread_pool(q_size, thread_count, on_thread_start);
+}
+
 std::shared_ptr<spdlog::details::thread_pool> spdlog_thread_pool()
 {
 	return spdlog::thread_pool();
@@ -46,9 +53,18 @@ void spdlog_flush_all()
 	spdlog::apply_all([&](std::shared_ptr<spdlog::logger> l) {l->flush(); });
 }
 
+void spdlog_apply_all(const std::function<void(std::shared_ptr<spdlog::logger>)>& fun)
+{
+	spdlog::apply_all(fun);
+}
+
+//Bumped whenever the logger registry changes, so LogHandles know to look again
+static std::atomic<uint64_t> LoggerGeneration(1);
+
 void spdlog_register_logger(std::shared_ptr<spdlog::logger> logger)
 {
-	return spdlog::register_logger(logger);
+	spdlog::register_logger(logger);
+	LoggerGeneration.fetch_add(1,std::memory_order_release);
 }
 
 std::shared_ptr<spdlog::logger> spdlog_get(const std::string &name)
@@ -59,16 +75,50 @@ std::shared_ptr<spdlog::logger> spdlog_get(const std::string &name)
 void spdlog_drop(const std::string &name)
 {
 	spdlog::drop(name);
+	LoggerGeneration.fetch_add(1,std::memory_order_release);
 }
 
 void spdlog_drop_all()
 {
 	spdlog::drop_all();
+	LoggerGeneration.fetch_add(1,std::memory_order_release);
 }
 
 void spdlog_shutdown()
 {
 	spdlog::shutdown();
+	LoggerGeneration.fetch_add(1,std::memory_order_release);
+}
+
+static std::atomic<size_t> NextLogHandleID(0);
+
+LogHandle::LogHandle(std::string name):
+	Name(std::move(name)),
+	ID(NextLogHandleID.fetch_add(1,std::memory_order_relaxed))
+{}
+
+spdlog::logger* LogHandle::Get() const
+{
+	//Each thread keeps its own copy of each handle's logger, so there's nothing shared to lock
+	//	a dropped logger is only kept alive until each thread next uses the handle
+	struct CacheEntry
+	{
+		std::shared_ptr<spdlog::logger> pLogger;
+		uint64_t Generation = 0;
+	};
+	thread_local std::vector<CacheEntry> Cache;
+
+	if(ID >= Cache.size())
+		Cache.resize(ID+1);
+	auto& entry = Cache[ID];
+	//take the generation before looking, so a change while we look gets picked up next time
+	auto generation = LoggerGeneration.load(std::memory_order_acquire);
+	if(entry.Generation != generation)
+	{
+		entry.pLogger = spdlog::get(Name);
+		entry.Generation = generation;
+	}
+	return entry.pLogger.get();
 }
 
 bool getline_noncomment(std::istream& is, std::string& line)
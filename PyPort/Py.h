@@ -40,23 +40,29 @@
 //#define SCOTTPYTHONCODEPATH
 
 // Hide some of the code to make Logging cleaner
+// The logger handle is cached, and the arguments are only evaluated if the level is enabled
+inline const odc::LogHandle& PyPortLog()
+{
+	static const odc::LogHandle handle("PyPort");
+	return handle;
+}
 #define LOGTRACE(...) \
-	if (auto log = odc::spdlog_get("PyPort")) \
+	if (auto log = PyPortLog().ForLevel(spdlog::level::trace)) \
 		log->trace(__VA_ARGS__);
 #define LOGDEBUG(...) \
-	if (auto log = odc::spdlog_get("PyPort")) \
+	if (auto log = PyPortLog().ForLevel(spdlog::level::debug)) \
 		log->debug(__VA_ARGS__);
 #define LOGERROR(...) \
-	if (auto log = odc::spdlog_get("PyPort")) \
+	if (auto log = PyPortLog().ForLevel(spdlog::level::err)) \
 		log->error(__VA_ARGS__);
 #define LOGWARN(...) \
-	if (auto log = odc::spdlog_get("PyPort"))  \
+	if (auto log = PyPortLog().ForLevel(spdlog::level::warn)) \
 		log->warn(__VA_ARGS__);
 #define LOGINFO(...) \
-	if (auto log = odc::spdlog_get("PyPort")) \
+	if (auto log = PyPortLog().ForLevel(spdlog::level::info)) \
 		log->info(__VA_ARGS__);
 #define LOGCRITICAL(...) \
-	if (auto log = odc::spdlog_get("PyPort")) \
+	if (auto log = PyPortLog().ForLevel(spdlog::level::critical)) \
 		log->critical(__VA_ARGS__);
 #define LOGSTRAND(...)
 /*if (auto log = odc::spdlog_get("PyPort")) \
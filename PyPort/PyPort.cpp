@@ -34,6 +34,7 @@
 // So leave the extension bit out for the moment, just get to the pont where we can load the class and call its methods...
 
 #include "PyPort.h"
+#include <opendatacon/HandlerMonitor.h>
 #include <chrono>
 #include <ctime>
 #include <time.h>
@@ -69,7 +70,7 @@ bool fileexists(const std::string& filename)
 }
 using namespace odc;
 
-std::shared_ptr<asio::io_context::strand> PyPort::python_strand = nullptr;
+std::shared_ptr<odc::serial_executor> PyPort::python_strand = nullptr;
 std::once_flag PyPort::python_strand_flag;
 
 std::vector<std::string> split(const std::string& s, char delim)
@@ -109,7 +110,8 @@ struct MyException: public std::exception
 PyPort::PyPort(const std::string& aName, const std::string& aConfFilename, const Json::Value& aConfOverrides):
 	DataPort(aName, aConfFilename, aConfOverrides),
 	JSONMain(""),
-	JSONOverride("")
+	JSONOverride(""),
+	pHandlerOwner(odc::GetHandlerOwner(aName))
 {
 	//the creation of a new PyPortConf will get the point details
 	pConf.reset(new PyPortConf(ConfFilename, ConfOverrides));
@@ -161,7 +163,7 @@ void PyPort::Build()
 	std::call_once(PyPort::python_strand_flag,[this]()
 		{
 			LOGDEBUG("Create python_strand");
-			PyPort::python_strand = pIOS->make_strand();
+			PyPort::python_strand = pIOS->make_serial_executor("PyPort");
 		});
 
 	// Every call to pWrapper should be strand protected. NOTE ASIO is not running here...
@@ -187,7 +189,7 @@ void PyPort::Build()
 			      LOGERROR("Exception Importing Module and Creating Class instance - {}", e.what());
 			}
 			LOGSTRAND("Exit Strand");
-		});
+		},pHandlerOwner);
 
 	pServer = ServerManager::AddConnection(pIOS, MyConf->pyHTTPAddr, MyConf->pyHTTPPort); //Static method - creates a new ServerManager if required
 
@@ -298,7 +300,7 @@ void PyPort::Enable()
 			pWrapper->PortOperational();
 			LOGDEBUG("Port enabled and  operational 1 {}", Name);
 			LOGSTRAND("Exit Strand");
-		});
+		},pHandlerOwner);
 	// Synchronously wait for promise to be fulfilled - pWrapper to be created, we need to poll the ASIO threadpool to do that
 	LOGDEBUG("Entering Port Wait {}", Name);
 	while (future.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready)
@@ -328,7 +330,7 @@ void PyPort::Disable()
 			LOGSTRAND("Entered Strand on Disable");
 			pWrapper->Disable();
 			LOGSTRAND("Exit Strand");
-		});
+		},pHandlerOwner);
 }
 
 std::shared_ptr<odc::EventInfo> PyPort::CreateEventFromStrParams(const std::string& EventTypeStr, size_t& ODCIndex, const std::string& QualityStr, const std::string& PayloadStr, const std::string& Name)
@@ -561,7 +563,7 @@ void PyPort::Event(std::shared_ptr<const EventInfo> event, const std::string& Se
 
 				PostCallbackCall(pStatusCallback, result);
 				LOGSTRAND("Exit Strand");
-			});
+			},pHandlerOwner);
 	}
 }
 void PyPort::SetTimer(uint32_t id, uint32_t delayms)
@@ -585,7 +587,7 @@ void PyPort::SetTimer(uint32_t id, uint32_t delayms)
 						LOGSTRAND("Entered Strand on SetTimer");
 						pWrapper->CallTimerHandler(id);
 						LOGSTRAND("Exit Strand");
-					});
+					},pHandlerOwner);
 			}
 		});
 }
@@ -608,7 +610,7 @@ void PyPort::RestHandler(const std::string& url, const std::string& content, Res
 
 			PostResponseCallbackCall(pResponseCallback, result);
 			LOGSTRAND("Exit Strand");
-		});
+		},pHandlerOwner);
 }
 
 // Just schedule the callback, don't want to do it in a strand protected section.
@@ -36,7 +36,7 @@
 #include "ServerManager.h"
 
 
-typedef asio::basic_waitable_timer<std::chrono::steady_clock> Timer_t;
+typedef odc::steady_timer Timer_t;
 typedef std::shared_ptr<Timer_t> pTimer_t;
 typedef std::shared_ptr<std::function<void (const std::string response)>> ResponseCallback_t;
 
@@ -88,8 +88,10 @@ private:
 	ServerTokenType pServer;
 
 	// We need one strand, for ALL python ports, so that we control access to the Python Interpreter to one thread.
-	static std::shared_ptr<asio::io_context::strand> python_strand;
+	static std::shared_ptr<odc::serial_executor> python_strand;
 	static std::once_flag python_strand_flag;
+	// ...but each port's time on it is its own (see HandlerMonitor.h)
+	odc::HandlerOwner* const pHandlerOwner;
 
 	// Worker methods
 	void PostCallbackCall(const odc::SharedStatusCallback_t& pStatusCallback, CommandStatus c);
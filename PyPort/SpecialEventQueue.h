@@ -54,7 +54,7 @@ public:
 	std::atomic<size_t> size;
 	size_t maxsize;
 	std::shared_ptr<odc::asio_service> pIOS;
-	std::unique_ptr<asio::io_context::strand> internal_queue_strand;
+	std::unique_ptr<odc::serial_executor> internal_queue_strand;
 
 public:
 	SpecialEventQueue(std::shared_ptr<odc::asio_service> _pIOS, size_t _maxsize)
@@ -63,7 +63,7 @@ public:
 		size(0),
 		maxsize(_maxsize),
 		pIOS(_pIOS),
-		internal_queue_strand(pIOS->make_strand())
+		internal_queue_strand(pIOS->make_serial_executor())
 	{}
 
 	size_t Size() { return size.load(); }
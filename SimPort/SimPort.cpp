@@ -214,7 +214,7 @@ bool SimPort::UILoad(const std::string& type, const std::string& index, const st
 				std::unique_lock<std::shared_timed_mutex> lck(ConfMutex);
 				pConf->BinaryForcedStates[idx] = true;
 			}
-			auto event = std::make_shared<EventInfo>(EventType::Binary,idx,Name,Q,ts);
+			auto event = MakeEvent(EventType::Binary,idx,Name,Q,ts);
 			bool valb = (val >= 1);
 			event->SetPayload<EventType::Binary>(std::move(valb));
 			PublishEvent(event);
@@ -230,7 +230,7 @@ bool SimPort::UILoad(const std::string& type, const std::string& index, const st
 				std::unique_lock<std::shared_timed_mutex> lck(ConfMutex);
 				pConf->AnalogForcedStates[idx] = true;
 			}
-			auto event = std::make_shared<EventInfo>(EventType::Analog,idx,Name,Q,ts);
+			auto event = MakeEvent(EventType::Analog,idx,Name,Q,ts);
 			event->SetPayload<EventType::Analog>(std::move(val));
 			PublishEvent(event);
 		}
@@ -362,7 +362,7 @@ void SimPort::PortUp()
 		//Check if we're configured to load this point from DB
 		if(DBStats.count("Analog"+std::to_string(index)))
 		{
-			auto event = std::make_shared<EventInfo>(EventType::Analog,index,Name);
+			auto event = MakeEvent(EventType::Analog,index,Name);
 			NextEventFromDB(event);
 			int64_t time_offset = 0;
 			if(!(TimestampHandling & TimestampMode::ABSOLUTE_T))
@@ -416,7 +416,7 @@ void SimPort::PortUp()
 		//send initial event
 		auto mean = pConf->AnalogStartVals.count(index) ? pConf->AnalogStartVals.at(index) : 0;
 		pConf->AnalogStartVals[index] = mean;
-		auto event = std::make_shared<EventInfo>(EventType::Analog,index,Name,QualityFlags::ONLINE);
+		auto event = MakeEvent(EventType::Analog,index,Name,QualityFlags::ONLINE);
 		event->SetPayload<EventType::Analog>(std::move(mean));
 		PublishEvent(event);
 
@@ -441,7 +441,7 @@ void SimPort::PortUp()
 		//send initial event
 		auto val = pConf->BinaryStartVals.count(index) ? pConf->BinaryStartVals.at(index) : false;
 		pConf->BinaryStartVals[index] = val;
-		auto event = std::make_shared<EventInfo>(EventType::Binary,index,Name,QualityFlags::ONLINE);
+		auto event = MakeEvent(EventType::Binary,index,Name,QualityFlags::ONLINE);
 		event->SetPayload<EventType::Binary>(std::move(val));
 		PublishEvent(event);
 
@@ -542,7 +542,7 @@ void SimPort::PopulateNextEvent(std::shared_ptr<EventInfo> event, int64_t time_o
 void SimPort::SpawnEvent(std::shared_ptr<EventInfo> event, int64_t time_offset)
 {
 	//deep copy event to modify as next event
-	auto next_event = std::make_shared<EventInfo>(*event);
+	auto next_event = MakeEvent(*event);
 
 	auto pConf = static_cast<SimPortConf*>(this->pConf.get());
 	std::string typeString = "Binary";
@@ -588,7 +588,7 @@ void SimPort::SpawnEvent(std::shared_ptr<EventInfo> event, int64_t time_offset)
 
 void SimPort::Build()
 {
-	pEnableDisableSync = pIOS->make_strand();
+	pEnableDisableSync = pIOS->make_serial_executor(Name);
 	auto shared_this = std::static_pointer_cast<SimPort>(shared_from_this());
 	this->SimCollection->Add(shared_this,this->Name);
 }
@@ -902,9 +902,9 @@ void SimPort::ProcessElements(const Json::Value& JSONRoot)
 							}
 						}
 
-						auto on = std::make_shared<EventInfo>(EventType::Binary,fb_index,Name,on_qual);
+						auto on = MakeEvent(EventType::Binary,fb_index,Name,on_qual);
 						on->SetPayload<EventType::Binary>(std::move(on_val));
-						auto off = std::make_shared<EventInfo>(EventType::Binary,fb_index,Name,off_qual);
+						auto off = MakeEvent(EventType::Binary,fb_index,Name,off_qual);
 						off->SetPayload<EventType::Binary>(std::move(off_val));
 
 						pConf->ControlFeedback[index].emplace_back(on,off,mode);
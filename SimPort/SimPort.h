@@ -70,7 +70,7 @@ public:
 	bool UISetUpdateInterval(const std::string& type, const std::string& index, const std::string& period);
 
 private:
-	typedef asio::basic_waitable_timer<std::chrono::steady_clock> Timer_t;
+	typedef odc::steady_timer Timer_t;
 	typedef std::shared_ptr<Timer_t> pTimer_t;
 	std::unordered_map<std::string, pTimer_t> Timers;
 	typedef std::shared_ptr<sqlite3> pDBConnection;
@@ -126,7 +126,7 @@ private:
 
 	std::shared_timed_mutex ConfMutex;
 
-	std::unique_ptr<asio::io_service::strand> pEnableDisableSync;
+	std::unique_ptr<odc::serial_executor> pEnableDisableSync;
 	static thread_local std::mt19937 RandNumGenerator;
 };
 
@@ -56,7 +56,7 @@ public:
 
 	void schedule()
 	{
-		nextpoll = std::chrono::steady_clock::now() + std::chrono::milliseconds(periodms);
+		nextpoll = odc::asio_clock::now() + std::chrono::milliseconds(periodms);
 	}
 
 	void reschedule()
@@ -152,7 +152,7 @@ private:
 	bool running;
 	typedef std::priority_queue<ASIOSchedulerTask*, std::vector<ASIOSchedulerTask*>, ASIOSchedulerTaskComparison> ScheduleType;
 	ScheduleType Schedule;
-	typedef asio::basic_waitable_timer<std::chrono::steady_clock> Timer_t;
+	typedef odc::steady_timer Timer_t;
 	std::unique_ptr<Timer_t> pTimer;
 };
 
@@ -0,0 +1,198 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * BoundedMPMCQueue.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#ifndef BOUNDEDMPMCQUEUE_H_
+#define BOUNDEDMPMCQUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace odc
+{
+
+//A fixed size, lock-free, multi-producer multi-consumer FIFO (a Vyukov style ring)
+//	Every slot has a sequence number that says whose turn it is: producers and consumers
+//	claim a position with a CAS, then hand the slot over by bumping its sequence
+//	Pushes that don't fit are refused and counted, rather than blocking
+template <typename T>
+class BoundedMPMCQueue
+{
+public:
+	//limit is the most items the queue will hold
+	explicit BoundedMPMCQueue(const size_t limit):
+		Limit(limit),
+		Mask(RoundUpPow2(limit < 2 ? 2 : limit)-1),
+		Cells(new Cell[Mask+1])
+	{
+		for(size_t i = 0; i <= Mask; i++)
+			Cells[i].Seq.store(i,std::memory_order_relaxed);
+	}
+	BoundedMPMCQueue(const BoundedMPMCQueue&) = delete;
+	BoundedMPMCQueue& operator=(const BoundedMPMCQueue&) = delete;
+
+	//Add to the back - false (and counted as an overflow) if there's no room
+	//	reserve leaves that many places free (eg. for an overflow marker pushed after this fails)
+	bool Push(const T& value, const size_t reserve = 0)
+	{
+		auto pos = EnqueuePos.load(std::memory_order_relaxed);
+		for(;;)
+		{
+			auto deq = DequeuePos.load(std::memory_order_acquire);
+			if(pos < deq)
+			{
+				//we're behind - it's moved on since we looked
+				pos = EnqueuePos.load(std::memory_order_relaxed);
+				continue;
+			}
+			if(pos - deq + reserve >= Limit)
+			{
+				Overflows.fetch_add(1,std::memory_order_relaxed);
+				return false;
+			}
+			auto& cell = Cells[pos & Mask];
+			auto diff = static_cast<intptr_t>(cell.Seq.load(std::memory_order_acquire)) - static_cast<intptr_t>(pos);
+			if(diff == 0)
+			{
+				if(EnqueuePos.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed))
+				{
+					cell.Value = value;
+					cell.Seq.store(pos+1,std::memory_order_release);
+					return true;
+				}
+			}
+			else if(diff < 0)
+			{
+				//a consumer hasn't finished with the slot yet - it's still full
+				Overflows.fetch_add(1,std::memory_order_relaxed);
+				return false;
+			}
+			else
+				pos = EnqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	//Take from the front - false if it's empty
+	bool Pop(T& value)
+	{
+		return PopImpl(&value);
+	}
+	bool Pop()
+	{
+		return PopImpl(nullptr);
+	}
+
+	//Copy the front without removing it - false if it's empty
+	//	Only meaningful with a single consumer (another consumer could pop it in the meantime)
+	bool Front(T& value) const
+	{
+		auto pos = DequeuePos.load(std::memory_order_acquire);
+		const auto& cell = Cells[pos & Mask];
+		if(cell.Seq.load(std::memory_order_acquire) != pos+1)
+			return false;
+		value = cell.Value;
+		return true;
+	}
+
+	bool Empty() const
+	{
+		auto pos = DequeuePos.load(std::memory_order_acquire);
+		return Cells[pos & Mask].Seq.load(std::memory_order_acquire) != pos+1;
+	}
+	//A snapshot - it may have changed by the time you look at it
+	size_t Size() const
+	{
+		auto deq = DequeuePos.load(std::memory_order_acquire);
+		auto enq = EnqueuePos.load(std::memory_order_acquire);
+		return enq > deq ? enq - deq : 0;
+	}
+	size_t Capacity() const
+	{
+		return Limit;
+	}
+	//How many pushes have been refused
+	uint64_t OverflowCount() const
+	{
+		return Overflows.load(std::memory_order_relaxed);
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> Seq;
+		T Value;
+	};
+
+	bool PopImpl(T* pValue)
+	{
+		auto pos = DequeuePos.load(std::memory_order_relaxed);
+		for(;;)
+		{
+			auto& cell = Cells[pos & Mask];
+			auto diff = static_cast<intptr_t>(cell.Seq.load(std::memory_order_acquire)) - static_cast<intptr_t>(pos+1);
+			if(diff == 0)
+			{
+				if(DequeuePos.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed))
+				{
+					if(pValue)
+						*pValue = std::move(cell.Value);
+					cell.Seq.store(pos+Mask+1,std::memory_order_release);
+					return true;
+				}
+			}
+			else if(diff < 0)
+				return false;
+			else
+				pos = DequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	static size_t RoundUpPow2(size_t n)
+	{
+		size_t pow2 = 1;
+		while(pow2 < n)
+			pow2 <<= 1;
+		return pow2;
+	}
+
+	const size_t Limit;
+	const size_t Mask;
+	std::unique_ptr<Cell[]> Cells;
+	//producers and consumers each hammer their own position, so keep them on separate cache lines
+	//	padded rather than alignas(), which new/make_shared don't honour before C++17
+	static constexpr size_t CacheLine = 64;
+	char PadLimits[CacheLine];
+	std::atomic<size_t> EnqueuePos{0};
+	char PadEnqueue[CacheLine-sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> DequeuePos{0};
+	char PadDequeue[CacheLine-sizeof(std::atomic<size_t>)];
+	std::atomic<uint64_t> Overflows{0};
+};
+
+} //namespace odc
+
+#endif /* BOUNDEDMPMCQUEUE_H_ */
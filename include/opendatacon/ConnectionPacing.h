@@ -0,0 +1,91 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * ConnectionPacing.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#ifndef CONNECTIONPACING_H_
+#define CONNECTIONPACING_H_
+
+#include <opendatacon/asio.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <random>
+
+namespace odc
+{
+
+//Randomised exponential backoff for retrying a connection ("decorrelated jitter")
+//	Each delay is a random time between base and 3 times the last delay, up to cap
+//	So a crowd of connections that all dropped at once drift apart as they retry, instead of retrying in lockstep
+class DecorrelatedJitter
+{
+public:
+	DecorrelatedJitter(const std::chrono::milliseconds& abase, const std::chrono::milliseconds& acap):
+		base(std::max(abase,std::chrono::milliseconds(1))),
+		cap(std::max(base,acap)),
+		last(base),
+		rng(std::random_device()())
+	{}
+	std::chrono::milliseconds Next()
+	{
+		auto upper = std::min(cap.count(),last.count()*3);
+		std::uniform_int_distribution<std::chrono::milliseconds::rep> dist(base.count(),upper);
+		last = std::chrono::milliseconds(dist(rng));
+		return last;
+	}
+	//Start again from base - eg. once connected
+	void Reset()
+	{
+		last = base;
+	}
+	std::chrono::milliseconds Base() const
+	{
+		return base;
+	}
+	std::chrono::milliseconds Cap() const
+	{
+		return cap;
+	}
+
+private:
+	std::chrono::milliseconds base;
+	std::chrono::milliseconds cap;
+	std::chrono::milliseconds last;
+	std::minstd_rand rng;
+};
+
+//A limit on how fast connections get started across the whole process, so hundreds of ports
+//	don't all hit an upstream at the same moment (at startup, or when it comes back)
+//	Up to burst go straight away, then they're spaced out at per_second
+//	Zero per_second (the default) is no limit
+void SetConnectRateLimit(const double per_second, const size_t burst = 1);
+//Post fn to pIOS when the limit allows the next connection to start
+//	Everyone takes their turn in the order they asked
+void PaceConnect(const std::shared_ptr<asio_service>& pIOS, const std::function<void()>& fn);
+
+} //namespace odc
+
+#endif /* CONNECTIONPACING_H_ */
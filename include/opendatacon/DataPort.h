@@ -50,6 +50,7 @@ public:
 	virtual void Build()=0;
 	virtual void ProcessElements(const Json::Value& JSONRoot) override =0;
 	virtual void Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override = 0;
+	using IOHandler::Event;
 
 	void Event(ConnectState state, const std::string& SenderName) final
 	{
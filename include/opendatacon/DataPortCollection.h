@@ -30,6 +30,7 @@
 
 #include "DataPort.h"
 #include "ResponderMap.h"
+#include "HandlerMonitor.h"
 
 namespace odc
 {
@@ -54,6 +55,11 @@ public:
 				if (auto target = GetTarget(params)) return target->GetStatistics();
 				return IUIResponder::GenerateResult("Bad parameter");
 			},"Returns available statistics from a DataPort");
+		this->AddCommand("HandlerStats", [this](const ParamCollection &params)
+			{
+				if (auto target = GetTarget(params)) return GetHandlerStats(*GetHandlerOwner(target->GetName()));
+				return IUIResponder::GenerateResult("Bad parameter");
+			},"Returns the time spent running handlers for a DataPort, and its fair share queue depth and throttling");
 		this->AddCommand("Status", [this](const ParamCollection &params)
 			{
 				if (auto target = GetTarget(params)) return target->GetStatus();
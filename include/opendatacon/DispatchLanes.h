@@ -0,0 +1,87 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * DispatchLanes.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#ifndef DISPATCHLANES_H_
+#define DISPATCHLANES_H_
+
+#include <opendatacon/asio.h>
+#include <opendatacon/IOTypes.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace odc
+{
+
+//A fixed set of serial lanes that events are dispatched on by point - (source, type, index)
+//	Everything for one point goes through the same lane, so it's handled in the order it was dispatched,
+//	but different points can be handled in parallel by as many threads as the asio_service has
+class DispatchLanes
+{
+public:
+	//owner is who the lanes' run time is attributed to (see HandlerMonitor.h)
+	DispatchLanes(asio_service& ios, const size_t num_lanes, const std::string& owner = "");
+	DispatchLanes(const DispatchLanes&) = delete;
+	DispatchLanes& operator=(const DispatchLanes&) = delete;
+
+	inline size_t Size() const { return Lanes.size(); }
+
+	//Which lane an event's point is handled on
+	inline size_t LaneFor(const EventInfo& event) const
+	{
+		return LaneFor(event.GetSourcePortID(),event.GetEventType(),event.GetIndex());
+	}
+	size_t LaneFor(const SourcePortID_t source, const EventType type, const size_t index) const;
+
+	//Queue fn to run after everything already posted to the same lane
+	//	controls and their results skip ahead of telemetry, like everywhere else
+	inline void Post(const size_t lane, std::function<void()>&& fn, const HandlerPriority priority = HandlerPriority::Normal)
+	{
+		Lanes[lane]->post(std::move(fn),priority);
+	}
+	inline void Post(const EventInfo& event, std::function<void()>&& fn)
+	{
+		Post(LaneFor(event),std::move(fn),IsPriorityEvent(event.GetEventType()) ? HandlerPriority::High : HandlerPriority::Normal);
+	}
+
+	//The events of a batch for one lane, in the order they were in the batch
+	struct SubBatch
+	{
+		size_t Lane;
+		HandlerPriority Priority;
+		EventBatch_t Events;
+	};
+	//Splits a batch by lane (and priority) - post each one to its lane to keep the per point order
+	std::vector<SubBatch> Split(const EventBatch_t& batch) const;
+
+private:
+	std::vector<std::unique_ptr<serial_executor>> Lanes;
+};
+
+} //namespace odc
+
+#endif /* DISPATCHLANES_H_ */
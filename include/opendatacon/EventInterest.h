@@ -0,0 +1,94 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * EventInterest.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#ifndef EVENTINTEREST_H_
+#define EVENTINTEREST_H_
+
+#include <cstdint>
+#include <vector>
+#include <opendatacon/IOTypes.h>
+
+namespace odc
+{
+
+//Describes which events a subscriber wants to see
+//	PublishEvent() doesn't bother delivering anything else
+//	ConnectState events always match, because every subscriber needs to track connections
+class EventInterest
+{
+public:
+	//Interested in everything
+	EventInterest();
+	//Interested in nothing (except ConnectState) - Add() to it from there
+	static EventInterest Nothing();
+
+	//Every index of a type
+	void Add(const EventType type);
+	//A range of indexes of a type (inclusive)
+	void Add(const EventType type, const size_t first, const size_t last);
+	//Everything another EventInterest is interested in
+	void Add(const EventInterest& other);
+
+	inline bool Matches(const EventInfo& event) const
+	{
+		auto bit = TypeBit(event.GetEventType());
+		if(AllIndexes & bit)
+			return true;
+		if(!(Types & bit))
+			return false;
+		return MatchesIndex(event.GetEventType(),event.GetIndex());
+	}
+	inline bool IsEverything() const
+	{
+		return AllIndexes == ~uint64_t(0);
+	}
+
+private:
+	static_assert(static_cast<size_t>(EventType::AfterRange) <= 64, "EventInterest needs a bit for each EventType");
+	static constexpr uint64_t TypeBit(const EventType type)
+	{
+		return uint64_t(1) << static_cast<uint8_t>(type);
+	}
+	bool MatchesIndex(const EventType type, const size_t index) const;
+
+	struct Range
+	{
+		EventType Type;
+		size_t First;
+		size_t Last;
+	};
+
+	//Types with any interest at all
+	uint64_t Types;
+	//Types with interest in every index
+	uint64_t AllIndexes;
+	//Index ranges for the rest, sorted by type then index, and merged where they touch
+	std::vector<Range> Ranges;
+};
+
+} //namespace odc
+
+#endif /* EVENTINTEREST_H_ */
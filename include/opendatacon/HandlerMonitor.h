@@ -0,0 +1,136 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * HandlerMonitor.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#ifndef HANDLERMONITOR_H_
+#define HANDLERMONITOR_H_
+
+#include <json/json.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace odc
+{
+
+//Runtime accounting for the handlers our executors run, attributed to whoever owns them (a port, connector etc.)
+//	Off by default - then a handler only costs a check of a flag
+//	When it's on, a watchdog thread also reports handlers that have been running too long (eg. blocked in a library call)
+
+//Accounting for one owner - registered once, and never freed, so executors can just keep a pointer
+struct HandlerOwner
+{
+	static constexpr size_t NumBuckets = 24;
+
+	explicit HandlerOwner(const std::string& aName):
+		Name(aName)
+	{
+		for(auto& bucket : Histogram)
+			bucket = 0;
+	}
+	const std::string Name;
+	std::atomic<uint64_t> Count{0};
+	std::atomic<uint64_t> TotalNs{0};
+	std::atomic<uint64_t> MaxNs{0};
+	//handlers that took longer than the stall threshold
+	std::atomic<uint64_t> Slow{0};
+	//handlers the watchdog caught still running past the stall threshold
+	std::atomic<uint64_t> Stalls{0};
+	//bucket 0 is under 1us, bucket n is [2^(n-1),2^n) us, the last one is everything longer
+	std::atomic<uint64_t> Histogram[NumBuckets];
+
+	//Fair share (off unless there's a quantum - see SetFairShareQuantum())
+	//	each turn an executor gets Weight quanta of run time before it goes to the back of the line
+	std::atomic<uint32_t> Weight{1};
+	//handlers posted but not yet run - only counted while the monitor or the fair share is on
+	std::atomic<int64_t> QueueDepth{0};
+	std::atomic<int64_t> MaxQueueDepth{0};
+	//turns cut short because the quantum ran out
+	std::atomic<uint64_t> Throttled{0};
+
+	inline void Queued()
+	{
+		auto depth = QueueDepth.fetch_add(1,std::memory_order_relaxed)+1;
+		auto max = MaxQueueDepth.load(std::memory_order_relaxed);
+		while(depth > max && !MaxQueueDepth.compare_exchange_weak(max,depth,std::memory_order_relaxed))
+		{}
+	}
+	inline void Dequeued()
+	{
+		QueueDepth.fetch_sub(1,std::memory_order_relaxed);
+	}
+};
+
+//The accounting for a name - the same pointer every time for the same name
+//	an empty name gets the catch-all "unattributed" owner
+HandlerOwner* GetHandlerOwner(const std::string& name);
+
+//Whose handler the calling thread is running - the "unattributed" owner if none (or the monitor's off)
+HandlerOwner* CurrentHandlerOwner();
+//Runs fn(ctx) in a HandlerScope for pOwner, unless that's who's running already (ie. dispatched inline)
+void RunMonitored(HandlerOwner* pOwner, void (*fn)(void*), void* ctx);
+
+//Turn accounting (and the stall watchdog) on or off
+//	handlers running longer than stall_threshold are logged and counted
+void EnableHandlerMonitor(const std::chrono::milliseconds& stall_threshold, const std::chrono::milliseconds& scan_period);
+void DisableHandlerMonitor();
+bool HandlerMonitorEnabled();
+//Whether executors count their queue depths - only while the monitor or the fair share is on
+bool QueueDepthTracked();
+
+//Fair share between owners: how long an executor may run its handlers before it has to
+//	let others have a turn (times the owner's Weight) - zero (the default) turns it off
+void SetFairShareQuantum(const std::chrono::microseconds& quantum);
+std::chrono::nanoseconds GetFairShareQuantum();
+void SetHandlerWeight(const std::string& name, const uint32_t weight);
+
+//Stats for one owner
+Json::Value GetHandlerStats(const HandlerOwner& owner);
+//Stats for the owners matching a regex (all if it's empty) - throws std::regex_error for a bad regex
+Json::Value GetHandlerStats(const std::string& owner_regex = "");
+void ResetHandlerStats();
+
+//Times a handler for an owner, from construction to destruction
+//	Executors put one around each handler they run
+class HandlerScope
+{
+public:
+	explicit HandlerScope(HandlerOwner* pOwner);
+	~HandlerScope();
+	HandlerScope(const HandlerScope&) = delete;
+	HandlerScope& operator=(const HandlerScope&) = delete;
+private:
+	HandlerOwner* const pOwner;
+	const bool Active;
+	std::chrono::steady_clock::time_point Start;
+	//what the watchdog was watching on this thread before us (if we're nested)
+	int64_t OuterStartNs = 0;
+	HandlerOwner* pOuterOwner = nullptr;
+};
+
+} //namespace odc
+
+#endif /* HANDLERMONITOR_H_ */
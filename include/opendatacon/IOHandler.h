@@ -27,12 +27,19 @@
 #ifndef IOHANDLER_H_
 #define IOHANDLER_H_
 
+#include <chrono>
 #include <functional>
 #include <unordered_map>
 #include <map>
+#include <memory>
+#include <vector>
 #include <atomic>
 #include <opendatacon/asio.h>
+#include <opendatacon/DispatchLanes.h>
 #include <opendatacon/IOTypes.h>
+#include <opendatacon/EventInterest.h>
+#include <opendatacon/PointSnapshot.h>
+#include <opendatacon/ShardedExecutor.h>
 #include <opendatacon/util.h>
 
 namespace odc
@@ -42,6 +49,25 @@ enum class  InitState_t { ENABLED, DISABLED, DELAYED };
 
 typedef std::shared_ptr<std::function<void (CommandStatus status)>> SharedStatusCallback_t;
 
+//A shared callback that does nothing - for when nobody is interested in the result
+const SharedStatusCallback_t& NoOpStatusCallback();
+
+//For APIs that need a command result on the calling thread (eg. opendnp3's ICommandHandler)
+//	Wait() sleeps until the callback fires or times out - it doesn't spin, or run other handlers
+//	The callback is safe to call after Wait() has given up
+class StatusWaiter
+{
+public:
+	StatusWaiter();
+	inline const SharedStatusCallback_t& Callback() const { return pCallback; }
+	//The status the callback was called with, or TIMEOUT
+	CommandStatus Wait(const std::chrono::milliseconds& timeout);
+private:
+	struct State;
+	std::shared_ptr<State> pState;
+	SharedStatusCallback_t pCallback;
+};
+
 //class to synchronise access to connection demand map
 class DemandMap
 {
@@ -67,14 +93,45 @@ public:
 	//Event events
 	virtual void Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) = 0;
 
+	//Batches of events: the status callback is called once for the whole batch
+	//	default unrolls the batch into single Event() calls - override to handle it in one go
+	virtual void Event(const EventBatch_t& batch, const std::string& SenderName, SharedStatusCallback_t pStatusCallback);
+
+	//Which events we'd act on if they were sent to us - for those subscribing on our behalf
+	virtual EventInterest GetEventInterest(){ return EventInterest(); }
+
 	virtual void Enable()=0;
 	virtual void Disable()=0;
 
-	void Subscribe(IOHandler* pIOHandler, std::string aName);
+	//Subscribe to the events we publish
+	//	Interest says which ones it wants - subscribing again replaces it
+	void Subscribe(IOHandler* pIOHandler, std::string aName, EventInterest Interest = EventInterest());
 	void SetIOS(std::shared_ptr<odc::asio_service> ios_ptr);
+	//Run on one shard of a ShardedExecutor (instead of SetIOS)
+	void SetShard(std::shared_ptr<ShardedExecutor> pExecutor, const size_t shard);
+	//Whether the calling thread isn't the one running our shard
+	//	(only ever true when we're on a ShardedExecutor)
+	inline bool OnOtherShard() const
+	{
+		return pShardExecutor && !pShardExecutor->OnShard(Shard);
+	}
+	//Hand fn over to be run by our shard
+	inline void PostToShard(std::function<void()>&& fn, const HandlerPriority priority = HandlerPriority::Normal)
+	{
+		pShardExecutor->Post(Shard,std::move(fn),pHandlerOwner,priority);
+	}
+	//Handle our events on num_lanes serial lanes run by ios_ptr, instead of on the thread that sent them
+	//	events for the same point keep their order, different points are handled in parallel
+	//	(as long as more than one thread runs ios_ptr)
+	//	0 lanes goes back to handling them on the sending thread - only change it before enabling
+	void SetDispatchLanes(std::shared_ptr<odc::asio_service> ios_ptr, const size_t num_lanes);
 
 	inline const std::string& GetName(){return Name;}
 	inline const bool Enabled(){return enabled;}
+	//Last known values of our points - what we've published, and what connectors have sent us
+	//	nullptr unless we keep one (see KeepSnapshot())
+	inline PointSnapshot* GetSnapshot(){return pSnapshot.get();}
+	inline const PointSnapshot* GetSnapshot() const {return pSnapshot.get();}
 	InitState_t InitState;
 	uint16_t EnableDelayms;
 
@@ -85,44 +142,109 @@ protected:
 	std::shared_ptr<odc::asio_service> pIOS;
 	std::atomic_bool enabled;
 
+	//cached handle to the logger for the event path - looking it up every event is too slow
+	static const LogHandle& EventLog()
+	{
+		static const LogHandle handle("opendatacon");
+		return handle;
+	}
+
+	//Keeping the snapshot costs every event we publish or get sent, so only ports that read it turn it on
+	//	call before any events flow (eg. from the constructor or Build())
+	inline void KeepSnapshot()
+	{
+		if(!pSnapshot)
+			pSnapshot = std::make_unique<PointSnapshot>();
+	}
+
 	inline bool InDemand(){ return mDemandMap.InDemand(); }
 	inline bool MuxConnectionEvents(ConnectState state, const std::string& SenderName)
 	{ return mDemandMap.MuxConnectionEvents(state, SenderName); }
 
 	inline void PublishEvent(ConnectState state)
 	{
-		auto event = std::make_shared<EventInfo>(EventType::ConnectState,0,Name);
+		auto event = MakeEvent(EventType::ConnectState,0,Name);
 		event->SetPayload<EventType::ConnectState>(std::move(state));
 		PublishEvent(event);
 	}
 
-	inline void PublishEvent(std::shared_ptr<EventInfo> event, SharedStatusCallback_t pStatusCallback = std::make_shared<std::function<void (CommandStatus status)>>([] (CommandStatus status){}))
+	inline void PublishEvent(std::shared_ptr<EventInfo> event, SharedStatusCallback_t pStatusCallback = NoOpStatusCallback())
 	{
 		if(!pStatusCallback)
-			pStatusCallback = std::make_shared<std::function<void (CommandStatus status)>>([] (CommandStatus status){});
+			pStatusCallback = NoOpStatusCallback();
+		if(pSnapshot)
+			pSnapshot->Update(*event);
 		if(event->GetEventType() == EventType::ConnectState)
 		{
 			//call the special connection Event() function separately,
 			//	so it can keep track of upsteam demand
-			for(auto IOHandler_pair: Subscribers)
+			for(const auto& IOHandler_pair: Subscribers)
 			{
-				IOHandler_pair.second->Event(event->GetPayload<EventType::ConnectState>(), Name);
+				IOHandler_pair.second.pIOHandler->Event(event->GetPayload<EventType::ConnectState>(), Name);
 			}
 		}
-		auto multi_callback = SyncMultiCallback(Subscribers.size(),pStatusCallback);
-		for(auto IOHandler_pair: Subscribers)
+		if(pDispatchLanes)
 		{
-			if(auto log = odc::spdlog_get("opendatacon"))
-				log->trace("{} {} Payload {} Event {} => {}", ToString(event->GetEventType()),event->GetIndex(), event->GetPayloadString(), Name, IOHandler_pair.first);
-			IOHandler_pair.second->Event(event, Name, multi_callback);
+			pDispatchLanes->Post(*event,[this,event,pStatusCallback]()
+				{
+					DeliverEvent(event,pStatusCallback);
+				});
+			return;
 		}
+		DeliverEvent(event,pStatusCallback);
 	}
 
+	//Publish a whole batch of events, with a single call to each (interested) subscriber
+	//	(or a call per dispatch lane, if we have them)
+	void PublishEvent(const EventBatch_t& batch, SharedStatusCallback_t pStatusCallback = NoOpStatusCallback());
+
+	//Wraps pStatusCallback so it's called once, after cb_number results have come in
+	//	the result is UNDEFINED if they don't all agree (and then it's called as soon as they don't)
 	SharedStatusCallback_t SyncMultiCallback (const size_t cb_number, SharedStatusCallback_t pStatusCallback);
 
+	//See SetDispatchLanes() - null unless we have some
+	inline DispatchLanes* GetDispatchLanes() const { return pDispatchLanes.get(); }
+
 private:
-	std::unordered_map<std::string,IOHandler*> Subscribers;
+	inline void DeliverEvent(const std::shared_ptr<EventInfo>& event, const SharedStatusCallback_t& pStatusCallback)
+	{
+		//Only deliver to the subscribers that want it
+		size_t interested = 0;
+		for(const auto& IOHandler_pair: Subscribers)
+			if(IOHandler_pair.second.Interest.Matches(*event))
+				interested++;
+		if(interested == 0 && !Subscribers.empty())
+		{
+			(*pStatusCallback)(CommandStatus::NOT_SUPPORTED);
+			return;
+		}
+
+		auto multi_callback = SyncMultiCallback(interested,pStatusCallback);
+		for(const auto& IOHandler_pair: Subscribers)
+		{
+			if(!IOHandler_pair.second.Interest.Matches(*event))
+				continue;
+			if(auto log = EventLog().ForLevel(spdlog::level::trace))
+				log->trace("{} {} Payload {} Event {} => {}", ToString(event->GetEventType()),event->GetIndex(), event->GetPayloadString(), Name, IOHandler_pair.first);
+			IOHandler_pair.second.pIOHandler->Event(event, Name, multi_callback);
+		}
+	}
+	void DeliverBatch(const EventBatch_t& batch, const SharedStatusCallback_t& pStatusCallback);
+
+	struct Subscriber
+	{
+		IOHandler* pIOHandler;
+		EventInterest Interest;
+	};
+	std::unordered_map<std::string,Subscriber> Subscribers;
 	DemandMap mDemandMap;
+	std::unique_ptr<PointSnapshot> pSnapshot;
+	std::shared_ptr<ShardedExecutor> pShardExecutor;
+	size_t Shard = 0;
+	std::shared_ptr<odc::asio_service> pDispatchIOS;
+	std::unique_ptr<DispatchLanes> pDispatchLanes;
+	//where the time spent in our handlers is accounted (see HandlerMonitor.h)
+	HandlerOwner* pHandlerOwner;
 
 	// Important that this is private - for inter process memory management
 	static std::unordered_map<std::string, IOHandler*> IOHandlers;
@@ -27,9 +27,13 @@
 #ifndef IOTYPES_H_
 #define IOTYPES_H_
 
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <string>
 #include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include <opendatacon/EnumClassFlags.h>
 #include <opendatacon/util.h>
@@ -112,6 +116,12 @@ constexpr EventType operator +( const EventType lhs, const int rhs)
 {
 	return static_cast<EventType>(static_cast<const uint8_t>(lhs) + rhs);
 }
+//Controls and command status - these take the high priority lane, so they don't queue behind telemetry
+constexpr bool IsPriorityEvent(const EventType et)
+{
+	return (et >= EventType::ControlRelayOutputBlock && et <= EventType::AnalogOutputDouble64)
+	       || et == EventType::BinaryCommandEvent || et == EventType::AnalogCommandEvent;
+}
 
 enum class CommandStatus : uint8_t
 {
@@ -464,17 +474,41 @@ EVENTPAYLOAD(EventType::Reserved11               , char) //stub
 EVENTPAYLOAD(EventType::Reserved12               , char) //stub
 //TODO: map the rest
 
+//Fixed size payloads are stored inline in the EventInfo (no allocation)
+//	anything that doesn't fit (eg. OctetString) is heap allocated
+constexpr size_t InlinePayloadSize = 16;
+typedef std::aligned_storage<InlinePayloadSize, alignof(double)>::type InlinePayload_t;
+template<typename T> struct PayloadIsInline
+{
+	static constexpr bool value = std::is_trivially_destructible<T>::value
+	                              && sizeof(T) <= InlinePayloadSize
+	                              && alignof(T) <= alignof(InlinePayload_t);
+};
+
+//Source port names are interned, so events only carry a small ID
+//	The tables live in libODC, so IDs are consistent across modules
+typedef uint32_t SourcePortID_t;
+SourcePortID_t InternSourcePort(const std::string& name);
+const std::string& GetSourcePortName(const SourcePortID_t id);
+
+//Points (source port, type, index) registered at config load get a dense ID (see PointRegistry.h)
+//	Events look theirs up the first time it's asked for, so anything downstream can use it as an array index
+//	(and the ones nobody asks don't pay for the lookup)
+typedef uint32_t PointID_t;
+constexpr PointID_t NoPointID = ~PointID_t(0);
+PointID_t FindPoint(const SourcePortID_t port, const EventType type, const size_t index);
+
 #define DELETEPAYLOADCASE(T)\
 	case T: \
-		delete static_cast<typename EventTypePayload<T>::type*>(pPayload); \
+		DestroyPayload<typename EventTypePayload<T>::type>(); \
 		break;
 #define COPYPAYLOADCASE(T)\
 	case T: \
-		pPayload = static_cast<void*>(new typename EventTypePayload<T>::type(evt.GetPayload<T>())); \
+		EmplacePayload<typename EventTypePayload<T>::type>(evt.GetPayload<T>()); \
 		break;
 #define DEFAULTPAYLOADCASE(T)\
 	case T: \
-		pPayload = static_cast<void*>(new typename EventTypePayload<T>::type()); \
+		EmplacePayload<typename EventTypePayload<T>::type>(); \
 		break;
 
 class EventInfo
@@ -485,21 +519,23 @@ public:
 		msSinceEpoch_t time = msSinceEpoch()):
 		Index(ind),
 		Timestamp(time),
+		SourcePort(InternSourcePort(source)),
+		PointID(UnresolvedPointID),
 		Quality(qual),
-		SourcePort(source),
 		Type(tp),
-		pPayload(nullptr)
+		HasPayload(false)
 	{}
 	//deep copy for payload
 	EventInfo(const EventInfo& evt):
 		Index(evt.Index),
 		Timestamp(evt.Timestamp),
-		Quality(evt.Quality),
 		SourcePort(evt.SourcePort),
+		PointID(evt.PointID.load(std::memory_order_relaxed)),
+		Quality(evt.Quality),
 		Type(evt.Type),
-		pPayload(evt.pPayload)
+		HasPayload(false)
 	{
-		if(pPayload)
+		if(evt.HasPayload)
 		{
 			switch(Type)
 			{
@@ -557,7 +593,7 @@ public:
 
 	~EventInfo()
 	{
-		if(pPayload)
+		if(HasPayload)
 		{
 			switch(Type)
 			{
@@ -622,16 +658,28 @@ public:
 	const size_t& GetIndex() const { return Index; }
 	const msSinceEpoch_t& GetTimestamp() const { return Timestamp; }
 	const QualityFlags& GetQuality() const { return Quality; }
-	const std::string& GetSourcePort() const { return SourcePort; }
+	const std::string& GetSourcePort() const { return GetSourcePortName(SourcePort); }
+	const SourcePortID_t& GetSourcePortID() const { return SourcePort; }
+	PointID_t GetPointID() const
+	{
+		auto id = PointID.load(std::memory_order_relaxed);
+		if(id == UnresolvedPointID)
+		{
+			id = FindPoint(SourcePort,Type,Index);
+			PointID.store(id,std::memory_order_relaxed);
+		}
+		return id;
+	}
+	bool IsPayloadSet() const { return HasPayload; }
 
 	template<EventType t>
 	const typename EventTypePayload<t>::type& GetPayload() const
 	{
 		if(t != Type)
 			throw std::runtime_error("Wrong payload type requested for selected odc::EventInfo");
-		if(!pPayload)
+		if(!HasPayload)
 			throw std::runtime_error("Called GetPayload on uninitialised odc::EventInfo payload");
-		return *static_cast<typename EventTypePayload<t>::type*>(pPayload);
+		return *PayloadPtr<typename EventTypePayload<t>::type>();
 	}
 
 	std::string GetPayloadString() const
@@ -676,25 +724,26 @@ public:
 	}
 
 	//Setters
-	void SetIndex(size_t i){ Index = i; }
+	void SetIndex(size_t i){ Index = i; PointID.store(UnresolvedPointID,std::memory_order_relaxed); }
 	void SetTimestamp(msSinceEpoch_t tm = msSinceEpoch()){ Timestamp = tm; }
 	void SetQuality(QualityFlags q){ Quality = q; }
-	void SetSource(const std::string& s){ SourcePort = s; }
+	void SetSource(const std::string& s){ SourcePort = InternSourcePort(s); PointID.store(UnresolvedPointID,std::memory_order_relaxed); }
 
 	template<EventType t>
 	void SetPayload(typename EventTypePayload<t>::type&& p)
 	{
 		if(t != Type)
 			throw std::runtime_error("Wrong payload type specified for selected odc::EventInfo");
-		if(pPayload)
-			delete static_cast<typename EventTypePayload<t>::type*>(pPayload);
-		pPayload = new typename EventTypePayload<t>::type(std::move(p));
+		if(HasPayload)
+			*PayloadPtr<typename EventTypePayload<t>::type>() = std::move(p);
+		else
+			EmplacePayload<typename EventTypePayload<t>::type>(std::move(p));
 	}
 
 	//Set default payload - mostly for testing
 	void SetPayload()
 	{
-		if(pPayload)
+		if(HasPayload)
 			return;
 		switch(Type)
 		{
@@ -750,14 +799,86 @@ public:
 	}
 
 private:
+	template<typename T>
+	T* PayloadPtr()
+	{
+		return PayloadIsInline<T>::value ? reinterpret_cast<T*>(&Payload.Inline) : static_cast<T*>(Payload.pHeap);
+	}
+	template<typename T>
+	const T* PayloadPtr() const
+	{
+		return PayloadIsInline<T>::value ? reinterpret_cast<const T*>(&Payload.Inline) : static_cast<const T*>(Payload.pHeap);
+	}
+	template<typename T, typename ... Args>
+	void EmplacePayload(Args&& ... args)
+	{
+		if(PayloadIsInline<T>::value)
+			new(&Payload.Inline) T(std::forward<Args>(args)...);
+		else
+			Payload.pHeap = new T(std::forward<Args>(args)...);
+		HasPayload = true;
+	}
+	//inline payloads are trivially destructible, so only the heap ones need anything done
+	template<typename T>
+	void DestroyPayload()
+	{
+		if(!PayloadIsInline<T>::value)
+			delete static_cast<T*>(Payload.pHeap);
+		HasPayload = false;
+	}
+
 	size_t Index;
 	msSinceEpoch_t Timestamp;
+	union
+	{
+		InlinePayload_t Inline;
+		void* pHeap;
+	} Payload;
+	SourcePortID_t SourcePort;
+	//looked up on demand - the registry never hands out this one
+	static constexpr PointID_t UnresolvedPointID = NoPointID-1;
+	mutable std::atomic<PointID_t> PointID;
 	QualityFlags Quality;
-	std::string SourcePort;
 	const EventType Type;
-	void *pPayload;
+	bool HasPayload;
 };
 
+//EventInfo objects (with their shared_ptr control block) come from a pool of fixed size blocks
+//	Each thread keeps its own free list and trades batches with a shared depot,
+//	so in steady state creating and destroying events doesn't touch the general purpose heap
+constexpr size_t EventPoolBlockSize = 64;
+//The block holds the EventInfo and the shared_ptr control block (a vtable pointer and two counts)
+//	anything bigger silently goes to the heap instead, so it has to fit
+static_assert(sizeof(EventInfo)+sizeof(void*)+2*sizeof(int) <= EventPoolBlockSize, "EventInfo has outgrown the event pool blocks");
+void* EventPoolAllocate(const size_t size);
+void EventPoolFree(void* p, const size_t size);
+//Number of times (process wide) the pool has had to go to the heap for a block
+uint64_t EventPoolHeapAllocations();
+
+template<typename T>
+class EventInfoAllocator
+{
+public:
+	typedef T value_type;
+	EventInfoAllocator() = default;
+	template<typename U> EventInfoAllocator(const EventInfoAllocator<U>&){}
+	T* allocate(size_t n){ return static_cast<T*>(EventPoolAllocate(n*sizeof(T))); }
+	void deallocate(T* p, size_t n){ EventPoolFree(p,n*sizeof(T)); }
+};
+template<typename T, typename U>
+bool operator==(const EventInfoAllocator<T>&, const EventInfoAllocator<U>&){ return true; }
+template<typename T, typename U>
+bool operator!=(const EventInfoAllocator<T>&, const EventInfoAllocator<U>&){ return false; }
+
+//Use instead of std::make_shared<EventInfo>
+template<typename ... Args>
+inline std::shared_ptr<EventInfo> MakeEvent(Args&& ... args)
+{
+	return std::allocate_shared<EventInfo>(EventInfoAllocator<EventInfo>(),std::forward<Args>(args)...);
+}
+
+typedef std::vector<std::shared_ptr<const EventInfo>> EventBatch_t;
+
 }
 
 #endif
@@ -0,0 +1,98 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * IOUring.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#ifndef IOURING_H_
+#define IOURING_H_
+
+#include <opendatacon/asio.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace odc
+{
+
+//Socket reads and writes through a Linux io_uring, instead of an epoll wakeup and syscall per operation
+//	-- Submissions queue up in the ring and go to the kernel together, in one syscall per burst
+//	-- Reads are multishot - armed once per socket, and the kernel picks from a registered pool of
+//		buffers for each chunk, until the socket closes
+//	-- Completions are handed back through the serial_executor you give, so they run on the asio_service
+//	Create() returns nullptr on platforms, builds or kernels (before 6.0) that can't do all that
+//	Only the data path goes through the ring - connect, accept etc. are still up to asio
+//	Sockets are Register()ed with the ring once they're connected, and their ops name the socket itself,
+//		so an op that's still queued when the socket's closed can never land on a new one that gets the same fd
+//	Shut the socket down to end a recv() - closing the fd isn't enough, because the ring holds a reference
+//	Whatever's still going when the ring's destroyed is cancelled, and its handlers aren't called
+class io_uring_service
+{
+public:
+	//data is only good until the handler returns, and is empty with the final (error) call
+	//	the end of the stream is asio::error::eof
+	typedef std::function<void(const asio::error_code& err, const char* data, size_t len)> recv_handler_t;
+	typedef std::function<void(const asio::error_code& err, size_t n)> send_handler_t;
+
+	//A socket's place in the ring (see Register()) - empty if it hasn't got one
+	struct file_t
+	{
+		int slot = -1;
+		uint32_t generation = 0;
+		explicit operator bool() const
+		{
+			return slot >= 0;
+		}
+	};
+
+	//entries is the submission queue size,
+	//	num_buffers x buffer_size is the read buffer pool shared by all the sockets,
+	//	and max_files is how many sockets can be registered at once (no more than the open file limit)
+	static std::shared_ptr<io_uring_service> Create(std::shared_ptr<asio_service> pIOS,
+		const unsigned int entries = 4096, const unsigned int num_buffers = 1024, const unsigned int buffer_size = 16*1024,
+		const unsigned int max_files = 32768);
+	//One to share, created on first use (nullptr if it can't be)
+	static std::shared_ptr<io_uring_service> Shared(std::shared_ptr<asio_service> pIOS);
+
+	virtual ~io_uring_service() = default;
+
+	//Register a connected socket, to recv() and send() on
+	//	Returns an empty file_t if there's no room left (use asio for that one instead)
+	virtual file_t Register(const int fd) = 0;
+	//Call when the socket's closed - anything started on file after that fails with bad_descriptor
+	virtual void Unregister(const file_t& file) = 0;
+
+	//Read from file until there's an error, or the end of the stream
+	virtual void recv(const file_t& file, serial_executor& executor, const recv_handler_t& handler) = 0;
+	//Write all of bufs to file in one gather write - they have to stay valid until the handler's called
+	virtual void send(const file_t& file, const std::vector<asio::const_buffer>& bufs, serial_executor& executor, const send_handler_t& handler) = 0;
+
+	//How many times we've called into the kernel to submit, and how much went with them
+	virtual size_t SubmitCalls() const = 0;
+	virtual size_t Submitted() const = 0;
+};
+
+} //namespace odc
+
+#endif /* IOURING_H_ */
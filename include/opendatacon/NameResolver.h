@@ -0,0 +1,70 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * NameResolver.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#ifndef NAMERESOLVER_H_
+#define NAMERESOLVER_H_
+
+#include <opendatacon/asio.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace odc
+{
+
+//Host name resolution for the whole process, that never blocks the asio_service
+//	Lookups run on the resolver's own threads, so a slow DNS server only holds up whoever's waiting on it
+//	Everyone asking for the same host and port at once shares the one lookup,
+//	and the answer is reused until it's older than the cache time
+//	If looking a host up again fails, the old answer is still given out rather than an error
+//	Numeric addresses and ports don't need looking up at all
+
+typedef std::vector<asio::ip::tcp::endpoint> tcp_endpoints_t;
+typedef std::function<void(const asio::error_code& err, const tcp_endpoints_t& endpoints)> ResolveHandler_t;
+//Does the actual lookup - it's allowed to block
+typedef std::function<tcp_endpoints_t(const std::string& host, const std::string& port, asio::error_code& err)> NameLookup_t;
+
+//Look up host and port, then post handler to pIOS with the result
+//	endpoints is never empty unless err is set
+void AsyncResolve(const std::shared_ptr<asio_service>& pIOS, const std::string& host, const std::string& port, const ResolveHandler_t& handler);
+
+//How long an answer is reused for (default 60s) - zero looks up every time (but still shares lookups in progress)
+void SetResolveCacheTime(const std::chrono::steady_clock::duration& cache_time);
+void ClearResolveCache();
+
+//Replace the system lookup (getaddrinfo) - eg. with a stand-in for testing
+//	nullptr puts the system lookup back. Clears the cache either way
+void SetNameLookup(const NameLookup_t& lookup);
+
+//How many lookups have actually been done - ie. not answered from the cache, or by one already in progress
+uint64_t NameLookupCount();
+
+} //namespace odc
+
+#endif /* NAMERESOLVER_H_ */
@@ -0,0 +1,59 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * PointRegistry.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#ifndef POINTREGISTRY_H_
+#define POINTREGISTRY_H_
+
+#include <opendatacon/IOTypes.h>
+
+namespace odc
+{
+
+//Every (port, event type, index) that a port declares in its config gets a dense 32 bit ID
+//	Ports register their points when they're built, so the registry is complete before anything is enabled
+//	After that, FindPoint() (and EventInfo::GetPointID()) is just a few array lookups, without locks
+//	The tables live in libODC, so IDs are consistent across modules
+
+struct PointInfo
+{
+	SourcePortID_t Port;
+	EventType Type;
+	size_t Index;
+};
+
+//Returns the existing ID if the point is already registered
+//	Returns NoPointID if the index is too big (see MaxRegisteredIndex)
+PointID_t RegisterPoint(const std::string& port, const EventType type, const size_t index);
+//Metadata for an ID from RegisterPoint() - throws if it isn't one
+const PointInfo& GetPointInfo(const PointID_t id);
+//IDs are 0 to PointCount()-1
+size_t PointCount();
+
+constexpr size_t MaxRegisteredIndex = (size_t(1)<<24)-1;
+
+} //namespace odc
+
+#endif /* POINTREGISTRY_H_ */
@@ -0,0 +1,104 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * PointSnapshot.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#ifndef POINTSNAPSHOT_H_
+#define POINTSNAPSHOT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <opendatacon/IOTypes.h>
+
+namespace odc
+{
+
+//The last known value of each point of a port
+//	Kept as flat arrays per event type, indexed by point index
+//	Updates and reads don't take locks: each point is a seqlock, so readers just retry if they race a writer
+//	Only measurement types are kept. The matching quality events (eg. AnalogQuality) update the quality of a known point
+class PointSnapshot
+{
+public:
+	PointSnapshot();
+	~PointSnapshot();
+	PointSnapshot(const PointSnapshot&) = delete;
+	PointSnapshot& operator=(const PointSnapshot&) = delete;
+
+	//Whether events of this type change the snapshot
+	static bool Stores(const EventType type);
+
+	void Update(const EventInfo& event);
+	inline void Update(const EventBatch_t& batch)
+	{
+		for(const auto& event : batch)
+			Update(*event);
+	}
+
+	//The last known value of a point, or nullptr if we've never seen one
+	std::shared_ptr<EventInfo> Get(const EventType type, const size_t index) const;
+	//Whether we've seen a value for a point, without building an event for it
+	bool Has(const EventType type, const size_t index) const;
+	//Every known point of a type, in index order
+	EventBatch_t GetEvents(const EventType type) const;
+	//Every known point
+	EventBatch_t GetEvents() const;
+	//Whether we've never seen a point
+	bool Empty() const;
+
+	//Points with an index beyond this aren't kept
+	static constexpr size_t MaxIndex = (size_t(1)<<20)-1;
+
+private:
+	struct Slot
+	{
+		//odd while being written, zero if never written
+		std::atomic<uint32_t> Seq{0};
+		std::atomic<uint32_t> Quality{0};
+		std::atomic<uint64_t> Value{0};
+		std::atomic<uint64_t> Timestamp{0};
+		std::atomic<uint32_t> SourcePort{0};
+	};
+	static constexpr size_t ChunkSize = 256;
+	static constexpr size_t MaxChunks = (MaxIndex+1)/ChunkSize;
+	struct Chunk
+	{
+		Slot Slots[ChunkSize];
+	};
+	//Chunks are allocated as points turn up, and never moved or freed until we're destroyed
+	struct Table
+	{
+		std::atomic<Chunk*> Chunks[MaxChunks];
+	};
+	static constexpr size_t NumTables = 7;
+	std::atomic<Table*> Tables[NumTables];
+
+	Slot* GetSlot(const size_t table, const size_t index, const bool create);
+	const Slot* GetSlot(const size_t table, const size_t index) const;
+	std::shared_ptr<EventInfo> Read(const size_t table, const Slot& slot, const size_t index) const;
+};
+
+} //namespace odc
+
+#endif /* POINTSNAPSHOT_H_ */
@@ -0,0 +1,115 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * ShardedExecutor.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#ifndef SHARDEDEXECUTOR_H_
+#define SHARDEDEXECUTOR_H_
+
+#include <opendatacon/asio.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace odc
+{
+
+struct HandlerOwner;
+
+//A set of asio_services (shards) that are each run by a single thread
+//	Pinning everything a port does to one shard keeps its handlers on one core,
+//	and the shards don't contend on a shared handler queue
+//	Work for another shard goes through that shard's lock-free mailbox
+class ShardedExecutor
+{
+public:
+	//cpu_sets[i] is the set of CPUs the thread for shard i may run on (missing or empty means no affinity)
+	explicit ShardedExecutor(const size_t num_shards, const std::vector<std::vector<unsigned int>>& cpu_sets = {});
+	//Stops, and waits for the shards to run out of work
+	~ShardedExecutor();
+	ShardedExecutor(const ShardedExecutor&) = delete;
+	ShardedExecutor& operator=(const ShardedExecutor&) = delete;
+
+	inline size_t Size() const { return Shards.size(); }
+	inline const std::shared_ptr<asio_service>& GetShard(const size_t shard) const { return Shards.at(shard)->pIOS; }
+	//The shard to use for something (eg. a port) by name, when it isn't pinned explicitly
+	size_t ShardFor(const std::string& name) const;
+
+	//Whether the calling thread is the one running a shard
+	inline bool OnShard(const size_t shard) const
+	{
+		return CurrentExecutor() == this && CurrentShard() == shard;
+	}
+	//Queue fn to run on a shard, in order with everything else posted to it in the same lane
+	//	High priority handlers run before any Normal ones still waiting
+	//	pOwner is who its run time is attributed to, if the HandlerMonitor is on
+	void Post(const size_t shard, std::function<void()>&& fn, HandlerOwner* pOwner = nullptr,
+		const HandlerPriority priority = HandlerPriority::Normal);
+	//Run fn straight away if we're already on the shard, otherwise Post() it
+	inline void Dispatch(const size_t shard, std::function<void()>&& fn, const HandlerPriority priority = HandlerPriority::Normal)
+	{
+		if(OnShard(shard))
+			fn();
+		else
+			Post(shard,std::move(fn),nullptr,priority);
+	}
+
+	//Start a thread for each shard
+	void Start();
+	//Let the shards run out of work - the threads finish once everything outstanding is done
+	void Stop();
+	void Join();
+
+private:
+	struct MailboxNode
+	{
+		std::function<void()> fn;
+		HandlerOwner* pOwner;
+		MailboxNode* next;
+	};
+	struct Shard
+	{
+		std::shared_ptr<asio_service> pIOS;
+		std::unique_ptr<asio::io_service::work> pWork;
+		std::vector<unsigned int> CPUs;
+		//producers push on the front, the shard takes the whole list at once
+		std::atomic<MailboxNode*> Mailbox{nullptr};
+		std::atomic<MailboxNode*> PriorityMailbox{nullptr};
+		std::thread Thread;
+	};
+	std::vector<std::unique_ptr<Shard>> Shards;
+
+	void Drain(Shard& shard);
+	static MailboxNode* TakeInOrder(std::atomic<MailboxNode*>& mailbox);
+
+	static const ShardedExecutor*& CurrentExecutor();
+	static size_t& CurrentShard();
+};
+
+} //namespace odc
+
+#endif /* SHARDEDEXECUTOR_H_ */
@@ -29,26 +29,52 @@
 //Helper class for managing access to a TCP socket, either as server or client
 //Usage:
 //	-- Construct
-//	-- Call Open()
+//	-- Call Open() - the end point is looked up without blocking (see NameResolver.h)
+//		Open() connects straight away - it's up to the caller to pace it, like DataConcentrator does when it enables ports
+//		Automatic reconnects are paced with everyone else's (see ConnectionPacing.h)
 //	-- Wait for a connection (state callback)
 //	-- Data will continuously be read from socket if available and passed to the read callback, unitl the socket is closed
-//	-- Optionally Write() to the socket. Data will be buffered if the connection isn't open.
+//		(either in a streambuf, or in place if you construct with a SpanReadCallback_t)
+//	-- Optionally Write() to the socket. Writes queue, and go out together in one gather write when they can.
+//		Data will be buffered if the connection isn't open.
+//	-- Optionally SetWriteHighWater() to be told when writes are queueing up faster than they go out
 //	-- If the socket closes for any reason you'll get a state callback
 //	-- Call Close() to intentionally close the socket 8-)
+//	-- As a server, optionally SetMultiClient() before Open() to serve more than one client at a time
+//	-- Optionally SetIOUring() before Open() to read and write through io_uring instead of asio
 
 #ifndef TCPSOCKETMANAGER
 #define TCPSOCKETMANAGER
 
 #include <opendatacon/asio.h>
+#include <opendatacon/ConnectionPacing.h>
+#include <opendatacon/IOUring.h>
+#include <opendatacon/NameResolver.h>
 #include <opendatacon/Platform.h>
-#include <string>
+#include <opendatacon/util.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
 #include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 
 namespace odc
 {
 
 typedef asio::basic_streambuf<std::allocator<char>> buf_t;
+//Alternative read handler that's given the unconsumed bytes in place - no copying into a streambuf
+//	returns how many bytes it used from the front - the rest get handed over again with the next read
+//	(the pointer is only good until it returns)
+typedef std::function<size_t(const char* data, size_t len)> SpanReadCallback_t;
+//Same again, but says which session it's from (see SetMultiClient())
+typedef std::function<size_t(size_t session, const char* data, size_t len)> SessionReadCallback_t;
 
 //buffer to track a data container
 //T must be a container with a data(), size() and get_allocator() members
@@ -102,31 +128,33 @@ public:
 		const std::function<void(buf_t&)>& aReadCallback, //Handler for data read off socket
 		const std::function<void(bool)>& aStateCallback,  //Handler for communicating the connection state of the socket
 		const size_t abuffer_limit                        //
-		      = std::numeric_limits<size_t>::max(),       //maximum number of writes to buffer
+		      = std::numeric_limits<size_t>::max(),       //maximum number of writes to queue (connected or not) - see Write()
 		const bool aauto_reopen = false,                  //Keeps the socket open (retry on error), unless you explicitly Close() it
-		const uint16_t aretry_time_ms = 0,                //You can specify a fixed retry time if auto_open is enabled, zero means exponential backoff
+		const uint16_t aretry_time_ms = 0,                //You can specify a retry time if auto_open is enabled (randomised between half and all of it), zero means randomised exponential backoff
 		const bool useKeepalives = true,                  //Set TCP keepalive socket option
 		const unsigned int KeepAliveTimeout_s = 599,      //TCP keepalive idle timeout (seconds)
 		const unsigned int KeepAliveRetry_s = 10,         //TCP keepalive retry interval (seconds)
 		const unsigned int KeepAliveFailcount = 3):       //TCP keepalive fail count
-		isConnected(false),
-		manuallyClosed(true),
-		pIOS(apIOS),
-		isServer(aisServer),
-		ReadCallback(aReadCallback),
-		StateCallback(aStateCallback),
-		Keepalives(useKeepalives,KeepAliveTimeout_s,KeepAliveRetry_s,KeepAliveFailcount),
-		pSock(pIOS->make_tcp_socket()),
-		pReadStrand(pIOS->make_strand()),
-		pWriteStrand(pIOS->make_strand()),
-		pSockStrand(pIOS->make_strand()),
-		pRetryTimer(pIOS->make_steady_timer()),
-		buffer_limit(abuffer_limit),
-		auto_reopen(aauto_reopen),
-		retry_time_ms(aretry_time_ms),
-		ramp_time_ms(0),
-		EndpointIterator(pIOS->make_tcp_resolver()->resolve(aEndPoint,aPort)),
-		pAcceptor(nullptr)
+		TCPSocketManager(apIOS,aisServer,aEndPoint,aPort,aReadCallback,nullptr,aStateCallback,
+			abuffer_limit,aauto_reopen,aretry_time_ms,useKeepalives,KeepAliveTimeout_s,KeepAliveRetry_s,KeepAliveFailcount)
+	{}
+	//Same as above, but reads are handed over in place (see SpanReadCallback_t) instead of in a streambuf
+	TCPSocketManager
+		(std::shared_ptr<odc::asio_service> apIOS,
+		const bool aisServer,
+		const std::string& aEndPoint,
+		const std::string& aPort,
+		const SpanReadCallback_t& aSpanReadCallback,
+		const std::function<void(bool)>& aStateCallback,
+		const size_t abuffer_limit = std::numeric_limits<size_t>::max(),
+		const bool aauto_reopen = false,
+		const uint16_t aretry_time_ms = 0,
+		const bool useKeepalives = true,
+		const unsigned int KeepAliveTimeout_s = 599,
+		const unsigned int KeepAliveRetry_s = 10,
+		const unsigned int KeepAliveFailcount = 3):
+		TCPSocketManager(apIOS,aisServer,aEndPoint,aPort,nullptr,aSpanReadCallback,aStateCallback,
+			abuffer_limit,aauto_reopen,aretry_time_ms,useKeepalives,KeepAliveTimeout_s,KeepAliveRetry_s,KeepAliveFailcount)
 	{}
 
 	void Open()
@@ -134,69 +162,132 @@ public:
 		pSockStrand->post([this]()
 			{
 				manuallyClosed = false;
-				if(isConnected)
+				if(opening || (multi_client ? !!pAcceptor : isConnected))
 					return;
-				if(isServer)
-				{
-				      pAcceptor = pIOS->make_tcp_acceptor(EndpointIterator);
-				      pAcceptor->async_accept(*pSock,[this](asio::error_code err_code)
-						{
-							ConnectCompletionHandler(err_code);
-							pAcceptor.reset();
-						});
-				}
-				else
-				{
-				      pSock->async_connect(*EndpointIterator,[this](asio::error_code err_code)
-						{
-							ConnectCompletionHandler(err_code);
-						});
-				}
+				Resolve(false);
 			});
 	}
+	//who the socket handlers' run time is attributed to (see HandlerMonitor.h), and who to log failures as
+	void SetOwner(const std::string& owner)
+	{
+		pReadStrand->set_owner(owner);
+		pWriteStrand->set_owner(owner);
+		pSockStrand->set_owner(owner);
+		pSockStrand->post([this,owner]()
+			{
+				Owner = owner;
+			});
+	}
+	//Server only - call before Open()
+	//	Keep accepting clients (up to max_sessions at once - any more are closed straight away),
+	//	instead of serving one at a time. Each session gets its own read buffer and write queue.
+	//	Write() goes to every session, sharing the one buffer (or waits for the first one, if there aren't any). WriteTo() goes to just one.
+	//	The state callback passed to the constructor says when the first session connects and the last one goes.
+	//	SessionRead and SessionState (if set) are told which session - SessionRead is used in place of the read callback.
+	//	Reads from all sessions are still handed over one at a time.
+	void SetMultiClient(const size_t amax_sessions,
+		const SessionReadCallback_t& SessionRead = nullptr,
+		const std::function<void(size_t session, bool)>& SessionState = nullptr)
+	{
+		if(!isServer)
+			throw std::invalid_argument("SetMultiClient is only for servers");
+		if(amax_sessions == 0)
+			throw std::invalid_argument("SetMultiClient needs at least one session");
+		multi_client = true;
+		max_sessions = amax_sessions;
+		SessionReadCallback = SessionRead;
+		SessionStateCallback = SessionState;
+	}
+	//Do the reads and writes through a ring (see IOUring.h) instead of asio - call before Open()
+	//	connecting and accepting are still done by asio
+	void SetIOUring(std::shared_ptr<io_uring_service> apRing)
+	{
+		pRing = apRing;
+	}
+	size_t SessionCount() const
+	{
+		return session_count;
+	}
 	void Close()
 	{
 		pSockStrand->post([this]()
 			{
 				manuallyClosed = true;
-				ramp_time_ms = 0;
+				backing_off = false;
+				Backoff.Reset();
 				pRetryTimer->cancel();
 				pAcceptor.reset();
+				if(multi_client)
+				{
+				      //the reads will fail and close the sessions properly
+				      for(auto& s : sessions)
+						CloseSocket(*s.second->pSock,s.second->file);
+				      return;
+				}
 				AutoClose();
 			});
 	}
 
+	//Each write goes out whole - never interleaved with another
+	//	High priority writes (eg. controls) go ahead of any normal ones still waiting
+	//	With SetMultiClient(), it goes to all the sessions connected at the time
+	//	Writes queue while there's nothing to send them to (not connected, or no sessions yet), and while the socket's busy
+	//	No more than buffer_limit are kept in a queue, connected or not - past that, the oldest normal priority one is dropped
 	template <typename T>
-	void Write(T&& aContainer)
+	void Write(T&& aContainer, const HandlerPriority priority = HandlerPriority::Normal)
 	{
 		//shared_const_buffer is a ref counted wraper that will delete the data in good time
 		auto buf = shared_const_buffer<T>(std::make_shared<T>(std::move(aContainer)));
 
-		pSockStrand->post([this,buf]()
+		pWriteStrand->post([this,buf,priority]()
 			{
-				if(!isConnected)
+				if(multi_client && !write_sessions.empty())
 				{
-				      pWriteStrand->post([this,buf]()
-						{
-							writebufs.push_back(buf);
-							if(writebufs.size() > buffer_limit)
-								writebufs.erase(writebufs.begin());
-						});
+				      for(auto& s : write_sessions)
+				      {
+				            s.second->writeq.Push(buf,priority,buffer_limit);
+				            SendSession(s.second);
+					}
+				      CheckBackpressure();
 				      return;
 				}
+				//the multi client server keeps it in our own queue for the first session
+				QueueWrite(buf,priority);
+				if(!multi_client)
+					SendQueued();
+			},priority);
+	}
+	//Write to just one session - same as Write() unless SetMultiClient()
+	//	dropped if the session's gone
+	template <typename T>
+	void WriteTo(const size_t session, T&& aContainer, const HandlerPriority priority = HandlerPriority::Normal)
+	{
+		if(!multi_client)
+			return Write(std::forward<T>(aContainer),priority);
 
-				asio::async_write(*pSock,buf,asio::transfer_all(),pWriteStrand->wrap([this,buf](asio::error_code err_code, std::size_t n)
-						{
-							if(err_code)
-							{
-							      writebufs.push_back(buf);
-							      if(writebufs.size() > buffer_limit)
-									writebufs.erase(writebufs.begin());
-							      AutoClose();
-							      AutoOpen();
-							      return;
-							}
-						}));
+		auto buf = shared_const_buffer<T>(std::make_shared<T>(std::move(aContainer)));
+
+		pWriteStrand->post([this,session,buf,priority]()
+			{
+				auto it = write_sessions.find(session);
+				if(it == write_sessions.end())
+					return;
+				it->second->writeq.Push(buf,priority,buffer_limit);
+				SendSession(it->second);
+				CheckBackpressure();
+			},priority);
+	}
+	//Call Backpressure(true) when more than high_water bytes are waiting to be written,
+	//	then Backpressure(false) once it's back down to half that
+	//	(with SetMultiClient(), it's the most backed up session that counts)
+	//	Called from the write strand, so don't Write() from it and wait
+	void SetWriteHighWater(const size_t high_water, const std::function<void(bool)>& Backpressure)
+	{
+		pWriteStrand->post([this,high_water,Backpressure]()
+			{
+				write_high_water = high_water;
+				BackpressureCallback = Backpressure;
+				CheckBackpressure();
 			});
 	}
 
@@ -206,74 +297,450 @@ public:
 	}
 
 private:
+	TCPSocketManager
+		(std::shared_ptr<odc::asio_service> apIOS,
+		const bool aisServer,
+		const std::string& aEndPoint,
+		const std::string& aPort,
+		const std::function<void(buf_t&)>& aReadCallback,
+		const SpanReadCallback_t& aSpanReadCallback,
+		const std::function<void(bool)>& aStateCallback,
+		const size_t abuffer_limit,
+		const bool aauto_reopen,
+		const uint16_t aretry_time_ms,
+		const bool useKeepalives,
+		const unsigned int KeepAliveTimeout_s,
+		const unsigned int KeepAliveRetry_s,
+		const unsigned int KeepAliveFailcount):
+		isConnected(false),
+		manuallyClosed(true),
+		pIOS(apIOS),
+		isServer(aisServer),
+		ReadCallback(aReadCallback),
+		SpanReadCallback(aSpanReadCallback),
+		StateCallback(aStateCallback),
+		Keepalives(useKeepalives,KeepAliveTimeout_s,KeepAliveRetry_s,KeepAliveFailcount),
+		pSock(pIOS->make_tcp_socket()),
+		pReadStrand(pIOS->make_serial_executor()),
+		pWriteStrand(pIOS->make_serial_executor()),
+		pSockStrand(pIOS->make_serial_executor()),
+		pRetryTimer(pIOS->make_steady_timer()),
+		buffer_limit(abuffer_limit),
+		auto_reopen(aauto_reopen),
+		retry_time_ms(aretry_time_ms),
+		Backoff(aretry_time_ms ? std::chrono::milliseconds(aretry_time_ms/2) : std::chrono::milliseconds(125),
+			aretry_time_ms ? std::chrono::milliseconds(aretry_time_ms) : std::chrono::seconds(30)),
+		EndPoint(aEndPoint),
+		Port(aPort),
+		pAcceptor(nullptr)
+	{}
+
+	//Outbound queue for one connection - only touched on the write strand
+	struct WriteQueue
+	{
+		std::deque<shared_const_buffer<Q>> bufs;
+		//how many at the front of bufs are high priority
+		size_t num_priority = 0;
+		//taken off the front of the queue for the gather write in progress (empty if there isn't one)
+		std::vector<shared_const_buffer<Q>> sending;
+		size_t num_priority_sending = 0;
+		//bytes in bufs and sending
+		size_t queued_bytes = 0;
+		//more than this many buffers per gather write just holds up the next high priority one
+		static constexpr size_t max_gather = 64;
+
+		//high priority writes go out first (but stay in order amongst themselves)
+		//	no more than limit are kept - the oldest telemetry is dropped first
+		void Push(const shared_const_buffer<Q>& buf, const HandlerPriority priority, const size_t limit)
+		{
+			if(priority == HandlerPriority::High)
+				bufs.insert(bufs.begin()+num_priority++,buf);
+			else
+				bufs.push_back(buf);
+			queued_bytes += asio::buffer_size(buf);
+			if(bufs.size() > limit)
+			{
+				auto drop = bufs.begin();
+				if(num_priority < bufs.size())
+					drop += num_priority;
+				else
+					num_priority--;
+				queued_bytes -= asio::buffer_size(*drop);
+				bufs.erase(drop);
+			}
+		}
+		//Take the next gather write's worth off the front - false if there's one going already, or nothing to send
+		bool TakeSending()
+		{
+			if(!sending.empty() || bufs.empty())
+				return false;
+			const size_t n = bufs.size() < max_gather ? bufs.size() : max_gather;
+			sending.assign(bufs.begin(),bufs.begin()+n);
+			bufs.erase(bufs.begin(),bufs.begin()+n);
+			num_priority_sending = std::min(num_priority,n);
+			num_priority -= num_priority_sending;
+			return true;
+		}
+		//n bytes of the gather write went out - if it failed, put the rest back where they came from
+		//	(any high priority ones that came in since still go ahead of the normal ones)
+		void Sent(const bool failed, size_t n)
+		{
+			auto sent = std::move(sending);
+			sending.clear();
+			size_t done = 0;
+			for(; done < sent.size() && n >= asio::buffer_size(sent[done]); done++)
+			{
+				n -= asio::buffer_size(sent[done]);
+				queued_bytes -= asio::buffer_size(sent[done]);
+			}
+			if(failed && done < sent.size())
+			{
+				auto num_priority_left = num_priority_sending > done ? num_priority_sending-done : 0;
+				bufs.insert(bufs.begin()+num_priority,sent.begin()+done+num_priority_left,sent.end());
+				bufs.insert(bufs.begin(),sent.begin()+done,sent.begin()+done+num_priority_left);
+				num_priority += num_priority_left;
+			}
+		}
+		void Clear()
+		{
+			bufs.clear();
+			num_priority = 0;
+			queued_bytes = 0;
+			for(auto& buf : sending)
+				queued_bytes += asio::buffer_size(buf);
+		}
+	};
+
+	//Reusable buffer for span reads - the bytes not consumed yet are [begin,end)
+	struct SpanBuffer
+	{
+		std::vector<char> buf;
+		size_t begin = 0;
+		size_t end = 0;
+		static constexpr size_t initial_size = 64*1024;
+		//don't bother reading into less space than this - shuffle down or grow instead
+		static constexpr size_t min_read = 4*1024;
+
+		//The free space at the end, to read into
+		asio::mutable_buffer Space()
+		{
+			if(buf.size() - end < min_read)
+			{
+				const auto unused = end - begin;
+				if(buf.size() - unused >= min_read)
+				{
+					//shuffle what the consumer's still waiting on down to the start
+					std::memmove(buf.data(),buf.data()+begin,unused);
+				}
+				else
+				{
+					//the consumer's waiting on most of the buffer (or it's the first read)
+					std::vector<char> bigger(buf.empty() ? initial_size : buf.size()*2);
+					std::memcpy(bigger.data(),buf.data()+begin,unused);
+					buf.swap(bigger);
+				}
+				begin = 0;
+				end = unused;
+			}
+			return asio::buffer(buf.data()+end,buf.size()-end);
+		}
+		//n bytes were read into Space(), then the consumer uses some from the front
+		template<typename F>
+		void Fill(const size_t n, const F& Consumer)
+		{
+			end += n;
+			Consume(Consumer);
+		}
+		template<typename F>
+		void Consume(const F& Consumer)
+		{
+			const size_t used = Consumer(buf.data()+begin,end-begin);
+			begin += std::min(used,end-begin);
+			if(begin == end)
+				begin = end = 0;
+		}
+		//Hand over data that was read somewhere else
+		//	in place if there's nothing left over from before - only what the consumer doesn't use gets copied
+		template<typename F>
+		void Deliver(const char* data, size_t len, const F& Consumer)
+		{
+			if(begin != end)
+			{
+				Append(data,len);
+				Consume(Consumer);
+				return;
+			}
+			const size_t used = std::min(Consumer(data,len),len);
+			Append(data+used,len-used);
+		}
+		void Append(const char* data, size_t len)
+		{
+			while(len > 0)
+			{
+				auto space = Space();
+				const size_t n = std::min(len,asio::buffer_size(space));
+				std::memcpy(buf.data()+end,data,n);
+				end += n;
+				data += n;
+				len -= n;
+			}
+		}
+		void Clear()
+		{
+			begin = end = 0;
+		}
+	};
+
+	//One client of a multi client server
+	struct Session
+	{
+		Session(const size_t id, odc::asio_service& IOS):
+			id(id),
+			pSock(IOS.make_tcp_socket())
+		{}
+		const size_t id;
+		std::unique_ptr<asio::ip::tcp::socket> pSock;
+		//its place in the ring, if there is one - set when it's accepted
+		io_uring_service::file_t file;
+		//only touched on the read strand
+		buf_t readbuf;
+		SpanBuffer span;
+		//only touched on the write strand
+		WriteQueue writeq;
+	};
+
 	bool isConnected;
 	bool manuallyClosed;
 	std::shared_ptr<odc::asio_service> pIOS;
 	const bool isServer;
 	const std::function<void(buf_t&)> ReadCallback;
+	const SpanReadCallback_t SpanReadCallback;
 	const std::function<void(bool)> StateCallback;
 	TCPKeepaliveOpts Keepalives;
 
 	buf_t readbuf;
-	std::vector<shared_const_buffer<Q>> writebufs;
+	//only touched on the read strand
+	SpanBuffer span;
+
+	//only touched on the write strand
+	WriteQueue writeq;
+	//whether the socket is connected, as far as writes are concerned
+	bool writable = false;
+	//the connection's place in the ring, as far as writes are concerned
+	io_uring_service::file_t write_file;
+	//counts connections, so a write that fails after a reconnect doesn't close the new connection
+	size_t write_generation = 0;
+	size_t write_high_water = std::numeric_limits<size_t>::max();
+	bool backpressured = false;
+	std::function<void(bool)> BackpressureCallback;
+
+	//Multi client server state - see SetMultiClient()
+	bool multi_client = false;
+	size_t max_sessions = 1;
+	SessionReadCallback_t SessionReadCallback;
+	std::function<void(size_t, bool)> SessionStateCallback;
+	//the same sessions, one for each strand - so the sockets and writes don't wait on each other
+	std::map<size_t,std::shared_ptr<Session>> sessions;       //sock strand
+	std::map<size_t,std::shared_ptr<Session>> write_sessions; //write strand
+	size_t next_session_id = 0;
+	std::atomic<size_t> session_count{0};
+
 	std::unique_ptr<asio::ip::tcp::socket> pSock;
 
 	//Strand to sync access to read buffer
-	std::unique_ptr<asio::io_service::strand> pReadStrand;
+	std::unique_ptr<odc::serial_executor> pReadStrand;
 	//Strand to sync access to write buffers
-	std::unique_ptr<asio::io_service::strand> pWriteStrand;
+	std::unique_ptr<odc::serial_executor> pWriteStrand;
 	//Strand to sync access to socket state
-	std::unique_ptr<asio::io_service::strand> pSockStrand;
+	std::unique_ptr<odc::serial_executor> pSockStrand;
 
 	//for timing open-retries
-	std::unique_ptr<asio::steady_timer> pRetryTimer;
+	std::unique_ptr<odc::steady_timer> pRetryTimer;
 
 	size_t buffer_limit;
 
 	//Auto open funtionality - see constructor for description
 	bool auto_reopen;
 	uint16_t retry_time_ms;
-	uint16_t ramp_time_ms; //keep track of exponential backoff
+	odc::DecorrelatedJitter Backoff;
+	//whether the next retry waits (always, if there's a retry time), or goes straight away
+	bool backing_off = false;
 
-	//Host/IP and Port are resolved into these:
-	asio::ip::tcp::resolver::iterator EndpointIterator;
+	//Host/IP and Port - looked up each time it's opened
+	const std::string EndPoint;
+	const std::string Port;
+	//between Open() and when it's listening, or the connect finishes
+	bool opening = false;
 	std::unique_ptr<asio::ip::tcp::acceptor> pAcceptor;
 
+	//reads and writes go through this instead, if it's set
+	std::shared_ptr<io_uring_service> pRing;
+	//the connection's place in the ring - only touched on the sock strand
+	io_uring_service::file_t ring_file;
+
+	//for the logs - only touched on the sock strand
+	std::string Owner;
+	//only the first of a run of failures to open is logged as a warning, the rest are debug
+	bool open_failing = false;
+	void LogOpenFailure(const char* what, const asio::error_code& err_code)
+	{
+		auto lvl = open_failing ? spdlog::level::debug : spdlog::level::warn;
+		open_failing = true;
+		if(auto log = odc::spdlog_get("opendatacon"))
+			log->log(lvl,"{}: Failed to {} {}:{} : '{}'{}", Owner.empty() ? "TCPSocketManager" : Owner, what, EndPoint, Port, err_code.message(),
+				auto_reopen && !manuallyClosed ? " - retrying" : "");
+	}
+
+	//Shut it down first if it's on the ring - the ring holds the fd open, and any reads would never finish
+	//	then take it out, so nothing that's still queued for it can go anywhere else
+	void CloseSocket(asio::ip::tcp::socket& sock, const io_uring_service::file_t& file = io_uring_service::file_t())
+	{
+		asio::error_code ignored;
+		if(file)
+		{
+			sock.shutdown(asio::ip::tcp::socket::shutdown_both,ignored);
+			pRing->Unregister(file);
+		}
+		sock.close(ignored);
+	}
+	//The ring only takes sockets once they're connected - anything it can't take uses asio (only call from the sock strand)
+	io_uring_service::file_t RegisterSocket(asio::ip::tcp::socket& sock)
+	{
+		if(!pRing)
+			return io_uring_service::file_t();
+		return pRing->Register(sock.native_handle());
+	}
+
+	//Queue a write - only call from the write strand
+	void QueueWrite(const shared_const_buffer<Q>& buf, const HandlerPriority priority)
+	{
+		writeq.Push(buf,priority,buffer_limit);
+		CheckBackpressure();
+	}
+	//Start one gather write of what's at the front of the queue, if there isn't one already going
+	//	- only call from the write strand
+	void SendQueued()
+	{
+		if(!writable || !writeq.TakeSending())
+			return;
+
+		const auto generation = write_generation;
+		if(write_file)
+		{
+			pRing->send(write_file,std::vector<asio::const_buffer>(writeq.sending.begin(),writeq.sending.end()),*pWriteStrand,[this,generation](const asio::error_code& err_code, std::size_t n)
+				{
+					WriteCompletionHandler(err_code,n,generation);
+				});
+			return;
+		}
+		asio::async_write(*pSock,writeq.sending,asio::transfer_all(),pWriteStrand->wrap([this,generation](asio::error_code err_code, std::size_t n)
+				{
+					WriteCompletionHandler(err_code,n,generation);
+				}));
+	}
+	void WriteCompletionHandler(asio::error_code err_code, std::size_t n, const size_t generation)
+	{
+		//what made it out in full doesn't need sending again, the rest waits for when we're connected again
+		writeq.Sent(!!err_code,n);
+		if(err_code && generation == write_generation)
+		{
+			writable = false;
+			AutoClose();
+			AutoOpen();
+		}
+		CheckBackpressure();
+		SendQueued();
+	}
+	void CheckBackpressure()
+	{
+		size_t queued_bytes = writeq.queued_bytes;
+		for(auto& s : write_sessions)
+			queued_bytes = std::max(queued_bytes,s.second->writeq.queued_bytes);
+
+		if(!backpressured && queued_bytes > write_high_water)
+		{
+			backpressured = true;
+			if(BackpressureCallback)
+				BackpressureCallback(true);
+		}
+		else if(backpressured && queued_bytes <= write_high_water/2)
+		{
+			backpressured = false;
+			if(BackpressureCallback)
+				BackpressureCallback(false);
+		}
+	}
 	void ConnectCompletionHandler(asio::error_code err_code)
 	{
 		if(err_code)
 		{
-			//TODO: implement logging
+			pSockStrand->dispatch([this,err_code]()
+				{
+					LogOpenFailure(isServer ? "accept on" : "connect to",err_code);
+				});
 			AutoOpen();
 			return;
 		}
 
 		pSockStrand->post([this]()
 			{
+				open_failing = false;
 				SetTCPKeepalives(*pSock,Keepalives.enabled,Keepalives.idle_timeout_s,Keepalives.retry_interval_s,Keepalives.fail_count);
 				isConnected = true;
+				session_count = 1;
+				ring_file = RegisterSocket(*pSock);
 				StateCallback(isConnected);
-				ramp_time_ms = 0;
-				//if there's anything in the buffer sequence, write it
-				pWriteStrand->post([this]()
+				backing_off = false;
+				Backoff.Reset();
+				//if there's anything queued, write it
+				const auto file = ring_file;
+				pWriteStrand->post([this,file]()
 					{
-						if(writebufs.size() > 0)
-						{
-						      auto n = asio::write(*pSock,writebufs,asio::transfer_all());
-						      if(n == 0)
-						      {
-						            AutoClose();
-						            AutoOpen();
-						            return;
-							}
-						      writebufs.clear();
-						}
+						writable = true;
+						write_file = file;
+						write_generation++;
+						SendQueued();
 					});
-				Read();
+				Read(file);
 			});
 	}
-	void Read()
+	//Reads go through the ring if the connection's registered with it, otherwise asio
+	void Read(const io_uring_service::file_t& file = io_uring_service::file_t())
 	{
+		if(file)
+		{
+			pReadStrand->post([this,file]()
+				{
+					span.Clear();
+					//one multishot read for the whole connection
+					pRing->recv(file,*pReadStrand,[this](const asio::error_code& err_code, const char* data, size_t len)
+						{
+							if(err_code)
+							{
+							      AutoClose();
+							      AutoOpen();
+							}
+							else if(SpanReadCallback)
+								span.Deliver(data,len,SpanReadCallback);
+							else
+							{
+							      readbuf.commit(asio::buffer_copy(readbuf.prepare(len),asio::buffer(data,len)));
+							      ReadCallback(readbuf);
+							}
+						});
+				});
+			return;
+		}
+		if(SpanReadCallback)
+		{
+			pReadStrand->post([this]()
+				{
+					//anything left over was from the last connection
+					span.Clear();
+					ReadSpan();
+				});
+			return;
+		}
 		asio::async_read(*pSock, readbuf, asio::transfer_at_least(1), pReadStrand->wrap([this](asio::error_code err_code, std::size_t n)
 				{
 					if(err_code)
@@ -288,6 +755,22 @@ private:
 					}
 				}));
 	}
+	//Read straight into the free space at the end of the span buffer - only call from the read strand
+	//	one read takes whatever the socket has, up to all the free space
+	void ReadSpan()
+	{
+		pSock->async_read_some(span.Space(), pReadStrand->wrap([this](asio::error_code err_code, std::size_t n)
+				{
+					if(err_code)
+					{
+					      AutoClose();
+					      AutoOpen();
+					      return;
+					}
+					span.Fill(n,SpanReadCallback);
+					ReadSpan();
+				}));
+	}
 	void AutoOpen()
 	{
 		pSockStrand->post([this]()
@@ -295,29 +778,91 @@ private:
 				if(!auto_reopen || manuallyClosed)
 					return;
 
-				if(retry_time_ms != 0)
+				//straight back in the first time, unless there's a retry time
+				if(!backing_off && retry_time_ms == 0)
 				{
-				      ramp_time_ms = retry_time_ms;
+				      backing_off = true;
+				      Reopen();
+				      return;
 				}
-
-				if(ramp_time_ms == 0)
+				backing_off = true;
+				pRetryTimer->expires_from_now(Backoff.Next());
+				pRetryTimer->async_wait(pSockStrand->wrap([this](asio::error_code err_code)
+					{
+						if (err_code != asio::error::operation_aborted)
+							Reopen();
+					}));
+			});
+	}
+	//Like Open(), but it doesn't undo a Close(), and a client waits its turn to connect - only call from the sock strand
+	void Reopen()
+	{
+		if(manuallyClosed || opening || (multi_client ? !!pAcceptor : isConnected))
+			return;
+		Resolve(true);
+	}
+	//Look up the end point, then listen or connect - only call from the sock strand
+	//	It's looked up every time, so a host that moves gets picked up once the cache times out
+	//	paced is for reconnects - see ConnectionPacing.h
+	void Resolve(const bool paced)
+	{
+		opening = true;
+		odc::AsyncResolve(pIOS,EndPoint,Port,pSockStrand->wrap([this,paced](const asio::error_code& err_code, const odc::tcp_endpoints_t& endpoints)
+			{
+				if(manuallyClosed)
 				{
-				      ramp_time_ms = 125;
-				      Open();
+				      opening = false;
+				      return;
 				}
-				else
+				if(err_code)
 				{
-				      pRetryTimer->expires_from_now(std::chrono::milliseconds(ramp_time_ms));
-				      pRetryTimer->async_wait([this](asio::error_code err_code)
-						{
-							if (err_code != asio::error::operation_aborted)
-							{
-							      ramp_time_ms *= 2;
-							      Open();
-							}
-						});
+				      opening = false;
+				      LogOpenFailure("resolve",err_code);
+				      AutoOpen();
+				      return;
 				}
-			});
+				const auto endpoint = endpoints.front();
+				if(isServer)
+				{
+				      Listen(endpoint);
+				      return;
+				}
+				if(paced)
+					odc::PaceConnect(pIOS,pSockStrand->wrap([this,endpoint](){ Connect(endpoint); }));
+				else
+					Connect(endpoint);
+			}));
+	}
+	//Only call from the sock strand
+	void Connect(const asio::ip::tcp::endpoint& endpoint)
+	{
+		if(manuallyClosed)
+		{
+			opening = false;
+			return;
+		}
+		pSock->async_connect(endpoint,pSockStrand->wrap([this](asio::error_code err_code)
+			{
+				opening = false;
+				ConnectCompletionHandler(err_code);
+			}));
+	}
+	//Only call from the sock strand
+	void Listen(const asio::ip::tcp::endpoint& endpoint)
+	{
+		pAcceptor = pIOS->make_tcp_acceptor(endpoint);
+		if(multi_client)
+		{
+			opening = false;
+			Accept();
+			return;
+		}
+		pAcceptor->async_accept(*pSock,pSockStrand->wrap([this](asio::error_code err_code)
+			{
+				opening = false;
+				ConnectCompletionHandler(err_code);
+				pAcceptor.reset();
+			}));
 	}
 	void AutoClose()
 	{
@@ -327,14 +872,192 @@ private:
 				{
 				      return;
 				}
-				pSock->close();
+				CloseSocket(*pSock,ring_file);
+				ring_file = io_uring_service::file_t();
 				isConnected = false;
+				session_count = 0;
+				pWriteStrand->post([this]()
+					{
+						writable = false;
+						write_file = io_uring_service::file_t();
+					});
 				StateCallback(isConnected);
 			});
 	}
+
+	//Multi client server - accept the next session, only call from the sock strand
+	void Accept()
+	{
+		auto pSession = std::make_shared<Session>(next_session_id++,*pIOS);
+		pAcceptor->async_accept(*pSession->pSock,pSockStrand->wrap([this,pSession](asio::error_code err_code)
+			{
+				if(err_code)
+				{
+				      if(err_code == asio::error::operation_aborted || !pAcceptor)
+						return;
+				      if(auto log = odc::spdlog_get("opendatacon"))
+						log->error("{}: Failed to accept a session on {}:{} : '{}' - retrying", Owner.empty() ? "TCPSocketManager" : Owner, EndPoint, Port, err_code.message());
+				      //try again in a bit - the error could be something like running out of file descriptors
+				      pRetryTimer->expires_from_now(std::chrono::milliseconds(retry_time_ms ? retry_time_ms : 125));
+				      pRetryTimer->async_wait(pSockStrand->wrap([this](asio::error_code err_code)
+						{
+							if(!err_code && pAcceptor)
+								Accept();
+						}));
+				      return;
+				}
+				if(sessions.size() >= max_sessions)
+				{
+				      CloseSocket(*pSession->pSock);
+				      Accept();
+				      return;
+				}
+				SetTCPKeepalives(*pSession->pSock,Keepalives.enabled,Keepalives.idle_timeout_s,Keepalives.retry_interval_s,Keepalives.fail_count);
+				pSession->file = RegisterSocket(*pSession->pSock);
+				sessions[pSession->id] = pSession;
+				session_count = sessions.size();
+				if(!isConnected)
+				{
+				      isConnected = true;
+				      StateCallback(isConnected);
+				}
+				if(SessionStateCallback)
+					SessionStateCallback(pSession->id,true);
+				pWriteStrand->post([this,pSession]()
+					{
+						//whatever was written while nobody was connected goes to the first session
+						if(write_sessions.empty())
+						{
+						      std::swap(pSession->writeq,writeq);
+						      SendSession(pSession);
+						}
+						write_sessions[pSession->id] = pSession;
+					});
+				pReadStrand->post([this,pSession]()
+					{
+						ReadSession(pSession);
+					});
+				Accept();
+			}));
+	}
+	//only call from the read strand
+	void ReadSession(const std::shared_ptr<Session>& pSession)
+	{
+		if(pSession->file)
+		{
+			pRing->recv(pSession->file,*pReadStrand,[this,pSession](const asio::error_code& err_code, const char* data, size_t len)
+				{
+					if(err_code)
+						CloseSession(pSession);
+					else if(SessionReadCallback)
+					{
+					      const auto id = pSession->id;
+					      pSession->span.Deliver(data,len,[this,id](const char* data, size_t len)
+							{
+								return SessionReadCallback(id,data,len);
+							});
+					}
+					else if(SpanReadCallback)
+						pSession->span.Deliver(data,len,SpanReadCallback);
+					else
+					{
+					      pSession->readbuf.commit(asio::buffer_copy(pSession->readbuf.prepare(len),asio::buffer(data,len)));
+					      ReadCallback(pSession->readbuf);
+					}
+				});
+			return;
+		}
+		if(!SessionReadCallback && !SpanReadCallback)
+		{
+			asio::async_read(*pSession->pSock, pSession->readbuf, asio::transfer_at_least(1), pReadStrand->wrap([this,pSession](asio::error_code err_code, std::size_t n)
+					{
+						if(err_code)
+						{
+						      CloseSession(pSession);
+						      return;
+						}
+						ReadCallback(pSession->readbuf);
+						ReadSession(pSession);
+					}));
+			return;
+		}
+		pSession->pSock->async_read_some(pSession->span.Space(), pReadStrand->wrap([this,pSession](asio::error_code err_code, std::size_t n)
+				{
+					if(err_code)
+					{
+					      CloseSession(pSession);
+					      return;
+					}
+					if(SessionReadCallback)
+					{
+					      const auto id = pSession->id;
+					      pSession->span.Fill(n,[this,id](const char* data, size_t len)
+							{
+								return SessionReadCallback(id,data,len);
+							});
+					}
+					else
+						pSession->span.Fill(n,SpanReadCallback);
+					ReadSession(pSession);
+				}));
+	}
+	//only call from the write strand
+	void SendSession(const std::shared_ptr<Session>& pSession)
+	{
+		if(!pSession->writeq.TakeSending())
+			return;
+		if(pSession->file)
+		{
+			pRing->send(pSession->file,std::vector<asio::const_buffer>(pSession->writeq.sending.begin(),pSession->writeq.sending.end()),*pWriteStrand,
+				[this,pSession](const asio::error_code& err_code, std::size_t n)
+				{
+					SessionWriteCompletionHandler(pSession,err_code,n);
+				});
+			return;
+		}
+		asio::async_write(*pSession->pSock,pSession->writeq.sending,asio::transfer_all(),pWriteStrand->wrap([this,pSession](asio::error_code err_code, std::size_t n)
+				{
+					SessionWriteCompletionHandler(pSession,err_code,n);
+				}));
+	}
+	void SessionWriteCompletionHandler(const std::shared_ptr<Session>& pSession, asio::error_code err_code, std::size_t n)
+	{
+		pSession->writeq.Sent(!!err_code,n);
+		if(err_code)
+		{
+			//the session's not coming back - nothing left to send it
+			pSession->writeq.Clear();
+			write_sessions.erase(pSession->id);
+			CloseSession(pSession);
+		}
+		else
+			SendSession(pSession);
+		CheckBackpressure();
+	}
+	void CloseSession(const std::shared_ptr<Session>& pSession)
+	{
+		pSockStrand->post([this,pSession]()
+			{
+				if(!sessions.erase(pSession->id))
+					return;
+				CloseSocket(*pSession->pSock,pSession->file);
+				session_count = sessions.size();
+				pWriteStrand->post([this,pSession]()
+					{
+						write_sessions.erase(pSession->id);
+						CheckBackpressure();
+					});
+				if(SessionStateCallback)
+					SessionStateCallback(pSession->id,false);
+				if(sessions.empty())
+				{
+				      isConnected = false;
+				      StateCallback(isConnected);
+				}
+			});
+	}
 };
 
 } //namespace odc
 
 #endif // TCPSOCKETMANAGER
-
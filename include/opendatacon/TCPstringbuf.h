@@ -43,6 +43,7 @@ public:
 		pIOS = apIOS;
 		pSockMan = std::make_unique<TCPSocketManager<std::string>>(apIOS,aisServer,aEndPoint,aPort,
 			[](buf_t& readbuf){},[](bool state){},1000,true);
+		pSockMan->SetOwner("TCPLog");
 		pSockMan->Open();
 	}
 	void DeInit()
@@ -0,0 +1,70 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * ThreadBudget.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+
+#ifndef THREADBUDGET_H_
+#define THREADBUDGET_H_
+
+#include <json/json.h>
+#include <cstddef>
+#include <vector>
+
+namespace odc
+{
+
+//How many threads each pool in the process gets, so together they don't oversubscribe the machine
+//	Set once from the "Threads" config section before any ports are built - ports that run
+//	their own thread pools (eg. DNP3Port's opendnp3 stack) size them from here
+struct ThreadBudget
+{
+	//threads running ODC's asio_service (or the number of executor shards)
+	size_t Workers;
+	//threads for protocol stacks that bring their own pool
+	size_t ProtocolWorkers;
+	//threads writing out async log messages
+	size_t LogWorkers;
+	//CPUs each pool may run on (empty means no affinity)
+	std::vector<unsigned int> WorkerCPUs;
+	std::vector<unsigned int> ProtocolCPUs;
+	std::vector<unsigned int> LogCPUs;
+};
+
+//What we get without a "Threads" config: workers and protocol threads sized to the machine, 3 log threads
+ThreadBudget DefaultThreadBudget();
+//Starts from the defaults and overrides whatever is in the config:
+//	"Threads" : {"Workers":4, "ProtocolWorkers":2, "LogWorkers":1, "CPUAffinity": <affinity>}
+//	where <affinity> is an array of CPUs for all the pools,
+//	or {"Workers":[CPUs], "Protocol":[CPUs], "Log":[CPUs]}
+ThreadBudget ParseThreadBudget(const Json::Value& JSONThreads);
+void SetThreadBudget(const ThreadBudget& budget);
+ThreadBudget GetThreadBudget();
+
+//Restrict the calling thread to a set of CPUs
+//	returns false if it's not supported or fails - an empty set always succeeds (does nothing)
+bool SetCurrentThreadAffinity(const std::vector<unsigned int>& cpus);
+
+} //namespace odc
+
+#endif /* THREADBUDGET_H_ */
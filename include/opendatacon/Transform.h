@@ -30,6 +30,9 @@
 #include <opendatacon/IOHandler.h>
 #include <opendatacon/IOTypes.h>
 #include <json/json.h>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
 #include <string>
 
 namespace odc
@@ -38,12 +41,85 @@ namespace odc
 class Transform
 {
 public:
-	Transform(const Json::Value& params): params(params){}
+	Transform(const Json::Value& params):
+		Transform(params,false)
+	{}
 	virtual ~Transform(){}
 
 	virtual bool Event(std::shared_ptr<EventInfo> event) = 0;
 
+	//Called by the connector once the ports are built (so their points are registered), before any events
+	//	with the name of the port this transform gets events from
+	virtual void Build(const std::string& SenderName){}
+
+	//Whether Event() needs to see this event at all
+	//	anything else is passed on without calling Event()
+	inline bool AppliesTo(const EventInfo& event) const
+	{
+		return (EventTypeMask & TypeBit(event.GetEventType()))
+		       && event.GetIndex() >= MinIndex && event.GetIndex() <= MaxIndex;
+	}
+
+	//Filter-only transforms (see FilterTransform) just pass or block events, they never change them
+	//	so they can be given the original event instead of a copy
+	inline bool IsFilterOnly() const { return FilterOnly; }
+
 	Json::Value params;
+
+protected:
+	//Derived transforms narrow down what they apply to in their constructors
+	//	the default is every event
+	inline void AppliesToTypes(std::initializer_list<EventType> types)
+	{
+		EventTypeMask = 0;
+		for(auto type : types)
+			EventTypeMask |= TypeBit(type);
+	}
+	inline void AppliesToIndexes(const size_t min, const size_t max)
+	{
+		MinIndex = min;
+		MaxIndex = max;
+	}
+
+private:
+	friend class FilterTransform;
+	Transform(const Json::Value& params, const bool filter_only):
+		params(params),
+		EventTypeMask(AllEventTypes),
+		MinIndex(0),
+		MaxIndex(std::numeric_limits<size_t>::max()),
+		FilterOnly(filter_only)
+	{}
+
+	static_assert(static_cast<size_t>(EventType::AfterRange) <= 64, "Transform EventTypeMask needs a bit for each EventType");
+	static constexpr uint64_t AllEventTypes = ~uint64_t(0);
+	static constexpr uint64_t TypeBit(const EventType type)
+	{
+		return uint64_t(1) << static_cast<uint8_t>(type);
+	}
+
+	uint64_t EventTypeMask;
+	size_t MinIndex;
+	size_t MaxIndex;
+	bool FilterOnly;
+};
+
+//A transform that only passes or blocks events
+//	it gets a read-only look at the event, so the connector can share the original
+class FilterTransform: public Transform
+{
+public:
+	FilterTransform(const Json::Value& params):
+		Transform(params,true)
+	{}
+
+	//Whether to pass the event on
+	virtual bool Filter(const EventInfo& event) = 0;
+
+	bool Event(std::shared_ptr<EventInfo> event) final
+	{
+		return Filter(*event);
+	}
 };
 
 }
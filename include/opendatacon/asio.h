@@ -36,6 +36,11 @@
 #define ASIO_HAS_CHRONO
 
 #include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <utility>
 
 //use these to suppress warnings
 typedef struct
@@ -49,6 +54,101 @@ typedef struct
 namespace odc
 {
 
+class serial_executor;
+class ShardedExecutor;
+struct HandlerOwner;
+struct VirtualClock;
+
+//The parts of HandlerMonitor.h the asio_service needs
+bool HandlerMonitorEnabled();
+HandlerOwner* CurrentHandlerOwner();
+void RunMonitored(HandlerOwner* pOwner, void (*fn)(void*), void* ctx);
+
+//Which lane a handler queues in - High (controls and their results) always runs before Normal (telemetry)
+//	handlers in the same lane still run in the order they're posted
+enum class HandlerPriority: uint8_t
+{
+	Normal,
+	High
+};
+
+//Whether virtual time is on, and what the time is - there's only the one, in libODC
+struct VirtualTime
+{
+	std::atomic_bool enabled{false};
+	std::atomic<std::chrono::steady_clock::rep> now{0};
+};
+VirtualTime& GetVirtualTime();
+
+//The clock for asio_service timers - normally just std::chrono::steady_clock,
+//	but in virtual time it only moves when it's told to, so simulations and tests
+//	can run hours worth of timers in seconds
+//	Its time_points are steady_clock ones, so deadlines from either clock can be mixed
+struct asio_clock
+{
+	typedef std::chrono::steady_clock::duration duration;
+	typedef duration::rep rep;
+	typedef duration::period period;
+	typedef std::chrono::steady_clock::time_point time_point;
+	static constexpr bool is_steady = true;
+	//inline, because it's on every timer and every pacing decision
+	static time_point now() noexcept
+	{
+		static const VirtualTime& virtual_time = GetVirtualTime();
+		if(virtual_time.enabled.load(std::memory_order_acquire))
+			return time_point(duration(virtual_time.now.load(std::memory_order_acquire)));
+		return std::chrono::steady_clock::now();
+	}
+};
+
+//Virtual time is for the whole process (every asio_service), so only switch it before any timers are set
+//	The clock starts from the real time, then only moves forward with run_virtual() or AdvanceVirtualTime()
+void EnableVirtualTime();
+void DisableVirtualTime();
+bool VirtualTimeEnabled();
+void AdvanceVirtualTime(const asio_clock::duration& d);
+
+//How long asio actually waits for a timer - in virtual time, either not at all (it's due),
+//	or until the clock is moved (which wakes every asio_service up to check again)
+struct asio_wait_traits
+{
+	static asio_clock::duration to_wait_duration(const asio_clock::duration& d);
+	static asio_clock::duration to_wait_duration(const asio_clock::time_point& t);
+};
+
+//Keeps track of when timers are waiting for in virtual time, so run_virtual() knows where to move the clock
+struct VirtualWait
+{
+	asio_clock::time_point expiry;
+	uint64_t id;
+};
+VirtualWait VirtualWaitStart(const asio_clock::time_point& expiry);
+void VirtualWaitEnd(const VirtualWait& wait);
+
+//What make_steady_timer() makes - an asio timer on the asio_clock
+class steady_timer: public asio::basic_waitable_timer<asio_clock,asio_wait_traits>
+{
+	typedef asio::basic_waitable_timer<asio_clock,asio_wait_traits> base_t;
+public:
+	using base_t::base_t;
+
+	template<typename WaitHandler>
+	void async_wait(WaitHandler&& handler)
+	{
+		if(!VirtualTimeEnabled())
+		{
+			base_t::async_wait(std::forward<WaitHandler>(handler));
+			return;
+		}
+		auto wait = VirtualWaitStart(expires_at());
+		base_t::async_wait([wait,h = std::forward<WaitHandler>(handler)](const asio::error_code& err) mutable
+			{
+				VirtualWaitEnd(wait);
+				h(err);
+			});
+	}
+};
+
 //This thin wrapper/factory class for asio::io_service is important
 //because it forces asio services to be created in the libODC memory
 //space, avoiding problems that come from transferring ownership of objects
@@ -56,38 +156,156 @@ namespace odc
 class asio_service: private asio::io_service
 {
 public:
-	asio_service():
-		asio::io_service()
-	{}
-	asio_service(int concurrency_hint):
-		asio::io_service(concurrency_hint)
-	{}
+	asio_service();
+	asio_service(int concurrency_hint);
+	~asio_service();
 
 	using asio::io_service::poll;
 	using asio::io_service::poll_one;
 	using asio::io_service::run;
 	using asio::io_service::run_one;
-	using asio::io_service::post;
-	using asio::io_service::dispatch;
 	using asio::io_service::stopped;
 
+	//Handlers posted straight to the service (rather than through an executor) are still timed
+	//	when the HandlerMonitor is on - for pOwner, or by default whoever's handler posted them
+	template<typename Handler>
+	void post(Handler&& handler, HandlerOwner* pOwner = nullptr)
+	{
+		if(HandlerMonitorEnabled())
+			asio::io_service::post(Monitored(std::forward<Handler>(handler),pOwner));
+		else
+			asio::io_service::post(std::forward<Handler>(handler));
+	}
+	template<typename Handler>
+	void dispatch(Handler&& handler, HandlerOwner* pOwner = nullptr)
+	{
+		if(HandlerMonitorEnabled())
+			asio::io_service::dispatch(Monitored(std::forward<Handler>(handler),pOwner));
+		else
+			asio::io_service::dispatch(std::forward<Handler>(handler));
+	}
+
 	//TODO: delete next line - noone should call stop
 	using asio::io_service::stop;
 
+	//Runs handlers on the calling thread in virtual time (see EnableVirtualTime()), as fast as they'll go
+	//	whenever nothing is ready to run, the clock jumps straight to when the next timer is due
+	//	Returns when there's nothing left to run and no timers waiting, or the clock would pass 'until'
+	//	Only deterministic if it's the only thing running handlers
+	size_t run_virtual(const asio_clock::time_point& until = asio_clock::time_point::max());
+	size_t run_virtual_for(const asio_clock::duration& d)
+	{
+		return run_virtual(asio_clock::now()+d);
+	}
+
 	std::unique_ptr<asio::io_service::work> make_work();
+	//Prefer make_serial_executor() - strands share a fixed pool of implementations,
+	//	so unrelated strands can end up serialising each other
 	std::unique_ptr<asio::io_service::strand> make_strand();
-	std::unique_ptr<asio::steady_timer> make_steady_timer();
-	std::unique_ptr<asio::steady_timer> make_steady_timer(std::chrono::steady_clock::duration t);
-	std::unique_ptr<asio::steady_timer> make_steady_timer(std::chrono::steady_clock::time_point t);
+	//owner is who the handlers' run time is attributed to, if the HandlerMonitor is on
+	std::unique_ptr<serial_executor> make_serial_executor(const std::string& owner = "");
+	std::unique_ptr<steady_timer> make_steady_timer();
+	std::unique_ptr<steady_timer> make_steady_timer(std::chrono::steady_clock::duration t);
+	std::unique_ptr<steady_timer> make_steady_timer(std::chrono::steady_clock::time_point t);
 	std::unique_ptr<asio::ip::tcp::resolver> make_tcp_resolver();
 	std::unique_ptr<asio::ip::tcp::socket> make_tcp_socket();
 	std::unique_ptr<asio::ip::tcp::acceptor> make_tcp_acceptor(asio::ip::tcp::resolver::iterator EndPoint);
+	std::unique_ptr<asio::ip::tcp::acceptor> make_tcp_acceptor(const asio::ip::tcp::endpoint& EndPoint);
 	std::unique_ptr<asio::ip::tcp::acceptor> make_tcp_acceptor();
 	std::unique_ptr<asio::ip::udp::resolver> make_udp_resolver();
 	std::unique_ptr<asio::ip::udp::socket> make_udp_socket();
 
 private:
 	asio::io_service* const unwrap_this = static_cast<asio::io_service*>(this);
+	friend struct VirtualClock;
+
+	template<typename Handler>
+	static auto Monitored(Handler&& handler, HandlerOwner* pOwner)
+	{
+		if(!pOwner)
+			pOwner = CurrentHandlerOwner();
+		return [h = std::forward<Handler>(handler),pOwner]() mutable
+		       {
+			       RunMonitored(pOwner,[](void* ctx){ (*static_cast<decltype(h)*>(ctx))(); },&h);
+		       };
+	}
+	//for the executors, which time each of their handlers themselves
+	template<typename Handler>
+	void post_unmonitored(Handler&& handler)
+	{
+		asio::io_service::post(std::forward<Handler>(handler));
+	}
+	friend class serial_executor;
+	friend class ShardedExecutor;
+};
+
+//Runs handlers one at a time, in the order they're posted - like a strand,
+//	but every instance has its own queue, so it can never be held up by another one
+//	Handlers queue on a lock-free list, and the executor only occupies an
+//	asio_service thread while it has something to run
+//	Copies share the same queue
+class serial_executor
+{
+public:
+	explicit serial_executor(asio_service& ios, const std::string& owner = "");
+	//Attribute our handlers' run time to someone else (see HandlerMonitor.h)
+	void set_owner(const std::string& owner);
+
+	//Queue fn to run after everything already posted to the same lane
+	//	High priority handlers jump ahead of all the Normal ones still waiting
+	void post(std::function<void()> fn, const HandlerPriority priority = HandlerPriority::Normal);
+	//Run fn now if we're already in a handler of this executor, otherwise post it
+	void dispatch(std::function<void()> fn, const HandlerPriority priority = HandlerPriority::Normal);
+	//The same, but attributed to pOwner instead of the executor's owner - for an executor shared between ports
+	void post(std::function<void()> fn, HandlerOwner* pOwner, const HandlerPriority priority = HandlerPriority::Normal);
+	void dispatch(std::function<void()> fn, HandlerOwner* pOwner, const HandlerPriority priority = HandlerPriority::Normal);
+	//Whether the calling thread is currently running one of our handlers
+	bool running_in_this_thread() const;
+
+	//Wrap a completion handler so it's dispatched through this executor
+	template<typename Handler>
+	auto wrap(Handler handler)
+	{
+		return [self = *this, handler](const auto&... args) mutable
+		       {
+			       self.dispatch(std::bind(handler,args...));
+		       };
+	}
+
+private:
+	struct Node
+	{
+		std::function<void()> fn;
+		//who it was posted for
+		HandlerOwner* pOwner;
+		Node* next;
+		//whether it was counted in the owner's QueueDepth (see HandlerMonitor.h)
+		bool counted;
+	};
+	struct Queue
+	{
+		Queue(asio_service& ios, HandlerOwner* pOwner):
+			ios(ios),
+			pOwner(pOwner)
+		{}
+		~Queue();
+		asio_service& ios;
+		std::atomic<HandlerOwner*> pOwner;
+		//producers push on the front, the runner takes the whole list at once
+		std::atomic<Node*> head{nullptr};
+		std::atomic<Node*> priority_head{nullptr};
+		//handlers posted but not yet run - the one that takes it from zero schedules a run
+		std::atomic<size_t> pending{0};
+		//taken from the heads in posting order, only touched by the (single) scheduled run
+		Node* ready = nullptr;
+		Node* priority_ready = nullptr;
+		//run time (ns) left in this turn for the fair share - see HandlerMonitor.h
+		int64_t deficit = 0;
+	};
+	std::shared_ptr<Queue> pQueue;
+
+	static void Run(const std::shared_ptr<Queue>& pQueue);
+	static Node* TakeInOrder(std::atomic<Node*>& head);
 };
 
 } //namespace odc
@@ -23,6 +23,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <functional>
 #include <string>
 #include <map>
 #include <cstdint>
@@ -33,14 +34,44 @@ namespace odc
 {
 
 void spdlog_init_thread_pool(size_t q_size, size_t thread_count);
+void spdlog_init_thread_pool(size_t q_size, size_t thread_count, std::function<void()> on_thread_start);
 std::shared_ptr<spdlog::details::thread_pool> spdlog_thread_pool();
 void spdlog_flush_all();
+void spdlog_apply_all(const std::function<void(std::shared_ptr<spdlog::logger>)>& fun);
 void spdlog_register_logger(std::shared_ptr<spdlog::logger> logger);
 std::shared_ptr<spdlog::logger> spdlog_get(const std::string &name);
 void spdlog_drop(const std::string &name);
 void spdlog_drop_all();
 void spdlog_shutdown();
 
+//Cheap access to a named logger for hot paths
+//	spdlog_get() does a locked registry lookup every time - a handle only goes back
+//	to the registry after loggers have been registered or dropped (through the functions above)
+class LogHandle
+{
+public:
+	explicit LogHandle(std::string name);
+
+	//The logger, or nullptr if there isn't one registered under our name
+	//	the pointer is for immediate use on the calling thread only
+	spdlog::logger* Get() const;
+
+	//Same as Get(), but also nullptr if the logger wouldn't log at lvl
+	//	so the log arguments don't need to be built
+	//	(only as good as the logger's level - keep it at the lowest level its sinks will take)
+	inline spdlog::logger* ForLevel(const spdlog::level::level_enum lvl) const
+	{
+		auto log = Get();
+		return (log && log->should_log(lvl)) ? log : nullptr;
+	}
+
+	inline const std::string& GetName() const { return Name; }
+
+private:
+	const std::string Name;
+	const size_t ID;
+};
+
 bool getline_noncomment(std::istream& is, std::string& line);
 bool extract_delimited_string(std::istream& ist, std::string& extracted);
 bool extract_delimited_string(const std::string& delims, std::istream& ist, std::string& extracted);
@@ -24,6 +24,7 @@
  *      Author: Neil Stephens <dearknarl@gmail.com>
  */
 
+#include <algorithm>
 #include <thread>
 #include <opendatacon/asio.h>
 
@@ -35,6 +36,10 @@
 #include <opendatacon/asio_syslog_spdlog_sink.h>
 
 #include <opendatacon/util.h>
+#include <opendatacon/ThreadBudget.h>
+#include <opendatacon/HandlerMonitor.h>
+#include <opendatacon/ConnectionPacing.h>
+#include <opendatacon/NameResolver.h>
 #include <opendatacon/Version.h>
 #include "DataConcentrator.h"
 #include "NullPort.h"
@@ -58,19 +63,56 @@ DataConcentrator::DataConcentrator(std::string FileName):
 			return result;
 		},"Return the version information of opendatacon.");
 
+	this->AddCommand("HandlerStats", [](const ParamCollection &params) //"Print handler run time statistics"
+		{
+			try
+			{
+				return odc::GetHandlerStats(params.count("Target") ? params.at("Target") : "");
+			}
+			catch(std::exception& e)
+			{
+				return IUIResponder::GenerateResult("Regex exception: '" + std::string(e.what()) + "'");
+			}
+		},"Return the time spent running handlers, per owner (port, connector etc). Optional argument: regex for which owners to match");
+	this->AddCommand("ResetHandlerStats", [](const ParamCollection &params)
+		{
+			odc::ResetHandlerStats();
+			return IUIResponder::GenerateResult("Success");
+		},"Zero the handler run time statistics");
+
 	//Parse the configs and create all user interfaces, ports and connections
 	ProcessFile();
 
 	if(Interfaces.empty() && DataPorts.empty() && DataConnectors.empty())
 		throw std::runtime_error("No objects to manage");
 
+	BuildShards();
+	//the lanes need a pool of threads to run in parallel - with shards, the main thread is the only one running pIOS
+	pLanesIOS = pIOS;
+	if(pShards && !DispatchLaneConf.empty())
+	{
+		pLanesIOS = std::make_shared<odc::asio_service>(odc::GetThreadBudget().Workers);
+		lanes_working = pLanesIOS->make_work();
+	}
 	for(auto& conn : DataConnectors)
-		conn.second->SetIOS(pIOS);
+	{
+		if(pShards)
+			conn.second->SetShard(pShards,ShardOf(conn.first));
+		else
+			conn.second->SetIOS(pIOS);
+		if(DispatchLaneConf.count(conn.first))
+			conn.second->SetDispatchLanes(pLanesIOS,DispatchLaneConf.at(conn.first));
+	}
 
 	std::unordered_map<std::string,std::shared_ptr<IUIResponder>> PortResponders;
 	for(auto& port : DataPorts)
 	{
-		port.second->SetIOS(pIOS);
+		if(pShards)
+			port.second->SetShard(pShards,ShardOf(port.first));
+		else
+			port.second->SetIOS(pIOS);
+		if(DispatchLaneConf.count(port.first))
+			port.second->SetDispatchLanes(pLanesIOS,DispatchLaneConf.at(port.first));
 		auto ResponderPair = port.second->GetUIResponder();
 		//if it's a different, valid responder pair, store it
 		if(ResponderPair.second && PortResponders.count(ResponderPair.first) == 0)
@@ -105,6 +147,58 @@ DataConcentrator::DataConcentrator(std::string FileName):
 	}
 }
 
+void DataConcentrator::BuildShards()
+{
+	if(!ExecutorConf.isObject() || ExecutorConf["Type"].asString() != "Sharded")
+		return;
+
+	const auto budget = odc::GetThreadBudget();
+	size_t num_shards = ExecutorConf.isMember("Shards") ? ExecutorConf["Shards"].asUInt() : budget.Workers;
+	if(num_shards == 0)
+		num_shards = 1;
+
+	//"CPUAffinity": true puts shard n on CPU n (wrapping around)
+	//	or give a CPU (or array of CPUs, eg. a NUMA node) for each shard
+	std::vector<std::vector<unsigned int>> cpu_sets;
+	const auto& affinity = ExecutorConf["CPUAffinity"];
+	if(affinity.isBool() && affinity.asBool())
+	{
+		auto num_cpus = std::max(1u,std::thread::hardware_concurrency());
+		for(size_t i = 0; i < num_shards; i++)
+			cpu_sets.push_back({static_cast<unsigned int>(i % num_cpus)});
+	}
+	else if(affinity.isArray())
+	{
+		for(Json::ArrayIndex n = 0; n < affinity.size(); ++n)
+		{
+			cpu_sets.emplace_back();
+			if(affinity[n].isArray())
+				for(Json::ArrayIndex c = 0; c < affinity[n].size(); ++c)
+					cpu_sets.back().push_back(affinity[n][c].asUInt());
+			else
+				cpu_sets.back().push_back(affinity[n].asUInt());
+		}
+	}
+	else
+	{
+		//otherwise they share the workers' CPUs from the thread budget
+		cpu_sets.assign(num_shards,budget.WorkerCPUs);
+	}
+
+	pShards = std::make_shared<odc::ShardedExecutor>(num_shards,cpu_sets);
+	if(auto log = odc::spdlog_get("opendatacon"))
+		log->info("Running ports and connectors on {} executor shards", num_shards);
+}
+
+size_t DataConcentrator::ShardOf(const std::string& Name)
+{
+	//"Pinning": { "<port or connector name>" : <shard>, ...}
+	const auto& pinning = ExecutorConf["Pinning"];
+	if(pinning.isObject() && pinning.isMember(Name))
+		return pinning[Name].asUInt() % pShards->Size();
+	return pShards->ShardFor(Name);
+}
+
 DataConcentrator::~DataConcentrator()
 {
 	//In case of exception - ie. if we're destructed while still running
@@ -142,6 +236,29 @@ DataConcentrator::~DataConcentrator()
 	}
 }
 
+spdlog::level::level_enum DataConcentrator::LowestSinkLevel()
+{
+	auto lowest = spdlog::level::off;
+	for(auto& sink : LogSinksVec)
+		lowest = std::min(lowest,sink->level());
+	return lowest;
+}
+
+void DataConcentrator::UpdateLoggerLevels()
+{
+	const auto level = LowestSinkLevel();
+	odc::spdlog_apply_all([&](std::shared_ptr<spdlog::logger> logger)
+		{
+			//only the loggers writing to our sinks
+			auto& sinks = logger->sinks();
+			if(!sinks.empty() && std::all_of(sinks.begin(),sinks.end(),[this](const spdlog::sink_ptr& sink)
+				{
+					return std::find(LogSinksVec.begin(),LogSinksVec.end(),sink) != LogSinksVec.end();
+				}))
+				logger->set_level(level);
+		});
+}
+
 void DataConcentrator::SetLogLevel(std::stringstream& ss)
 {
 	std::string sinkname;
@@ -163,6 +280,7 @@ void DataConcentrator::SetLogLevel(std::stringstream& ss)
 				else
 				{
 					sink.second->set_level(new_level);
+					UpdateLoggerLevels();
 					return;
 				}
 			}
@@ -182,6 +300,10 @@ void DataConcentrator::ProcessElements(const Json::Value& JSONRoot)
 	if(!JSONRoot.isObject())
 		throw std::runtime_error("No valid JSON config object");
 
+	//before anything starts threads - ports size their own pools from this too
+	odc::SetThreadBudget(odc::ParseThreadBudget(JSONRoot["Threads"]));
+	const auto budget = odc::GetThreadBudget();
+
 	//setup log sinks
 	auto log_size_kb = JSONRoot.isMember("LogFileSizekB") ? JSONRoot["LogFileSizekB"].asUInt() : 5*1024;
 	auto log_num = JSONRoot.isMember("NumLogFiles") ? JSONRoot["NumLogFiles"].asUInt() : 5;
@@ -270,10 +392,13 @@ void DataConcentrator::ProcessElements(const Json::Value& JSONRoot)
 			LogSinksMap["tcp"] = tcp;
 			LogSinksVec.push_back(tcp);
 		}
-		odc::spdlog_init_thread_pool(4096,3);
+		odc::spdlog_init_thread_pool(4096,budget.LogWorkers,[budget]()
+			{
+				odc::SetCurrentThreadAffinity(budget.LogCPUs);
+			});
 		auto pMainLogger = std::make_shared<spdlog::async_logger>("opendatacon", begin(LogSinksVec), end(LogSinksVec),
 			odc::spdlog_thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
-		pMainLogger->set_level(spdlog::level::trace);
+		pMainLogger->set_level(LowestSinkLevel());
 		odc::spdlog_register_logger(pMainLogger);
 	}
 	catch (const spdlog::spdlog_ex& ex)
@@ -289,6 +414,38 @@ void DataConcentrator::ProcessElements(const Json::Value& JSONRoot)
 	log->critical("Log level set to {}", spdlog::level::level_string_views[log_level]);
 	log->critical("Console level set to {}", spdlog::level::level_string_views[console_level]);
 	log->info("Loading configuration... ");
+	log->info("Thread budget: {} workers, {} protocol stack threads, {} log threads", budget.Workers, budget.ProtocolWorkers, budget.LogWorkers);
+
+	if(JSONRoot.isMember("Executor"))
+		ExecutorConf = JSONRoot["Executor"];
+
+	if(JSONRoot.isMember("Watchdog"))
+	{
+		const auto& Watchdog = JSONRoot["Watchdog"];
+		auto stall_threshold = std::chrono::milliseconds(Watchdog.get("StallThresholdms",1000).asUInt());
+		auto scan_period = std::chrono::milliseconds(Watchdog.get("ScanPeriodms",100).asUInt());
+		log->info("Handler watchdog: stall threshold {}ms, scan period {}ms", stall_threshold.count(), scan_period.count());
+		odc::EnableHandlerMonitor(stall_threshold,scan_period);
+	}
+
+	if(JSONRoot.isMember("FairShare"))
+	{
+		auto quantum = std::chrono::microseconds(JSONRoot["FairShare"].get("Quantumus",1000).asUInt());
+		log->info("Fair share quantum {}us", quantum.count());
+		odc::SetFairShareQuantum(quantum);
+	}
+
+	if(JSONRoot.isMember("ConnectRate"))
+	{
+		const auto& ConnectRate = JSONRoot["ConnectRate"];
+		auto per_second = ConnectRate.get("PerSecond",0).asDouble();
+		auto burst = ConnectRate.get("Burst",1).asUInt();
+		log->info("Connections and port enables paced at {}/s, in bursts of up to {}", per_second, burst);
+		odc::SetConnectRateLimit(per_second,burst);
+	}
+
+	if(JSONRoot.isMember("ResolveCacheTimes"))
+		odc::SetResolveCacheTime(std::chrono::seconds(JSONRoot["ResolveCacheTimes"].asUInt()));
 
 	//Configure the user interface
 	if(JSONRoot.isMember("Plugins"))
@@ -357,7 +514,7 @@ void DataConcentrator::ProcessElements(const Json::Value& JSONRoot)
 			{
 				auto pLibLogger = std::make_shared<spdlog::async_logger>(libname, begin(LogSinksVec), end(LogSinksVec),
 					odc::spdlog_thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
-				pLibLogger->set_level(spdlog::level::trace);
+				pLibLogger->set_level(LowestSinkLevel());
 				odc::spdlog_register_logger(pLibLogger);
 			}
 
@@ -389,6 +546,11 @@ void DataConcentrator::ProcessElements(const Json::Value& JSONRoot)
 				continue;
 			}
 
+			if(Ports[n].isMember("Weight"))
+				odc::SetHandlerWeight(Ports[n]["Name"].asString(),Ports[n]["Weight"].asUInt());
+			if(Ports[n].isMember("DispatchLanes"))
+				DispatchLaneConf[Ports[n]["Name"].asString()] = Ports[n]["DispatchLanes"].asUInt();
+
 			std::function<void (IOHandler*)> set_init_mode;
 			if(Ports[n].isMember("InitState"))
 			{
@@ -466,7 +628,7 @@ void DataConcentrator::ProcessElements(const Json::Value& JSONRoot)
 			{
 				auto pLibLogger = std::make_shared<spdlog::async_logger>(libname, begin(LogSinksVec), end(LogSinksVec),
 					odc::spdlog_thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
-				pLibLogger->set_level(spdlog::level::trace);
+				pLibLogger->set_level(LowestSinkLevel());
 				odc::spdlog_register_logger(pLibLogger);
 			}
 
@@ -510,7 +672,7 @@ void DataConcentrator::ProcessElements(const Json::Value& JSONRoot)
 		//make a logger for use by Connectors
 		auto pConnLogger = std::make_shared<spdlog::async_logger>("Connectors", begin(LogSinksVec), end(LogSinksVec),
 			odc::spdlog_thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
-		pConnLogger->set_level(spdlog::level::trace);
+		pConnLogger->set_level(LowestSinkLevel());
 		odc::spdlog_register_logger(pConnLogger);
 
 		for(Json::Value::ArrayIndex n = 0; n < Connectors.size(); ++n)
@@ -526,6 +688,8 @@ void DataConcentrator::ProcessElements(const Json::Value& JSONRoot)
 				continue;
 			}
 			DataConnectors.emplace(Connectors[n]["Name"].asString(), std::unique_ptr<DataConnector,void (*)(DataConnector*)>(new DataConnector(Connectors[n]["Name"].asString(), Connectors[n]["ConfFilename"].asString(), Connectors[n]["ConfOverrides"]),[](DataConnector* pDC){delete pDC;}));
+			if(Connectors[n].isMember("DispatchLanes"))
+				DispatchLaneConf[Connectors[n]["Name"].asString()] = Connectors[n]["DispatchLanes"].asUInt();
 			if(Connectors[n].isMember("InitState"))
 			{
 				if(Connectors[n]["InitState"].asString() == "ENABLED")
@@ -579,8 +743,48 @@ void DataConcentrator::Run()
 {
 	if (auto log = odc::spdlog_get("opendatacon"))
 		log->info("Starting worker threads...");
-	for (size_t i = 0; i < std::thread::hardware_concurrency(); ++i)
-		threads.emplace_back([&]() {pIOS->run(); });
+	if(pShards)
+	{
+		//the shards do the heavy lifting - the main thread looks after the rest
+		pShards->Start();
+		if(lanes_working)
+		{
+			const auto budget = odc::GetThreadBudget();
+			for (size_t i = 0; i < budget.Workers; ++i)
+				threads.emplace_back([this,budget]()
+					{
+						if(!odc::SetCurrentThreadAffinity(budget.WorkerCPUs))
+						{
+							if(auto log = odc::spdlog_get("opendatacon"))
+								log->warn("Failed to set CPU affinity for dispatch lane thread");
+						}
+						pLanesIOS->run();
+					});
+		}
+	}
+	else
+	{
+		const auto budget = odc::GetThreadBudget();
+		for (size_t i = 0; i < budget.Workers; ++i)
+			threads.emplace_back([this,budget]()
+				{
+					if(!odc::SetCurrentThreadAffinity(budget.WorkerCPUs))
+					{
+						if(auto log = odc::spdlog_get("opendatacon"))
+							log->warn("Failed to set CPU affinity for worker thread");
+					}
+					pIOS->run();
+				});
+	}
+
+	//ports and connectors are enabled on their own shard, if they have one
+	auto PostEnable = [this](IOHandler* pIOHandler)
+		{
+			if(pShards)
+				pIOHandler->PostToShard([pIOHandler](){ pIOHandler->Enable(); });
+			else
+				pIOS->post([pIOHandler](){ pIOHandler->Enable(); });
+		};
 
 	if(auto log = odc::spdlog_get("opendatacon"))
 		log->info("Enabling DataConnectors...");
@@ -588,41 +792,42 @@ void DataConcentrator::Run()
 	{
 		if(Name_n_Conn.second->InitState == InitState_t::ENABLED)
 		{
-			pIOS->post([&]()
-				{
-					Name_n_Conn.second->Enable();
-				});
+			PostEnable(Name_n_Conn.second.get());
 		}
 		else if(Name_n_Conn.second->InitState == InitState_t::DELAYED)
 		{
-			std::shared_ptr<asio::steady_timer> pTimer = pIOS->make_steady_timer();
+			std::shared_ptr<odc::steady_timer> pTimer = pIOS->make_steady_timer();
 			pTimer->expires_from_now(std::chrono::milliseconds(Name_n_Conn.second->EnableDelayms));
-			pTimer->async_wait([pTimer,&Name_n_Conn](asio::error_code err_code)
+			pTimer->async_wait([pTimer,&Name_n_Conn,PostEnable](asio::error_code err_code)
 				{
 					//FIXME: check err_code?
-					Name_n_Conn.second->Enable();
+					PostEnable(Name_n_Conn.second.get());
 				});
 		}
 	}
 	if(auto log = odc::spdlog_get("opendatacon"))
 		log->info("Enabling DataPorts...");
+	//ports are staggered (see ConnectionPacing.h), so they don't all connect out at once
 	for(auto& Name_n_Port : DataPorts)
 	{
 		if(Name_n_Port.second->InitState == InitState_t::ENABLED)
 		{
-			pIOS->post([&]()
+			odc::PaceConnect(pIOS,[&Name_n_Port,PostEnable]()
 				{
-					Name_n_Port.second->Enable();
+					PostEnable(Name_n_Port.second.get());
 				});
 		}
 		else if(Name_n_Port.second->InitState == InitState_t::DELAYED)
 		{
-			std::shared_ptr<asio::steady_timer> pTimer = pIOS->make_steady_timer();
+			std::shared_ptr<odc::steady_timer> pTimer = pIOS->make_steady_timer();
 			pTimer->expires_from_now(std::chrono::milliseconds(Name_n_Port.second->EnableDelayms));
-			pTimer->async_wait([pTimer,&Name_n_Port](asio::error_code err_code)
+			pTimer->async_wait([this,pTimer,&Name_n_Port,PostEnable](asio::error_code err_code)
 				{
 					//FIXME: check err_code?
-					Name_n_Port.second->Enable();
+					odc::PaceConnect(pIOS,[&Name_n_Port,PostEnable]()
+						{
+							PostEnable(Name_n_Port.second.get());
+						});
 				});
 		}
 	}
@@ -643,6 +848,9 @@ void DataConcentrator::Run()
 	for(auto& thread : threads)
 		thread.join();
 	threads.clear();
+	if(pShards)
+		pShards->Join();
+	odc::DisableHandlerMonitor();
 
 	if(auto log = odc::spdlog_get("opendatacon"))
 		log->info("Destoying Interfaces...");
@@ -696,9 +904,15 @@ void DataConcentrator::Shutdown()
 			//shutdown tcp logger so it doesn't keep the io_service going
 			TCPbuf.DeInit();
 			if(LogSinksMap.count("tcp"))
+			{
 				LogSinksMap["tcp"]->set_level(spdlog::level::off);
+				UpdateLoggerLevels();
+			}
 
 			ios_working.reset();
+			lanes_working.reset();
+			if(pShards)
+				pShards->Stop();
 		});
 }
 
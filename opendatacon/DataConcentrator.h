@@ -28,6 +28,7 @@
 #define DATACONCENTRATOR_H_
 
 #include <opendatacon/asio.h>
+#include <opendatacon/ShardedExecutor.h>
 #include <unordered_map>
 #include <opendatacon/DataPort.h>
 #include <opendatacon/DataPortCollection.h>
@@ -66,6 +67,16 @@ private:
 
 	std::shared_ptr<odc::asio_service> pIOS;
 	std::shared_ptr<asio::io_service::work> ios_working;
+	//ports and connectors run on these instead of pIOS if the config asks for it
+	Json::Value ExecutorConf;
+	std::shared_ptr<odc::ShardedExecutor> pShards;
+	void BuildShards();
+	size_t ShardOf(const std::string& Name);
+	//how many dispatch lanes each port or connector asked for (see IOHandler::SetDispatchLanes)
+	std::unordered_map<std::string,size_t> DispatchLaneConf;
+	//what runs the dispatch lanes - pIOS, unless that's only run by the main thread (ie. with shards)
+	std::shared_ptr<odc::asio_service> pLanesIOS;
+	std::shared_ptr<asio::io_service::work> lanes_working;
 	std::once_flag shutdown_flag;
 	std::atomic_bool shutting_down;
 	std::atomic_bool shut_down;
@@ -77,6 +88,10 @@ private:
 	std::map<std::string,spdlog::sink_ptr> LogSinksMap;
 	std::vector<spdlog::sink_ptr> LogSinksVec;
 	void SetLogLevel(std::stringstream& ss);
+	//Loggers only pass on messages one of the sinks will take, so hot paths can skip building the rest
+	//	(see odc::LogHandle::ForLevel)
+	spdlog::level::level_enum LowestSinkLevel();
+	void UpdateLoggerLevels();
 
 	std::vector<std::thread> threads;
 };
@@ -24,6 +24,7 @@
  *      Author: Neil Stephens <dearknarl@gmail.com>
  */
 
+#include <algorithm>
 #include <iostream>
 #include "DataConnector.h"
 #include "IndexOffsetTransform.h"
@@ -36,6 +37,9 @@
 #include <spdlog/spdlog.h>
 #include <opendatacon/util.h>
 
+//Connectors logger handle for the event path
+static const LogHandle ConnectorsLog("Connectors");
+
 DataConnector::DataConnector(std::string aName, std::string aConfFilename, const Json::Value aConfOverrides):
 	IOHandler(aName),
 	ConfigParser(aConfFilename, aConfOverrides)
@@ -220,20 +224,70 @@ void DataConnector::Event(ConnectState state, const std::string& SenderName)
 	{
 		auto bounds = SenderConnectionsLookup.equal_range(SenderName);
 		for(auto aMatch_it = bounds.first; aMatch_it != bounds.second; aMatch_it++)
-		{
-			//guess which one is the sendee
-			IOHandler* pSendee = Connections[aMatch_it->second].second;
+			GetSendee(aMatch_it->second, SenderName)->Event(state, Name);
+	}
+}
 
-			//check if we were right and correct if need be
-			if(pSendee->GetName() == SenderName)
-				pSendee = Connections[aMatch_it->second].first;
+void DataConnector::Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback)
+{
+	if(!enabled)
+	{
+		(*pStatusCallback)(CommandStatus::UNDEFINED);
+		return;
+	}
 
-			pSendee->Event(state, Name);
+	auto pRoute = FindRoute(SenderName);
+	//Do we have a connection for this sender?
+	if(pRoute)
+	{
+		if(auto pLanes = GetDispatchLanes())
+		{
+			pLanes->Post(*event,[this,pRoute,event,pStatusCallback]()
+				{
+					RouteEvent(*pRoute, event, pStatusCallback);
+				});
+			return;
 		}
+		RouteEvent(*pRoute, event, pStatusCallback);
+		return;
 	}
+	//no connection for sender if we get here
+	if(auto log = ConnectorsLog.ForLevel(spdlog::level::warn))
+		log->warn("{}: discarding event from '{}' (No connection defined)", Name, SenderName);
+
+	(*pStatusCallback)(CommandStatus::UNDEFINED);
 }
 
-void DataConnector::Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback)
+void DataConnector::RouteEvent(const Route& route, const std::shared_ptr<const EventInfo>& event, const SharedStatusCallback_t& pStatusCallback)
+{
+	std::shared_ptr<const EventInfo> new_event_obj;
+	if(!ApplyTransforms(route, event, new_event_obj))
+	{
+		(*pStatusCallback)(CommandStatus::UNDEFINED);
+		return;
+	}
+
+	auto multi_callback = SyncMultiCallback(route.Destinations.size(),pStatusCallback);
+	for(auto pSendee : route.Destinations)
+	{
+		if(auto log = EventLog().ForLevel(spdlog::level::trace))
+			log->trace("{} {} Payload {} Event {} => {}", ToString(new_event_obj->GetEventType()),new_event_obj->GetIndex(), new_event_obj->GetPayloadString(), Name, pSendee->GetName());
+
+		if(auto pSnapshot = pSendee->GetSnapshot())
+			pSnapshot->Update(*new_event_obj);
+		//ports on another shard take the event on their own thread
+		//	controls skip the queue of telemetry waiting there
+		if(pSendee->OnOtherShard())
+			pSendee->PostToShard([pSendee,new_event_obj,this,multi_callback]()
+				{
+					pSendee->Event(new_event_obj, this->Name, multi_callback);
+				},IsPriorityEvent(new_event_obj->GetEventType()) ? HandlerPriority::High : HandlerPriority::Normal);
+		else
+			pSendee->Event(new_event_obj, this->Name, multi_callback);
+	}
+}
+
+void DataConnector::Event(const EventBatch_t& batch, const std::string& SenderName, SharedStatusCallback_t pStatusCallback)
 {
 	if(!enabled)
 	{
@@ -241,59 +295,230 @@ void DataConnector::Event(std::shared_ptr<const EventInfo> event, const std::str
 		return;
 	}
 
-	auto connection_count = SenderConnectionsLookup.count(SenderName);
+	auto pRoute = FindRoute(SenderName);
 	//Do we have a connection for this sender?
-	if(connection_count > 0)
+	if(!pRoute)
 	{
-		auto new_event_obj = std::make_shared<EventInfo>(*event);
-		if(ConnectionTransforms.count(SenderName))
+		if(auto log = ConnectorsLog.ForLevel(spdlog::level::warn))
+			log->warn("{}: discarding batch of {} events from '{}' (No connection defined)", Name, batch.size(), SenderName);
+		(*pStatusCallback)(CommandStatus::UNDEFINED);
+		return;
+	}
+
+	if(auto pLanes = GetDispatchLanes())
+	{
+		auto split = pLanes->Split(batch);
+		auto lanes_callback = SyncMultiCallback(split.size(),pStatusCallback);
+		for(auto& sub_batch : split)
 		{
-			for(auto& Transform : ConnectionTransforms[SenderName])
-			{
-				if(!Transform->Event(new_event_obj))
-				{
-					if(auto log = odc::spdlog_get("opendatacon"))
-						log->trace("{} {} Payload {} Event {} => Transform Block", ToString(new_event_obj->GetEventType()),new_event_obj->GetIndex(), new_event_obj->GetPayloadString(), Name);
-					(*pStatusCallback)(CommandStatus::UNDEFINED);
-					return;
-				}
-				else
+			pLanes->Post(sub_batch.Lane,[this,pRoute,events = std::move(sub_batch.Events),lanes_callback]()
 				{
-					if(auto log = odc::spdlog_get("opendatacon"))
-						log->trace("{} {} Payload {} Event {} => Transform Pass", ToString(new_event_obj->GetEventType()),new_event_obj->GetIndex(), new_event_obj->GetPayloadString(), Name);
-				}
+					RouteBatch(*pRoute, events, lanes_callback);
+				},sub_batch.Priority);
+		}
+		return;
+	}
+	RouteBatch(*pRoute, batch, pStatusCallback);
+}
+
+void DataConnector::RouteBatch(const Route& route, const EventBatch_t& batch, const SharedStatusCallback_t& pStatusCallback)
+{
+	//If the transforms leave every event untouched, we can pass on the same batch
+	const EventBatch_t* pOutBatch = &batch;
+	EventBatch_t transformed;
+	bool blocked = false;
+	if(!route.Transforms.empty())
+	{
+		bool changed = false;
+		transformed.reserve(batch.size());
+		for(const auto& event : batch)
+		{
+			std::shared_ptr<const EventInfo> new_event_obj;
+			if(ApplyTransforms(route, event, new_event_obj))
+			{
+				changed |= (new_event_obj != event);
+				transformed.push_back(std::move(new_event_obj));
 			}
+			else
+				blocked = true;
 		}
+		if(blocked || changed)
+			pOutBatch = &transformed;
+	}
+	else
+		CopiesAvoided.fetch_add(batch.size(),std::memory_order_relaxed);
 
-		auto multi_callback = SyncMultiCallback(connection_count,pStatusCallback);
-		auto bounds = SenderConnectionsLookup.equal_range(SenderName);
-		for(auto aMatch_it = bounds.first; aMatch_it != bounds.second; aMatch_it++)
+	if(pOutBatch->empty())
+	{
+		(*pStatusCallback)(blocked ? CommandStatus::UNDEFINED : CommandStatus::SUCCESS);
+		return;
+	}
+
+	//A transform block counts as an UNDEFINED result for the batch, like it does for a single event
+	auto multi_callback = SyncMultiCallback(route.Destinations.size()+(blocked ? 1 : 0),pStatusCallback);
+	if(blocked)
+		(*multi_callback)(CommandStatus::UNDEFINED);
+
+	for(auto pSendee : route.Destinations)
+	{
+		if(auto log = EventLog().ForLevel(spdlog::level::trace))
+			log->trace("Batch of {} events Event {} => {}", pOutBatch->size(), Name, pSendee->GetName());
+
+		if(auto pSnapshot = pSendee->GetSnapshot())
+			pSnapshot->Update(*pOutBatch);
+		if(pSendee->OnOtherShard())
+			PostBatchToShard(pSendee,*pOutBatch,multi_callback);
+		else
+			pSendee->Event(*pOutBatch, this->Name, multi_callback);
+	}
+}
+
+void DataConnector::PostBatchToShard(IOHandler* pSendee, const EventBatch_t& batch, SharedStatusCallback_t pStatusCallback)
+{
+	auto num_priority = std::count_if(batch.begin(),batch.end(),[](const std::shared_ptr<const EventInfo>& event)
 		{
-			//guess which one is the sendee
-			IOHandler* pSendee = Connections[aMatch_it->second].second;
+			return IsPriorityEvent(event->GetEventType());
+		});
+	if(num_priority == 0 || size_t(num_priority) == batch.size())
+	{
+		pSendee->PostToShard([pSendee,batch,this,pStatusCallback]()
+			{
+				pSendee->Event(batch, this->Name, pStatusCallback);
+			},num_priority ? HandlerPriority::High : HandlerPriority::Normal);
+		return;
+	}
 
-			//check if we were right and correct if need be
-			if(pSendee->GetName() == SenderName)
-				pSendee = Connections[aMatch_it->second].first;
+	//A mixed batch is split, so the controls don't wait behind telemetry queued for the other shard
+	EventBatch_t priority_batch, normal_batch;
+	priority_batch.reserve(num_priority);
+	normal_batch.reserve(batch.size()-num_priority);
+	for(const auto& event : batch)
+		(IsPriorityEvent(event->GetEventType()) ? priority_batch : normal_batch).push_back(event);
+	auto split_callback = SyncMultiCallback(2,pStatusCallback);
+	pSendee->PostToShard([pSendee,priority_batch,this,split_callback]()
+		{
+			pSendee->Event(priority_batch, this->Name, split_callback);
+		},HandlerPriority::High);
+	pSendee->PostToShard([pSendee,normal_batch,this,split_callback]()
+		{
+			pSendee->Event(normal_batch, this->Name, split_callback);
+		});
+}
 
-			if(auto log = odc::spdlog_get("opendatacon"))
-				log->trace("{} {} Payload {} Event {} => {}", ToString(new_event_obj->GetEventType()),new_event_obj->GetIndex(), new_event_obj->GetPayloadString(), Name, pSendee->GetName());
+IOHandler* DataConnector::GetSendee(const std::string& ConName, const std::string& SenderName)
+{
+	//guess which one is the sendee
+	IOHandler* pSendee = Connections[ConName].second;
 
-			pSendee->Event(new_event_obj, this->Name, multi_callback);
+	//check if we were right and correct if need be
+	if(pSendee->GetName() == SenderName)
+		pSendee = Connections[ConName].first;
+
+	return pSendee;
+}
+
+void DataConnector::CompileRoutes()
+{
+	Routes.clear();
+	for(auto& sender_conn : SenderConnectionsLookup)
+	{
+		const auto& SenderName = sender_conn.first;
+		auto route_it = std::find_if(Routes.begin(),Routes.end(),[&](const Route& route){ return *route.pSenderName == SenderName; });
+		if(route_it == Routes.end())
+		{
+			Route route;
+			//Point at the sender's own copy of its name, because that's what it passes to Event()
+			route.pSenderName = &GetIOHandlers().at(SenderName)->GetName();
+			auto tx_it = ConnectionTransforms.find(SenderName);
+			if(tx_it != ConnectionTransforms.end())
+				for(auto& pTransform : tx_it->second)
+				{
+					pTransform->Build(SenderName);
+					route.Transforms.push_back(pTransform.get());
+				}
+			Routes.push_back(std::move(route));
+			route_it = Routes.end()-1;
 		}
-		return;
+		route_it->Destinations.push_back(GetSendee(sender_conn.second, SenderName));
 	}
-	//no connection for sender if we get here
-	if(auto log = odc::spdlog_get("Connectors"))
-		log->warn("{}: discarding event from '", Name+SenderName+"' (No connection defined)");
+	RoutesCompiled = true;
+}
 
-	(*pStatusCallback)(CommandStatus::UNDEFINED);
+const DataConnector::Route* DataConnector::FindRoute(const std::string& SenderName) const
+{
+	//Senders publish using their own Name, so we can usually match on the address alone
+	for(auto& route : Routes)
+		if(route.pSenderName == &SenderName)
+			return &route;
+	for(auto& route : Routes)
+		if(*route.pSenderName == SenderName)
+			return &route;
+	return nullptr;
+}
+
+bool DataConnector::ApplyTransforms(const Route& route, const std::shared_ptr<const EventInfo>& event, std::shared_ptr<const EventInfo>& out_event)
+{
+	//Pass on the original event, unless a transform that might change it gets hold of it
+	//	filter-only transforms just look at whichever one we're up to
+	out_event = event;
+	std::shared_ptr<EventInfo> pCopy;
+	for(auto pTransform : route.Transforms)
+	{
+		if(!pTransform->AppliesTo(*out_event))
+			continue;
+
+		bool pass;
+		if(pTransform->IsFilterOnly())
+			pass = static_cast<FilterTransform*>(pTransform)->Filter(*out_event);
+		else
+		{
+			if(!pCopy)
+				out_event = pCopy = MakeEvent(*event);
+			pass = pTransform->Event(pCopy);
+		}
+
+		if(!pass)
+		{
+			if(auto log = EventLog().ForLevel(spdlog::level::trace))
+				log->trace("{} {} Payload {} Event {} => Transform Block", ToString(out_event->GetEventType()),out_event->GetIndex(), out_event->GetPayloadString(), Name);
+			return false;
+		}
+		else
+		{
+			if(auto log = EventLog().ForLevel(spdlog::level::trace))
+				log->trace("{} {} Payload {} Event {} => Transform Pass", ToString(out_event->GetEventType()),out_event->GetIndex(), out_event->GetPayloadString(), Name);
+		}
+	}
+	if(pCopy)
+		EventCopies.fetch_add(1,std::memory_order_relaxed);
+	else
+		CopiesAvoided.fetch_add(1,std::memory_order_relaxed);
+	return true;
 }
 
 void DataConnector::Build()
-{}
+{
+	CompileRoutes();
+
+	//Now the ports are built, tell each sender what our destinations can actually use
+	//	(this happens before anything is enabled, so nobody is publishing yet)
+	for(auto& route : Routes)
+	{
+		auto interest = EventInterest::Nothing();
+		for(auto pDest : route.Destinations)
+			interest.Add(pDest->GetEventInterest());
+		//a transform might map an event onto something else, so we can't narrow it down
+		for(auto pTransform : route.Transforms)
+			if(!pTransform->IsFilterOnly())
+				interest = EventInterest();
+		GetIOHandlers().at(*route.pSenderName)->Subscribe(this, Name, std::move(interest));
+	}
+}
 void DataConnector::Enable()
 {
+	//The routes are fixed from here on, and must be in place before we take events
+	if(!RoutesCompiled)
+		CompileRoutes();
 	enabled = true;
 }
 void DataConnector::Disable()
@@ -40,12 +40,16 @@ public:
 	~DataConnector() override {}
 
 	void Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override;
+	void Event(const EventBatch_t& batch, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override;
 
 	void Event(ConnectState state, const std::string& SenderName) override;
 
 	virtual const Json::Value GetStatistics() const
 	{
-		return Json::Value();
+		Json::Value stats;
+		stats["EventCopies"] = Json::UInt64(EventCopies.load(std::memory_order_relaxed));
+		stats["CopiesAvoided"] = Json::UInt64(CopiesAvoided.load(std::memory_order_relaxed));
+		return stats;
 	}
 
 	virtual const Json::Value GetCurrentState() const
@@ -63,6 +67,31 @@ protected:
 	std::unordered_map<std::string,std::pair<IOHandler*,IOHandler*> > Connections;
 	std::multimap<std::string,std::string> SenderConnectionsLookup;
 	std::unordered_map<std::string,std::vector<std::unique_ptr<Transform, std::function<void(Transform*)>> > > ConnectionTransforms;
+
+private:
+	//Where events from a sender go, compiled from the maps above so the event path doesn't need them
+	struct Route
+	{
+		const std::string* pSenderName;
+		std::vector<IOHandler*> Destinations;
+		std::vector<Transform*> Transforms;
+	};
+	std::vector<Route> Routes;
+	bool RoutesCompiled = false;
+
+	void CompileRoutes();
+	const Route* FindRoute(const std::string& SenderName) const;
+	IOHandler* GetSendee(const std::string& ConName, const std::string& SenderName);
+	//The rest of Event() once we know the route - on a dispatch lane, if we have them
+	void RouteEvent(const Route& route, const std::shared_ptr<const EventInfo>& event, const SharedStatusCallback_t& pStatusCallback);
+	void RouteBatch(const Route& route, const EventBatch_t& batch, const SharedStatusCallback_t& pStatusCallback);
+	bool ApplyTransforms(const Route& route, const std::shared_ptr<const EventInfo>& event, std::shared_ptr<const EventInfo>& out_event);
+	//Hand a batch to a sendee on another shard - with any controls in their own high priority batch
+	void PostBatchToShard(IOHandler* pSendee, const EventBatch_t& batch, SharedStatusCallback_t pStatusCallback);
+
+	//Events are only copied when a transform might change them
+	std::atomic<uint64_t> EventCopies{0};
+	std::atomic<uint64_t> CopiesAvoided{0};
 };
 
 #endif /* DATACONNECTOR_H_ */
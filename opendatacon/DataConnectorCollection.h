@@ -32,6 +32,7 @@
 
 #include "DataConnector.h"
 #include <opendatacon/ResponderMap.h>
+#include <opendatacon/HandlerMonitor.h>
 
 using namespace odc;
 
@@ -55,6 +56,11 @@ public:
 				if (auto target = GetTarget(params)) return target->GetStatistics();
 				return IUIResponder::GenerateResult("Bad parameter");
 			});
+		this->AddCommand("HandlerStats", [this](const ParamCollection &params)
+			{
+				if (auto target = GetTarget(params)) return GetHandlerStats(*GetHandlerOwner(target->GetName()));
+				return IUIResponder::GenerateResult("Bad parameter");
+			});
 		this->AddCommand("Status", [this](const ParamCollection &params) -> const Json::Value
 			{
 				if (auto target = GetTarget(params))
@@ -50,10 +50,41 @@ public:
 		load_map("AnalogMap",AnalogMap);
 		load_map("BinaryMap",BinaryMap);
 		load_map("ControlMap",ControlMap);
+		//everything else passes straight through (but unmapped indexes of these types are blocked)
+		AppliesToTypes({EventType::Analog,EventType::Binary,EventType::ControlRelayOutputBlock});
+	}
+
+	//Resolve the mapped points to registry IDs, so most events just need an array lookup
+	void Build(const std::string& SenderName) override
+	{
+		auto sender = InternSourcePort(SenderName);
+		auto map_points = [&](const EventType type, const std::unordered_map<uint16_t,uint16_t>& map)
+					{
+						for(auto& mapping : map)
+						{
+							auto id = FindPoint(sender,type,mapping.first);
+							if(id == NoPointID)
+								continue;
+							if(id >= ByPointID.size())
+								ByPointID.resize(id+1,-1);
+							ByPointID[id] = mapping.second;
+						}
+					};
+		map_points(EventType::Analog,AnalogMap);
+		map_points(EventType::Binary,BinaryMap);
+		map_points(EventType::ControlRelayOutputBlock,ControlMap);
 	}
 
 	bool Event(std::shared_ptr<EventInfo> event) override
 	{
+		auto id = event->GetPointID();
+		if(id < ByPointID.size() && ByPointID[id] >= 0)
+		{
+			event->SetIndex(ByPointID[id]);
+			return true;
+		}
+
+		//points that aren't registered (or aren't mapped) go the long way
 		auto* map = &AnalogMap;
 		switch(event->GetEventType())
 		{
@@ -79,6 +110,10 @@ public:
 	std::unordered_map<uint16_t,uint16_t> AnalogMap;
 	std::unordered_map<uint16_t,uint16_t> BinaryMap;
 	std::unordered_map<uint16_t,uint16_t> ControlMap;
+
+private:
+	//mapped index by PointID, or -1
+	std::vector<int32_t> ByPointID;
 };
 
 #endif /* INDEXMAPTRANSFORM_H_ */
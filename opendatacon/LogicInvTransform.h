@@ -37,7 +37,9 @@ class LogicInvTransform: public Transform
 public:
 	LogicInvTransform(const Json::Value& params):
 		Transform(params)
-	{}
+	{
+		AppliesToTypes({EventType::BinaryOutputStatus,EventType::Binary});
+	}
 
 	bool Event(std::shared_ptr<EventInfo> event) override
 	{
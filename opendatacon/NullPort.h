@@ -31,7 +31,7 @@
 
 using namespace odc;
 
-typedef asio::basic_waitable_timer<std::chrono::steady_clock> Timer_t;
+typedef odc::steady_timer Timer_t;
 
 /* The equivalent of /dev/null as a DataPort */
 class NullPort: public DataPort
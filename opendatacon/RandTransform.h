@@ -36,7 +36,9 @@ class RandTransform: public Transform
 public:
 	RandTransform(const Json::Value& params):
 		Transform(params)
-	{}
+	{
+		AppliesToTypes({EventType::Analog});
+	}
 
 	bool Event(std::shared_ptr<EventInfo> event) override
 	{
@@ -32,12 +32,20 @@
 #include <unordered_map>
 #include <opendatacon/util.h>
 
-class RateLimitTransform: public Transform
+class RateLimitTransform: public FilterTransform
 {
 public:
 	RateLimitTransform(const Json::Value& params):
-		Transform(params)
+		FilterTransform(params)
 	{
+		AppliesToTypes({EventType::Binary,
+		                EventType::Analog,
+		                EventType::DoubleBitBinary,
+		                EventType::Counter,
+		                EventType::FrozenCounter,
+		                EventType::BinaryOutputStatus,
+		                EventType::AnalogOutputStatus});
+
 		std::string name = "DEFAULT";
 		if (params.isMember("Name") && params["Name"].isString())
 		{
@@ -79,9 +87,9 @@ public:
 	}
 
 private:
-	bool Event(std::shared_ptr<EventInfo> event) override
+	bool Filter(const EventInfo& event) override
 	{
-		switch(event->GetEventType())
+		switch(event.GetEventType())
 		{
 			case EventType::Binary:
 			case EventType::Analog:
@@ -27,15 +27,16 @@
 #ifndef THRESHOLDTRANSFORM_H_
 #define THRESHOLDTRANSFORM_H_
 
+#include <algorithm>
 #include <cstdint>
 #include <cfloat>
 #include <opendatacon/Transform.h>
 
-class ThresholdTransform: public Transform
+class ThresholdTransform: public FilterTransform
 {
 public:
 	ThresholdTransform(const Json::Value& params):
-		Transform(params),
+		FilterTransform(params),
 		pass_on(false),
 		already_under(false),
 		threshold(-DBL_MAX)
@@ -51,27 +52,43 @@ public:
 			if(params.isMember("threshold") && params["threshold"].isNumeric())
 				threshold = params["threshold"].asDouble();
 		}
+
+		//Only analogs between the threshold point and the points it controls are of interest
+		if(!params["points"].isArray())
+		{
+			AppliesToTypes({});
+			return;
+		}
+		AppliesToTypes({EventType::Analog});
+		size_t min_index = threshold_point_index;
+		size_t max_index = threshold_point_index;
+		for(Json::ArrayIndex n = 0; n < params["points"].size(); ++n)
+		{
+			min_index = std::min<size_t>(min_index,params["points"][n].asUInt());
+			max_index = std::max<size_t>(max_index,params["points"][n].asUInt());
+		}
+		AppliesToIndexes(min_index,max_index);
 	}
 
-	bool Event(std::shared_ptr<EventInfo> event) override
+	bool Filter(const EventInfo& event) override
 	{
-		if(event->GetEventType() != EventType::Analog)
+		if(event.GetEventType() != EventType::Analog)
 			return true;
 
 		if(!params["points"].isArray())
 			return true;
 
-		if(event->GetIndex() == threshold_point_index)
+		if(event.GetIndex() == threshold_point_index)
 		{
-			pass_on = (event->GetPayload<EventType::Analog>() >= threshold) || (!already_under);
-			already_under = (event->GetPayload<EventType::Analog>() < threshold);
+			pass_on = (event.GetPayload<EventType::Analog>() >= threshold) || (!already_under);
+			already_under = (event.GetPayload<EventType::Analog>() < threshold);
 		}
 
 		if(!pass_on)
 		{
 			for(Json::ArrayIndex n = 0; n < params["points"].size(); ++n)
 			{
-				if(event->GetIndex() == params["points"][n].asUInt())
+				if(event.GetIndex() == params["points"][n].asUInt())
 					return false;
 			}
 		}
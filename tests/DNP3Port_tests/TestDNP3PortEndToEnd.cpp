@@ -20,6 +20,8 @@
 /**
  */
 #include <opendatacon/asio.h>
+#include <opendatacon/ThreadBudget.h>
+#include <atomic>
 #include <thread>
 #include <catch.hpp>
 
@@ -199,3 +201,122 @@ TEST_CASE(SUITE("Serial link"))
 	}
 }
 
+
+TEST_CASE(SUITE("Passthrough on one stack thread"))
+{
+	//an outstation waiting for a command result that comes back through a DNP3 master
+	//	with only one stack thread, that wait would stop the master getting the result
+	//	so the outstation has to refuse the command straight away, rather than time out (or pretend it worked)
+	auto default_budget = odc::GetThreadBudget();
+	auto budget = default_budget;
+	budget.ProtocolWorkers = 1;
+	odc::SetThreadBudget(budget);
+
+	//Load the library
+	InitLibaryLoading();
+	auto portlib = LoadModule(GetLibFileName("DNP3Port"));
+	REQUIRE(portlib);
+	{
+		auto ios = std::make_shared<odc::asio_service>();
+		auto work = ios->make_work();
+		std::thread t([&](){ios->run();});
+
+		newptr newOutstation = GetPortCreator(portlib, "DNP3Outstation");
+		REQUIRE(newOutstation);
+		delptr delOutstation = GetPortDestroyer(portlib, "DNP3Outstation");
+		REQUIRE(delOutstation);
+		newptr newMaster = GetPortCreator(portlib, "DNP3Master");
+		REQUIRE(newMaster);
+		delptr delMaster = GetPortDestroyer(portlib, "DNP3Master");
+		REQUIRE(delMaster);
+
+		Json::Value Controls;
+		Controls[0]["Index"] = 0;
+
+		//upstream master -> outstation (waits for results) -> downstream master -> outstation
+		Json::Value UMconf;
+		UMconf["ServerType"] = "PERSISTENT";
+		UMconf["Port"] = 20010;
+		UMconf["BinaryControls"] = Controls;
+		auto UpMaster = std::unique_ptr<DataPort,delptr>(newMaster("UpstreamMaster", "", UMconf), delMaster);
+		REQUIRE(UpMaster);
+
+		Json::Value Oconf;
+		Oconf["IP"] = "0.0.0.0";
+		Oconf["Port"] = 20010;
+		Oconf["BinaryControls"] = Controls;
+		Oconf["WaitForCommandResponses"] = true;
+		Oconf["CommandResponseTimeoutms"] = 5000;
+		auto OPUT = std::shared_ptr<DataPort>(newOutstation("OutstationUnderTest", "", Oconf), delOutstation);
+		REQUIRE(OPUT);
+
+		Json::Value DMconf;
+		DMconf["ServerType"] = "PERSISTENT";
+		DMconf["Port"] = 20011;
+		DMconf["BinaryControls"] = Controls;
+		auto DownMaster = std::unique_ptr<DataPort,delptr>(newMaster("DownstreamMaster", "", DMconf), delMaster);
+		REQUIRE(DownMaster);
+
+		Json::Value DOconf;
+		DOconf["IP"] = "0.0.0.0";
+		DOconf["Port"] = 20011;
+		DOconf["BinaryControls"] = Controls;
+		auto DownOutstation = std::shared_ptr<DataPort>(newOutstation("DownstreamOutstation", "", DOconf), delOutstation);
+		REQUIRE(DownOutstation);
+
+		//pass the outstation's commands on to the downstream master
+		OPUT->Subscribe(DownMaster.get(), "DownstreamMaster");
+
+		std::vector<DataPort*> ports = {UpMaster.get(), OPUT.get(), DownMaster.get(), DownOutstation.get()};
+		for(auto port : ports)
+		{
+			port->Build();
+			port->SetIOS(ios);
+		}
+		for(auto port : ports)
+			port->Enable();
+
+		unsigned int count = 0;
+		auto any_down = [&]()
+				    {
+					    for(auto port : ports)
+						    if(port->GetStatus()["Result"].asString() == "Port enabled - link down")
+							    return true;
+					    return false;
+				    };
+		while(any_down() && count < 20000)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			count++;
+		}
+		REQUIRE_FALSE(any_down());
+
+		std::atomic<bool> done(false);
+		std::atomic<CommandStatus> result(CommandStatus::UNDEFINED);
+		auto crob = std::make_shared<EventInfo>(EventType::ControlRelayOutputBlock,0,"Test");
+		crob->SetPayload<EventType::ControlRelayOutputBlock>(ControlRelayOutputBlock());
+		auto start = std::chrono::steady_clock::now();
+		UpMaster->Event(crob, "Test", std::make_shared<std::function<void (CommandStatus)>>([&](CommandStatus status)
+			{
+				result = status;
+				done = true;
+			}));
+		while(!done && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		//answered without waiting out the outstation's response timeout, and not as a success it can't vouch for
+		REQUIRE(done);
+		CHECK(result == CommandStatus::TOO_MANY_OPS);
+		CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(2500));
+
+		for(auto port : ports)
+			port->Disable();
+
+		work.reset();
+		t.join();
+		ios.reset();
+	}
+	//Unload the library
+	UnLoadModule(portlib);
+	odc::SetThreadBudget(default_budget);
+}
@@ -0,0 +1,134 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * BoundedMPMCQueueTests.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include <opendatacon/BoundedMPMCQueue.h>
+
+using namespace odc;
+
+#define SUITE(name) "BoundedMPMCQueueTestSuite - " name
+
+TEST_CASE(SUITE("FIFOAndLimit"))
+{
+	//limits don't have to be a power of two
+	BoundedMPMCQueue<int> queue(15);
+	REQUIRE(queue.Capacity() == 15);
+	REQUIRE(queue.Empty());
+	int value = 0;
+	REQUIRE_FALSE(queue.Front(value));
+	REQUIRE_FALSE(queue.Pop());
+
+	for(int i = 0; i < 15; i++)
+		REQUIRE(queue.Push(i));
+	REQUIRE(queue.Size() == 15);
+	REQUIRE_FALSE(queue.Push(15));
+	REQUIRE(queue.OverflowCount() == 1);
+
+	REQUIRE(queue.Front(value));
+	REQUIRE(value == 0);
+	REQUIRE(queue.Pop());
+	REQUIRE(queue.Pop(value));
+	REQUIRE(value == 1);
+
+	//leave a place free for a marker
+	REQUIRE(queue.Push(100,1));
+	REQUIRE_FALSE(queue.Push(101,1));
+	REQUIRE(queue.Push(-1));
+	REQUIRE(queue.OverflowCount() == 2);
+
+	for(int i = 2; i < 15; i++)
+	{
+		REQUIRE(queue.Pop(value));
+		REQUIRE(value == i);
+	}
+	REQUIRE(queue.Pop(value));
+	REQUIRE(value == 100);
+	REQUIRE(queue.Pop(value));
+	REQUIRE(value == -1);
+	REQUIRE(queue.Empty());
+	REQUIRE(queue.Size() == 0);
+
+	//round and round the ring
+	for(int i = 0; i < 1000; i++)
+	{
+		REQUIRE(queue.Push(i));
+		REQUIRE(queue.Pop(value));
+		REQUIRE(value == i);
+	}
+}
+
+TEST_CASE(SUITE("ConcurrentProducersConsumers"))
+{
+	const size_t num_producers = 4;
+	const size_t num_consumers = 4;
+	const uint32_t per_producer = 100000;
+	BoundedMPMCQueue<uint64_t> queue(64);
+
+	std::atomic<size_t> producers_done(0), out_of_order(0);
+	std::vector<std::atomic<uint32_t>> received(num_producers);
+	for(auto& r : received)
+		r = 0;
+
+	std::vector<std::thread> threads;
+	for(size_t p = 0; p < num_producers; p++)
+		threads.emplace_back([&,p]()
+			{
+				for(uint32_t i = 0; i < per_producer; i++)
+					while(!queue.Push((uint64_t(p)<<32)|i))
+						std::this_thread::yield();
+				producers_done++;
+			});
+	for(size_t c = 0; c < num_consumers; c++)
+		threads.emplace_back([&]()
+			{
+				//each consumer sees each producer's items in order
+				std::vector<int64_t> last(num_producers,-1);
+				uint64_t item;
+				while(producers_done < num_producers || !queue.Empty())
+				{
+					if(!queue.Pop(item))
+					{
+						std::this_thread::yield();
+						continue;
+					}
+					auto p = item>>32;
+					int64_t i = item & 0xFFFFFFFF;
+					if(i <= last[p])
+						out_of_order++;
+					last[p] = i;
+					received[p]++;
+				}
+			});
+	for(auto& t : threads)
+		t.join();
+
+	REQUIRE(out_of_order == 0);
+	for(auto& r : received)
+		REQUIRE(r == per_producer);
+	REQUIRE(queue.Empty());
+}
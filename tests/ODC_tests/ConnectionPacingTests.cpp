@@ -0,0 +1,138 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * ConnectionPacingTests.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+#include <chrono>
+#include <memory>
+#include <set>
+#include <vector>
+#include <catch.hpp>
+#include <opendatacon/ConnectionPacing.h>
+
+using namespace odc;
+
+#define SUITE(name) "ConnectionPacingTestSuite - " name
+
+TEST_CASE(SUITE("DecorrelatedJitter"))
+{
+	//a crowd of connections that all dropped at the same time
+	const auto base = std::chrono::milliseconds(125);
+	const auto cap = std::chrono::seconds(30);
+	std::vector<DecorrelatedJitter> crowd;
+	for(size_t i = 0; i < 500; i++)
+		crowd.emplace_back(base,cap);
+
+	std::chrono::milliseconds last_mean(0);
+	for(size_t retry = 0; retry < 8; retry++)
+	{
+		std::set<std::chrono::milliseconds::rep> delays;
+		std::chrono::milliseconds total(0);
+		bool in_range = true;
+		for(auto& backoff : crowd)
+		{
+			auto delay = backoff.Next();
+			in_range &= (delay >= base && delay <= cap);
+			delays.insert(delay.count());
+			total += delay;
+		}
+		CHECK(in_range);
+		//they don't retry in lockstep
+		CHECK(delays.size() > 100);
+		//and they back off
+		auto mean = total/crowd.size();
+		CHECK(mean > last_mean);
+		last_mean = mean;
+	}
+
+	//but not forever
+	for(size_t retry = 0; retry < 100; retry++)
+		crowd.front().Next();
+	CHECK(crowd.front().Next() <= cap);
+
+	//a retry time is the most it waits, and at least half
+	DecorrelatedJitter fixed(std::chrono::milliseconds(500),std::chrono::milliseconds(1000));
+	for(size_t retry = 0; retry < 100; retry++)
+	{
+		auto delay = fixed.Next();
+		CHECK(delay >= std::chrono::milliseconds(500));
+		CHECK(delay <= std::chrono::milliseconds(1000));
+	}
+}
+
+//Switches virtual time on for a test, and back off again even if it fails
+struct PacingScope
+{
+	PacingScope(){ EnableVirtualTime(); }
+	~PacingScope()
+	{
+		SetConnectRateLimit(0);
+		DisableVirtualTime();
+	}
+};
+
+TEST_CASE(SUITE("RateLimit"))
+{
+	PacingScope scope;
+	auto pIOS = std::make_shared<asio_service>(1);
+	//so it doesn't stop between runs
+	auto work = pIOS->make_work();
+
+	//no limit by default
+	const auto unlimited_start = asio_clock::now();
+	std::vector<asio_clock::duration> unlimited;
+	for(size_t i = 0; i < 20; i++)
+		PaceConnect(pIOS,[&](){ unlimited.push_back(asio_clock::now()-unlimited_start); });
+	pIOS->run_virtual();
+	REQUIRE(unlimited.size() == 20);
+	for(auto& t : unlimited)
+		CHECK(t == asio_clock::duration::zero());
+
+	//a burst of 5 straight away, then 10 a second
+	SetConnectRateLimit(10,5);
+	const auto start = asio_clock::now();
+	std::vector<std::pair<size_t,asio_clock::duration>> started;
+	for(size_t i = 0; i < 25; i++)
+		PaceConnect(pIOS,[&,i](){ started.emplace_back(i,asio_clock::now()-start); });
+	pIOS->run_virtual();
+	REQUIRE(started.size() == 25);
+	for(size_t i = 0; i < started.size(); i++)
+	{
+		//in the order they asked
+		CHECK(started[i].first == i);
+		auto due = i < 5 ? asio_clock::duration::zero() : std::chrono::milliseconds(100)*(i-4);
+		CHECK(started[i].second == due);
+	}
+
+	//after a quiet spell, the burst is available again
+	AdvanceVirtualTime(std::chrono::seconds(10));
+	const auto later = asio_clock::now();
+	std::vector<asio_clock::duration> burst;
+	for(size_t i = 0; i < 6; i++)
+		PaceConnect(pIOS,[&](){ burst.push_back(asio_clock::now()-later); });
+	pIOS->run_virtual();
+	REQUIRE(burst.size() == 6);
+	for(size_t i = 0; i < 5; i++)
+		CHECK(burst[i] == asio_clock::duration::zero());
+	CHECK(burst[5] == std::chrono::milliseconds(100));
+}
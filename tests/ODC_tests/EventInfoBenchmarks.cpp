@@ -0,0 +1,229 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * EventInfoBenchmarks.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include <opendatacon/IOTypes.h>
+#include "AllocationCounter.h"
+
+using namespace odc;
+
+#define SUITE(name) "EventInfoBenchmarkSuite - " name
+
+TEST_CASE(SUITE("AllocationsPerEvent"))
+{
+	//long enough to defeat the small string optimisation
+	const std::string source = "AllocationsPerEventSourcePort";
+	//first use interns the name (allocates), after that it's free
+	InternSourcePort(source);
+
+	//fixed size payloads live inside the EventInfo: the only allocation is make_shared
+	auto count = ThreadAllocationCount();
+	auto analog = std::make_shared<EventInfo>(EventType::Analog,1,source);
+	analog->SetPayload<EventType::Analog>(1.5);
+	//Catch allocates while building assertions, so take the count first
+	auto allocs = ThreadAllocationCount()-count;
+	REQUIRE(allocs == 1);
+
+	count = ThreadAllocationCount();
+	auto analog_copy = std::make_shared<EventInfo>(*analog);
+	allocs = ThreadAllocationCount()-count;
+	REQUIRE(allocs == 1);
+	REQUIRE(analog_copy->GetPayload<EventType::Analog>() == 1.5);
+	REQUIRE(analog_copy->GetSourcePort() == source);
+	REQUIRE(analog_copy->GetSourcePortID() == analog->GetSourcePortID());
+
+	count = ThreadAllocationCount();
+	auto crob = std::make_shared<EventInfo>(EventType::ControlRelayOutputBlock,2,source);
+	crob->SetPayload<EventType::ControlRelayOutputBlock>(ControlRelayOutputBlock());
+	allocs = ThreadAllocationCount()-count;
+	REQUIRE(allocs == 1);
+
+	//OctetString is the only payload that goes on the heap
+	std::string octets = "a string long enough that it doesn't fit inline";
+	count = ThreadAllocationCount();
+	auto octet_event = std::make_shared<EventInfo>(EventType::OctetString,3,source);
+	octet_event->SetPayload<EventType::OctetString>(std::move(octets));
+	allocs = ThreadAllocationCount()-count;
+	REQUIRE(allocs == 2);
+
+	REQUIRE(sizeof(EventInfo) <= 48);
+}
+
+TEST_CASE(SUITE("PooledEvents"))
+{
+	const std::string source = "PooledEventsSourcePort";
+	InternSourcePort(source);
+	//prime this thread's free list (the loop below has two events alive at once)
+	{
+		auto prime1 = MakeEvent(EventType::Analog,0,source);
+		auto prime2 = MakeEvent(EventType::Analog,0,source);
+	}
+
+	auto count = ThreadAllocationCount();
+	auto heap_count = EventPoolHeapAllocations();
+	for(size_t i = 0; i < 1000; i++)
+	{
+		auto event = MakeEvent(EventType::Analog,i,source);
+		event->SetPayload<EventType::Analog>(double(i));
+		auto copy = MakeEvent(*event);
+	}
+	auto allocs = ThreadAllocationCount()-count;
+	auto heap_allocs = EventPoolHeapAllocations()-heap_count;
+	REQUIRE(allocs == 0);
+	REQUIRE(heap_allocs == 0);
+
+	//events are usually created on one thread and destroyed on another
+	const size_t num_events = 10000;
+	std::vector<std::shared_ptr<EventInfo>> events;
+	events.reserve(num_events);
+	for(size_t round = 0; round < 5; round++)
+	{
+		heap_count = EventPoolHeapAllocations();
+		std::thread producer([&]()
+			{
+				for(size_t i = 0; i < num_events; i++)
+					events.push_back(MakeEvent(EventType::Binary,i,source));
+			});
+		producer.join();
+		std::thread consumer([&](){ events.clear(); });
+		consumer.join();
+		heap_allocs = EventPoolHeapAllocations()-heap_count;
+		if(round == 0)
+			REQUIRE(heap_allocs <= num_events);
+		else
+			REQUIRE(heap_allocs == 0);
+	}
+}
+
+TEST_CASE(SUITE("EventThroughput"),"[.][benchmark]")
+{
+	const size_t num_events = 1000000;
+	const std::string source = "EventThroughputSourcePort";
+	InternSourcePort(source);
+
+	auto count = ThreadAllocationCount();
+	auto start = std::chrono::high_resolution_clock::now();
+	size_t index_sum = 0;
+	for(size_t i = 0; i < num_events; i++)
+	{
+		auto event = std::make_shared<EventInfo>(EventType::Analog,i,source);
+		event->SetPayload<EventType::Analog>(double(i));
+		auto copy = std::make_shared<EventInfo>(*event);
+		index_sum += copy->GetIndex();
+	}
+	auto time = std::chrono::high_resolution_clock::now() - start;
+	auto allocs = ThreadAllocationCount()-count;
+	REQUIRE(index_sum == num_events*(num_events-1)/2);
+
+	std::cout<<"EventInfo create+copy (make_shared): "
+	         <<double(allocs)/num_events<<" allocations per event, "
+	         <<std::chrono::duration_cast<std::chrono::nanoseconds>(time).count()/num_events<<"ns per event"<<std::endl;
+
+	count = ThreadAllocationCount();
+	start = std::chrono::high_resolution_clock::now();
+	index_sum = 0;
+	for(size_t i = 0; i < num_events; i++)
+	{
+		auto event = MakeEvent(EventType::Analog,i,source);
+		event->SetPayload<EventType::Analog>(double(i));
+		auto copy = MakeEvent(*event);
+		index_sum += copy->GetIndex();
+	}
+	time = std::chrono::high_resolution_clock::now() - start;
+	allocs = ThreadAllocationCount()-count;
+	REQUIRE(index_sum == num_events*(num_events-1)/2);
+
+	std::cout<<"EventInfo create+copy (MakeEvent): "
+	         <<double(allocs)/num_events<<" allocations per event, "
+	         <<std::chrono::duration_cast<std::chrono::nanoseconds>(time).count()/num_events<<"ns per event"<<std::endl;
+}
+
+//Events are made on one thread (eg. a port's) and released on another (the last subscriber's)
+//	returns ns per event
+template<typename Make>
+static double CrossThreadTime(Make make)
+{
+	const size_t batch_size = 1000;
+	const size_t num_batches = 2000;
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::deque<std::vector<std::shared_ptr<EventInfo>>> handed_over;
+	bool done = false;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	std::thread consumer([&]()
+		{
+			std::unique_lock<std::mutex> lck(mtx);
+			while(true)
+			{
+				cv.wait(lck,[&](){ return done || !handed_over.empty(); });
+				if(handed_over.empty())
+					return;
+				auto batch = std::move(handed_over.front());
+				handed_over.pop_front();
+				lck.unlock();
+				batch.clear();
+				lck.lock();
+			}
+		});
+	for(size_t b = 0; b < num_batches; b++)
+	{
+		std::vector<std::shared_ptr<EventInfo>> batch;
+		batch.reserve(batch_size);
+		for(size_t i = 0; i < batch_size; i++)
+			batch.push_back(make(i));
+		std::lock_guard<std::mutex> lck(mtx);
+		handed_over.push_back(std::move(batch));
+		cv.notify_one();
+	}
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		done = true;
+		cv.notify_one();
+	}
+	consumer.join();
+	auto time = std::chrono::high_resolution_clock::now() - start;
+	return double(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count())/(batch_size*num_batches);
+}
+
+TEST_CASE(SUITE("CrossThreadThroughput"),"[.][benchmark]")
+{
+	const std::string source = "CrossThreadThroughputSourcePort";
+	InternSourcePort(source);
+
+	for(size_t run = 0; run < 3; run++)
+	{
+		auto heap = CrossThreadTime([&](size_t i){ return std::make_shared<EventInfo>(EventType::Analog,i,source); });
+		auto pooled = CrossThreadTime([&](size_t i){ return MakeEvent(EventType::Analog,i,source); });
+		std::cout<<"EventInfo made on one thread, released on another: make_shared "<<heap<<"ns, MakeEvent "<<pooled<<"ns per event"<<std::endl;
+	}
+}
@@ -0,0 +1,219 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * HandlerMonitorTests.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include <opendatacon/asio.h>
+#include <opendatacon/HandlerMonitor.h>
+#include <opendatacon/ShardedExecutor.h>
+
+using namespace odc;
+
+#define SUITE(name) "HandlerMonitorTestSuite - " name
+
+//runs an asio_service on a few threads for the life of the object
+struct RunningIOS
+{
+	RunningIOS():
+		pIOS(std::make_shared<asio_service>(2)),
+		work(pIOS->make_work())
+	{
+		for(size_t i = 0; i < 2; i++)
+			threads.emplace_back([this](){ pIOS->run(); });
+	}
+	~RunningIOS()
+	{
+		work.reset();
+		for(auto& t : threads)
+			t.join();
+	}
+	std::shared_ptr<asio_service> pIOS;
+	std::unique_ptr<asio::io_service::work> work;
+	std::vector<std::thread> threads;
+};
+
+static void WaitFor(const std::atomic<size_t>& count, const size_t target)
+{
+	auto deadline = std::chrono::steady_clock::now()+std::chrono::seconds(10);
+	while(count < target && std::chrono::steady_clock::now() < deadline)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+static uint64_t HistogramTotal(const HandlerOwner* pOwner)
+{
+	uint64_t total = 0;
+	for(auto& bucket : pOwner->Histogram)
+		total += bucket;
+	return total;
+}
+
+TEST_CASE(SUITE("Accounting"))
+{
+	EnableHandlerMonitor(std::chrono::milliseconds(50),std::chrono::milliseconds(10));
+	RunningIOS ios;
+
+	auto pOwner = GetHandlerOwner("HandlerMonitorTests Accounting");
+	REQUIRE(GetHandlerOwner("HandlerMonitorTests Accounting") == pOwner);
+	REQUIRE(GetHandlerOwner("")->Name == "unattributed");
+
+	auto pSerial = ios.pIOS->make_serial_executor("HandlerMonitorTests Accounting");
+	std::atomic<size_t> done(0);
+	for(size_t i = 0; i < 100; i++)
+		pSerial->post([&](){ done++; });
+	pSerial->post([&]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			done++;
+		});
+	WaitFor(done,101);
+	//the count goes up after the handler returns
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	CHECK(pOwner->Count == 101);
+	CHECK(HistogramTotal(pOwner) == 101);
+	CHECK(pOwner->Slow == 1);
+	CHECK(pOwner->MaxNs >= 100000000);
+	CHECK(pOwner->TotalNs >= pOwner->MaxNs);
+
+	//handlers move with the owner
+	pSerial->set_owner("HandlerMonitorTests Accounting 2");
+	pSerial->post([&](){ done++; });
+	WaitFor(done,102);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	CHECK(pOwner->Count == 101);
+	CHECK(GetHandlerOwner("HandlerMonitorTests Accounting 2")->Count == 1);
+
+	//shard mailboxes are accounted too
+	ShardedExecutor Executor(1);
+	Executor.Start();
+	Executor.Post(0,[&](){ done++; },pOwner);
+	Executor.Stop();
+	Executor.Join();
+	CHECK(pOwner->Count == 102);
+
+	auto stats = GetHandlerStats("HandlerMonitorTests Accounting.*");
+	CHECK(stats.size() == 2);
+	CHECK(stats["HandlerMonitorTests Accounting"]["Count"].asUInt64() == 102);
+	CHECK(stats["HandlerMonitorTests Accounting"]["Slow"].asUInt64() == 1);
+	REQUIRE_THROWS(GetHandlerStats("(unbalanced"));
+
+	DisableHandlerMonitor();
+}
+
+TEST_CASE(SUITE("RawPosts"))
+{
+	EnableHandlerMonitor(std::chrono::milliseconds(50),std::chrono::milliseconds(10));
+	RunningIOS ios;
+
+	auto pOwner = GetHandlerOwner("HandlerMonitorTests RawPosts");
+	auto pOther = GetHandlerOwner("HandlerMonitorTests RawPosts Other");
+	auto pSerial = ios.pIOS->make_serial_executor("HandlerMonitorTests RawPosts");
+	std::atomic<size_t> done(0);
+
+	//posted straight to the service from one of our handlers, so it's still ours
+	pSerial->post([&]()
+		{
+			ios.pIOS->post([&](){ done++; });
+			done++;
+		});
+	WaitFor(done,2);
+	//explicitly owned
+	ios.pIOS->post([&](){ done++; },pOther);
+	WaitFor(done,3);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	CHECK(pOwner->Count == 2);
+	CHECK(pOther->Count == 1);
+
+	//a shared executor can attribute each handler to whoever it's for, inline dispatches included
+	auto pShared = ios.pIOS->make_serial_executor("HandlerMonitorTests RawPosts Shared");
+	auto pShared2 = GetHandlerOwner("HandlerMonitorTests RawPosts Shared");
+	pShared->post([&](){ done++; },pOther);
+	pShared->post([&]()
+		{
+			pShared->dispatch([&](){ done++; },pOwner);
+			//the same owner doesn't get counted twice
+			pShared->dispatch([&](){ done++; },pShared2);
+			done++;
+		});
+	WaitFor(done,7);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	CHECK(pOther->Count == 2);
+	CHECK(pOwner->Count == 3);
+	CHECK(pShared2->Count == 1);
+
+	DisableHandlerMonitor();
+}
+
+TEST_CASE(SUITE("Watchdog"))
+{
+	EnableHandlerMonitor(std::chrono::milliseconds(50),std::chrono::milliseconds(10));
+	RunningIOS ios;
+
+	auto pOwner = GetHandlerOwner("HandlerMonitorTests Watchdog");
+	auto pSerial = ios.pIOS->make_serial_executor("HandlerMonitorTests Watchdog");
+	std::atomic<size_t> done(0);
+	std::atomic<bool> caught(false);
+	pSerial->post([&]()
+		{
+			//stay stalled until the watchdog notices, then a while longer to make sure it only reports once
+			auto deadline = std::chrono::steady_clock::now()+std::chrono::seconds(10);
+			while(pOwner->Stalls == 0 && std::chrono::steady_clock::now() < deadline)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			caught = (pOwner->Stalls != 0);
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			done++;
+		});
+	WaitFor(done,1);
+	CHECK(caught);
+	CHECK(pOwner->Stalls == 1);
+
+	ResetHandlerStats();
+	CHECK(pOwner->Stalls == 0);
+	CHECK(pOwner->Count == 0);
+
+	DisableHandlerMonitor();
+}
+
+TEST_CASE(SUITE("Disabled"))
+{
+	DisableHandlerMonitor();
+	REQUIRE_FALSE(HandlerMonitorEnabled());
+	RunningIOS ios;
+
+	auto pOwner = GetHandlerOwner("HandlerMonitorTests Disabled");
+	auto pSerial = ios.pIOS->make_serial_executor("HandlerMonitorTests Disabled");
+	std::atomic<size_t> done(0);
+	for(size_t i = 0; i < 100; i++)
+		pSerial->post([&](){ done++; });
+	WaitFor(done,100);
+
+	CHECK(pOwner->Count == 0);
+	//with the fair share off too, the queue depth isn't counted either
+	CHECK(pOwner->MaxQueueDepth == 0);
+	CHECK(GetHandlerStats("HandlerMonitorTests Disabled").size() == 0);
+}
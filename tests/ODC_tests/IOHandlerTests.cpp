@@ -24,6 +24,12 @@
  *      Author: Neil Stephens <dearknarl@gmail.com>
  */
 #include <catch.hpp>
+#include <chrono>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <opendatacon/IOTypes.h>
 #include "TestPorts.h"
 #include "../opendatacon/DataConnector.h"
@@ -32,6 +38,34 @@ using namespace odc;
 
 #define SUITE(name) "IOHandlerTestSuite - " name
 
+class CountingTransform: public Transform
+{
+public:
+	CountingTransform(): Transform(Json::Value::nullSingleton())
+	{
+		AppliesToTypes({EventType::Analog});
+		AppliesToIndexes(10,19);
+	}
+	bool Event(std::shared_ptr<EventInfo> event) override
+	{
+		Calls++;
+		return event->GetIndex() != 15;
+	}
+	size_t Calls = 0;
+};
+
+class TransformTestConnector: public DataConnector
+{
+public:
+	TransformTestConnector(std::string aName, std::string aConfFilename, const Json::Value aConfOverrides):
+		DataConnector(aName,aConfFilename,aConfOverrides)
+	{}
+	void AddTransform(const std::string& Sender, Transform* pTransform)
+	{
+		ConnectionTransforms[Sender].push_back(std::unique_ptr<Transform, std::function<void(Transform*)>>(pTransform,[](Transform*){}));
+	}
+};
+
 TEST_CASE(SUITE("StatusCallback"))
 {
 	/*
@@ -127,3 +161,724 @@ TEST_CASE(SUITE("StatusCallback"))
 			REQUIRE(cb_status == CommandStatus::UNDEFINED);
 	}
 }
+
+TEST_CASE(SUITE("BatchEvents"))
+{
+	/*
+	 * Publish a batch of events through three connectors:
+	 *	- one without transforms
+	 *	- one with a transform that moves every index
+	 *	- one with a transform that blocks some of the events
+	 * verify each sink gets one call for the whole batch, and the status callback
+	 */
+
+	auto ios = std::make_shared<odc::asio_service>();
+	auto work = ios->make_work();
+
+	PublicPublishPort Source("BatchSource","",Json::Value::nullSingleton());
+	BatchCountPort PlainSink("PlainSink","",Json::Value::nullSingleton());
+	BatchCountPort OffsetSink("OffsetSink","",Json::Value::nullSingleton());
+	BatchCountPort BlockSink("BlockSink","",Json::Value::nullSingleton());
+
+	Json::Value Conn1Conf;
+	Conn1Conf["Connections"][0]["Name"] = "SourcetoPlainSink";
+	Conn1Conf["Connections"][0]["Port1"] = "BatchSource";
+	Conn1Conf["Connections"][0]["Port2"] = "PlainSink";
+	Json::Value Conn2Conf;
+	Conn2Conf["Connections"][0]["Name"] = "SourcetoOffsetSink";
+	Conn2Conf["Connections"][0]["Port1"] = "BatchSource";
+	Conn2Conf["Connections"][0]["Port2"] = "OffsetSink";
+	Conn2Conf["Transforms"][0]["Type"] = "IndexOffset";
+	Conn2Conf["Transforms"][0]["Sender"] = "BatchSource";
+	Conn2Conf["Transforms"][0]["Parameters"]["Offset"] = 1;
+	Json::Value Conn3Conf;
+	Conn3Conf["Connections"][0]["Name"] = "SourcetoBlockSink";
+	Conn3Conf["Connections"][0]["Port1"] = "BatchSource";
+	Conn3Conf["Connections"][0]["Port2"] = "BlockSink";
+	//IndexOffset blocks anything it would move to index 0 or below
+	Conn3Conf["Transforms"][0]["Type"] = "IndexOffset";
+	Conn3Conf["Transforms"][0]["Sender"] = "BatchSource";
+	Conn3Conf["Transforms"][0]["Parameters"]["Offset"] = -50;
+
+	DataConnector Conn1("BatchConn1","",Conn1Conf);
+	DataConnector Conn2("BatchConn2","",Conn2Conf);
+	DataConnector Conn3("BatchConn3","",Conn3Conf);
+	DataConnector* Conns[3] = {&Conn1,&Conn2,&Conn3};
+
+	Source.SetIOS(ios);
+	PlainSink.SetIOS(ios);
+	OffsetSink.SetIOS(ios);
+	BlockSink.SetIOS(ios);
+	for(auto& c :Conns)
+	{
+		c->SetIOS(ios);
+		c->Enable();
+	}
+
+	std::atomic_bool executed(false);
+	CommandStatus cb_status;
+	auto StatusCallback = std::make_shared<std::function<void (CommandStatus status)>>([&](CommandStatus status)
+		{
+			cb_status = status;
+			executed = true;
+		});
+
+	const size_t num_events = 100;
+	EventBatch_t batch;
+	for(size_t i = 0; i < num_events; i++)
+	{
+		auto event = MakeEvent(EventType::Analog,i,"BatchSource");
+		event->SetPayload<EventType::Analog>(double(i));
+		batch.push_back(std::move(event));
+	}
+
+	Source.PublicPublishEvent(batch,StatusCallback);
+	while(!executed)
+		ios->run_one();
+
+	//the blocked events make the overall result UNDEFINED, like for single events
+	REQUIRE(cb_status == CommandStatus::UNDEFINED);
+
+	REQUIRE(PlainSink.Batches == 1);
+	REQUIRE(PlainSink.Indexes.size() == num_events);
+	REQUIRE(OffsetSink.Batches == 1);
+	REQUIRE(OffsetSink.Indexes.size() == num_events);
+	for(size_t i = 0; i < num_events; i++)
+	{
+		REQUIRE(PlainSink.Indexes[i] == i);
+		REQUIRE(OffsetSink.Indexes[i] == i+1);
+	}
+	REQUIRE(BlockSink.Batches == 1);
+	REQUIRE(BlockSink.Indexes.size() == num_events-51);
+	REQUIRE(BlockSink.Indexes.front() == 1);
+
+	//the source events weren't touched by the transforms
+	for(size_t i = 0; i < num_events; i++)
+		REQUIRE(batch[i]->GetIndex() == i);
+
+	//an empty batch completes straight away
+	executed = false;
+	cb_status = CommandStatus::UNDEFINED;
+	Source.PublicPublishEvent(EventBatch_t(),StatusCallback);
+	REQUIRE(executed);
+	REQUIRE(cb_status == CommandStatus::SUCCESS);
+}
+
+TEST_CASE(SUITE("BatchPriority"))
+{
+	//controls in a batch are delivered ahead of the telemetry, keeping the order within each
+	auto ios = std::make_shared<odc::asio_service>();
+	PublicPublishPort Source("PrioritySource","",Json::Value::nullSingleton());
+	BatchCountPort Sink("PrioritySink","",Json::Value::nullSingleton());
+	Json::Value ConnConf;
+	ConnConf["Connections"][0]["Name"] = "SourcetoSink";
+	ConnConf["Connections"][0]["Port1"] = "PrioritySource";
+	ConnConf["Connections"][0]["Port2"] = "PrioritySink";
+	DataConnector Conn("PriorityConn","",ConnConf);
+	Source.SetIOS(ios);
+	Sink.SetIOS(ios);
+	Conn.SetIOS(ios);
+	Conn.Enable();
+
+	EventBatch_t batch;
+	batch.push_back(MakeEvent(EventType::Analog,0,"PrioritySource"));
+	batch.push_back(MakeEvent(EventType::ControlRelayOutputBlock,1,"PrioritySource"));
+	batch.push_back(MakeEvent(EventType::Binary,2,"PrioritySource"));
+	batch.push_back(MakeEvent(EventType::AnalogOutputInt16,3,"PrioritySource"));
+	batch.push_back(MakeEvent(EventType::Analog,4,"PrioritySource"));
+
+	CommandStatus cb_status = CommandStatus::UNDEFINED;
+	size_t callbacks = 0;
+	auto StatusCallback = std::make_shared<std::function<void (CommandStatus status)>>([&](CommandStatus status)
+		{
+			cb_status = status;
+			callbacks++;
+		});
+	Source.PublicPublishEvent(batch,StatusCallback);
+
+	REQUIRE(callbacks == 1);
+	REQUIRE(cb_status == CommandStatus::SUCCESS);
+	REQUIRE(Sink.Batches == 1);
+	REQUIRE(Sink.Indexes == std::vector<size_t>({1,3,0,2,4}));
+	//the publisher's batch is left alone
+	REQUIRE(batch[0]->GetIndex() == 0);
+}
+
+TEST_CASE(SUITE("BatchEventsDefaultAdapter"))
+{
+	//a port that only handles single events still gets every event in a batch, in order
+	auto ios = std::make_shared<odc::asio_service>();
+	auto work = ios->make_work();
+
+	PayloadCheckPort Sink("AdapterSink","",Json::Value::nullSingleton());
+	Sink.SetIOS(ios);
+
+	std::atomic_bool executed(false);
+	CommandStatus cb_status;
+	auto StatusCallback = std::make_shared<std::function<void (CommandStatus status)>>([&](CommandStatus status)
+		{
+			cb_status = status;
+			executed = true;
+		});
+
+	EventBatch_t batch;
+	for(size_t i = 0; i < 10; i++)
+	{
+		auto event = MakeEvent(EventType::OctetString,i,"AdapterSource");
+		event->SetPayload<EventType::OctetString>(std::to_string(i)+"_AdapterSource_"+ToString(event->GetQuality())+"_"+std::to_string(event->GetTimestamp()));
+		batch.push_back(std::move(event));
+	}
+	IOHandler* pSink = &Sink;
+	pSink->Event(batch,"AdapterSource",StatusCallback);
+	while(!executed)
+		ios->run_one();
+	REQUIRE(cb_status == CommandStatus::SUCCESS);
+
+	//one bad payload spoils the whole batch
+	auto bad_event = MakeEvent(EventType::OctetString,10,"AdapterSource");
+	bad_event->SetPayload<EventType::OctetString>("wrong");
+	batch.push_back(bad_event);
+	executed = false;
+	pSink->Event(batch,"AdapterSource",StatusCallback);
+	while(!executed)
+		ios->run_one();
+	REQUIRE(cb_status == CommandStatus::UNDEFINED);
+}
+
+TEST_CASE(SUITE("MultiCallbackThreads"))
+{
+	//results coming in from many threads at once still make exactly one callback
+	PublicPublishPort Port("MultiCallbackPort","",Json::Value::nullSingleton());
+	const size_t num_threads = 8;
+	const size_t per_thread = 1000;
+
+	for(auto odd_one_out : {false, true})
+	{
+		for(size_t round = 0; round < 20; round++)
+		{
+			std::atomic<size_t> calls(0);
+			std::atomic<CommandStatus> result(CommandStatus::SUCCESS);
+			auto StatusCallback = std::make_shared<std::function<void (CommandStatus status)>>([&](CommandStatus status)
+				{
+					result = status;
+					calls++;
+				});
+			auto multi_callback = Port.PublicSyncMultiCallback(num_threads*per_thread,StatusCallback);
+
+			std::vector<std::thread> threads;
+			for(size_t t = 0; t < num_threads; t++)
+			{
+				threads.emplace_back([=]()
+					{
+						for(size_t i = 0; i < per_thread; i++)
+						{
+							bool odd = odd_one_out && t == num_threads-1 && i == per_thread/2;
+							(*multi_callback)(odd ? CommandStatus::BLOCKED : CommandStatus::SUCCESS);
+						}
+					});
+			}
+			for(auto& t : threads)
+				t.join();
+
+			REQUIRE(calls == 1);
+			if(odd_one_out)
+				REQUIRE(result == CommandStatus::UNDEFINED);
+			else
+				REQUIRE(result == CommandStatus::SUCCESS);
+		}
+	}
+}
+
+//Answers controls some time later, from a timer - like a port waiting on a downstream device
+class DeferredResponsePort: public NullPort
+{
+public:
+	DeferredResponsePort(const std::string& aName, const std::string& aConfFilename, const Json::Value& aConfOverrides):
+		NullPort(aName, aConfFilename, aConfOverrides)
+	{}
+	void Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override
+	{
+		std::shared_ptr<odc::steady_timer> pTimer = pIOS->make_steady_timer(std::chrono::milliseconds(200));
+		pTimer->async_wait([pTimer,pStatusCallback](asio::error_code err)
+			{
+				(*pStatusCallback)(CommandStatus::SUCCESS);
+			});
+	}
+};
+
+TEST_CASE(SUITE("StatusWaiter"))
+{
+	//100 controls at once, each from a thread that has to wait for the result (like the opendnp3 stack does)
+	//	the waiting threads should sleep, not burn CPU
+	auto ios = std::make_shared<odc::asio_service>(2);
+	auto work = ios->make_work();
+	std::vector<std::thread> ios_threads;
+	for(size_t i = 0; i < 2; i++)
+		ios_threads.emplace_back([&](){ ios->run(); });
+
+	PublicPublishPort Source("WaiterSource","",Json::Value::nullSingleton());
+	DeferredResponsePort Sink("WaiterSink","",Json::Value::nullSingleton());
+	Sink.SetIOS(ios);
+	Json::Value ConnConf;
+	ConnConf["Connections"][0]["Name"] = "SourcetoSink";
+	ConnConf["Connections"][0]["Port1"] = "WaiterSource";
+	ConnConf["Connections"][0]["Port2"] = "WaiterSink";
+	DataConnector Conn("WaiterConn","",ConnConf);
+	Conn.SetIOS(ios);
+	Conn.Enable();
+
+	const size_t num_commands = 100;
+	std::vector<CommandStatus> results(num_commands,CommandStatus::UNDEFINED);
+	auto cpu_start = std::clock();
+	auto wall_start = std::chrono::steady_clock::now();
+	std::vector<std::thread> command_threads;
+	for(size_t i = 0; i < num_commands; i++)
+	{
+		command_threads.emplace_back([&,i]()
+			{
+				auto event = MakeEvent(EventType::ControlRelayOutputBlock,i,"WaiterSource");
+				event->SetPayload<EventType::ControlRelayOutputBlock>(ControlRelayOutputBlock());
+				StatusWaiter waiter;
+				Source.PublicPublishEvent(event,waiter.Callback());
+				results[i] = waiter.Wait(std::chrono::seconds(5));
+			});
+	}
+	for(auto& t : command_threads)
+		t.join();
+	auto cpu_ms = 1000.0*(std::clock()-cpu_start)/CLOCKS_PER_SEC;
+	auto wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-wall_start).count();
+
+	for(auto result : results)
+		REQUIRE(result == CommandStatus::SUCCESS);
+	//they all waited (in parallel) for the response
+	REQUIRE(wall_ms >= 200);
+	//spinning would use at least a whole core for the duration
+	REQUIRE(cpu_ms < wall_ms/2);
+
+	//nobody answers
+	StatusWaiter waiter;
+	REQUIRE(waiter.Wait(std::chrono::milliseconds(50)) == CommandStatus::TIMEOUT);
+	//answering late is harmless
+	auto late_callback = waiter.Callback();
+	(*late_callback)(CommandStatus::SUCCESS);
+
+	work.reset();
+	for(auto& t : ios_threads)
+		t.join();
+}
+
+TEST_CASE(SUITE("TransformScope"))
+{
+	//Transforms only get called for the event types and indexes they apply to
+	auto ios = std::make_shared<odc::asio_service>();
+	auto work = ios->make_work();
+
+	PublicPublishPort Source("ScopeSource","",Json::Value::nullSingleton());
+	BatchCountPort Sink("ScopeSink","",Json::Value::nullSingleton());
+
+	Json::Value ConnConf;
+	ConnConf["Connections"][0]["Name"] = "SourcetoSink";
+	ConnConf["Connections"][0]["Port1"] = "ScopeSource";
+	ConnConf["Connections"][0]["Port2"] = "ScopeSink";
+	TransformTestConnector Conn("ScopeConn","",ConnConf);
+	CountingTransform Tx;
+	Conn.AddTransform("ScopeSource",&Tx);
+
+	Source.SetIOS(ios);
+	Sink.SetIOS(ios);
+	Conn.SetIOS(ios);
+	Conn.Build();
+	Conn.Enable();
+
+	for(size_t i = 0; i < 30; i++)
+	{
+		auto analog = MakeEvent(EventType::Analog,i,"ScopeSource");
+		analog->SetPayload<EventType::Analog>(double(i));
+		Source.PublicPublishEvent(analog);
+		auto binary = MakeEvent(EventType::Binary,i,"ScopeSource");
+		binary->SetPayload<EventType::Binary>(true);
+		Source.PublicPublishEvent(binary);
+	}
+	while(ios->poll_one());
+
+	//called for analogs 10-19 only, and those are the only ones that could be blocked
+	REQUIRE(Tx.Calls == 10);
+	REQUIRE(Sink.Indexes.size() == 59);	//only events the transform got hold of were copied
+	auto stats = Conn.GetStatistics();
+	REQUIRE(stats["EventCopies"].asUInt64() == 9);
+	REQUIRE(stats["CopiesAvoided"].asUInt64() == 50);
+}
+
+class FilterOnlyTransform: public FilterTransform
+{
+public:
+	FilterOnlyTransform(): FilterTransform(Json::Value::nullSingleton())
+	{}
+	bool Filter(const EventInfo& event) override
+	{
+		return event.GetIndex() % 2;
+	}
+};
+
+TEST_CASE(SUITE("CopyOnWrite"))
+{
+	//events are only copied if a transform might change them
+	auto ios = std::make_shared<odc::asio_service>();
+	auto work = ios->make_work();
+
+	PublicPublishPort Source("CoWSource","",Json::Value::nullSingleton());
+	BatchCountPort PlainSink("CoWPlainSink","",Json::Value::nullSingleton());
+	BatchCountPort FilterSink("CoWFilterSink","",Json::Value::nullSingleton());
+	BatchCountPort OffsetSink("CoWOffsetSink","",Json::Value::nullSingleton());
+
+	Json::Value PlainConf;
+	PlainConf["Connections"][0]["Name"] = "SourcetoPlainSink";
+	PlainConf["Connections"][0]["Port1"] = "CoWSource";
+	PlainConf["Connections"][0]["Port2"] = "CoWPlainSink";
+	Json::Value FilterConf;
+	FilterConf["Connections"][0]["Name"] = "SourcetoFilterSink";
+	FilterConf["Connections"][0]["Port1"] = "CoWSource";
+	FilterConf["Connections"][0]["Port2"] = "CoWFilterSink";
+	Json::Value OffsetConf;
+	OffsetConf["Connections"][0]["Name"] = "SourcetoOffsetSink";
+	OffsetConf["Connections"][0]["Port1"] = "CoWSource";
+	OffsetConf["Connections"][0]["Port2"] = "CoWOffsetSink";
+	OffsetConf["Transforms"][0]["Type"] = "IndexOffset";
+	OffsetConf["Transforms"][0]["Sender"] = "CoWSource";
+	OffsetConf["Transforms"][0]["Parameters"]["Offset"] = 100;
+
+	DataConnector PlainConn("CoWPlainConn","",PlainConf);
+	TransformTestConnector FilterConn("CoWFilterConn","",FilterConf);
+	FilterOnlyTransform Filter;
+	FilterConn.AddTransform("CoWSource",&Filter);
+	DataConnector OffsetConn("CoWOffsetConn","",OffsetConf);
+	DataConnector* Conns[3] = {&PlainConn,&FilterConn,&OffsetConn};
+
+	Source.SetIOS(ios);
+	PlainSink.SetIOS(ios);
+	FilterSink.SetIOS(ios);
+	OffsetSink.SetIOS(ios);
+	for(auto& c :Conns)
+	{
+		c->SetIOS(ios);
+		c->Enable();
+	}
+
+	const size_t num_events = 10;
+	std::vector<std::shared_ptr<EventInfo>> events;
+	for(size_t i = 0; i < num_events; i++)
+	{
+		events.push_back(MakeEvent(EventType::Analog,i,"CoWSource"));
+		events.back()->SetPayload<EventType::Analog>(double(i));
+		Source.PublicPublishEvent(events.back());
+	}
+
+	REQUIRE(PlainSink.Events.size() == num_events);
+	REQUIRE(FilterSink.Events.size() == num_events/2);
+	REQUIRE(OffsetSink.Events.size() == num_events);
+	for(size_t i = 0; i < num_events; i++)
+	{
+		//the very same event objects go through unless they're changed
+		REQUIRE(PlainSink.Events[i] == events[i]);
+		REQUIRE(OffsetSink.Events[i] != events[i]);
+		REQUIRE(OffsetSink.Events[i]->GetIndex() == i+100);
+		REQUIRE(events[i]->GetIndex() == i);
+	}
+	for(size_t i = 0; i < num_events/2; i++)
+		REQUIRE(FilterSink.Events[i] == events[2*i+1]);
+
+	REQUIRE(PlainConn.GetStatistics()["CopiesAvoided"].asUInt64() == num_events);
+	REQUIRE(PlainConn.GetStatistics()["EventCopies"].asUInt64() == 0);
+	REQUIRE(FilterConn.GetStatistics()["CopiesAvoided"].asUInt64() == num_events/2);
+	REQUIRE(FilterConn.GetStatistics()["EventCopies"].asUInt64() == 0);
+	REQUIRE(OffsetConn.GetStatistics()["CopiesAvoided"].asUInt64() == 0);
+	REQUIRE(OffsetConn.GetStatistics()["EventCopies"].asUInt64() == num_events);
+
+	//a batch that the transforms leave alone is passed on as it is
+	EventBatch_t batch(events.begin(),events.end());
+	Source.PublicPublishEvent(batch);
+	REQUIRE(PlainSink.Events.size() == 2*num_events);
+	REQUIRE(PlainSink.Events.back() == events.back());
+	REQUIRE(FilterSink.Events.size() == num_events);
+	REQUIRE(FilterSink.Events.back() == events.back());
+}
+
+TEST_CASE(SUITE("EventInterest"))
+{
+	auto Event = [](EventType type, size_t index)
+			 {
+				 return MakeEvent(type,index,"InterestSource");
+			 };
+
+	EventInterest Everything;
+	REQUIRE(Everything.IsEverything());
+	REQUIRE(Everything.Matches(*Event(EventType::Analog,12345)));
+
+	auto Interest = EventInterest::Nothing();
+	REQUIRE_FALSE(Interest.IsEverything());
+	REQUIRE_FALSE(Interest.Matches(*Event(EventType::Analog,0)));
+	//everyone needs to know about connections
+	REQUIRE(Interest.Matches(*Event(EventType::ConnectState,0)));
+
+	//out of order, overlapping and touching ranges
+	Interest.Add(EventType::Analog,20,29);
+	Interest.Add(EventType::Analog,5,9);
+	Interest.Add(EventType::Analog,10,12);
+	Interest.Add(EventType::Analog,25,40);
+	Interest.Add(EventType::Binary,7,7);
+	Interest.Add(EventType::Counter);
+	for(size_t i = 0; i < 50; i++)
+	{
+		bool analog = (i >= 5 && i <= 12) || (i >= 20 && i <= 40);
+		REQUIRE(Interest.Matches(*Event(EventType::Analog,i)) == analog);
+		REQUIRE(Interest.Matches(*Event(EventType::Binary,i)) == (i == 7));
+		REQUIRE(Interest.Matches(*Event(EventType::Counter,i)));
+		REQUIRE_FALSE(Interest.Matches(*Event(EventType::ControlRelayOutputBlock,i)));
+	}
+
+	auto Other = EventInterest::Nothing();
+	Other.Add(EventType::Analog,13,19);
+	Other.Add(EventType::ControlRelayOutputBlock,1,1);
+	Interest.Add(Other);
+	for(size_t i = 5; i <= 40; i++)
+		REQUIRE(Interest.Matches(*Event(EventType::Analog,i)));
+	REQUIRE(Interest.Matches(*Event(EventType::ControlRelayOutputBlock,1)));
+
+	Interest.Add(Everything);
+	REQUIRE(Interest.IsEverything());
+}
+
+TEST_CASE(SUITE("SubscriberInterest"))
+{
+	//Subscribers only get the events they're interested in
+	PublicPublishPort Source("InterestSource","",Json::Value::nullSingleton());
+	BatchCountPort AllSink("AllSink","",Json::Value::nullSingleton());
+	BatchCountPort AnalogSink("AnalogSink","",Json::Value::nullSingleton());
+	BatchCountPort BinarySink("BinarySink","",Json::Value::nullSingleton());
+
+	auto AnalogInterest = EventInterest::Nothing();
+	AnalogInterest.Add(EventType::Analog,0,9);
+	auto BinaryInterest = EventInterest::Nothing();
+	BinaryInterest.Add(EventType::Binary);
+	Source.Subscribe(&AllSink,"AllSink");
+	Source.Subscribe(&AnalogSink,"AnalogSink",AnalogInterest);
+	Source.Subscribe(&BinarySink,"BinarySink",BinaryInterest);
+
+	CommandStatus cb_status = CommandStatus::UNDEFINED;
+	auto StatusCallback = std::make_shared<std::function<void (CommandStatus status)>>([&](CommandStatus status)
+		{
+			cb_status = status;
+		});
+
+	EventBatch_t batch;
+	for(size_t i = 0; i < 20; i++)
+	{
+		auto analog = MakeEvent(EventType::Analog,i,"InterestSource");
+		Source.PublicPublishEvent(analog,StatusCallback);
+		REQUIRE(cb_status == CommandStatus::SUCCESS);
+		batch.push_back(std::move(analog));
+	}
+	REQUIRE(AllSink.Indexes.size() == 20);
+	REQUIRE(AnalogSink.Indexes.size() == 10);
+	REQUIRE(BinarySink.Indexes.size() == 0);
+
+	Source.PublicPublishEvent(batch,StatusCallback);
+	REQUIRE(cb_status == CommandStatus::SUCCESS);
+	REQUIRE(AllSink.Batches == 1);
+	REQUIRE(AllSink.Indexes.size() == 40);
+	//only the part of the batch it wants
+	REQUIRE(AnalogSink.Batches == 1);
+	REQUIRE(AnalogSink.Indexes.size() == 20);
+	REQUIRE(AnalogSink.Indexes.back() == 9);
+	//nothing at all if it doesn't want any of it
+	REQUIRE(BinarySink.Batches == 0);
+
+	//if nobody wants it, nobody is there to say it worked
+	Source.Subscribe(&AllSink,"AllSink",BinaryInterest);
+	Source.PublicPublishEvent(MakeEvent(EventType::Counter,0,"InterestSource"),StatusCallback);
+	REQUIRE(cb_status == CommandStatus::NOT_SUPPORTED);
+	cb_status = CommandStatus::UNDEFINED;
+	Source.PublicPublishEvent(batch,StatusCallback);
+	REQUIRE(cb_status == CommandStatus::SUCCESS);
+	EventBatch_t counters = {MakeEvent(EventType::Counter,0,"InterestSource")};
+	Source.PublicPublishEvent(counters,StatusCallback);
+	REQUIRE(cb_status == CommandStatus::NOT_SUPPORTED);
+}
+
+TEST_CASE(SUITE("ConnectorInterest"))
+{
+	//Connectors subscribe for what their destinations can use, unless a transform might change things
+	auto ios = std::make_shared<odc::asio_service>();
+
+	PublicPublishPort Source("ConnInterestSource","",Json::Value::nullSingleton());
+	InterestPort PlainSink("ConnInterestPlainSink","",Json::Value::nullSingleton());
+	InterestPort OffsetSink("ConnInterestOffsetSink","",Json::Value::nullSingleton());
+	PlainSink.Interest.Add(EventType::Analog,0,4);
+	OffsetSink.Interest.Add(EventType::Analog,0,4);
+
+	Json::Value PlainConf;
+	PlainConf["Connections"][0]["Name"] = "SourcetoPlainSink";
+	PlainConf["Connections"][0]["Port1"] = "ConnInterestSource";
+	PlainConf["Connections"][0]["Port2"] = "ConnInterestPlainSink";
+	Json::Value OffsetConf;
+	OffsetConf["Connections"][0]["Name"] = "SourcetoOffsetSink";
+	OffsetConf["Connections"][0]["Port1"] = "ConnInterestSource";
+	OffsetConf["Connections"][0]["Port2"] = "ConnInterestOffsetSink";
+	OffsetConf["Transforms"][0]["Type"] = "IndexOffset";
+	OffsetConf["Transforms"][0]["Sender"] = "ConnInterestSource";
+	OffsetConf["Transforms"][0]["Parameters"]["Offset"] = 10;
+
+	DataConnector PlainConn("ConnInterestPlainConn","",PlainConf);
+	DataConnector OffsetConn("ConnInterestOffsetConn","",OffsetConf);
+	DataConnector* Conns[2] = {&PlainConn,&OffsetConn};
+	for(auto& c :Conns)
+	{
+		c->SetIOS(ios);
+		c->Build();
+		c->Enable();
+	}
+
+	for(size_t i = 0; i < 10; i++)
+		Source.PublicPublishEvent(MakeEvent(EventType::Analog,i,"ConnInterestSource"));
+
+	REQUIRE(PlainSink.Indexes.size() == 5);
+	REQUIRE(PlainSink.Indexes.back() == 4);
+	//moved indexes mean the connector has to take everything
+	REQUIRE(OffsetSink.Indexes.size() == 10);
+}
+
+//Checks every point's values arrive in the order they were published, from whichever thread
+class OrderCheckPort: public NullPort
+{
+public:
+	OrderCheckPort(const std::string& aName, const std::string& aConfFilename, const Json::Value& aConfOverrides):
+		NullPort(aName, aConfFilename, aConfOverrides)
+	{}
+	void Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override
+	{
+		Check(*event);
+		(*pStatusCallback)(CommandStatus::SUCCESS);
+	}
+	void Event(const EventBatch_t& batch, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override
+	{
+		for(const auto& event : batch)
+			Check(*event);
+		(*pStatusCallback)(CommandStatus::SUCCESS);
+	}
+	std::atomic<size_t> Received{0};
+	std::atomic<size_t> OutOfOrder{0};
+	//the most events being handled at the same time
+	std::atomic<size_t> MaxInside{0};
+
+private:
+	void Check(const EventInfo& event)
+	{
+		auto inside = ++Inside;
+		auto max = MaxInside.load();
+		while(inside > max && !MaxInside.compare_exchange_weak(max,inside))
+		{}
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			auto value = event.GetPayload<EventType::Analog>();
+			auto last_it = Last.find(event.GetIndex());
+			if(last_it != Last.end() && value <= last_it->second)
+				OutOfOrder++;
+			Last[event.GetIndex()] = value;
+		}
+		//give the other lanes a chance to overlap
+		if(event.GetIndex() % 8 == 0)
+			std::this_thread::sleep_for(std::chrono::microseconds(20));
+		Inside--;
+		Received++;
+	}
+	std::atomic<size_t> Inside{0};
+	std::mutex mtx;
+	std::unordered_map<size_t,double> Last;
+};
+
+TEST_CASE(SUITE("DispatchLanes"))
+{
+	//Lots of threads publishing lots of points, through lanes on the publisher or on the connector:
+	//	each point's updates must arrive in order, while different points are handled in parallel
+	const size_t num_io_threads = 4;
+	const size_t num_publishers = 4;
+	const size_t points_per_publisher = 100;
+	const size_t rounds = 100;
+	const size_t num_lanes = 8;
+
+	for(auto lanes_on_connector : {false, true})
+	{
+		auto ios = std::make_shared<odc::asio_service>(num_io_threads);
+		auto work = ios->make_work();
+		std::vector<std::thread> io_threads;
+		for(size_t i = 0; i < num_io_threads; i++)
+			io_threads.emplace_back([ios](){ ios->run(); });
+
+		const std::string suffix = lanes_on_connector ? "Conn" : "Source";
+		PublicPublishPort Source("LaneSource"+suffix,"",Json::Value::nullSingleton());
+		OrderCheckPort Sink("LaneSink"+suffix,"",Json::Value::nullSingleton());
+		Json::Value ConnConf;
+		ConnConf["Connections"][0]["Name"] = "SourcetoSink";
+		ConnConf["Connections"][0]["Port1"] = "LaneSource"+suffix;
+		ConnConf["Connections"][0]["Port2"] = "LaneSink"+suffix;
+		DataConnector Conn("LaneConn"+suffix,"",ConnConf);
+		Source.SetIOS(ios);
+		Sink.SetIOS(ios);
+		Conn.SetIOS(ios);
+		if(lanes_on_connector)
+			Conn.SetDispatchLanes(ios,num_lanes);
+		else
+			Source.SetDispatchLanes(ios,num_lanes);
+		Conn.Enable();
+
+		std::atomic<size_t> callbacks(0);
+		std::atomic<size_t> failures(0);
+		auto StatusCallback = std::make_shared<std::function<void (CommandStatus status)>>([&](CommandStatus status)
+			{
+				if(status != CommandStatus::SUCCESS)
+					failures++;
+				callbacks++;
+			});
+
+		//each publisher has its own points, and alternates single events and batches
+		std::vector<std::thread> publishers;
+		for(size_t p = 0; p < num_publishers; p++)
+		{
+			publishers.emplace_back([&,p]()
+				{
+					for(size_t round = 0; round < rounds; round++)
+					{
+						EventBatch_t batch;
+						for(size_t i = 0; i < points_per_publisher; i++)
+						{
+							auto event = MakeEvent(EventType::Analog,p*points_per_publisher+i,"LaneSource"+suffix);
+							event->SetPayload<EventType::Analog>(double(round));
+							if(round % 2)
+								batch.push_back(std::move(event));
+							else
+								Source.PublicPublishEvent(event,StatusCallback);
+						}
+						if(round % 2)
+							Source.PublicPublishEvent(batch,StatusCallback);
+					}
+				});
+		}
+		for(auto& t : publishers)
+			t.join();
+
+		const size_t expected_callbacks = num_publishers*(rounds/2)*(points_per_publisher+1);
+		auto deadline = std::chrono::steady_clock::now()+std::chrono::seconds(30);
+		while(callbacks < expected_callbacks && std::chrono::steady_clock::now() < deadline)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		work.reset();
+		for(auto& t : io_threads)
+			t.join();
+
+		REQUIRE(callbacks == expected_callbacks);
+		CHECK(failures == 0);
+		CHECK(Sink.Received == num_publishers*points_per_publisher*rounds);
+		CHECK(Sink.OutOfOrder == 0);
+		CHECK(Sink.MaxInside > 1);
+	}
+}
@@ -0,0 +1,91 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * LogHandleTests.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+#include <catch.hpp>
+#include <opendatacon/util.h>
+#include <spdlog/sinks/null_sink.h>
+
+using namespace odc;
+
+#define SUITE(name) "LogHandleTestSuite - " name
+
+static std::shared_ptr<spdlog::logger> MakeNullLogger(const std::string& name, spdlog::level::level_enum lvl)
+{
+	auto logger = std::make_shared<spdlog::logger>(name, std::make_shared<spdlog::sinks::null_sink_mt>());
+	logger->set_level(lvl);
+	return logger;
+}
+
+TEST_CASE(SUITE("FollowsRegistry"))
+{
+	const LogHandle handle("LogHandleTestLogger");
+	REQUIRE(handle.Get() == nullptr);
+
+	auto logger = MakeNullLogger("LogHandleTestLogger",spdlog::level::debug);
+	odc::spdlog_register_logger(logger);
+	REQUIRE(handle.Get() == logger.get());
+
+	//level checks follow the logger, even when it changes after we've cached it
+	REQUIRE(handle.ForLevel(spdlog::level::trace) == nullptr);
+	REQUIRE(handle.ForLevel(spdlog::level::debug) == logger.get());
+	logger->set_level(spdlog::level::trace);
+	REQUIRE(handle.ForLevel(spdlog::level::trace) == logger.get());
+
+	odc::spdlog_drop("LogHandleTestLogger");
+	REQUIRE(handle.Get() == nullptr);
+	//the handle doesn't hold on to a dropped logger
+	REQUIRE(logger.use_count() == 1);
+
+	auto logger2 = MakeNullLogger("LogHandleTestLogger",spdlog::level::info);
+	odc::spdlog_register_logger(logger2);
+	REQUIRE(handle.Get() == logger2.get());
+	odc::spdlog_drop("LogHandleTestLogger");
+}
+
+TEST_CASE(SUITE("LazyArguments"))
+{
+	const LogHandle handle("LogHandleLazyLogger");
+	auto logger = MakeNullLogger("LogHandleLazyLogger",spdlog::level::info);
+	odc::spdlog_register_logger(logger);
+
+	size_t evaluated = 0;
+	auto expensive = [&]() -> std::string
+			     {
+				     evaluated++;
+				     return "expensive";
+			     };
+	for(int i = 0; i < 10; i++)
+	{
+		if(auto log = handle.ForLevel(spdlog::level::trace))
+			log->trace("{}",expensive());
+	}
+	REQUIRE(evaluated == 0);
+
+	if(auto log = handle.ForLevel(spdlog::level::info))
+		log->info("{}",expensive());
+	REQUIRE(evaluated == 1);
+
+	odc::spdlog_drop("LogHandleLazyLogger");
+}
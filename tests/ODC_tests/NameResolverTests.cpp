@@ -0,0 +1,185 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * NameResolverTests.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include <opendatacon/NameResolver.h>
+
+using namespace odc;
+
+#define SUITE(name) "NameResolverTestSuite - " name
+
+//Puts the system lookup and cache time back after a test, even if it fails
+struct StandInScope
+{
+	explicit StandInScope(const NameLookup_t& lookup){ SetNameLookup(lookup); }
+	~StandInScope()
+	{
+		SetNameLookup(nullptr);
+		SetResolveCacheTime(std::chrono::seconds(60));
+	}
+};
+
+//Resolves "upstream.test" to localhost (slowly, like a DNS server having a bad day), and nothing else
+struct StandInResolver
+{
+	std::atomic<size_t> calls{0};
+	std::atomic_bool fail{false};
+	tcp_endpoints_t operator()(const std::string& host, const std::string& port, asio::error_code& err)
+	{
+		calls++;
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		if(fail || host != "upstream.test")
+		{
+			err = asio::error::host_not_found;
+			return {};
+		}
+		return {asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"),static_cast<unsigned short>(std::stoul(port)))};
+	}
+};
+
+//Resolves on pIOS, and waits for the answer
+struct Result
+{
+	std::atomic_bool done{false};
+	asio::error_code err;
+	tcp_endpoints_t endpoints;
+};
+static void Resolve(const std::shared_ptr<asio_service>& pIOS, const std::string& host, const std::string& port, Result& result)
+{
+	AsyncResolve(pIOS,host,port,[&result](const asio::error_code& err, const tcp_endpoints_t& endpoints)
+		{
+			result.err = err;
+			result.endpoints = endpoints;
+			result.done = true;
+		});
+}
+static bool Wait(Result& result)
+{
+	auto deadline = std::chrono::steady_clock::now()+std::chrono::seconds(10);
+	while(!result.done && std::chrono::steady_clock::now() < deadline)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	return result.done;
+}
+
+TEST_CASE(SUITE("SharedAndCached"))
+{
+	StandInResolver stand_in;
+	StandInScope scope([&](const std::string& host, const std::string& port, asio::error_code& err){ return stand_in(host,port,err); });
+
+	auto pIOS = std::make_shared<asio_service>(2);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> io_threads;
+	for(size_t i = 0; i < 2; i++)
+		io_threads.emplace_back([pIOS](){ pIOS->run(); });
+
+	//everyone asking at once shares the one lookup
+	const auto lookups_before = NameLookupCount();
+	std::vector<Result> results(20);
+	for(auto& result : results)
+		Resolve(pIOS,"upstream.test","20000",result);
+	for(auto& result : results)
+	{
+		REQUIRE(Wait(result));
+		CHECK_FALSE(result.err);
+		REQUIRE(result.endpoints.size() == 1);
+		CHECK(result.endpoints.front() == asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"),20000));
+	}
+	CHECK(stand_in.calls == 1);
+
+	//then it comes from the cache
+	Result cached;
+	Resolve(pIOS,"upstream.test","20000",cached);
+	REQUIRE(Wait(cached));
+	CHECK_FALSE(cached.err);
+	CHECK(stand_in.calls == 1);
+
+	//a different port is a different lookup
+	Result other_port;
+	Resolve(pIOS,"upstream.test","20001",other_port);
+	REQUIRE(Wait(other_port));
+	CHECK(other_port.endpoints.front().port() == 20001);
+	CHECK(stand_in.calls == 2);
+	CHECK(NameLookupCount()-lookups_before == 2);
+
+	//numbers don't need looking up
+	Result numeric;
+	Resolve(pIOS,"127.0.0.1","20002",numeric);
+	REQUIRE(Wait(numeric));
+	CHECK_FALSE(numeric.err);
+	CHECK(numeric.endpoints.front() == asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"),20002));
+	CHECK(stand_in.calls == 2);
+
+	//and a host that doesn't exist is an error
+	Result unknown;
+	Resolve(pIOS,"nowhere.test","20000",unknown);
+	REQUIRE(Wait(unknown));
+	CHECK(unknown.err == asio::error::host_not_found);
+	CHECK(unknown.endpoints.empty());
+
+	work.reset();
+	for(auto& t : io_threads)
+		t.join();
+}
+
+TEST_CASE(SUITE("StaleBeatsNothing"))
+{
+	StandInResolver stand_in;
+	StandInScope scope([&](const std::string& host, const std::string& port, asio::error_code& err){ return stand_in(host,port,err); });
+	//look up every time
+	SetResolveCacheTime(std::chrono::steady_clock::duration::zero());
+
+	auto pIOS = std::make_shared<asio_service>(1);
+	auto work = pIOS->make_work();
+	std::thread io_thread([pIOS](){ pIOS->run(); });
+
+	Result first;
+	Resolve(pIOS,"upstream.test","20000",first);
+	REQUIRE(Wait(first));
+	CHECK_FALSE(first.err);
+
+	//when the server stops answering, the last answer still gets used
+	stand_in.fail = true;
+	Result stale;
+	Resolve(pIOS,"upstream.test","20000",stale);
+	REQUIRE(Wait(stale));
+	CHECK(stand_in.calls == 2);
+	CHECK_FALSE(stale.err);
+	CHECK(stale.endpoints == first.endpoints);
+
+	//unless there isn't one
+	ClearResolveCache();
+	Result none;
+	Resolve(pIOS,"upstream.test","20000",none);
+	REQUIRE(Wait(none));
+	CHECK(none.err == asio::error::host_not_found);
+
+	work.reset();
+	io_thread.join();
+}
@@ -0,0 +1,140 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * PointRegistryTests.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+#include <atomic>
+#include <thread>
+#include <catch.hpp>
+#include <opendatacon/PointRegistry.h>
+#include "TestPorts.h"
+#include "../opendatacon/DataConnector.h"
+
+using namespace odc;
+
+#define SUITE(name) "PointRegistryTestSuite - " name
+
+TEST_CASE(SUITE("DenseIDs"))
+{
+	auto first = RegisterPoint("RegistryPort",EventType::Analog,10);
+	REQUIRE(first != NoPointID);
+	auto second = RegisterPoint("RegistryPort",EventType::Analog,11);
+	auto third = RegisterPoint("RegistryPort",EventType::Binary,10);
+	auto fourth = RegisterPoint("OtherRegistryPort",EventType::Analog,10);
+	REQUIRE(second == first+1);
+	REQUIRE(third == first+2);
+	REQUIRE(fourth == first+3);
+	REQUIRE(PointCount() >= fourth+1);
+
+	//registering again gives the same ID
+	REQUIRE(RegisterPoint("RegistryPort",EventType::Analog,10) == first);
+
+	auto& info = GetPointInfo(third);
+	REQUIRE(GetSourcePortName(info.Port) == "RegistryPort");
+	REQUIRE(info.Type == EventType::Binary);
+	REQUIRE(info.Index == 10);
+	REQUIRE_THROWS(GetPointInfo(NoPointID));
+
+	REQUIRE(FindPoint(InternSourcePort("RegistryPort"),EventType::Analog,11) == second);
+	REQUIRE(FindPoint(InternSourcePort("RegistryPort"),EventType::Analog,12) == NoPointID);
+	REQUIRE(FindPoint(InternSourcePort("UnregisteredPort"),EventType::Analog,10) == NoPointID);
+	REQUIRE(RegisterPoint("RegistryPort",EventType::Analog,MaxRegisteredIndex+1) == NoPointID);
+
+	//scattered indexes, right up to the biggest, don't need a table sized to match
+	auto biggest = RegisterPoint("RegistryPort",EventType::Counter,MaxRegisteredIndex);
+	auto scattered = RegisterPoint("RegistryPort",EventType::Counter,70000);
+	REQUIRE(FindPoint(InternSourcePort("RegistryPort"),EventType::Counter,MaxRegisteredIndex) == biggest);
+	REQUIRE(FindPoint(InternSourcePort("RegistryPort"),EventType::Counter,70000) == scattered);
+	REQUIRE(FindPoint(InternSourcePort("RegistryPort"),EventType::Counter,70001) == NoPointID);
+	REQUIRE(FindPoint(InternSourcePort("RegistryPort"),EventType::Counter,MaxRegisteredIndex+1) == NoPointID);
+
+	//events find their ID when it's asked for, and again after they change identity
+	auto event = MakeEvent(EventType::Analog,10,"RegistryPort");
+	REQUIRE(event->GetPointID() == first);
+	REQUIRE(MakeEvent(*event)->GetPointID() == first);
+	event->SetIndex(11);
+	REQUIRE(event->GetPointID() == second);
+	event->SetIndex(12);
+	REQUIRE(event->GetPointID() == NoPointID);
+	event->SetIndex(10);
+	event->SetSource("OtherRegistryPort");
+	REQUIRE(event->GetPointID() == fourth);
+}
+
+TEST_CASE(SUITE("ConcurrentLookups"))
+{
+	//lookups don't lock, and stay correct while the tables grow
+	const size_t num_points = 20000;
+	auto port = InternSourcePort("GrowingRegistryPort");
+	std::atomic_bool done(false);
+	std::atomic<size_t> wrong(0);
+	std::thread reader([&]()
+		{
+			while(!done)
+				for(size_t i = 0; i < num_points; i += 97)
+				{
+					auto id = FindPoint(port,EventType::Counter,i);
+					if(id != NoPointID && GetPointInfo(id).Index != i)
+						wrong++;
+				}
+		});
+	for(size_t i = 0; i < num_points; i++)
+		RegisterPoint("GrowingRegistryPort",EventType::Counter,i);
+	done = true;
+	reader.join();
+	REQUIRE(wrong == 0);
+	for(size_t i = 0; i < num_points; i++)
+		REQUIRE(GetPointInfo(FindPoint(port,EventType::Counter,i)).Index == i);
+}
+
+TEST_CASE(SUITE("IndexMapByID"))
+{
+	//IndexMap resolves registered points up front, and still maps the rest the long way
+	PublicPublishPort Source("RegistryMapSource","",Json::Value::nullSingleton());
+	BatchCountPort Sink("RegistryMapSink","",Json::Value::nullSingleton());
+	RegisterPoint("RegistryMapSource",EventType::Analog,1);
+	RegisterPoint("RegistryMapSource",EventType::Analog,2);
+
+	Json::Value ConnConf;
+	ConnConf["Connections"][0]["Name"] = "SourcetoSink";
+	ConnConf["Connections"][0]["Port1"] = "RegistryMapSource";
+	ConnConf["Connections"][0]["Port2"] = "RegistryMapSink";
+	ConnConf["Transforms"][0]["Type"] = "IndexMap";
+	ConnConf["Transforms"][0]["Sender"] = "RegistryMapSource";
+	for(Json::ArrayIndex n = 0; n < 3; n++)
+	{
+		ConnConf["Transforms"][0]["Parameters"]["AnalogMap"]["From"][n] = n+1;
+		ConnConf["Transforms"][0]["Parameters"]["AnalogMap"]["To"][n] = n+100;
+	}
+	DataConnector Conn("RegistryMapConn","",ConnConf);
+	Conn.Build();
+	Conn.Enable();
+
+	for(size_t i = 0; i < 5; i++)
+		Source.PublicPublishEvent(MakeEvent(EventType::Analog,i,"RegistryMapSource"));
+
+	REQUIRE(Sink.Indexes == std::vector<size_t>({100,101,102}));
+	//the mapped events have the identity of their new index (which isn't registered)
+	for(auto& event : Sink.Events)
+		REQUIRE(event->GetPointID() == NoPointID);
+}
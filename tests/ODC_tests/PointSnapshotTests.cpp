@@ -0,0 +1,186 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * PointSnapshotTests.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+#include <atomic>
+#include <thread>
+#include <catch.hpp>
+#include <opendatacon/PointSnapshot.h>
+#include "TestPorts.h"
+#include "../opendatacon/DataConnector.h"
+
+using namespace odc;
+
+#define SUITE(name) "PointSnapshotTestSuite - " name
+
+TEST_CASE(SUITE("LastKnownValues"))
+{
+	PointSnapshot Snapshot;
+	REQUIRE(Snapshot.Get(EventType::Analog,0) == nullptr);
+	REQUIRE(Snapshot.GetEvents().empty());
+	REQUIRE(Snapshot.Empty());
+
+	auto analog = MakeEvent(EventType::Analog,300,"SnapshotSource",QualityFlags::ONLINE,1234);
+	analog->SetPayload<EventType::Analog>(-1.25);
+	Snapshot.Update(*analog);
+	REQUIRE_FALSE(Snapshot.Empty());
+	auto dbb = MakeEvent(EventType::DoubleBitBinary,2,"SnapshotSource");
+	dbb->SetPayload<EventType::DoubleBitBinary>(DBB(true,false));
+	Snapshot.Update(*dbb);
+	auto counter = MakeEvent(EventType::Counter,5,"SnapshotSource");
+	counter->SetPayload<EventType::Counter>(42);
+	Snapshot.Update(*counter);
+	auto earlier = MakeEvent(EventType::Analog,3,"SnapshotSource");
+	earlier->SetPayload<EventType::Analog>(3);
+	Snapshot.Update(*earlier);
+
+	auto got = Snapshot.Get(EventType::Analog,300);
+	REQUIRE(got != nullptr);
+	REQUIRE(got->GetPayload<EventType::Analog>() == -1.25);
+	REQUIRE(got->GetTimestamp() == 1234);
+	REQUIRE(got->GetQuality() == QualityFlags::ONLINE);
+	REQUIRE(got->GetSourcePort() == "SnapshotSource");
+	REQUIRE(Snapshot.Get(EventType::DoubleBitBinary,2)->GetPayload<EventType::DoubleBitBinary>() == DBB(true,false));
+	REQUIRE(Snapshot.Get(EventType::Counter,5)->GetPayload<EventType::Counter>() == 42);
+	REQUIRE(Snapshot.Get(EventType::Counter,6) == nullptr);
+	REQUIRE(Snapshot.Has(EventType::Counter,5));
+	REQUIRE_FALSE(Snapshot.Has(EventType::Counter,6));
+	REQUIRE_FALSE(Snapshot.Has(EventType::Analog,5));
+
+	//in index order
+	auto analogs = Snapshot.GetEvents(EventType::Analog);
+	REQUIRE(analogs.size() == 2);
+	REQUIRE(analogs[0]->GetIndex() == 3);
+	REQUIRE(analogs[1]->GetIndex() == 300);
+	REQUIRE(Snapshot.GetEvents().size() == 4);
+
+	//quality events only change points we already know about
+	auto quality = MakeEvent(EventType::AnalogQuality,300,"SnapshotSource",QualityFlags::NONE,5678);
+	quality->SetPayload<EventType::AnalogQuality>(QualityFlags::COMM_LOST);
+	Snapshot.Update(*quality);
+	got = Snapshot.Get(EventType::Analog,300);
+	REQUIRE(got->GetQuality() == QualityFlags::COMM_LOST);
+	REQUIRE(got->GetPayload<EventType::Analog>() == -1.25);
+	REQUIRE(got->GetTimestamp() == 5678);
+	quality->SetIndex(301);
+	Snapshot.Update(*quality);
+	REQUIRE(Snapshot.Get(EventType::Analog,301) == nullptr);
+	REQUIRE_FALSE(Snapshot.Has(EventType::Analog,301));
+	REQUIRE_FALSE(Snapshot.Has(EventType::AnalogQuality,300));
+
+	//things that aren't point values aren't kept
+	auto crob = MakeEvent(EventType::ControlRelayOutputBlock,1,"SnapshotSource");
+	crob->SetPayload<EventType::ControlRelayOutputBlock>(ControlRelayOutputBlock());
+	Snapshot.Update(*crob);
+	auto no_payload = MakeEvent(EventType::Binary,1,"SnapshotSource");
+	Snapshot.Update(*no_payload);
+	auto too_big = MakeEvent(EventType::Binary,PointSnapshot::MaxIndex+1,"SnapshotSource");
+	too_big->SetPayload<EventType::Binary>(true);
+	Snapshot.Update(*too_big);
+	REQUIRE(Snapshot.GetEvents().size() == 4);
+}
+
+TEST_CASE(SUITE("ConcurrentReads"))
+{
+	//Readers never see a half written point
+	PointSnapshot Snapshot;
+	std::atomic_bool stop(false);
+	auto writer = [&](size_t offset)
+			  {
+				  for(size_t i = offset; !stop; i += 2)
+				  {
+					  auto event = MakeEvent(EventType::Analog,7,"SnapshotWriter",QualityFlags::ONLINE,i);
+					  event->SetPayload<EventType::Analog>(double(i));
+					  Snapshot.Update(*event);
+				  }
+			  };
+	std::thread writer1(writer,0);
+	std::thread writer2(writer,1);
+
+	size_t torn = 0, reads = 0;
+	while(reads < 20000)
+	{
+		if(auto event = Snapshot.Get(EventType::Analog,7))
+		{
+			reads++;
+			if(event->GetPayload<EventType::Analog>() != double(event->GetTimestamp()))
+				torn++;
+		}
+		else
+			std::this_thread::yield();
+	}
+	stop = true;
+	writer1.join();
+	writer2.join();
+	REQUIRE(torn == 0);
+}
+
+TEST_CASE(SUITE("UpdatedByTheBus"))
+{
+	//Ports that keep a snapshot keep what they publish, and connectors keep what they send them (after transforms)
+	PublicPublishPort Source("SnapshotBusSource","",Json::Value::nullSingleton());
+	PublicPublishPort Sink("SnapshotBusSink","",Json::Value::nullSingleton());
+	PublicPublishPort Other("SnapshotBusOther","",Json::Value::nullSingleton());
+	Source.PublicKeepSnapshot();
+	Sink.PublicKeepSnapshot();
+
+	Json::Value ConnConf;
+	ConnConf["Connections"][0]["Name"] = "SourcetoSink";
+	ConnConf["Connections"][0]["Port1"] = "SnapshotBusSource";
+	ConnConf["Connections"][0]["Port2"] = "SnapshotBusSink";
+	ConnConf["Connections"][1]["Name"] = "SourcetoOther";
+	ConnConf["Connections"][1]["Port1"] = "SnapshotBusSource";
+	ConnConf["Connections"][1]["Port2"] = "SnapshotBusOther";
+	ConnConf["Transforms"][0]["Type"] = "IndexOffset";
+	ConnConf["Transforms"][0]["Sender"] = "SnapshotBusSource";
+	ConnConf["Transforms"][0]["Parameters"]["Offset"] = 10;
+	DataConnector Conn("SnapshotBusConn","",ConnConf);
+	Conn.Enable();
+
+	for(size_t i = 0; i < 5; i++)
+	{
+		auto event = MakeEvent(EventType::Binary,i,"SnapshotBusSource");
+		event->SetPayload<EventType::Binary>(i%2);
+		Source.PublicPublishEvent(event);
+	}
+	EventBatch_t batch;
+	for(size_t i = 0; i < 5; i++)
+	{
+		auto event = MakeEvent(EventType::Analog,i,"SnapshotBusSource");
+		event->SetPayload<EventType::Analog>(i*1.5);
+		batch.push_back(event);
+	}
+	Source.PublicPublishEvent(batch);
+
+	//the rest don't pay for one
+	REQUIRE(Other.GetSnapshot() == nullptr);
+	REQUIRE(Source.GetSnapshot()->GetEvents().size() == 10);
+	REQUIRE(Sink.GetSnapshot()->GetEvents().size() == 10);
+	for(size_t i = 0; i < 5; i++)
+	{
+		REQUIRE(Source.GetSnapshot()->Get(EventType::Binary,i)->GetPayload<EventType::Binary>() == bool(i%2));
+		REQUIRE(Sink.GetSnapshot()->Get(EventType::Binary,i+10)->GetPayload<EventType::Binary>() == bool(i%2));
+		REQUIRE(Sink.GetSnapshot()->Get(EventType::Analog,i+10)->GetPayload<EventType::Analog>() == i*1.5);
+	}
+}
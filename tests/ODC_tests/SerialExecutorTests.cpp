@@ -0,0 +1,302 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * SerialExecutorTests.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include <opendatacon/asio.h>
+#include <opendatacon/HandlerMonitor.h>
+
+using namespace odc;
+
+#define SUITE(name) "SerialExecutorTestSuite - " name
+
+TEST_CASE(SUITE("OrderAndExclusion"))
+{
+	auto pIOS = std::make_shared<asio_service>(4);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> threads;
+	for(size_t i = 0; i < 4; i++)
+		threads.emplace_back([&](){ pIOS->run(); });
+
+	auto pSerial = pIOS->make_serial_executor();
+	REQUIRE_FALSE(pSerial->running_in_this_thread());
+
+	const size_t num_producers = 4;
+	const size_t per_producer = 10000;
+	std::vector<size_t> last(num_producers,0);
+	std::atomic<size_t> in_flight(0), overlaps(0), out_of_order(0), not_running(0), count(0);
+
+	std::vector<std::thread> producers;
+	for(size_t p = 0; p < num_producers; p++)
+		producers.emplace_back([&,p]()
+			{
+				for(size_t i = 1; i <= per_producer; i++)
+					pSerial->post([&,p,i]()
+						{
+							if(in_flight++ != 0)
+								overlaps++;
+							if(!pSerial->running_in_this_thread())
+								not_running++;
+							if(last[p]+1 != i)
+								out_of_order++;
+							last[p] = i;
+							//already in the executor, so this runs straight away
+							bool ran = false;
+							pSerial->dispatch([&](){ ran = true; });
+							if(!ran)
+								not_running++;
+							in_flight--;
+							count++;
+						});
+			});
+	for(auto& t : producers)
+		t.join();
+	while(count < num_producers*per_producer)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	//wrapped completion handlers go through the executor too
+	std::atomic<bool> wrapped_ran(false), wrapped_in_executor(false);
+	auto handler = pSerial->wrap([&](asio::error_code err, size_t n)
+		{
+			wrapped_in_executor = pSerial->running_in_this_thread() && !err && n == 42;
+			wrapped_ran = true;
+		});
+	handler(asio::error_code(),42);
+	while(!wrapped_ran)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	work.reset();
+	for(auto& t : threads)
+		t.join();
+
+	REQUIRE(overlaps == 0);
+	REQUIRE(out_of_order == 0);
+	REQUIRE(not_running == 0);
+	REQUIRE(wrapped_in_executor);
+}
+
+TEST_CASE(SUITE("PriorityLane"))
+{
+	auto pIOS = std::make_shared<asio_service>(2);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> threads;
+	for(size_t i = 0; i < 2; i++)
+		threads.emplace_back([&](){ pIOS->run(); });
+
+	auto pSerial = pIOS->make_serial_executor();
+	std::atomic<bool> blocked(false), release(false);
+	pSerial->post([&]()
+		{
+			blocked = true;
+			while(!release)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		});
+	while(!blocked)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	//a backlog of telemetry, with controls posted after it
+	std::vector<int> order;
+	std::atomic<size_t> count(0);
+	const int num_normal = 1000, num_high = 10;
+	for(int i = 0; i < num_normal; i++)
+		pSerial->post([&,i](){ order.push_back(i); count++; });
+	for(int i = 0; i < num_high; i++)
+		pSerial->post([&,i]()
+			{
+				order.push_back(-1-i);
+				//and one posted from inside the executor still goes before the backlog
+				if(i == 0)
+					pSerial->post([&](){ order.push_back(-100); count++; },HandlerPriority::High);
+				count++;
+			},HandlerPriority::High);
+	release = true;
+	while(count < num_normal+num_high+1)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	work.reset();
+	for(auto& t : threads)
+		t.join();
+
+	REQUIRE(order.size() == num_normal+num_high+1);
+	for(int i = 0; i < num_high; i++)
+		REQUIRE(order[i] == -1-i);
+	REQUIRE(order[num_high] == -100);
+	for(int i = 0; i < num_normal; i++)
+		REQUIRE(order[num_high+1+i] == i);
+}
+
+static void Spin(const std::chrono::microseconds& t)
+{
+	auto start = std::chrono::steady_clock::now();
+	while(std::chrono::steady_clock::now() - start < t)
+	{}
+}
+
+//How long a quiet port's handler waits behind a chatty port's backlog, on a single thread
+static std::chrono::milliseconds QuietLatency()
+{
+	auto pIOS = std::make_shared<asio_service>(1);
+	auto pChatty = pIOS->make_serial_executor("SerialExecutorTests Chatty");
+	auto pQuiet = pIOS->make_serial_executor("SerialExecutorTests Quiet");
+	std::chrono::steady_clock::time_point posted, ran;
+	//the backlog is there before the thread gets going, like after a burst of reads
+	for(size_t i = 0; i < 2000; i++)
+		pChatty->post([](){ Spin(std::chrono::microseconds(50)); });
+	posted = std::chrono::steady_clock::now();
+	pQuiet->post([&](){ ran = std::chrono::steady_clock::now(); });
+	pIOS->run();
+	return std::chrono::duration_cast<std::chrono::milliseconds>(ran-posted);
+}
+
+TEST_CASE(SUITE("FairShare"))
+{
+	auto pChatty = GetHandlerOwner("SerialExecutorTests Chatty");
+
+	//without the fair share, the quiet port waits for the whole backlog (~100ms)
+	SetFairShareQuantum(std::chrono::microseconds(0));
+	auto unfair = QuietLatency();
+	REQUIRE(unfair.count() >= 50);
+
+	//with it, the chatty port only gets a quantum before it has to let the quiet one in
+	SetFairShareQuantum(std::chrono::microseconds(1000));
+	auto throttled = pChatty->Throttled.load();
+	auto fair = QuietLatency();
+	CHECK(fair.count() < 20);
+	CHECK(pChatty->Throttled > throttled);
+	CHECK(pChatty->QueueDepth == 0);
+	CHECK(pChatty->MaxQueueDepth >= 2000);
+
+	//weighted ports share the thread in proportion
+	SetHandlerWeight("SerialExecutorTests Heavy",3);
+	auto pIOS = std::make_shared<asio_service>(1);
+	auto pLight = pIOS->make_serial_executor("SerialExecutorTests Light");
+	auto pHeavy = pIOS->make_serial_executor("SerialExecutorTests Heavy");
+	size_t light = 0, heavy = 0, light_at_sample = 0;
+	const size_t sample_at = 3000;
+	for(size_t i = 0; i < 5000; i++)
+	{
+		pLight->post([&](){ Spin(std::chrono::microseconds(20)); light++; });
+		pHeavy->post([&]()
+			{
+				Spin(std::chrono::microseconds(20));
+				if(++heavy == sample_at)
+					light_at_sample = light;
+			});
+	}
+	pIOS->run();
+	REQUIRE(light_at_sample > 0);
+	auto ratio = double(sample_at)/light_at_sample;
+	CHECK(ratio > 2.0);
+	CHECK(ratio < 4.5);
+	SetHandlerWeight("SerialExecutorTests Heavy",1);
+
+	//one long handler only costs the next turn, rather than a string of turns that don't run anything
+	auto pSlow = GetHandlerOwner("SerialExecutorTests Slow");
+	auto pSlowIOS = std::make_shared<asio_service>(1);
+	auto pSlowExecutor = pSlowIOS->make_serial_executor("SerialExecutorTests Slow");
+	size_t ran = 0;
+	pSlowExecutor->post([&](){ Spin(std::chrono::milliseconds(20)); ran++; });
+	for(size_t i = 0; i < 5; i++)
+		pSlowExecutor->post([&](){ ran++; });
+	throttled = pSlow->Throttled.load();
+	pSlowIOS->run();
+	CHECK(ran == 6);
+	CHECK(pSlow->Throttled - throttled <= 3);
+
+	SetFairShareQuantum(std::chrono::microseconds(0));
+}
+
+//One port blocks its executor, then every other port posts a handler
+//	returns how many of the others were held up behind the blocked one
+template<typename MakeExecutor>
+static size_t CountHeldUp(const size_t num_ports, MakeExecutor make_executor)
+{
+	auto pIOS = std::make_shared<asio_service>(4);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> threads;
+	for(size_t i = 0; i < 4; i++)
+		threads.emplace_back([&](){ pIOS->run(); });
+
+	auto executors = make_executor(*pIOS,num_ports);
+	const auto block_time = std::chrono::milliseconds(500);
+	std::atomic<bool> blocked(false);
+	executors[0]->post([&]()
+		{
+			blocked = true;
+			std::this_thread::sleep_for(block_time);
+		});
+	while(!blocked)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	std::atomic<size_t> held_up(0), done(0);
+	for(size_t p = 1; p < num_ports; p++)
+	{
+		auto posted = std::chrono::steady_clock::now();
+		executors[p]->post([&,posted]()
+			{
+				if(std::chrono::steady_clock::now() - posted > block_time/2)
+					held_up++;
+				done++;
+			});
+	}
+	while(done < num_ports-1)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	work.reset();
+	for(auto& t : threads)
+		t.join();
+	return held_up;
+}
+
+TEST_CASE(SUITE("IndependentPorts"))
+{
+	//a thousand ports, each with its own serial executor: a stuck port mustn't hold up the rest
+	auto held_up = CountHeldUp(1000,[](asio_service& ios, size_t n)
+		{
+			std::vector<std::unique_ptr<serial_executor>> executors;
+			for(size_t i = 0; i < n; i++)
+				executors.push_back(ios.make_serial_executor());
+			return executors;
+		});
+	REQUIRE(held_up == 0);
+}
+
+TEST_CASE(SUITE("StrandCollisions"),"[.][benchmark]")
+{
+	//the same with legacy strands, which share a fixed pool of implementations
+	auto held_up = CountHeldUp(1000,[](asio_service& ios, size_t n)
+		{
+			std::vector<std::unique_ptr<asio::io_service::strand>> strands;
+			for(size_t i = 0; i < n; i++)
+				strands.push_back(ios.make_strand());
+			return strands;
+		});
+	std::cout<<"1000 ports on strands: "<<held_up<<" held up behind a blocked port"<<std::endl;
+	REQUIRE(held_up < 1000);
+}
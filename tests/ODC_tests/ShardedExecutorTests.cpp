@@ -0,0 +1,433 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * ShardedExecutorTests.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include <opendatacon/ShardedExecutor.h>
+#include "TestPorts.h"
+#include "../opendatacon/DataConnector.h"
+
+using namespace odc;
+
+#define SUITE(name) "ShardedExecutorTestSuite - " name
+
+TEST_CASE(SUITE("RunsOnShard"))
+{
+	ShardedExecutor Executor(3);
+	REQUIRE(Executor.Size() == 3);
+	REQUIRE(Executor.ShardFor("SomePort") == Executor.ShardFor("SomePort"));
+	REQUIRE(Executor.ShardFor("SomePort") < 3);
+	REQUIRE_FALSE(Executor.OnShard(0));
+	Executor.Start();
+
+	std::atomic<size_t> wrong(0), done(0);
+	std::vector<std::thread::id> thread_ids(3);
+	for(size_t shard = 0; shard < 3; shard++)
+	{
+		Executor.Post(shard,[&,shard]()
+			{
+				thread_ids[shard] = std::this_thread::get_id();
+				for(size_t other = 0; other < 3; other++)
+					if(Executor.OnShard(other) != (other == shard))
+						wrong++;
+				//already on the shard, so this runs straight away
+				bool ran = false;
+				Executor.Dispatch(shard,[&](){ ran = true; });
+				if(!ran)
+					wrong++;
+				done++;
+			});
+		//handlers posted with asio directly run on the same thread
+		Executor.GetShard(shard)->post([&,shard]()
+			{
+				if(!Executor.OnShard(shard))
+					wrong++;
+				done++;
+			});
+	}
+	Executor.Stop();
+	Executor.Join();
+	REQUIRE(done == 6);
+	REQUIRE(wrong == 0);
+	REQUIRE(thread_ids[0] != thread_ids[1]);
+	REQUIRE(thread_ids[1] != thread_ids[2]);
+}
+
+TEST_CASE(SUITE("MailboxOrder"))
+{
+	//everything from one producer runs in the order it was posted
+	ShardedExecutor Executor(2);
+	Executor.Start();
+	const size_t num_producers = 4;
+	const size_t per_producer = 10000;
+	std::vector<size_t> last(num_producers,0);
+	std::atomic<size_t> out_of_order(0), count(0);
+
+	std::vector<std::thread> producers;
+	for(size_t p = 0; p < num_producers; p++)
+		producers.emplace_back([&,p]()
+			{
+				for(size_t i = 1; i <= per_producer; i++)
+					Executor.Post(1,[&,p,i]()
+						{
+							if(last[p]+1 != i)
+								out_of_order++;
+							last[p] = i;
+							count++;
+						});
+			});
+	for(auto& t : producers)
+		t.join();
+	Executor.Stop();
+	Executor.Join();
+	REQUIRE(count == num_producers*per_producer);
+	REQUIRE(out_of_order == 0);
+}
+
+class ShardCheckPort: public BatchCountPort
+{
+public:
+	ShardCheckPort(const std::string& aName, const std::string& aConfFilename, const Json::Value& aConfOverrides):
+		BatchCountPort(aName, aConfFilename, aConfOverrides)
+	{}
+	void Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override
+	{
+		if(OnOtherShard())
+			WrongShard++;
+		BatchCountPort::Event(event,SenderName,pStatusCallback);
+	}
+	std::atomic<size_t> WrongShard{0};
+};
+
+TEST_CASE(SUITE("CrossShardHandOff"))
+{
+	//connectors hand events to ports on other shards, instead of calling them on the publisher's thread
+	auto pExecutor = std::make_shared<ShardedExecutor>(2);
+	PublicPublishPort Source("ShardSource","",Json::Value::nullSingleton());
+	ShardCheckPort Sink("ShardSink","",Json::Value::nullSingleton());
+	Json::Value ConnConf;
+	ConnConf["Connections"][0]["Name"] = "SourcetoSink";
+	ConnConf["Connections"][0]["Port1"] = "ShardSource";
+	ConnConf["Connections"][0]["Port2"] = "ShardSink";
+	DataConnector Conn("ShardConn","",ConnConf);
+	Source.SetShard(pExecutor,0);
+	Conn.SetShard(pExecutor,0);
+	Sink.SetShard(pExecutor,1);
+	Conn.Enable();
+	pExecutor->Start();
+
+	const size_t num_events = 1000;
+	std::atomic<size_t> results(0), failures(0);
+	auto StatusCallback = std::make_shared<std::function<void (CommandStatus status)>>([&](CommandStatus status)
+		{
+			if(status != CommandStatus::SUCCESS)
+				failures++;
+			results++;
+		});
+	pExecutor->Post(0,[&]()
+		{
+			for(size_t i = 0; i < num_events; i++)
+				Source.PublicPublishEvent(MakeEvent(EventType::Analog,i,"ShardSource"),StatusCallback);
+		});
+	while(results < num_events)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	pExecutor->Stop();
+	pExecutor->Join();
+
+	REQUIRE(failures == 0);
+	REQUIRE(Sink.WrongShard == 0);
+	REQUIRE(Sink.Indexes.size() == num_events);
+	//and in order
+	for(size_t i = 0; i < num_events; i++)
+		REQUIRE(Sink.Indexes[i] == i);
+}
+
+TEST_CASE(SUITE("PriorityLane"))
+{
+	//controls overtake telemetry that's queued for another shard
+	auto pExecutor = std::make_shared<ShardedExecutor>(2);
+	PublicPublishPort Source("PrioritySource","",Json::Value::nullSingleton());
+	ShardCheckPort Sink("PrioritySink","",Json::Value::nullSingleton());
+	Json::Value ConnConf;
+	ConnConf["Connections"][0]["Name"] = "SourcetoSink";
+	ConnConf["Connections"][0]["Port1"] = "PrioritySource";
+	ConnConf["Connections"][0]["Port2"] = "PrioritySink";
+	DataConnector Conn("PriorityConn","",ConnConf);
+	Source.SetShard(pExecutor,0);
+	Conn.SetShard(pExecutor,0);
+	Sink.SetShard(pExecutor,1);
+	Conn.Enable();
+	pExecutor->Start();
+
+	//hold up the sink's shard while everything queues
+	std::atomic<bool> blocked(false), release(false);
+	pExecutor->Post(1,[&]()
+		{
+			blocked = true;
+			while(!release)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		});
+	while(!blocked)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	const size_t num_events = 1000;
+	std::atomic<size_t> results(0), failures(0);
+	std::atomic<bool> published(false);
+	auto StatusCallback = std::make_shared<std::function<void (CommandStatus status)>>([&](CommandStatus status)
+		{
+			if(status != CommandStatus::SUCCESS)
+				failures++;
+			results++;
+		});
+	pExecutor->Post(0,[&]()
+		{
+			for(size_t i = 0; i < num_events; i++)
+				Source.PublicPublishEvent(MakeEvent(EventType::Analog,i,"PrioritySource"),StatusCallback);
+			Source.PublicPublishEvent(MakeEvent(EventType::ControlRelayOutputBlock,num_events,"PrioritySource"),StatusCallback);
+			//a mixed batch is split, and the status still comes back once
+			EventBatch_t batch;
+			batch.push_back(MakeEvent(EventType::Analog,2*num_events,"PrioritySource"));
+			batch.push_back(MakeEvent(EventType::ControlRelayOutputBlock,2*num_events+1,"PrioritySource"));
+			batch.push_back(MakeEvent(EventType::Analog,2*num_events+2,"PrioritySource"));
+			Source.PublicPublishEvent(batch,StatusCallback);
+			published = true;
+		});
+	//wait for everything to be queued before letting the sink go
+	while(!published)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	release = true;
+	while(results < num_events+2)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	pExecutor->Stop();
+	pExecutor->Join();
+
+	REQUIRE(failures == 0);
+	REQUIRE(Sink.WrongShard == 0);
+	REQUIRE(Sink.Indexes.size() == num_events+4);
+	//the controls first, in the order they were sent
+	REQUIRE(Sink.Indexes[0] == num_events);
+	REQUIRE(Sink.Indexes[1] == 2*num_events+1);
+	//then the telemetry, still in order
+	for(size_t i = 0; i < num_events; i++)
+		REQUIRE(Sink.Indexes[2+i] == i);
+	REQUIRE(Sink.Indexes[num_events+2] == 2*num_events);
+	REQUIRE(Sink.Indexes[num_events+3] == 2*num_events+2);
+}
+
+TEST_CASE(SUITE("ShardedVsSingle"),"[.][benchmark]")
+{
+	//Each "port" runs a chain of handlers, passing every tenth one to the next port
+	//	on one shared io_service (with strands), then with the ports sharded
+	const size_t num_threads = std::max(2u,std::thread::hardware_concurrency());
+	const size_t num_ports = 4*num_threads;
+	const size_t chain_length = 20000;
+
+	struct PortState
+	{
+		std::unique_ptr<asio::io_service::strand> pStrand;
+		size_t Shard;
+		std::atomic<size_t> Count{0};
+		uint64_t Work = 0;
+	};
+
+	auto run = [&](bool sharded)
+		   {
+			   auto pSingle = std::make_shared<asio_service>(num_threads+1);
+			   auto pShards = std::make_shared<ShardedExecutor>(num_threads);
+			   std::vector<std::unique_ptr<PortState>> ports;
+			   for(size_t p = 0; p < num_ports; p++)
+			   {
+				   ports.emplace_back(new PortState());
+				   ports.back()->pStrand = pSingle->make_strand();
+				   ports.back()->Shard = p % num_threads;
+			   }
+			   std::atomic<size_t> finished(0);
+			   std::function<void(size_t,size_t)> step = [&](size_t p, size_t n)
+									  {
+										  auto& port = *ports[p];
+										  for(size_t i = 0; i < 100; i++)
+											  port.Work = port.Work*31+i;
+										  port.Count++;
+										  if(n+1 == chain_length)
+										  {
+											  finished++;
+											  return;
+										  }
+										  auto next_port = (n % 10 == 9) ? (p+1) % num_ports : p;
+										  if(sharded)
+											  pShards->Post(ports[next_port]->Shard,[&,next_port,n](){ step(next_port,n+1); });
+										  else
+											  ports[next_port]->pStrand->post([&,next_port,n](){ step(next_port,n+1); });
+									  };
+
+			   auto start = std::chrono::high_resolution_clock::now();
+			   std::vector<std::thread> threads;
+			   auto work = pSingle->make_work();
+			   if(sharded)
+				   pShards->Start();
+			   else
+				   for(size_t t = 0; t < num_threads; t++)
+					   threads.emplace_back([&](){ pSingle->run(); });
+			   for(size_t p = 0; p < num_ports; p++)
+			   {
+				   if(sharded)
+					   pShards->Post(ports[p]->Shard,[&,p](){ step(p,0); });
+				   else
+					   ports[p]->pStrand->post([&,p](){ step(p,0); });
+			   }
+			   while(finished < num_ports)
+				   std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			   auto time = std::chrono::high_resolution_clock::now() - start;
+			   work.reset();
+			   pShards->Stop();
+			   pShards->Join();
+			   for(auto& t : threads)
+				   t.join();
+			   return std::chrono::duration_cast<std::chrono::milliseconds>(time).count();
+		   };
+
+	auto single_ms = run(false);
+	auto sharded_ms = run(true);
+	std::cout<<num_ports*chain_length<<" handlers over "<<num_ports<<" ports, "<<num_threads<<" threads: "
+	         <<"single io_service "<<single_ms<<"ms, sharded "<<sharded_ms<<"ms"<<std::endl;
+	REQUIRE(single_ms >= 0);
+}
+
+//Takes a little time over each event (like a real port would), and notes when the samples arrive
+class LatencySinkPort: public NullPort
+{
+public:
+	static constexpr size_t FirstSample = 1000000;
+	LatencySinkPort(const std::string& aName, const size_t num_samples):
+		NullPort(aName, "", Json::Value::nullSingleton()),
+		ControlArrival(num_samples),
+		TelemetryArrival(num_samples)
+	{}
+	void Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override
+	{
+		Handle(*event);
+		(*pStatusCallback)(CommandStatus::SUCCESS);
+	}
+	void Event(const EventBatch_t& batch, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override
+	{
+		for(const auto& event : batch)
+			Handle(*event);
+		(*pStatusCallback)(CommandStatus::SUCCESS);
+	}
+	std::vector<std::chrono::steady_clock::time_point> ControlArrival;
+	std::vector<std::chrono::steady_clock::time_point> TelemetryArrival;
+private:
+	void Handle(const EventInfo& event)
+	{
+		auto start = std::chrono::steady_clock::now();
+		while(std::chrono::steady_clock::now() - start < std::chrono::microseconds(1))
+		{}
+		if(event.GetIndex() < FirstSample)
+			return;
+		auto& arrival = (event.GetEventType() == EventType::ControlRelayOutputBlock) ? ControlArrival : TelemetryArrival;
+		arrival.at(event.GetIndex()-FirstSample) = std::chrono::steady_clock::now();
+	}
+};
+
+TEST_CASE(SUITE("ControlLatency"),"[.][benchmark]")
+{
+	//A flood of analogs (like a SimPort doing an integrity scan) queues for a port on another shard
+	//	meanwhile another port sends it controls, each with an analog alongside for comparison
+	const size_t num_samples = 20;
+	const size_t flood_batches = 2000, batch_size = 100;
+	auto pExecutor = std::make_shared<ShardedExecutor>(3);
+	PublicPublishPort Flood("LatencyFlood","",Json::Value::nullSingleton());
+	PublicPublishPort Controller("LatencyController","",Json::Value::nullSingleton());
+	LatencySinkPort Sink("LatencySink",num_samples);
+	Json::Value FloodConf;
+	FloodConf["Connections"][0]["Name"] = "FloodtoSink";
+	FloodConf["Connections"][0]["Port1"] = "LatencyFlood";
+	FloodConf["Connections"][0]["Port2"] = "LatencySink";
+	Json::Value ControlConf;
+	ControlConf["Connections"][0]["Name"] = "ControllertoSink";
+	ControlConf["Connections"][0]["Port1"] = "LatencyController";
+	ControlConf["Connections"][0]["Port2"] = "LatencySink";
+	DataConnector FloodConn("LatencyFloodConn","",FloodConf);
+	DataConnector ControlConn("LatencyControlConn","",ControlConf);
+	Flood.SetShard(pExecutor,0);
+	FloodConn.SetShard(pExecutor,0);
+	Sink.SetShard(pExecutor,1);
+	Controller.SetShard(pExecutor,2);
+	ControlConn.SetShard(pExecutor,2);
+	FloodConn.Enable();
+	ControlConn.Enable();
+	pExecutor->Start();
+
+	std::atomic<size_t> results(0);
+	auto StatusCallback = std::make_shared<std::function<void (CommandStatus status)>>([&](CommandStatus status)
+		{
+			results++;
+		});
+
+	pExecutor->Post(0,[&]()
+		{
+			EventBatch_t batch;
+			for(size_t i = 0; i < batch_size; i++)
+				batch.push_back(MakeEvent(EventType::Analog,i,"LatencyFlood"));
+			for(size_t b = 0; b < flood_batches; b++)
+				Flood.PublicPublishEvent(batch,StatusCallback);
+		});
+
+	std::vector<std::chrono::steady_clock::time_point> sent(num_samples);
+	for(size_t s = 0; s < num_samples; s++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		pExecutor->Post(2,[&,s]()
+			{
+				sent[s] = std::chrono::steady_clock::now();
+				Controller.PublicPublishEvent(MakeEvent(EventType::ControlRelayOutputBlock,LatencySinkPort::FirstSample+s,"LatencyController"),StatusCallback);
+				Controller.PublicPublishEvent(MakeEvent(EventType::Analog,LatencySinkPort::FirstSample+s,"LatencyController"),StatusCallback);
+			});
+	}
+	while(results < flood_batches+2*num_samples)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	pExecutor->Stop();
+	pExecutor->Join();
+
+	auto stats = [&](const std::vector<std::chrono::steady_clock::time_point>& arrival)
+			 {
+				 std::vector<double> ms;
+				 for(size_t s = 0; s < num_samples; s++)
+					 ms.push_back(std::chrono::duration<double,std::milli>(arrival[s]-sent[s]).count());
+				 std::sort(ms.begin(),ms.end());
+				 return std::make_pair(ms[num_samples/2],ms.back());
+			 };
+	auto control = stats(Sink.ControlArrival);
+	auto telemetry = stats(Sink.TelemetryArrival);
+	std::cout<<"Latency behind a flood of "<<flood_batches*batch_size<<" analogs: "
+	         <<"controls median "<<control.first<<"ms max "<<control.second<<"ms, "
+	         <<"analogs median "<<telemetry.first<<"ms max "<<telemetry.second<<"ms"<<std::endl;
+	REQUIRE(control.second <= telemetry.second);
+}
@@ -0,0 +1,970 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * TCPSocketManagerTests.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include <opendatacon/ConnectionPacing.h>
+#include <opendatacon/IOUring.h>
+#include <opendatacon/NameResolver.h>
+#include <opendatacon/TCPSocketManager.h>
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+using namespace odc;
+
+#define SUITE(name) "TCPSocketManagerTestSuite - " name
+
+//Waits up to timeout for pred to be true
+template<typename Pred>
+static bool WaitFor(Pred pred, const std::chrono::seconds& timeout = std::chrono::seconds(30))
+{
+	auto deadline = std::chrono::steady_clock::now()+timeout;
+	while(!pred())
+	{
+		if(std::chrono::steady_clock::now() > deadline)
+			return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+//Frames look like "<writer>:<seq>:<len>:<len chars>\n" - so a frame that's been split or mixed with another won't parse
+static std::string MakeFrame(const size_t writer, const size_t seq)
+{
+	const size_t len = (seq*7919 + writer*104729) % 3000;
+	return std::to_string(writer)+":"+std::to_string(seq)+":"+std::to_string(len)+":"+std::string(len,char('a'+seq%26))+"\n";
+}
+
+//Checks every frame is whole, and each writer's frames arrive in order
+struct FrameChecker
+{
+	explicit FrameChecker(const size_t num_writers):
+		num_writers(num_writers),
+		next_seq(num_writers,0)
+	{}
+	//frame without the newline
+	void Check(const std::string& frame)
+	{
+		size_t writer, seq, len;
+		char sep1, sep2, sep3;
+		std::istringstream iss(frame);
+		if(!(iss >> writer >> sep1 >> seq >> sep2 >> len >> sep3) || sep1 != ':' || sep2 != ':' || sep3 != ':'
+		   || writer >= num_writers || MakeFrame(writer,seq) != frame+"\n")
+		{
+			bad_frames++;
+			return;
+		}
+		if(seq != next_seq[writer])
+			out_of_order++;
+		next_seq[writer] = seq+1;
+		frames++;
+	}
+	const size_t num_writers;
+	std::vector<size_t> next_seq;
+	std::atomic<size_t> frames{0}, bad_frames{0}, out_of_order{0};
+};
+
+TEST_CASE(SUITE("GatherWriteStress"))
+{
+	const size_t num_io_threads = 2;
+	const size_t num_writers = 4;
+	const size_t frames_per_writer = 2000;
+
+	auto pIOS = std::make_shared<asio_service>(num_io_threads);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> io_threads;
+	for(size_t i = 0; i < num_io_threads; i++)
+		io_threads.emplace_back([pIOS](){ pIOS->run(); });
+
+	//the server end checks every frame is whole, and each writer's frames arrive in order
+	std::string received;
+	FrameChecker checker(num_writers);
+	auto ReadHandler = [&](buf_t& readbuf)
+		{
+			received.append(asio::buffers_begin(readbuf.data()),asio::buffers_end(readbuf.data()));
+			readbuf.consume(readbuf.size());
+			size_t pos;
+			while((pos = received.find('\n')) != std::string::npos)
+			{
+				checker.Check(received.substr(0,pos));
+				received.erase(0,pos+1);
+			}
+		};
+	std::atomic_bool server_connected(false), client_connected(false);
+	TCPSocketManager<std::string> Server(pIOS,true,"127.0.0.1","20598",ReadHandler,
+		[&](bool state){ server_connected = state; });
+	TCPSocketManager<std::string> Client(pIOS,false,"127.0.0.1","20598",[](buf_t& readbuf){ readbuf.consume(readbuf.size()); },
+		[&](bool state){ client_connected = state; },
+		std::numeric_limits<size_t>::max(),true,100);
+
+	//small enough that a flood of writes goes over it
+	std::mutex bp_mtx;
+	std::vector<bool> backpressure;
+	Client.SetWriteHighWater(64*1024,[&](bool on)
+		{
+			std::lock_guard<std::mutex> lck(bp_mtx);
+			backpressure.push_back(on);
+		});
+
+	Server.Open();
+	Client.Open();
+	REQUIRE(WaitFor([&](){ return server_connected && client_connected; }));
+
+	std::vector<std::thread> writers;
+	for(size_t w = 0; w < num_writers; w++)
+		writers.emplace_back([&,w]()
+			{
+				for(size_t seq = 0; seq < frames_per_writer; seq++)
+					Client.Write(MakeFrame(w,seq));
+			});
+	for(auto& t : writers)
+		t.join();
+
+	CHECK(WaitFor([&](){ return checker.frames + checker.bad_frames >= num_writers*frames_per_writer; }));
+	CHECK(checker.frames == num_writers*frames_per_writer);
+	CHECK(checker.bad_frames == 0);
+	CHECK(checker.out_of_order == 0);
+	{
+		//backpressure comes on and goes off again, in turn
+		std::lock_guard<std::mutex> lck(bp_mtx);
+		CHECK_FALSE(backpressure.empty());
+		for(size_t i = 0; i < backpressure.size(); i++)
+			CHECK(backpressure[i] == (i%2 == 0));
+		CHECK(backpressure.size()%2 == 0);
+	}
+
+	Client.Close();
+	Server.Close();
+	REQUIRE(WaitFor([&](){ return !server_connected && !client_connected; }));
+	work.reset();
+	for(auto& t : io_threads)
+		t.join();
+}
+
+TEST_CASE(SUITE("SpanRead"))
+{
+	const size_t num_io_threads = 2;
+	const size_t frames_to_send = 5000;
+
+	auto pIOS = std::make_shared<asio_service>(num_io_threads);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> io_threads;
+	for(size_t i = 0; i < num_io_threads; i++)
+		io_threads.emplace_back([pIOS](){ pIOS->run(); });
+
+	//the server end takes whole frames straight out of the span, and leaves any partial frame for next time
+	FrameChecker checker(1);
+	std::atomic<size_t> big_frames(0);
+	const std::string big_frame(300*1024,'z');
+	auto SpanReadHandler = [&](const char* data, size_t len) -> size_t
+		{
+			size_t used = 0;
+			const char* nl;
+			while((nl = static_cast<const char*>(std::memchr(data+used,'\n',len-used))) != nullptr)
+			{
+				const size_t frame_len = nl-(data+used);
+				if(frame_len == big_frame.size())
+				{
+					if(std::string(data+used,frame_len) == big_frame)
+						big_frames++;
+					else
+						checker.bad_frames++;
+				}
+				else
+					checker.Check(std::string(data+used,frame_len));
+				used += frame_len+1;
+			}
+			return used;
+		};
+	std::atomic_bool server_connected(false), client_connected(false);
+	TCPSocketManager<std::string> Server(pIOS,true,"127.0.0.1","20599",SpanReadHandler,
+		[&](bool state){ server_connected = state; });
+	TCPSocketManager<std::string> Client(pIOS,false,"127.0.0.1","20599",[](buf_t& readbuf){ readbuf.consume(readbuf.size()); },
+		[&](bool state){ client_connected = state; },
+		std::numeric_limits<size_t>::max(),true,100);
+
+	Server.Open();
+	Client.Open();
+	REQUIRE(WaitFor([&](){ return server_connected && client_connected; }));
+
+	//a frame bigger than the read buffer makes it grow
+	for(size_t seq = 0; seq < frames_to_send; seq++)
+	{
+		Client.Write(MakeFrame(0,seq));
+		if(seq == frames_to_send/2)
+			Client.Write(big_frame+"\n");
+	}
+
+	CHECK(WaitFor([&](){ return checker.frames + checker.bad_frames + big_frames >= frames_to_send+1; }));
+	CHECK(checker.frames == frames_to_send);
+	CHECK(big_frames == 1);
+	CHECK(checker.bad_frames == 0);
+	CHECK(checker.out_of_order == 0);
+
+	Client.Close();
+	Server.Close();
+	REQUIRE(WaitFor([&](){ return !server_connected && !client_connected; }));
+	work.reset();
+	for(auto& t : io_threads)
+		t.join();
+}
+
+TEST_CASE(SUITE("WriteLimitWhileConnected"))
+{
+	auto pIOS = std::make_shared<asio_service>(2);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> io_threads;
+	for(size_t i = 0; i < 2; i++)
+		io_threads.emplace_back([pIOS](){ pIOS->run(); });
+
+	//a peer that never reads, so the writes back up once the socket buffers are full
+	auto pAcceptor = pIOS->make_tcp_acceptor(asio::ip::tcp::endpoint(asio::ip::address::from_string("127.0.0.1"),20608));
+	auto pPeer = pIOS->make_tcp_socket();
+	std::atomic_bool accepted(false);
+	pAcceptor->async_accept(*pPeer,[&](asio::error_code err_code){ accepted = !err_code; });
+
+	const size_t limit = 4;
+	const size_t write_size = 1024*1024;
+	std::atomic_bool connected(false), over_limit(false), backed_up(false);
+	TCPSocketManager<std::string> Client(pIOS,false,"127.0.0.1","20608",[](buf_t& readbuf){ readbuf.consume(readbuf.size()); },
+		[&](bool state){ connected = state; },limit);
+	//there can't be more than the limit waiting, plus the same again going out
+	Client.SetWriteHighWater(2*limit*write_size,[&](bool on){ if(on) over_limit = true; });
+	Client.Open();
+	REQUIRE(WaitFor([&](){ return connected && accepted; }));
+
+	for(size_t i = 0; i < 100; i++)
+		Client.Write(std::string(write_size,'x'));
+	//but there is a backlog
+	Client.SetWriteHighWater(write_size,[&](bool on){ if(on) backed_up = true; });
+	REQUIRE(WaitFor([&](){ return !!backed_up; }));
+	CHECK_FALSE(over_limit);
+
+	Client.Close();
+	REQUIRE(WaitFor([&](){ return !connected; }));
+	asio::error_code ignored;
+	pPeer->close(ignored);
+	pAcceptor->close(ignored);
+	work.reset();
+	for(auto& t : io_threads)
+		t.join();
+}
+
+TEST_CASE(SUITE("ReadThroughput"),"[.][benchmark]")
+{
+	const size_t chunk_size = 64*1024;
+	const size_t num_chunks = 4*1024; //256MiB
+
+	auto pIOS = std::make_shared<asio_service>(2);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> io_threads;
+	for(size_t i = 0; i < 2; i++)
+		io_threads.emplace_back([pIOS](){ pIOS->run(); });
+
+	//both consumers look at every byte (counting newlines), so it's only the read path that differs
+	std::atomic<size_t> legacy_bytes(0), legacy_lines(0);
+	auto LegacyReadHandler = [&](buf_t& readbuf)
+		{
+			legacy_lines += std::count(asio::buffers_begin(readbuf.data()),asio::buffers_end(readbuf.data()),'\n');
+			legacy_bytes += readbuf.size();
+			readbuf.consume(readbuf.size());
+		};
+	std::atomic<size_t> span_bytes(0), span_lines(0);
+	auto SpanReadHandler = [&](const char* data, size_t len) -> size_t
+		{
+			span_lines += std::count(data,data+len,'\n');
+			span_bytes += len;
+			return len;
+		};
+
+	std::atomic_bool server_connected(false), client_connected(false);
+	auto ServerState = [&](bool state){ server_connected = state; };
+	auto ClientState = [&](bool state){ client_connected = state; };
+	auto ClientRead = [](buf_t& readbuf){ readbuf.consume(readbuf.size()); };
+	TCPSocketManager<std::string> LegacyServer(pIOS,true,"127.0.0.1","20600",LegacyReadHandler,ServerState);
+	TCPSocketManager<std::string> LegacyClient(pIOS,false,"127.0.0.1","20600",ClientRead,ClientState,
+		std::numeric_limits<size_t>::max(),true,100);
+	TCPSocketManager<std::string> SpanServer(pIOS,true,"127.0.0.1","20601",SpanReadHandler,ServerState);
+	TCPSocketManager<std::string> SpanClient(pIOS,false,"127.0.0.1","20601",ClientRead,ClientState,
+		std::numeric_limits<size_t>::max(),true,100);
+
+	//returns MB/s
+	auto Run = [&](TCPSocketManager<std::string>& Server, TCPSocketManager<std::string>& Client, std::atomic<size_t>& bytes)
+		{
+			Server.Open();
+			Client.Open();
+			REQUIRE(WaitFor([&](){ return server_connected && client_connected; }));
+
+			std::string chunk(chunk_size,'x');
+			chunk.back() = '\n';
+			auto start = std::chrono::high_resolution_clock::now();
+			for(size_t i = 0; i < num_chunks; i++)
+			{
+				//don't queue up more than a few MB
+				while((i-bytes/chunk_size) > 64)
+					std::this_thread::yield();
+				Client.Write(std::string(chunk));
+			}
+			REQUIRE(WaitFor([&](){ return bytes >= chunk_size*num_chunks; }));
+			auto time = std::chrono::high_resolution_clock::now() - start;
+
+			Client.Close();
+			Server.Close();
+			REQUIRE(WaitFor([&](){ return !server_connected && !client_connected; }));
+			auto secs = std::chrono::duration_cast<std::chrono::microseconds>(time).count()/1e6;
+			return bytes/secs/(1024*1024);
+		};
+
+	auto legacy = Run(LegacyServer,LegacyClient,legacy_bytes);
+	auto span = Run(SpanServer,SpanClient,span_bytes);
+
+	CHECK(legacy_lines == num_chunks);
+	CHECK(span_lines == num_chunks);
+	std::cout<<"streambuf read: "<<legacy<<" MB/s"<<std::endl;
+	std::cout<<"span read:      "<<span<<" MB/s"<<std::endl;
+
+	work.reset();
+	for(auto& t : io_threads)
+		t.join();
+}
+
+TEST_CASE(SUITE("MultiClient"))
+{
+	const size_t num_io_threads = 2;
+	const size_t max_sessions = 3;
+	const size_t frames_to_send = 1000;
+
+	auto pIOS = std::make_shared<asio_service>(num_io_threads);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> io_threads;
+	for(size_t i = 0; i < num_io_threads; i++)
+		io_threads.emplace_back([pIOS](){ pIOS->run(); });
+
+	//each session's reads should only ever have its own client's frames, in order
+	std::mutex mtx;
+	std::map<size_t,std::unique_ptr<FrameChecker>> session_checkers;
+	std::vector<size_t> session_ids;
+	std::atomic_bool server_connected(false);
+	TCPSocketManager<std::string> Server(pIOS,true,"127.0.0.1","20602",[](const char*, size_t len){ return len; },
+		[&](bool state){ server_connected = state; });
+	Server.SetMultiClient(max_sessions,
+		[&](size_t session, const char* data, size_t len) -> size_t
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			auto& pChecker = session_checkers[session];
+			if(!pChecker)
+				pChecker = std::make_unique<FrameChecker>(max_sessions);
+			size_t used = 0;
+			const char* nl;
+			while((nl = static_cast<const char*>(std::memchr(data+used,'\n',len-used))) != nullptr)
+			{
+				pChecker->Check(std::string(data+used,nl));
+				used = nl-data+1;
+			}
+			return used;
+		},
+		[&](size_t session, bool state)
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			if(state)
+				session_ids.push_back(session);
+		});
+
+	//the clients check what's broadcast, and what's written to just them
+	struct Client
+	{
+		std::string received;
+		std::unique_ptr<FrameChecker> pChecker = std::make_unique<FrameChecker>(max_sessions+1);
+		std::atomic<size_t> connects{0}, disconnects{0};
+		std::unique_ptr<TCPSocketManager<std::string>> pSockMan;
+	};
+	std::vector<Client> clients(max_sessions+1);
+	for(auto& c : clients)
+	{
+		auto pC = &c;
+		c.pSockMan = std::make_unique<TCPSocketManager<std::string>>(pIOS,false,"127.0.0.1","20602",
+			[pC](buf_t& readbuf)
+			{
+				pC->received.append(asio::buffers_begin(readbuf.data()),asio::buffers_end(readbuf.data()));
+				readbuf.consume(readbuf.size());
+				size_t pos;
+				while((pos = pC->received.find('\n')) != std::string::npos)
+				{
+					pC->pChecker->Check(pC->received.substr(0,pos));
+					pC->received.erase(0,pos+1);
+				}
+			},
+			[pC](bool state){ state ? pC->connects++ : pC->disconnects++; });
+	}
+
+	Server.Open();
+	//connect them one at a time, so we know which session is which
+	for(size_t i = 0; i < max_sessions; i++)
+	{
+		clients[i].pSockMan->Open();
+		REQUIRE(WaitFor([&](){ return Server.SessionCount() == i+1; }));
+	}
+	REQUIRE(server_connected);
+	REQUIRE(session_ids.size() == max_sessions);
+
+	//one too many gets closed straight away
+	clients[max_sessions].pSockMan->Open();
+	REQUIRE(WaitFor([&](){ return clients[max_sessions].disconnects > 0; }));
+	CHECK(Server.SessionCount() == max_sessions);
+
+	//per-session writes in both directions
+	for(size_t seq = 0; seq < frames_to_send; seq++)
+	{
+		for(size_t i = 0; i < max_sessions; i++)
+		{
+			clients[i].pSockMan->Write(MakeFrame(i,seq));
+			Server.WriteTo(session_ids[i],MakeFrame(i,seq));
+		}
+		//and one for everyone (as if from writer max_sessions)
+		Server.Write(MakeFrame(max_sessions,seq));
+	}
+
+	CHECK(WaitFor([&]()
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			size_t total = 0;
+			for(auto& sc : session_checkers)
+				total += sc.second->frames + sc.second->bad_frames;
+			for(size_t i = 0; i < max_sessions; i++)
+				total += clients[i].pChecker->frames + clients[i].pChecker->bad_frames;
+			return total >= 3*max_sessions*frames_to_send;
+		}));
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		REQUIRE(session_checkers.size() == max_sessions);
+		for(size_t i = 0; i < max_sessions; i++)
+		{
+			auto& server_side = *session_checkers[session_ids[i]];
+			CHECK(server_side.frames == frames_to_send);
+			CHECK(server_side.next_seq[i] == frames_to_send);
+			CHECK(server_side.bad_frames == 0);
+			CHECK(server_side.out_of_order == 0);
+
+			auto& client_side = *clients[i].pChecker;
+			CHECK(client_side.frames == 2*frames_to_send);
+			CHECK(client_side.next_seq[i] == frames_to_send);
+			CHECK(client_side.next_seq[max_sessions] == frames_to_send);
+			CHECK(client_side.bad_frames == 0);
+			CHECK(client_side.out_of_order == 0);
+		}
+	}
+	//the one that was turned away didn't get anything
+	CHECK(clients[max_sessions].pChecker->frames == 0);
+
+	//a client leaving frees its session
+	clients[0].pSockMan->Close();
+	CHECK(WaitFor([&](){ return Server.SessionCount() == max_sessions-1; }));
+	CHECK(server_connected);
+
+	for(auto& c : clients)
+		c.pSockMan->Close();
+	Server.Close();
+	REQUIRE(WaitFor([&](){ return !server_connected && Server.SessionCount() == 0; }));
+	work.reset();
+	for(auto& t : io_threads)
+		t.join();
+}
+
+TEST_CASE(SUITE("MultiClientNoSessions"))
+{
+	auto pIOS = std::make_shared<asio_service>(2);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> io_threads;
+	for(size_t i = 0; i < 2; i++)
+		io_threads.emplace_back([pIOS](){ pIOS->run(); });
+
+	const size_t limit = 3;
+	TCPSocketManager<std::string> Server(pIOS,true,"127.0.0.1","20609",[](const char*, size_t len){ return len; },[](bool){},limit);
+	Server.SetMultiClient(2);
+	Server.Open();
+
+	//nobody's connected yet - the last few are kept for the first session, the same as a client keeps them until it connects
+	for(size_t seq = 0; seq < 5; seq++)
+		Server.Write(MakeFrame(0,seq));
+
+	std::mutex mtx;
+	std::string received;
+	std::atomic_bool connected(false);
+	TCPSocketManager<std::string> Client(pIOS,false,"127.0.0.1","20609",
+		[&](buf_t& readbuf)
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			received.append(asio::buffers_begin(readbuf.data()),asio::buffers_end(readbuf.data()));
+			readbuf.consume(readbuf.size());
+		},
+		[&](bool state){ connected = state; });
+	Client.Open();
+
+	const auto expected = MakeFrame(0,2)+MakeFrame(0,3)+MakeFrame(0,4);
+	CHECK(WaitFor([&]()
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			return received.size() >= expected.size();
+		}));
+	{
+		std::lock_guard<std::mutex> lck(mtx);
+		CHECK(received == expected);
+	}
+
+	Client.Close();
+	Server.Close();
+	REQUIRE(WaitFor([&](){ return !connected && Server.SessionCount() == 0; }));
+	work.reset();
+	for(auto& t : io_threads)
+		t.join();
+}
+
+TEST_CASE(SUITE("IOUring"))
+{
+	const size_t num_io_threads = 2;
+	const size_t frames_to_send = 2000;
+
+	auto pIOS = std::make_shared<asio_service>(num_io_threads);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> io_threads;
+	for(size_t i = 0; i < num_io_threads; i++)
+		io_threads.emplace_back([pIOS](){ pIOS->run(); });
+
+	//small pool, so it runs out and has to wait for buffers to come back
+	auto pRing = io_uring_service::Create(pIOS,256,8,4096);
+	if(!pRing)
+	{
+		WARN("io_uring isn't supported here - skipping");
+		work.reset();
+		for(auto& t : io_threads)
+			t.join();
+		return;
+	}
+
+	//span reads on the server, streambuf reads on the client - both off the ring
+	FrameChecker server_checker(1), client_checker(1);
+	auto SpanReadHandler = [&](const char* data, size_t len) -> size_t
+		{
+			size_t used = 0;
+			const char* nl;
+			while((nl = static_cast<const char*>(std::memchr(data+used,'\n',len-used))) != nullptr)
+			{
+				server_checker.Check(std::string(data+used,nl));
+				used = nl-data+1;
+			}
+			return used;
+		};
+	std::string received;
+	auto ReadHandler = [&](buf_t& readbuf)
+		{
+			received.append(asio::buffers_begin(readbuf.data()),asio::buffers_end(readbuf.data()));
+			readbuf.consume(readbuf.size());
+			size_t pos;
+			while((pos = received.find('\n')) != std::string::npos)
+			{
+				client_checker.Check(received.substr(0,pos));
+				received.erase(0,pos+1);
+			}
+		};
+	std::atomic_bool server_connected(false), client_connected(false);
+	TCPSocketManager<std::string> Server(pIOS,true,"127.0.0.1","20603",SpanReadHandler,
+		[&](bool state){ server_connected = state; });
+	TCPSocketManager<std::string> Client(pIOS,false,"127.0.0.1","20603",ReadHandler,
+		[&](bool state){ client_connected = state; },
+		std::numeric_limits<size_t>::max(),true,100);
+	Server.SetIOUring(pRing);
+	Client.SetIOUring(pRing);
+
+	Server.Open();
+	Client.Open();
+	REQUIRE(WaitFor([&](){ return server_connected && client_connected; }));
+
+	for(size_t seq = 0; seq < frames_to_send; seq++)
+	{
+		Client.Write(MakeFrame(0,seq));
+		Server.Write(MakeFrame(0,seq));
+	}
+	CHECK(WaitFor([&](){ return server_checker.frames + server_checker.bad_frames >= frames_to_send
+		                    && client_checker.frames + client_checker.bad_frames >= frames_to_send; }));
+	for(auto pChecker : {&server_checker,&client_checker})
+	{
+		CHECK(pChecker->frames == frames_to_send);
+		CHECK(pChecker->bad_frames == 0);
+		CHECK(pChecker->out_of_order == 0);
+	}
+	//it should have batched at least some of the submissions
+	CHECK(pRing->Submitted() > pRing->SubmitCalls());
+
+	//closing one end has to finish the reads on the ring, so the other end sees it
+	Server.Close();
+	CHECK(WaitFor([&](){ return !server_connected && !client_connected; }));
+
+	Client.Close();
+	work.reset();
+	for(auto& t : io_threads)
+		t.join();
+}
+
+//A connected pair of sockets, made without running anything
+static void ConnectPair(asio_service& IOS, asio::ip::tcp::acceptor& Acceptor, std::unique_ptr<asio::ip::tcp::socket>& pClient, std::unique_ptr<asio::ip::tcp::socket>& pServer)
+{
+	pClient = IOS.make_tcp_socket();
+	pServer = IOS.make_tcp_socket();
+	pClient->connect(Acceptor.local_endpoint());
+	Acceptor.accept(*pServer);
+}
+
+TEST_CASE(SUITE("IOUringStaleFile"))
+{
+	//nothing's submitted, or handed back, until we run it
+	auto pIOS = std::make_shared<asio_service>(1);
+	auto work = pIOS->make_work();
+	auto pRing = io_uring_service::Create(pIOS,64,8,4096);
+	if(!pRing)
+	{
+		WARN("io_uring isn't supported here - skipping");
+		return;
+	}
+	auto pAcceptor = pIOS->make_tcp_acceptor(asio::ip::tcp::endpoint(asio::ip::address::from_string("127.0.0.1"),0));
+	auto pSerial = pIOS->make_serial_executor();
+	const std::string msg("for the old socket");
+	std::atomic_bool sent(false);
+	asio::error_code send_err;
+	auto Send = [&](const io_uring_service::file_t& file)
+		{
+			sent = false;
+			pRing->send(file,{asio::buffer(msg)},*pSerial,[&](const asio::error_code& err_code, size_t)
+				{
+					send_err = err_code;
+					sent = true;
+				});
+		};
+
+	std::unique_ptr<asio::ip::tcp::socket> pOld, pOldPeer, pNew, pNewPeer;
+	ConnectPair(*pIOS,*pAcceptor,pOld,pOldPeer);
+	auto old_file = pRing->Register(pOld->native_handle());
+	REQUIRE(old_file);
+	Send(old_file);
+
+	//the old socket goes, and a new one gets its fd, before the send goes to the kernel
+	const auto old_fd = pOld->native_handle();
+	pRing->Unregister(old_file);
+	pOld->close();
+	ConnectPair(*pIOS,*pAcceptor,pNew,pNewPeer);
+	CHECK(pNew->native_handle() == old_fd);
+	auto new_file = pRing->Register(pNew->native_handle());
+	REQUIRE(new_file);
+	//the old slot's still busy with the send
+	CHECK(new_file.slot != old_file.slot);
+
+	while(!sent)
+		pIOS->run_one();
+	CHECK(send_err == asio::error::bad_descriptor);
+
+	//nor can anything new start on the old one
+	Send(old_file);
+	while(!sent)
+		pIOS->run_one();
+	CHECK(send_err == asio::error::bad_descriptor);
+
+	//none of it went to the new socket, which works as normal
+	CHECK(pNewPeer->available() == 0);
+	Send(new_file);
+	while(!sent)
+		pIOS->run_one();
+	CHECK_FALSE(send_err);
+	std::string received(msg.size(),0);
+	asio::read(*pNewPeer,asio::buffer(&received[0],received.size()));
+	CHECK(received == msg);
+
+	pRing->Unregister(new_file);
+}
+
+TEST_CASE(SUITE("IOUringDestroyedWhileBusy"))
+{
+	auto pIOS = std::make_shared<asio_service>(1);
+	auto work = pIOS->make_work();
+	std::thread io_thread([pIOS](){ pIOS->run(); });
+
+	auto pRing = io_uring_service::Create(pIOS,64,8,4096);
+	if(pRing)
+	{
+		auto pAcceptor = pIOS->make_tcp_acceptor(asio::ip::tcp::endpoint(asio::ip::address::from_string("127.0.0.1"),0));
+		std::unique_ptr<asio::ip::tcp::socket> pSock, pPeer;
+		ConnectPair(*pIOS,*pAcceptor,pSock,pPeer);
+		auto pSerial = pIOS->make_serial_executor();
+		std::atomic_bool called(false);
+		//a read that's never going to finish by itself
+		pRing->recv(pRing->Register(pSock->native_handle()),*pSerial,[&](const asio::error_code&, const char*, size_t){ called = true; });
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+		//it's cancelled, and nobody's told
+		pRing.reset();
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		CHECK_FALSE(called);
+	}
+	else
+		WARN("io_uring isn't supported here - skipping");
+
+	work.reset();
+	io_thread.join();
+}
+
+#ifdef __linux__
+TEST_CASE(SUITE("IOUringCPU"),"[.][benchmark]")
+{
+	size_t num_connections = 1000;
+	const size_t messages_per_connection = 1000;
+
+	//two sockets per connection
+	rlimit fd_limit;
+	getrlimit(RLIMIT_NOFILE,&fd_limit);
+	fd_limit.rlim_cur = fd_limit.rlim_max;
+	setrlimit(RLIMIT_NOFILE,&fd_limit);
+	getrlimit(RLIMIT_NOFILE,&fd_limit);
+	if(fd_limit.rlim_cur < 2*num_connections+100)
+	{
+		num_connections = (fd_limit.rlim_cur-100)/2;
+		std::cout<<"Only enough file descriptors for "<<num_connections<<" connections"<<std::endl;
+	}
+
+	const size_t num_io_threads = std::max(2u,std::thread::hardware_concurrency());
+	auto pIOS = std::make_shared<asio_service>(num_io_threads);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> io_threads;
+	for(size_t i = 0; i < num_io_threads; i++)
+		io_threads.emplace_back([pIOS](){ pIOS->run(); });
+
+	auto CPUTime = []()
+		{
+			rusage usage;
+			getrusage(RUSAGE_SELF,&usage);
+			return std::chrono::seconds(usage.ru_utime.tv_sec+usage.ru_stime.tv_sec)
+			       + std::chrono::microseconds(usage.ru_utime.tv_usec+usage.ru_stime.tv_usec);
+		};
+
+	//the handlers need these until the io threads are done
+	std::vector<std::unique_ptr<TCPSocketManager<std::string>>> SockMans;
+	std::atomic<size_t> asio_messages(0), uring_messages(0);
+
+	//one multi client server, and all the clients connect to it
+	//	returns CPU microseconds per message
+	auto Run = [&](const std::string& port, std::shared_ptr<io_uring_service> pRing, std::atomic<size_t>& messages)
+		{
+			SockMans.emplace_back(new TCPSocketManager<std::string>(pIOS,true,"127.0.0.1",port,[&](const char* data, size_t len) -> size_t
+				{
+					const char* last = data;
+					for(const char* nl; (nl = static_cast<const char*>(std::memchr(last,'\n',data+len-last))) != nullptr; last = nl+1)
+						messages++;
+					return last-data;
+				},
+				[](bool){}));
+			auto& Server = *SockMans.back();
+			Server.SetMultiClient(num_connections);
+			if(pRing)
+				Server.SetIOUring(pRing);
+			std::vector<TCPSocketManager<std::string>*> Clients;
+			for(size_t i = 0; i < num_connections; i++)
+			{
+				SockMans.emplace_back(new TCPSocketManager<std::string>(pIOS,false,"127.0.0.1",port,[](buf_t& readbuf){ readbuf.consume(readbuf.size()); },[](bool){},
+					std::numeric_limits<size_t>::max(),true,100));
+				Clients.push_back(SockMans.back().get());
+				if(pRing)
+					Clients.back()->SetIOUring(pRing);
+			}
+
+			Server.Open();
+			for(auto& pClient : Clients)
+				pClient->Open();
+			REQUIRE(WaitFor([&](){ return Server.SessionCount() == num_connections; }));
+
+			const std::string message = std::string(63,'m')+"\n";
+			auto start = CPUTime();
+			for(size_t m = 0; m < messages_per_connection; m++)
+				for(auto& pClient : Clients)
+					pClient->Write(std::string(message));
+			REQUIRE(WaitFor([&](){ return messages >= num_connections*messages_per_connection; },std::chrono::seconds(300)));
+			auto cpu = CPUTime()-start;
+
+			for(auto& pClient : Clients)
+				pClient->Close();
+			Server.Close();
+			REQUIRE(WaitFor([&](){ return Server.SessionCount() == 0; }));
+			return double(std::chrono::duration_cast<std::chrono::microseconds>(cpu).count())/messages;
+		};
+
+	auto asio_us = Run("20604",nullptr,asio_messages);
+	std::cout<<"asio/epoll: "<<asio_us<<" CPU us per message over "<<num_connections<<" connections"<<std::endl;
+	if(auto pRing = io_uring_service::Create(pIOS))
+	{
+		auto uring_us = Run("20605",pRing,uring_messages);
+		std::cout<<"io_uring:   "<<uring_us<<" CPU us per message over "<<num_connections<<" connections ("
+		         <<pRing->Submitted()<<" submissions in "<<pRing->SubmitCalls()<<" syscalls)"<<std::endl;
+	}
+	else
+		std::cout<<"io_uring isn't supported here"<<std::endl;
+
+	work.reset();
+	for(auto& t : io_threads)
+		t.join();
+}
+#endif
+
+TEST_CASE(SUITE("ResolveWithoutBlocking"))
+{
+	//a stand-in for a slow DNS server (put back to the system one afterwards, even if it fails)
+	struct LookupScope
+	{
+		~LookupScope(){ SetNameLookup(nullptr); }
+	} lookup_scope;
+	std::atomic<size_t> lookups(0);
+	SetNameLookup([&](const std::string& host, const std::string& port, asio::error_code& err) -> tcp_endpoints_t
+		{
+			lookups++;
+			std::this_thread::sleep_for(std::chrono::milliseconds(500));
+			return {asio::ip::tcp::endpoint(asio::ip::make_address("127.0.0.1"),static_cast<unsigned short>(std::stoul(port)))};
+		});
+
+	auto pIOS = std::make_shared<asio_service>(2);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> io_threads;
+	for(size_t i = 0; i < 2; i++)
+		io_threads.emplace_back([pIOS](){ pIOS->run(); });
+
+	//neither constructing nor opening waits for the lookup
+	std::atomic_bool server_connected(false), client_connected(false);
+	auto start = std::chrono::steady_clock::now();
+	TCPSocketManager<std::string> Server(pIOS,true,"upstream.test","20606",[](buf_t& readbuf){ readbuf.consume(readbuf.size()); },
+		[&](bool state){ server_connected = state; });
+	TCPSocketManager<std::string> Client(pIOS,false,"upstream.test","20606",[](buf_t& readbuf){ readbuf.consume(readbuf.size()); },
+		[&](bool state){ client_connected = state; },
+		std::numeric_limits<size_t>::max(),true,100);
+	Server.Open();
+	Client.Open();
+	CHECK(std::chrono::steady_clock::now()-start < std::chrono::milliseconds(250));
+
+	REQUIRE(WaitFor([&](){ return server_connected && client_connected; }));
+	//they shared the lookup, and any retries came from the cache
+	CHECK(lookups == 1);
+
+	Client.Close();
+	Server.Close();
+	REQUIRE(WaitFor([&](){ return !server_connected && !client_connected; }));
+	work.reset();
+	for(auto& t : io_threads)
+		t.join();
+}
+
+TEST_CASE(SUITE("PacedReconnectStorm"))
+{
+	const size_t num_clients = 20;
+	struct RateLimitScope
+	{
+		RateLimitScope(){ SetConnectRateLimit(100); }
+		~RateLimitScope(){ SetConnectRateLimit(0); }
+	} rate_limit_scope;
+
+	auto pIOS = std::make_shared<asio_service>(2);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> io_threads;
+	for(size_t i = 0; i < 2; i++)
+		io_threads.emplace_back([pIOS](){ pIOS->run(); });
+
+	std::mutex mtx;
+	std::vector<std::chrono::steady_clock::time_point> connect_times;
+	std::atomic<size_t> connected(0);
+	TCPSocketManager<std::string> Server(pIOS,true,"127.0.0.1","20607",[](buf_t& readbuf){ readbuf.consume(readbuf.size()); },[](bool){});
+	Server.SetMultiClient(num_clients);
+	std::vector<std::unique_ptr<TCPSocketManager<std::string>>> Clients;
+	for(size_t i = 0; i < num_clients; i++)
+	{
+		Clients.emplace_back(new TCPSocketManager<std::string>(pIOS,false,"127.0.0.1","20607",[](buf_t& readbuf){ readbuf.consume(readbuf.size()); },
+			[&](bool state)
+			{
+				if(state)
+				{
+				      std::lock_guard<std::mutex> lck(mtx);
+				      connect_times.push_back(std::chrono::steady_clock::now());
+				      connected++;
+				}
+				else
+					connected--;
+			},
+			std::numeric_limits<size_t>::max(),true));
+	}
+
+	//a connection every 10ms at most, no matter how many want to go at once
+	auto CheckSpread = [&](const bool one_turn_each)
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			REQUIRE(connect_times.size() == num_clients);
+			std::sort(connect_times.begin(),connect_times.end());
+			auto spread = connect_times.back()-connect_times.front();
+			CHECK(spread >= std::chrono::milliseconds(10)*(num_clients-2));
+			//not one turn to open and another to connect
+			//	(reconnects are spread out more anyway, by their backoff)
+			if(one_turn_each)
+				CHECK(spread < std::chrono::milliseconds(15)*num_clients);
+			connect_times.clear();
+		};
+
+	//the first open is paced by the caller, like DataConcentrator enabling ports
+	Server.Open();
+	for(auto& pClient : Clients)
+	{
+		auto pC = pClient.get();
+		PaceConnect(pIOS,[pC](){ pC->Open(); });
+	}
+	REQUIRE(WaitFor([&](){ return connected == num_clients && Server.SessionCount() == num_clients; }));
+	CheckSpread(true);
+
+	//the upstream goes away and comes back - they all come back too, but not all at once
+	Server.Close();
+	REQUIRE(WaitFor([&](){ return connected == 0; }));
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	Server.Open();
+	REQUIRE(WaitFor([&](){ return connected == num_clients && Server.SessionCount() == num_clients; }));
+	CheckSpread(false);
+
+	for(auto& pClient : Clients)
+		pClient->Close();
+	Server.Close();
+	REQUIRE(WaitFor([&](){ return connected == 0 && Server.SessionCount() == 0; }));
+	work.reset();
+	for(auto& t : io_threads)
+		t.join();
+}
@@ -38,10 +38,22 @@ public:
 	PublicPublishPort(const std::string& aName, const std::string& aConfFilename, const Json::Value& aConfOverrides):
 		NullPort(aName, aConfFilename, aConfOverrides)
 	{}
-	void PublicPublishEvent(std::shared_ptr<EventInfo> event, SharedStatusCallback_t pStatusCallback = std::make_shared<std::function<void (CommandStatus status)>>([] (CommandStatus status){}))
+	void PublicPublishEvent(std::shared_ptr<EventInfo> event, SharedStatusCallback_t pStatusCallback = NoOpStatusCallback())
 	{
 		PublishEvent(event,pStatusCallback);
 	}
+	void PublicPublishEvent(const EventBatch_t& batch, SharedStatusCallback_t pStatusCallback = NoOpStatusCallback())
+	{
+		PublishEvent(batch,pStatusCallback);
+	}
+	SharedStatusCallback_t PublicSyncMultiCallback(const size_t cb_number, SharedStatusCallback_t pStatusCallback)
+	{
+		return SyncMultiCallback(cb_number,pStatusCallback);
+	}
+	void PublicKeepSnapshot()
+	{
+		KeepSnapshot();
+	}
 };
 
 class PayloadCheckPort: public NullPort
@@ -66,6 +78,47 @@ public:
 	}
 };
 
+class BatchCountPort: public NullPort
+{
+public:
+	BatchCountPort(const std::string& aName, const std::string& aConfFilename, const Json::Value& aConfOverrides):
+		NullPort(aName, aConfFilename, aConfOverrides)
+	{}
+	void Event(std::shared_ptr<const EventInfo> event, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override
+	{
+		Indexes.push_back(event->GetIndex());
+		Events.push_back(event);
+		(*pStatusCallback)(CommandStatus::SUCCESS);
+	}
+	void Event(const EventBatch_t& batch, const std::string& SenderName, SharedStatusCallback_t pStatusCallback) override
+	{
+		Batches++;
+		for(const auto& event : batch)
+		{
+			Indexes.push_back(event->GetIndex());
+			Events.push_back(event);
+		}
+		(*pStatusCallback)(CommandStatus::SUCCESS);
+	}
+	size_t Batches = 0;
+	std::vector<size_t> Indexes;
+	std::vector<std::shared_ptr<const EventInfo>> Events;
+};
+
+class InterestPort: public BatchCountPort
+{
+public:
+	InterestPort(const std::string& aName, const std::string& aConfFilename, const Json::Value& aConfOverrides):
+		BatchCountPort(aName, aConfFilename, aConfOverrides),
+		Interest(EventInterest::Nothing())
+	{}
+	EventInterest GetEventInterest() override
+	{
+		return Interest;
+	}
+	EventInterest Interest;
+};
+
 }
 
 #endif /* TESTPORTS_H_ */
@@ -0,0 +1,77 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * ThreadBudgetTests.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+#include <catch.hpp>
+#include <opendatacon/ThreadBudget.h>
+
+using namespace odc;
+
+#define SUITE(name) "ThreadBudgetTestSuite - " name
+
+TEST_CASE(SUITE("ParseConfig"))
+{
+	auto defaults = DefaultThreadBudget();
+	REQUIRE(defaults.Workers >= 1);
+	REQUIRE(defaults.ProtocolWorkers >= 1);
+	REQUIRE(defaults.LogWorkers == 3);
+	REQUIRE(defaults.WorkerCPUs.empty());
+
+	//missing section means defaults
+	auto budget = ParseThreadBudget(Json::Value::nullSingleton());
+	REQUIRE(budget.Workers == defaults.Workers);
+	REQUIRE(budget.ProtocolWorkers == defaults.ProtocolWorkers);
+
+	Json::Value conf;
+	conf["Workers"] = 4;
+	conf["ProtocolWorkers"] = 0;
+	conf["LogWorkers"] = 1;
+	conf["CPUAffinity"][0] = 2;
+	conf["CPUAffinity"][1] = 3;
+	budget = ParseThreadBudget(conf);
+	REQUIRE(budget.Workers == 4);
+	//every pool gets at least one thread
+	REQUIRE(budget.ProtocolWorkers == 1);
+	REQUIRE(budget.LogWorkers == 1);
+	REQUIRE(budget.WorkerCPUs == std::vector<unsigned int>({2,3}));
+	REQUIRE(budget.ProtocolCPUs == budget.WorkerCPUs);
+	REQUIRE(budget.LogCPUs == budget.WorkerCPUs);
+
+	//separate CPUs for each pool
+	conf["CPUAffinity"] = Json::Value();
+	conf["CPUAffinity"]["Workers"][0] = 0;
+	conf["CPUAffinity"]["Workers"][1] = 1;
+	conf["CPUAffinity"]["Log"] = 3;
+	budget = ParseThreadBudget(conf);
+	REQUIRE(budget.WorkerCPUs == std::vector<unsigned int>({0,1}));
+	REQUIRE(budget.ProtocolCPUs.empty());
+	REQUIRE(budget.LogCPUs == std::vector<unsigned int>({3}));
+
+	SetThreadBudget(budget);
+	REQUIRE(GetThreadBudget().Workers == 4);
+	SetThreadBudget(defaults);
+	REQUIRE(GetThreadBudget().Workers == defaults.Workers);
+
+	REQUIRE(SetCurrentThreadAffinity({}));
+}
@@ -0,0 +1,183 @@
+/*	opendatacon
+ *
+ *	Copyright (c) 2014:
+ *
+ *		DCrip3fJguWgVCLrZFfA7sIGgvx1Ou3fHfCxnrz4svAi
+ *		yxeOtDhDCXf1Z4ApgXvX5ahqQmzRfJ2DoX8S05SqHA==
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+/*
+ * VirtualTimeTests.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: Neil Stephens <dearknarl@gmail.com>
+ */
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include <opendatacon/asio.h>
+#include <opendatacon/ASIOScheduler.h>
+
+using namespace odc;
+
+#define SUITE(name) "VirtualTimeTestSuite - " name
+
+//Switches virtual time on for a test, and back off again even if it fails
+struct VirtualTimeScope
+{
+	VirtualTimeScope(){ EnableVirtualTime(); }
+	~VirtualTimeScope(){ DisableVirtualTime(); }
+};
+
+TEST_CASE(SUITE("TimersFireInOrder"))
+{
+	VirtualTimeScope virtual_time;
+	auto pIOS = std::make_shared<asio_service>(1);
+	const auto start = asio_clock::now();
+
+	//the clock is exactly the expiry when each timer fires, and they fire in expiry order
+	std::vector<std::unique_ptr<steady_timer>> timers;
+	std::vector<size_t> fired;
+	bool on_time = true;
+	for(size_t i : {5, 1, 4, 2, 3})
+	{
+		timers.push_back(pIOS->make_steady_timer(std::chrono::hours(i)));
+		auto expiry = timers.back()->expires_at();
+		timers.back()->async_wait([&,i,expiry](asio::error_code err)
+			{
+				on_time &= (asio_clock::now() == expiry);
+				fired.push_back(i);
+			});
+	}
+	//a cancelled timer doesn't hold the clock up, or fire
+	auto pCancelled = pIOS->make_steady_timer(std::chrono::hours(2));
+	bool cancelled_aborted = false;
+	pCancelled->async_wait([&](asio::error_code err){ cancelled_aborted = (err == asio::error::operation_aborted); });
+	pCancelled->cancel();
+
+	auto real_start = std::chrono::steady_clock::now();
+	pIOS->run_virtual();
+	auto real_time = std::chrono::steady_clock::now() - real_start;
+
+	CHECK(fired == std::vector<size_t>({1,2,3,4,5}));
+	CHECK(on_time);
+	CHECK(cancelled_aborted);
+	CHECK(asio_clock::now() - start == std::chrono::hours(5));
+	CHECK(real_time < std::chrono::seconds(5));
+}
+
+TEST_CASE(SUITE("HandlersRunBeforeTheClockMoves"))
+{
+	VirtualTimeScope virtual_time;
+	auto pIOS = std::make_shared<asio_service>(1);
+	auto pSerial = pIOS->make_serial_executor();
+
+	//a periodic timer that hands off to an executor - the work is all done before the next period
+	const auto period = std::chrono::seconds(1);
+	auto pTimer = pIOS->make_steady_timer();
+	size_t ticks = 0, late = 0;
+	asio_clock::time_point deadline = asio_clock::now();
+	std::function<void()> tick = [&]()
+		{
+			deadline += period;
+			pTimer->expires_at(deadline);
+			pTimer->async_wait([&](asio::error_code err)
+				{
+					if(err)
+						return;
+					pSerial->post([&]()
+						{
+							if(asio_clock::now() != deadline)
+								late++;
+							if(++ticks < 3600)
+								tick();
+						});
+				});
+		};
+	tick();
+	pIOS->run_virtual();
+
+	CHECK(ticks == 3600);
+	CHECK(late == 0);
+}
+
+TEST_CASE(SUITE("RunUntil"))
+{
+	VirtualTimeScope virtual_time;
+	auto pIOS = std::make_shared<asio_service>(1);
+	auto work = pIOS->make_work();
+
+	//ASIOScheduler polls on the asio_clock, so an hour of polling takes no time
+	ASIOScheduler scheduler(*pIOS);
+	size_t fast = 0, slow = 0;
+	std::function<void()> fast_poll = [&](){ fast++; };
+	std::function<void()> slow_poll = [&](){ slow++; };
+	scheduler.Add(1000,fast_poll);
+	scheduler.Add(60000,slow_poll);
+	scheduler.Start();
+
+	const auto start = asio_clock::now();
+	pIOS->run_virtual_for(std::chrono::hours(1));
+	CHECK(asio_clock::now() - start == std::chrono::hours(1));
+	CHECK(fast == 3600);
+	CHECK(slow == 60);
+
+	//and it picks up where it left off
+	pIOS->run_virtual_for(std::chrono::minutes(1));
+	CHECK(fast == 3660);
+	CHECK(slow == 61);
+	scheduler.Stop();
+	pIOS->run_virtual();
+}
+
+TEST_CASE(SUITE("ThreadsWaitForTheClock"))
+{
+	VirtualTimeScope virtual_time;
+	auto pIOS = std::make_shared<asio_service>(2);
+	auto work = pIOS->make_work();
+	std::vector<std::thread> threads;
+	for(size_t i = 0; i < 2; i++)
+		threads.emplace_back([&](){ pIOS->run(); });
+
+	std::atomic<size_t> fired(0);
+	auto pTimer = pIOS->make_steady_timer(std::chrono::hours(1));
+	pTimer->async_wait([&](asio::error_code err){ fired++; });
+
+	//the threads sleep until the clock moves, rather than spinning on a timer that won't expire by itself
+	auto cpu_start = std::clock();
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	auto cpu_ms = (std::clock()-cpu_start)*1000/CLOCKS_PER_SEC;
+	CHECK(fired == 0);
+	CHECK(cpu_ms < 100);
+
+	//not far enough
+	AdvanceVirtualTime(std::chrono::minutes(30));
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	CHECK(fired == 0);
+
+	AdvanceVirtualTime(std::chrono::minutes(30));
+	auto deadline = std::chrono::steady_clock::now()+std::chrono::seconds(10);
+	while(fired == 0 && std::chrono::steady_clock::now() < deadline)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	CHECK(fired == 1);
+
+	work.reset();
+	for(auto& t : threads)
+		t.join();
+}